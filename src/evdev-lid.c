@@ -156,7 +156,7 @@ evdev_read_switch_reliability_prop(struct evdev_device *device)
 	const char *prop;
 	enum switch_reliability r;
 
-	prop = udev_device_get_property_value(device->udev_device,
+	prop = evdev_device_get_udev_property(device,
 					      "LIBINPUT_ATTR_LID_SWITCH_RELIABILITY");
 	if (!parse_switch_reliability_property(prop, &r)) {
 		evdev_log_error(device,
@@ -279,6 +279,7 @@ struct evdev_dispatch_interface lid_switch_interface = {
 	lid_switch_interface_device_added,   /* device_resumed, treat as add */
 	lid_switch_sync_initial_state,
 	NULL, /* toggle_touch */
+	NULL, /* sync_touches */
 };
 
 struct evdev_dispatch *
@@ -24,10 +24,15 @@
 #include "config.h"
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "evdev.h"
 
 #define MIDDLEBUTTON_TIMEOUT ms2us(50)
+#define MIDDLEBUTTON_TIMEOUT_MIN ms2us(20)
+/* don't adapt until we've seen a few chords */
+#define MIDDLEBUTTON_MIN_SAMPLES 8
 
 /*****************************************
  * BEFORE YOU EDIT THIS FILE, look at the state diagram in
@@ -92,7 +97,77 @@ static void
 middlebutton_timer_set(struct evdev_device *device, uint64_t now)
 {
 	libinput_timer_set(&device->middlebutton.timer,
-			   now + MIDDLEBUTTON_TIMEOUT);
+			   now + device->middlebutton.timeout);
+}
+
+static int
+middlebutton_gap_cmp(const void *a, const void *b)
+{
+	uint64_t ga = *(const uint64_t*)a,
+		 gb = *(const uint64_t*)b;
+
+	return ga < gb ? -1 : ga > gb;
+}
+
+/* The timeout is 1.5 times the 99th percentile of the recent chord
+ * gaps, within MIDDLEBUTTON_TIMEOUT_MIN and MIDDLEBUTTON_TIMEOUT. A
+ * shorter timeout means fewer chords are seen, so chords missed by a
+ * small margin are counted too, see middlebutton_record_gap().
+ */
+static void
+middlebutton_update_timeout(struct evdev_device *device)
+{
+	uint64_t gaps[MIDDLEBUTTON_GAP_HISTORY];
+	uint64_t timeout;
+	unsigned int n;
+
+	n = min(device->middlebutton.stats.ngaps,
+		(unsigned int)MIDDLEBUTTON_GAP_HISTORY);
+	if (n < MIDDLEBUTTON_MIN_SAMPLES)
+		return;
+
+	memcpy(gaps, device->middlebutton.stats.gaps, n * sizeof(*gaps));
+	qsort(gaps, n, sizeof(*gaps), middlebutton_gap_cmp);
+
+	/* nearest rank */
+	timeout = gaps[(n * 99 + 99)/100 - 1] * 3/2;
+	timeout = max(timeout, MIDDLEBUTTON_TIMEOUT_MIN);
+	timeout = min(timeout, MIDDLEBUTTON_TIMEOUT);
+
+	if (timeout == device->middlebutton.timeout)
+		return;
+
+	device->middlebutton.timeout = timeout;
+	evdev_log_debug(device,
+			"middlebutton: timeout now %dms (%u chords, %u missed)\n",
+			(int)us2ms(timeout),
+			device->middlebutton.stats.nchords,
+			device->middlebutton.stats.nmissed);
+}
+
+static void
+middlebutton_record_gap(struct evdev_device *device,
+			uint64_t now,
+			bool missed)
+{
+	uint64_t gap = now - device->middlebutton.first_event_time;
+	unsigned int idx;
+
+	if (missed) {
+		/* the other button came too late for our timeout, but
+		 * would have made it with the default one */
+		if (gap > MIDDLEBUTTON_TIMEOUT)
+			return;
+		device->middlebutton.stats.nmissed++;
+	} else {
+		device->middlebutton.stats.nchords++;
+	}
+
+	idx = device->middlebutton.stats.ngaps % MIDDLEBUTTON_GAP_HISTORY;
+	device->middlebutton.stats.gaps[idx] = gap;
+	device->middlebutton.stats.ngaps++;
+
+	middlebutton_update_timeout(device);
 }
 
 static void
@@ -175,6 +250,7 @@ evdev_middlebutton_ldown_handle_event(struct evdev_device *device,
 		middlebutton_state_error(device, event);
 		break;
 	case MIDDLEBUTTON_EVENT_R_DOWN:
+		middlebutton_record_gap(device, time, false);
 		middlebutton_post_event(device, time,
 					BTN_MIDDLE,
 					LIBINPUT_BUTTON_STATE_PRESSED);
@@ -209,6 +285,7 @@ evdev_middlebutton_ldown_handle_event(struct evdev_device *device,
 		middlebutton_set_state(device,
 				       MIDDLEBUTTON_PASSTHROUGH,
 				       time);
+		device->middlebutton.timed_out = true;
 		break;
 	case MIDDLEBUTTON_EVENT_ALL_UP:
 		middlebutton_state_error(device, event);
@@ -225,6 +302,7 @@ evdev_middlebutton_rdown_handle_event(struct evdev_device *device,
 {
 	switch (event) {
 	case MIDDLEBUTTON_EVENT_L_DOWN:
+		middlebutton_record_gap(device, time, false);
 		middlebutton_post_event(device, time,
 					BTN_MIDDLE,
 					LIBINPUT_BUTTON_STATE_PRESSED);
@@ -263,6 +341,7 @@ evdev_middlebutton_rdown_handle_event(struct evdev_device *device,
 		middlebutton_set_state(device,
 				       MIDDLEBUTTON_PASSTHROUGH,
 				       time);
+		device->middlebutton.timed_out = true;
 		break;
 	case MIDDLEBUTTON_EVENT_ALL_UP:
 		middlebutton_state_error(device, event);
@@ -393,14 +472,20 @@ evdev_middlebutton_passthrough_handle_event(struct evdev_device *device,
 	switch (event) {
 	case MIDDLEBUTTON_EVENT_L_DOWN:
 	case MIDDLEBUTTON_EVENT_R_DOWN:
+		if (device->middlebutton.timed_out)
+			middlebutton_record_gap(device, time, true);
+		device->middlebutton.timed_out = false;
+		return 0;
 	case MIDDLEBUTTON_EVENT_OTHER:
 	case MIDDLEBUTTON_EVENT_R_UP:
 	case MIDDLEBUTTON_EVENT_L_UP:
+		device->middlebutton.timed_out = false;
 		return 0;
 	case MIDDLEBUTTON_EVENT_TIMEOUT:
 		middlebutton_state_error(device, event);
 		break;
 	case MIDDLEBUTTON_EVENT_ALL_UP:
+		device->middlebutton.timed_out = false;
 		middlebutton_set_state(device, MIDDLEBUTTON_IDLE, time);
 		break;
 	}
@@ -691,6 +776,21 @@ evdev_middlebutton_get_default(struct libinput_device *device)
 			LIBINPUT_CONFIG_MIDDLE_EMULATION_DISABLED;
 }
 
+bool
+evdev_middlebutton_get_stats(struct evdev_device *device,
+			     struct libinput_middle_emulation_stats *stats)
+{
+	/* only set by evdev_init_middlebutton() */
+	if (device->middlebutton.timeout == 0)
+		return false;
+
+	stats->chords = device->middlebutton.stats.nchords;
+	stats->missed = device->middlebutton.stats.nmissed;
+	stats->timeout_usec = device->middlebutton.timeout;
+
+	return true;
+}
+
 void
 evdev_init_middlebutton(struct evdev_device *device,
 			bool enable,
@@ -698,11 +798,13 @@ evdev_init_middlebutton(struct evdev_device *device,
 {
 	libinput_timer_init(&device->middlebutton.timer,
 			    evdev_libinput_context(device),
+			    &device->base,
 			    evdev_middlebutton_handle_timeout,
 			    device);
 	device->middlebutton.enabled_default = enable;
 	device->middlebutton.want_enabled = enable;
 	device->middlebutton.enabled = enable;
+	device->middlebutton.timeout = MIDDLEBUTTON_TIMEOUT;
 
 	if (!want_config)
 		return;
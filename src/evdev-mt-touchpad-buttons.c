@@ -146,14 +146,14 @@ is_inside_top_middle_area(const struct tp_dispatch *tp,
 static void
 tp_button_set_enter_timer(struct tp_dispatch *tp, struct tp_touch *t)
 {
-	libinput_timer_set(&t->button.timer,
+	libinput_timer_set(&t->cold->button.timer,
 			   t->millis + DEFAULT_BUTTON_ENTER_TIMEOUT);
 }
 
 static void
 tp_button_set_leave_timer(struct tp_dispatch *tp, struct tp_touch *t)
 {
-	libinput_timer_set(&t->button.timer,
+	libinput_timer_set(&t->cold->button.timer,
 			   t->millis + DEFAULT_BUTTON_LEAVE_TIMEOUT);
 }
 
@@ -167,31 +167,31 @@ tp_button_set_state(struct tp_dispatch *tp,
 		    enum button_state new_state,
 		    enum button_event event)
 {
-	libinput_timer_cancel(&t->button.timer);
+	libinput_timer_cancel(&t->cold->button.timer);
 
-	t->button.state = new_state;
+	t->button_state = new_state;
 
-	switch (t->button.state) {
+	switch (t->button_state) {
 	case BUTTON_STATE_NONE:
-		t->button.curr = 0;
+		t->cold->button.curr = 0;
 		break;
 	case BUTTON_STATE_AREA:
-		t->button.curr = BUTTON_EVENT_IN_AREA;
+		t->cold->button.curr = BUTTON_EVENT_IN_AREA;
 		break;
 	case BUTTON_STATE_BOTTOM:
-		t->button.curr = event;
+		t->cold->button.curr = event;
 		break;
 	case BUTTON_STATE_TOP:
 		break;
 	case BUTTON_STATE_TOP_NEW:
-		t->button.curr = event;
+		t->cold->button.curr = event;
 		tp_button_set_enter_timer(tp, t);
 		break;
 	case BUTTON_STATE_TOP_TO_IGNORE:
 		tp_button_set_leave_timer(tp, t);
 		break;
 	case BUTTON_STATE_IGNORE:
-		t->button.curr = 0;
+		t->cold->button.curr = 0;
 		break;
 	}
 }
@@ -258,7 +258,7 @@ tp_button_bottom_handle_event(struct tp_dispatch *tp,
 	case BUTTON_EVENT_IN_BOTTOM_R:
 	case BUTTON_EVENT_IN_BOTTOM_M:
 	case BUTTON_EVENT_IN_BOTTOM_L:
-		if (event != t->button.curr)
+		if (event != t->cold->button.curr)
 			tp_button_set_state(tp,
 					    t,
 					    BUTTON_STATE_BOTTOM,
@@ -294,7 +294,7 @@ tp_button_top_handle_event(struct tp_dispatch *tp,
 	case BUTTON_EVENT_IN_TOP_R:
 	case BUTTON_EVENT_IN_TOP_M:
 	case BUTTON_EVENT_IN_TOP_L:
-		if (event != t->button.curr)
+		if (event != t->cold->button.curr)
 			tp_button_set_state(tp,
 					    t,
 					    BUTTON_STATE_TOP_NEW,
@@ -327,7 +327,7 @@ tp_button_top_new_handle_event(struct tp_dispatch *tp,
 	case BUTTON_EVENT_IN_TOP_R:
 	case BUTTON_EVENT_IN_TOP_M:
 	case BUTTON_EVENT_IN_TOP_L:
-		if (event != t->button.curr)
+		if (event != t->cold->button.curr)
 			tp_button_set_state(tp,
 					    t,
 					    BUTTON_STATE_TOP_NEW,
@@ -359,7 +359,7 @@ tp_button_top_to_ignore_handle_event(struct tp_dispatch *tp,
 	case BUTTON_EVENT_IN_TOP_R:
 	case BUTTON_EVENT_IN_TOP_M:
 	case BUTTON_EVENT_IN_TOP_L:
-		if (event == t->button.curr)
+		if (event == t->cold->button.curr)
 			tp_button_set_state(tp,
 					    t,
 					    BUTTON_STATE_TOP,
@@ -417,9 +417,9 @@ tp_button_handle_event(struct tp_dispatch *tp,
 		       enum button_event event,
 		       uint64_t time)
 {
-	enum button_state current = t->button.state;
+	enum button_state current = t->button_state;
 
-	switch(t->button.state) {
+	switch(t->button_state) {
 	case BUTTON_STATE_NONE:
 		tp_button_none_handle_event(tp, t, event);
 		break;
@@ -443,12 +443,48 @@ tp_button_handle_event(struct tp_dispatch *tp,
 		break;
 	}
 
-	if (current != t->button.state)
-		evdev_log_debug(tp->device,
-				"button state: from %s, event %s to %s\n",
-				button_state_to_str(current),
-				button_event_to_str(event),
-				button_state_to_str(t->button.state));
+	if (current != t->button_state)
+		evdev_log_debug_trace(tp->device,
+				      "button state: from %s, event %s to %s\n",
+				      button_state_to_str(current),
+				      button_event_to_str(event),
+				      button_state_to_str(t->button_state));
+}
+
+static void
+tp_button_handle_touch_state(struct tp_dispatch *tp,
+			     struct tp_touch *t,
+			     uint64_t time)
+{
+	if (t->state == TOUCH_NONE || t->state == TOUCH_HOVERING)
+		return;
+
+	if (t->state == TOUCH_END) {
+		tp_button_handle_event(tp, t, BUTTON_EVENT_UP, time);
+	} else if (t->dirty) {
+		enum button_event event;
+
+		if (is_inside_bottom_right_area(tp, t))
+			event = BUTTON_EVENT_IN_BOTTOM_R;
+		else if (is_inside_bottom_middle_area(tp, t))
+			event = BUTTON_EVENT_IN_BOTTOM_M;
+		else if (is_inside_bottom_left_area(tp, t))
+			event = BUTTON_EVENT_IN_BOTTOM_L;
+		else if (is_inside_top_right_area(tp, t))
+			event = BUTTON_EVENT_IN_TOP_R;
+		else if (is_inside_top_middle_area(tp, t))
+			event = BUTTON_EVENT_IN_TOP_M;
+		else if (is_inside_top_left_area(tp, t))
+			event = BUTTON_EVENT_IN_TOP_L;
+		else
+			event = BUTTON_EVENT_IN_AREA;
+
+		tp_button_handle_event(tp, t, event, time);
+	}
+	if (tp->queued & TOUCHPAD_EVENT_BUTTON_RELEASE)
+		tp_button_handle_event(tp, t, BUTTON_EVENT_RELEASE, time);
+	if (tp->queued & TOUCHPAD_EVENT_BUTTON_PRESS)
+		tp_button_handle_event(tp, t, BUTTON_EVENT_PRESS, time);
 }
 
 void
@@ -456,36 +492,16 @@ tp_button_handle_state(struct tp_dispatch *tp, uint64_t time)
 {
 	struct tp_touch *t;
 
-	tp_for_each_touch(tp, t) {
-		if (t->state == TOUCH_NONE || t->state == TOUCH_HOVERING)
-			continue;
-
-		if (t->state == TOUCH_END) {
-			tp_button_handle_event(tp, t, BUTTON_EVENT_UP, time);
-		} else if (t->dirty) {
-			enum button_event event;
-
-			if (is_inside_bottom_right_area(tp, t))
-				event = BUTTON_EVENT_IN_BOTTOM_R;
-			else if (is_inside_bottom_middle_area(tp, t))
-				event = BUTTON_EVENT_IN_BOTTOM_M;
-			else if (is_inside_bottom_left_area(tp, t))
-				event = BUTTON_EVENT_IN_BOTTOM_L;
-			else if (is_inside_top_right_area(tp, t))
-				event = BUTTON_EVENT_IN_TOP_R;
-			else if (is_inside_top_middle_area(tp, t))
-				event = BUTTON_EVENT_IN_TOP_M;
-			else if (is_inside_top_left_area(tp, t))
-				event = BUTTON_EVENT_IN_TOP_L;
-			else
-				event = BUTTON_EVENT_IN_AREA;
-
-			tp_button_handle_event(tp, t, event, time);
-		}
-		if (tp->queued & TOUCHPAD_EVENT_BUTTON_RELEASE)
-			tp_button_handle_event(tp, t, BUTTON_EVENT_RELEASE, time);
-		if (tp->queued & TOUCHPAD_EVENT_BUTTON_PRESS)
-			tp_button_handle_event(tp, t, BUTTON_EVENT_PRESS, time);
+	/* A physical button press or release affects all touches,
+	 * otherwise only the touches that changed in this frame need
+	 * handling. TOUCH_END is always dirty. */
+	if (tp->queued & (TOUCHPAD_EVENT_BUTTON_PRESS |
+			  TOUCHPAD_EVENT_BUTTON_RELEASE)) {
+		tp_for_each_touch(tp, t)
+			tp_button_handle_touch_state(tp, t, time);
+	} else {
+		tp_for_each_dirty_touch(tp, t)
+			tp_button_handle_touch_state(tp, t, time);
 	}
 }
 
@@ -871,9 +887,10 @@ tp_init_buttons(struct tp_dispatch *tp,
 	tp_init_middlebutton_emulation(tp, device);
 
 	tp_for_each_touch(tp, t) {
-		t->button.state = BUTTON_STATE_NONE;
-		libinput_timer_init(&t->button.timer,
+		t->button_state = BUTTON_STATE_NONE;
+		libinput_timer_init(&t->cold->button.timer,
 				    tp_libinput_context(tp),
+				    &tp->device->base,
 				    tp_button_handle_timeout, t);
 	}
 }
@@ -884,7 +901,7 @@ tp_remove_buttons(struct tp_dispatch *tp)
 	struct tp_touch *t;
 
 	tp_for_each_touch(tp, t)
-		libinput_timer_cancel(&t->button.timer);
+		libinput_timer_cancel(&t->cold->button.timer);
 }
 
 static int
@@ -935,8 +952,8 @@ tp_clickfinger_within_distance(struct tp_dispatch *tp,
 	if (!t1 || !t2)
 		return 0;
 
-	if (t1->thumb.state == THUMB_STATE_YES ||
-	    t2->thumb.state == THUMB_STATE_YES)
+	if (t1->thumb_state == THUMB_STATE_YES ||
+	    t2->thumb_state == THUMB_STATE_YES)
 		return 0;
 
 	x = abs(t1->point.x - t2->point.x);
@@ -992,11 +1009,8 @@ tp_clickfinger_set_button(struct tp_dispatch *tp)
 
 	/* two fingers down on the touchpad. Check for distance
 	 * between the fingers. */
-	tp_for_each_touch(tp, t) {
-		if (t->state != TOUCH_BEGIN && t->state != TOUCH_UPDATE)
-			continue;
-
-		if (t->thumb.state == THUMB_STATE_YES)
+	tp_for_each_active_touch(tp, t) {
+		if (t->thumb_state == THUMB_STATE_YES)
 			continue;
 
 		if (!first)
@@ -1097,7 +1111,7 @@ tp_post_clickpadbutton_buttons(struct tp_dispatch *tp, uint64_t time)
 		uint32_t area = 0;
 
 		tp_for_each_touch(tp, t) {
-			switch (t->button.curr) {
+			switch (t->cold->button.curr) {
 			case BUTTON_EVENT_IN_AREA:
 				area |= AREA;
 				break;
@@ -1187,7 +1201,7 @@ bool
 tp_button_touch_active(const struct tp_dispatch *tp,
 		       const struct tp_touch *t)
 {
-	return t->button.state == BUTTON_STATE_AREA;
+	return t->button_state == BUTTON_STATE_AREA;
 }
 
 bool
@@ -102,7 +102,7 @@ tp_edge_scroll_set_timer(struct tp_dispatch *tp,
 	    LIBINPUT_CONFIG_CLICK_METHOD_BUTTON_AREAS)
 		return;
 
-	libinput_timer_set(&t->scroll.timer,
+	libinput_timer_set(&t->cold->scroll.timer,
 			   t->millis + DEFAULT_SCROLL_LOCK_TIMEOUT);
 }
 
@@ -111,23 +111,23 @@ tp_edge_scroll_set_state(struct tp_dispatch *tp,
 			 struct tp_touch *t,
 			 enum tp_edge_scroll_touch_state state)
 {
-	libinput_timer_cancel(&t->scroll.timer);
+	libinput_timer_cancel(&t->cold->scroll.timer);
 
-	t->scroll.edge_state = state;
+	t->edge_state = state;
 
 	switch (state) {
 	case EDGE_SCROLL_TOUCH_STATE_NONE:
-		t->scroll.edge = EDGE_NONE;
+		t->cold->scroll.edge = EDGE_NONE;
 		break;
 	case EDGE_SCROLL_TOUCH_STATE_EDGE_NEW:
-		t->scroll.edge = tp_touch_get_edge(tp, t);
-		t->scroll.initial = t->point;
+		t->cold->scroll.edge = tp_touch_get_edge(tp, t);
+		t->cold->scroll.initial = t->point;
 		tp_edge_scroll_set_timer(tp, t);
 		break;
 	case EDGE_SCROLL_TOUCH_STATE_EDGE:
 		break;
 	case EDGE_SCROLL_TOUCH_STATE_AREA:
-		t->scroll.edge = EDGE_NONE;
+		t->cold->scroll.edge = EDGE_NONE;
 		break;
 	}
 }
@@ -170,8 +170,8 @@ tp_edge_scroll_handle_edge_new(struct tp_dispatch *tp,
 			       event);
 		break;
 	case SCROLL_EVENT_MOTION:
-		t->scroll.edge &= tp_touch_get_edge(tp, t);
-		if (!t->scroll.edge)
+		t->cold->scroll.edge &= tp_touch_get_edge(tp, t);
+		if (!t->cold->scroll.edge)
 			tp_edge_scroll_set_state(tp, t,
 					EDGE_SCROLL_TOUCH_STATE_AREA);
 		break;
@@ -199,9 +199,9 @@ tp_edge_scroll_handle_edge(struct tp_dispatch *tp,
 		break;
 	case SCROLL_EVENT_MOTION:
 		/* If started at the bottom right, decide in which dir to scroll */
-		if (t->scroll.edge == (EDGE_RIGHT | EDGE_BOTTOM)) {
-			t->scroll.edge &= tp_touch_get_edge(tp, t);
-			if (!t->scroll.edge)
+		if (t->cold->scroll.edge == (EDGE_RIGHT | EDGE_BOTTOM)) {
+			t->cold->scroll.edge &= tp_touch_get_edge(tp, t);
+			if (!t->cold->scroll.edge)
 				tp_edge_scroll_set_state(tp, t,
 						EDGE_SCROLL_TOUCH_STATE_AREA);
 		}
@@ -240,7 +240,7 @@ tp_edge_scroll_handle_event(struct tp_dispatch *tp,
 			    struct tp_touch *t,
 			    enum scroll_event event)
 {
-	enum tp_edge_scroll_touch_state current = t->scroll.edge_state;
+	enum tp_edge_scroll_touch_state current = t->edge_state;
 
 	switch (current) {
 	case EDGE_SCROLL_TOUCH_STATE_NONE:
@@ -257,11 +257,11 @@ tp_edge_scroll_handle_event(struct tp_dispatch *tp,
 		break;
 	}
 
-	evdev_log_debug(tp->device,
-			"edge state: %s → %s → %s\n",
-			edge_state_to_str(current),
-			edge_event_to_str(event),
-			edge_state_to_str(t->scroll.edge_state));
+	evdev_log_debug_trace(tp->device,
+			      "edge state: %s → %s → %s\n",
+			      edge_state_to_str(current),
+			      edge_event_to_str(event),
+			      edge_state_to_str(t->edge_state));
 }
 
 static void
@@ -303,9 +303,10 @@ tp_edge_scroll_init(struct tp_dispatch *tp, struct evdev_device *device)
 		tp->scroll.bottom_edge = INT_MAX;
 
 	tp_for_each_touch(tp, t) {
-		t->scroll.direction = -1;
-		libinput_timer_init(&t->scroll.timer,
+		t->cold->scroll.direction = -1;
+		libinput_timer_init(&t->cold->scroll.timer,
 				    tp_libinput_context(tp),
+				    &tp->device->base,
 				    tp_edge_scroll_handle_timeout, t);
 	}
 }
@@ -316,7 +317,7 @@ tp_remove_edge_scroll(struct tp_dispatch *tp)
 	struct tp_touch *t;
 
 	tp_for_each_touch(tp, t)
-		libinput_timer_cancel(&t->scroll.timer);
+		libinput_timer_cancel(&t->cold->scroll.timer);
 }
 
 void
@@ -325,21 +326,20 @@ tp_edge_scroll_handle_state(struct tp_dispatch *tp, uint64_t time)
 	struct tp_touch *t;
 
 	if (tp->scroll.method != LIBINPUT_CONFIG_SCROLL_EDGE) {
-		tp_for_each_touch(tp, t) {
+		tp_for_each_touch_in_mask(tp, t, tp->touch_masks.began) {
 			if (t->state == TOUCH_BEGIN)
-				t->scroll.edge_state =
+				t->edge_state =
 					EDGE_SCROLL_TOUCH_STATE_AREA;
-			else if (t->state == TOUCH_END)
-				t->scroll.edge_state =
+		}
+		tp_for_each_touch_in_mask(tp, t, tp->touch_masks.ended) {
+			if (t->state == TOUCH_END)
+				t->edge_state =
 					EDGE_SCROLL_TOUCH_STATE_NONE;
 		}
 		return;
 	}
 
-	tp_for_each_touch(tp, t) {
-		if (!t->dirty)
-			continue;
-
+	tp_for_each_dirty_touch(tp, t) {
 		switch (t->state) {
 		case TOUCH_NONE:
 		case TOUCH_HOVERING:
@@ -368,28 +368,25 @@ tp_edge_scroll_post_events(struct tp_dispatch *tp, uint64_t time)
 	const struct normalized_coords zero = { 0.0, 0.0 };
 	const struct discrete_coords zero_discrete = { 0.0, 0.0 };
 
-	tp_for_each_touch(tp, t) {
-		if (!t->dirty)
-			continue;
-
-		if (t->palm.state != PALM_NONE)
+	tp_for_each_dirty_touch(tp, t) {
+		if (t->palm_state != PALM_NONE)
 			continue;
 
 		/* only scroll with the finger in the previous edge */
-		if (t->scroll.edge &&
-		    (tp_touch_get_edge(tp, t) & t->scroll.edge) == 0)
+		if (t->cold->scroll.edge &&
+		    (tp_touch_get_edge(tp, t) & t->cold->scroll.edge) == 0)
 			continue;
 
-		switch (t->scroll.edge) {
+		switch (t->cold->scroll.edge) {
 			case EDGE_NONE:
-				if (t->scroll.direction != -1) {
+				if (t->cold->scroll.direction != -1) {
 					/* Send stop scroll event */
 					evdev_notify_axis(device, time,
-						AS_MASK(t->scroll.direction),
+						AS_MASK(t->cold->scroll.direction),
 						LIBINPUT_POINTER_AXIS_SOURCE_FINGER,
 						&zero,
 						&zero_discrete);
-					t->scroll.direction = -1;
+					t->cold->scroll.direction = -1;
 				}
 				continue;
 			case EDGE_RIGHT:
@@ -408,18 +405,18 @@ tp_edge_scroll_post_events(struct tp_dispatch *tp, uint64_t time)
 		/* scroll is not accelerated */
 		normalized = tp_filter_motion_unaccelerated(tp, &normalized, time);
 
-		switch (t->scroll.edge_state) {
+		switch (t->edge_state) {
 		case EDGE_SCROLL_TOUCH_STATE_NONE:
 		case EDGE_SCROLL_TOUCH_STATE_AREA:
 			evdev_log_bug_libinput(device,
 					 "unexpected scroll state %d\n",
-					 t->scroll.edge_state);
+					 t->edge_state);
 			break;
 		case EDGE_SCROLL_TOUCH_STATE_EDGE_NEW:
 			tmp = normalized;
 			normalized = tp_normalize_delta(tp,
 					device_delta(t->point,
-						     t->scroll.initial));
+						     t->cold->scroll.initial));
 			if (fabs(*delta) < DEFAULT_SCROLL_THRESHOLD)
 				normalized = zero;
 			else
@@ -437,7 +434,7 @@ tp_edge_scroll_post_events(struct tp_dispatch *tp, uint64_t time)
 				  LIBINPUT_POINTER_AXIS_SOURCE_FINGER,
 				  &normalized,
 				  &zero_discrete);
-		t->scroll.direction = axis;
+		t->cold->scroll.direction = axis;
 
 		tp_edge_scroll_handle_event(tp, t, SCROLL_EVENT_POSTED);
 	}
@@ -454,17 +451,17 @@ tp_edge_scroll_stop_events(struct tp_dispatch *tp, uint64_t time)
 	const struct discrete_coords zero_discrete = { 0.0, 0.0 };
 
 	tp_for_each_touch(tp, t) {
-		if (t->scroll.direction != -1) {
+		if (t->cold->scroll.direction != -1) {
 			evdev_notify_axis(device, time,
-					    AS_MASK(t->scroll.direction),
+					    AS_MASK(t->cold->scroll.direction),
 					    LIBINPUT_POINTER_AXIS_SOURCE_FINGER,
 					    &zero,
 					    &zero_discrete);
-			t->scroll.direction = -1;
+			t->cold->scroll.direction = -1;
 			/* reset touch to area state, avoids loading the
 			 * state machine with special case handling */
-			t->scroll.edge = EDGE_NONE;
-			t->scroll.edge_state = EDGE_SCROLL_TOUCH_STATE_AREA;
+			t->cold->scroll.edge = EDGE_NONE;
+			t->edge_state = EDGE_SCROLL_TOUCH_STATE_AREA;
 		}
 	}
 }
@@ -473,5 +470,5 @@ int
 tp_edge_scroll_touch_active(const struct tp_dispatch *tp,
 			    const struct tp_touch *t)
 {
-	return t->scroll.edge_state == EDGE_SCROLL_TOUCH_STATE_AREA;
+	return t->edge_state == EDGE_SCROLL_TOUCH_STATE_AREA;
 }
@@ -49,12 +49,13 @@ static struct normalized_coords
 tp_get_touches_delta(struct tp_dispatch *tp, bool average)
 {
 	struct tp_touch *t;
-	unsigned int i, nactive = 0;
+	unsigned int nactive = 0;
 	struct normalized_coords normalized;
 	struct normalized_coords delta = {0.0, 0.0};
 
-	for (i = 0; i < tp->num_slots; i++) {
-		t = &tp->touches[i];
+	tp_for_each_active_touch(tp, t) {
+		if (tp_touch_index(tp, t) >= tp->num_slots)
+			break;
 
 		if (!tp_touch_active(tp, t))
 			continue;
@@ -129,7 +130,6 @@ static void
 tp_gesture_post_pointer_motion(struct tp_dispatch *tp, uint64_t time)
 {
 	struct normalized_coords delta, unaccel;
-	struct device_float_coords raw;
 
 	/* When a clickpad is clicked, combine motion of all active touches */
 	if (tp->buttons.is_clickpad && tp->buttons.state)
@@ -139,13 +139,14 @@ tp_gesture_post_pointer_motion(struct tp_dispatch *tp, uint64_t time)
 
 	delta = tp_filter_motion(tp, &unaccel, time);
 
-	if (!normalized_is_zero(delta) || !normalized_is_zero(unaccel)) {
-		raw = tp_unnormalize_for_xaxis(tp, unaccel);
-		pointer_notify_motion(&tp->device->base,
-				      time,
-				      &delta,
-				      &raw);
-	}
+	/* The raw delta is unaccel scaled back with the x axis
+	 * coefficient, see tp_unnormalize_for_xaxis() */
+	if (!normalized_is_zero(delta) || !normalized_is_zero(unaccel))
+		pointer_notify_motion_normalized(&tp->device->base,
+						 time,
+						 &delta,
+						 &unaccel,
+						 tp->accel.x_scale_coeff);
 }
 
 static unsigned int
@@ -190,7 +191,7 @@ tp_gesture_get_direction(struct tp_dispatch *tp, struct tp_touch *touch,
 
 	move_threshold *= (nfingers - 1);
 
-	delta = device_delta(touch->point, touch->gesture.initial);
+	delta = device_delta(touch->point, touch->cold->gesture.initial);
 	mm = tp_phys_delta(tp, delta);
 
 	if (length_in_mm(mm) < move_threshold)
@@ -226,8 +227,8 @@ tp_gesture_set_scroll_buildup(struct tp_dispatch *tp)
 	struct tp_touch *first = tp->gesture.touches[0],
 			*second = tp->gesture.touches[1];
 
-	d0 = device_delta(first->point, first->gesture.initial);
-	d1 = device_delta(second->point, second->gesture.initial);
+	d0 = device_delta(first->point, first->cold->gesture.initial);
+	d1 = device_delta(second->point, second->cold->gesture.initial);
 
 	average = device_float_average(d0, d1);
 	tp->device->scroll.buildup = tp_normalize_delta(tp, average);
@@ -286,8 +287,8 @@ tp_gesture_handle_state_none(struct tp_dispatch *tp, uint64_t time)
 	}
 
 	tp->gesture.initial_time = time;
-	first->gesture.initial = first->point;
-	second->gesture.initial = second->point;
+	first->cold->gesture.initial = first->point;
+	second->cold->gesture.initial = second->point;
 	tp->gesture.touches[0] = first;
 	tp->gesture.touches[1] = second;
 
@@ -479,10 +480,10 @@ tp_gesture_post_gesture(struct tp_dispatch *tp, uint64_t time)
 		tp->gesture.state =
 			tp_gesture_handle_state_pinch(tp, time);
 
-	evdev_log_debug(tp->device,
-			"gesture state: %s → %s\n",
-			gesture_state_to_str(oldstate),
-			gesture_state_to_str(tp->gesture.state));
+	evdev_log_debug_trace(tp->device,
+			      "gesture state: %s → %s\n",
+			      gesture_state_to_str(oldstate),
+			      gesture_state_to_str(tp->gesture.state));
 }
 
 void
@@ -594,7 +595,7 @@ tp_gesture_handle_state(struct tp_dispatch *tp, uint64_t time)
 	unsigned int active_touches = 0;
 	struct tp_touch *t;
 
-	tp_for_each_touch(tp, t) {
+	tp_for_each_active_touch(tp, t) {
 		if (tp_touch_active(tp, t))
 			active_touches++;
 	}
@@ -632,6 +633,7 @@ tp_init_gesture(struct tp_dispatch *tp)
 
 	libinput_timer_init(&tp->gesture.finger_count_switch_timer,
 			    tp_libinput_context(tp),
+			    &tp->device->base,
 			    tp_gesture_finger_count_switch_timeout, tp);
 }
 
@@ -144,6 +144,17 @@ tp_tap_clear_timer(struct tp_dispatch *tp)
 	libinput_timer_cancel(&tp->tap.timer);
 }
 
+static inline void
+tp_tap_update_speculative(struct tp_dispatch *tp)
+{
+	/* Switching mid-sequence would leave the button state out of
+	 * sync with the state machine */
+	if (tp->tap.state != TAP_STATE_IDLE)
+		return;
+
+	tp->tap.speculative_enabled = tp->tap.want_speculative_enabled;
+}
+
 static void
 tp_tap_idle_handle_event(struct tp_dispatch *tp,
 			 struct tp_touch *t,
@@ -190,6 +201,14 @@ tp_tap_touch_handle_event(struct tp_dispatch *tp,
 			      1,
 			      LIBINPUT_BUTTON_STATE_PRESSED);
 		if (tp->tap.drag_enabled) {
+			/* Speculative taps release immediately, a drag or
+			 * double-tap presses the button again on the next
+			 * touch */
+			if (tp->tap.speculative_enabled)
+				tp_tap_notify(tp,
+					      time,
+					      1,
+					      LIBINPUT_BUTTON_STATE_RELEASED);
 			tp->tap.state = TAP_STATE_TAPPED;
 			tp_tap_set_timer(tp, time);
 		} else {
@@ -210,8 +229,8 @@ tp_tap_touch_handle_event(struct tp_dispatch *tp,
 		break;
 	case TAP_EVENT_THUMB:
 		tp->tap.state = TAP_STATE_IDLE;
-		t->tap.is_thumb = true;
-		t->tap.state = TAP_TOUCH_STATE_DEAD;
+		t->cold->tap.is_thumb = true;
+		t->cold->tap.state = TAP_TOUCH_STATE_DEAD;
 		tp_tap_clear_timer(tp);
 		break;
 	}
@@ -239,8 +258,8 @@ tp_tap_hold_handle_event(struct tp_dispatch *tp,
 		break;
 	case TAP_EVENT_THUMB:
 		tp->tap.state = TAP_STATE_IDLE;
-		t->tap.is_thumb = true;
-		t->tap.state = TAP_TOUCH_STATE_DEAD;
+		t->cold->tap.is_thumb = true;
+		t->cold->tap.state = TAP_TOUCH_STATE_DEAD;
 		break;
 	}
 }
@@ -258,15 +277,19 @@ tp_tap_tapped_handle_event(struct tp_dispatch *tp,
 		break;
 	case TAP_EVENT_TOUCH:
 		tp->tap.state = TAP_STATE_DRAGGING_OR_DOUBLETAP;
+		if (tp->tap.speculative_enabled)
+			tp_tap_notify(tp, time, 1, LIBINPUT_BUTTON_STATE_PRESSED);
 		tp_tap_set_timer(tp, time);
 		break;
 	case TAP_EVENT_TIMEOUT:
 		tp->tap.state = TAP_STATE_IDLE;
-		tp_tap_notify(tp, time, 1, LIBINPUT_BUTTON_STATE_RELEASED);
+		if (!tp->tap.speculative_enabled)
+			tp_tap_notify(tp, time, 1, LIBINPUT_BUTTON_STATE_RELEASED);
 		break;
 	case TAP_EVENT_BUTTON:
 		tp->tap.state = TAP_STATE_DEAD;
-		tp_tap_notify(tp, time, 1, LIBINPUT_BUTTON_STATE_RELEASED);
+		if (!tp->tap.speculative_enabled)
+			tp_tap_notify(tp, time, 1, LIBINPUT_BUTTON_STATE_RELEASED);
 		break;
 	case TAP_EVENT_THUMB:
 		break;
@@ -337,7 +360,7 @@ tp_tap_touch2_release_handle_event(struct tp_dispatch *tp,
 	switch (event) {
 	case TAP_EVENT_TOUCH:
 		tp->tap.state = TAP_STATE_TOUCH_2_HOLD;
-		t->tap.state = TAP_TOUCH_STATE_DEAD;
+		t->cold->tap.state = TAP_TOUCH_STATE_DEAD;
 		tp_tap_clear_timer(tp);
 		break;
 	case TAP_EVENT_RELEASE:
@@ -375,7 +398,7 @@ tp_tap_touch3_handle_event(struct tp_dispatch *tp,
 		break;
 	case TAP_EVENT_RELEASE:
 		tp->tap.state = TAP_STATE_TOUCH_2_HOLD;
-		if (t->tap.state == TAP_TOUCH_STATE_TOUCH) {
+		if (t->cold->tap.state == TAP_TOUCH_STATE_TOUCH) {
 			tp_tap_notify(tp, time, 3, LIBINPUT_BUTTON_STATE_PRESSED);
 			tp_tap_notify(tp, time, 3, LIBINPUT_BUTTON_STATE_RELEASED);
 		}
@@ -577,8 +600,12 @@ tp_tap_multitap_handle_event(struct tp_dispatch *tp,
 		break;
 	case TAP_EVENT_TIMEOUT:
 		tp->tap.state = TAP_STATE_IDLE;
-		tp_tap_notify(tp, time, 1, LIBINPUT_BUTTON_STATE_PRESSED);
-		tp_tap_notify(tp, time, 1, LIBINPUT_BUTTON_STATE_RELEASED);
+		/* in speculative mode the last tap's click was sent when
+		 * the finger lifted */
+		if (!tp->tap.speculative_enabled) {
+			tp_tap_notify(tp, time, 1, LIBINPUT_BUTTON_STATE_PRESSED);
+			tp_tap_notify(tp, time, 1, LIBINPUT_BUTTON_STATE_RELEASED);
+		}
 		break;
 	case TAP_EVENT_BUTTON:
 		tp->tap.state = TAP_STATE_IDLE;
@@ -708,11 +735,14 @@ tp_tap_handle_event(struct tp_dispatch *tp,
 	if (tp->tap.state == TAP_STATE_IDLE || tp->tap.state == TAP_STATE_DEAD)
 		tp_tap_clear_timer(tp);
 
-	evdev_log_debug(tp->device,
-		  "tap state: %s → %s → %s\n",
-		  tap_state_to_str(current),
-		  tap_event_to_str(event),
-		  tap_state_to_str(tp->tap.state));
+	if (tp->tap.state == TAP_STATE_IDLE)
+		tp_tap_update_speculative(tp);
+
+	evdev_log_debug_trace(tp->device,
+			      "tap state: %s → %s → %s\n",
+			      tap_state_to_str(current),
+			      tap_event_to_str(event),
+			      tap_state_to_str(tp->tap.state));
 }
 
 static bool
@@ -720,7 +750,7 @@ tp_tap_exceeds_motion_threshold(struct tp_dispatch *tp,
 				struct tp_touch *t)
 {
 	struct phys_coords mm =
-		tp_phys_delta(tp, device_delta(t->point, t->tap.initial));
+		tp_phys_delta(tp, device_delta(t->point, t->cold->tap.initial));
 
 	return length_in_mm(mm) > DEFAULT_TAP_MOVE_THRESHOLD;
 }
@@ -746,17 +776,17 @@ tp_tap_handle_state(struct tp_dispatch *tp, uint64_t time)
 	if (tp->buttons.is_clickpad && tp->queued & TOUCHPAD_EVENT_BUTTON_PRESS)
 		tp_tap_handle_event(tp, NULL, TAP_EVENT_BUTTON, time);
 
-	tp_for_each_touch(tp, t) {
-		if (!t->dirty || t->state == TOUCH_NONE)
+	tp_for_each_dirty_touch(tp, t) {
+		if (t->state == TOUCH_NONE)
 			continue;
 
 		if (tp->buttons.is_clickpad &&
 		    tp->queued & TOUCHPAD_EVENT_BUTTON_PRESS)
-			t->tap.state = TAP_TOUCH_STATE_DEAD;
+			t->cold->tap.state = TAP_TOUCH_STATE_DEAD;
 
 		/* If a touch was considered thumb for tapping once, we
 		 * ignore it for the rest of lifetime */
-		if (t->tap.is_thumb)
+		if (t->cold->tap.is_thumb)
 			continue;
 
 		if (t->state == TOUCH_HOVERING)
@@ -766,13 +796,13 @@ tp_tap_handle_state(struct tp_dispatch *tp, uint64_t time)
 			/* The simple version: if a touch is a thumb on
 			 * begin we ignore it. All other thumb touches
 			 * follow the normal tap state for now */
-			if (t->thumb.state == THUMB_STATE_YES) {
-				t->tap.is_thumb = true;
+			if (t->thumb_state == THUMB_STATE_YES) {
+				t->cold->tap.is_thumb = true;
 				continue;
 			}
 
-			t->tap.state = TAP_TOUCH_STATE_TOUCH;
-			t->tap.initial = t->point;
+			t->cold->tap.state = TAP_TOUCH_STATE_TOUCH;
+			t->cold->tap.initial = t->point;
 			tp_tap_handle_event(tp, t, TAP_EVENT_TOUCH, time);
 
 			/* If we think this is a palm, pretend there's a
@@ -785,7 +815,7 @@ tp_tap_handle_state(struct tp_dispatch *tp, uint64_t time)
 		} else if (t->state == TOUCH_END) {
 			if (t->was_down)
 				tp_tap_handle_event(tp, t, TAP_EVENT_RELEASE, time);
-			t->tap.state = TAP_TOUCH_STATE_IDLE;
+			t->cold->tap.state = TAP_TOUCH_STATE_IDLE;
 		} else if (tp->tap.state != TAP_STATE_IDLE &&
 			   tp_tap_exceeds_motion_threshold(tp, t)) {
 			struct tp_touch *tmp;
@@ -793,14 +823,14 @@ tp_tap_handle_state(struct tp_dispatch *tp, uint64_t time)
 			/* Any touch exceeding the threshold turns all
 			 * touches into DEAD */
 			tp_for_each_touch(tp, tmp) {
-				if (tmp->tap.state == TAP_TOUCH_STATE_TOUCH)
-					tmp->tap.state = TAP_TOUCH_STATE_DEAD;
+				if (tmp->cold->tap.state == TAP_TOUCH_STATE_TOUCH)
+					tmp->cold->tap.state = TAP_TOUCH_STATE_DEAD;
 			}
 
 			tp_tap_handle_event(tp, t, TAP_EVENT_MOTION, time);
 		} else if (tp->tap.state != TAP_STATE_IDLE &&
-			   t->thumb.state == THUMB_STATE_YES &&
-			   !t->tap.is_thumb) {
+			   t->thumb_state == THUMB_STATE_YES &&
+			   !t->cold->tap.is_thumb) {
 			tp_tap_handle_event(tp, t, TAP_EVENT_THUMB, time);
 		}
 	}
@@ -856,10 +886,10 @@ tp_tap_handle_timeout(uint64_t time, void *data)
 
 	tp_for_each_touch(tp, t) {
 		if (t->state == TOUCH_NONE ||
-		    t->tap.state == TAP_TOUCH_STATE_IDLE)
+		    t->cold->tap.state == TAP_TOUCH_STATE_IDLE)
 			continue;
 
-		t->tap.state = TAP_TOUCH_STATE_DEAD;
+		t->cold->tap.state = TAP_TOUCH_STATE_DEAD;
 	}
 }
 
@@ -1045,6 +1075,46 @@ tp_tap_config_get_default_draglock_enabled(struct libinput_device *device)
 	return tp_drag_lock_default(evdev);
 }
 
+static enum libinput_config_status
+tp_tap_config_set_speculative_enabled(struct libinput_device *device,
+				      enum libinput_config_tap_speculative_state enabled)
+{
+	struct evdev_dispatch *dispatch = evdev_device(device)->dispatch;
+	struct tp_dispatch *tp = tp_dispatch(dispatch);
+
+	tp->tap.want_speculative_enabled =
+		(enabled == LIBINPUT_CONFIG_TAP_SPECULATIVE_ENABLED);
+
+	tp_tap_update_speculative(tp);
+
+	return LIBINPUT_CONFIG_STATUS_SUCCESS;
+}
+
+static enum libinput_config_tap_speculative_state
+tp_tap_config_get_speculative_enabled(struct libinput_device *device)
+{
+	struct evdev_dispatch *dispatch = evdev_device(device)->dispatch;
+	struct tp_dispatch *tp = tp_dispatch(dispatch);
+
+	return tp->tap.want_speculative_enabled ?
+		LIBINPUT_CONFIG_TAP_SPECULATIVE_ENABLED :
+		LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED;
+}
+
+static inline enum libinput_config_tap_speculative_state
+tp_tap_speculative_default(struct evdev_device *device)
+{
+	return LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED;
+}
+
+static enum libinput_config_tap_speculative_state
+tp_tap_config_get_default_speculative_enabled(struct libinput_device *device)
+{
+	struct evdev_device *evdev = evdev_device(device);
+
+	return tp_tap_speculative_default(evdev);
+}
+
 void
 tp_init_tap(struct tp_dispatch *tp)
 {
@@ -1061,6 +1131,9 @@ tp_init_tap(struct tp_dispatch *tp)
 	tp->tap.config.set_draglock_enabled = tp_tap_config_set_draglock_enabled;
 	tp->tap.config.get_draglock_enabled = tp_tap_config_get_draglock_enabled;
 	tp->tap.config.get_default_draglock_enabled = tp_tap_config_get_default_draglock_enabled;
+	tp->tap.config.set_speculative_enabled = tp_tap_config_set_speculative_enabled;
+	tp->tap.config.get_speculative_enabled = tp_tap_config_get_speculative_enabled;
+	tp->tap.config.get_default_speculative_enabled = tp_tap_config_get_default_speculative_enabled;
 	tp->device->base.config.tap = &tp->tap.config;
 
 	tp->tap.state = TAP_STATE_IDLE;
@@ -1069,9 +1142,14 @@ tp_init_tap(struct tp_dispatch *tp)
 	tp->tap.want_map = tp->tap.map;
 	tp->tap.drag_enabled = tp_drag_default(tp->device);
 	tp->tap.drag_lock_enabled = tp_drag_lock_default(tp->device);
+	tp->tap.speculative_enabled =
+		tp_tap_speculative_default(tp->device) ==
+			LIBINPUT_CONFIG_TAP_SPECULATIVE_ENABLED;
+	tp->tap.want_speculative_enabled = tp->tap.speculative_enabled;
 
 	libinput_timer_init(&tp->tap.timer,
 			    tp_libinput_context(tp),
+			    &tp->device->base,
 			    tp_tap_handle_timeout, tp);
 }
 
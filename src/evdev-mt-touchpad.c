@@ -60,8 +60,7 @@ tp_filter_motion(struct tp_dispatch *tp,
 	 * make sure we're on the same resolution for both axes */
 	raw = tp_unnormalize_for_xaxis(tp, *unaccelerated);
 
-	return filter_dispatch(tp->device->pointer.filter,
-			       &raw, tp, time);
+	return evdev_filter_dispatch(tp->device, &raw, tp, time);
 }
 
 struct normalized_coords
@@ -82,6 +81,31 @@ tp_filter_motion_unaccelerated(struct tp_dispatch *tp,
 					&raw, tp, time);
 }
 
+static inline void
+tp_motion_smoothing(struct tp_dispatch *tp,
+		    struct tp_touch *t,
+		    uint64_t time)
+{
+	struct device_float_coords in, out;
+
+	if (!tp->smoothing.enabled || t->history.count == 0) {
+		smoothing_filter_reset(&t->cold->smoothing);
+		if (!tp->smoothing.enabled) {
+			t->cold->smoothed = t->point;
+			return;
+		}
+	}
+
+	in.x = t->point.x;
+	in.y = t->point.y;
+	out = smoothing_filter_apply(&t->cold->smoothing,
+				     &tp->smoothing.params,
+				     &in,
+				     time);
+	t->cold->smoothed.x = round(out.x);
+	t->cold->smoothed.y = round(out.y);
+}
+
 static inline void
 tp_motion_history_push(struct tp_touch *t)
 {
@@ -90,7 +114,7 @@ tp_motion_history_push(struct tp_touch *t)
 	if (t->history.count < TOUCHPAD_HISTORY_LENGTH)
 		t->history.count++;
 
-	t->history.samples[motion_index] = t->point;
+	t->history.samples[motion_index] = t->cold->smoothed;
 	t->history.index = motion_index;
 }
 
@@ -200,6 +224,13 @@ tp_fake_finger_set(struct tp_dispatch *tp,
 	}
 }
 
+static inline void
+tp_touch_set_dirty(struct tp_dispatch *tp, struct tp_touch *t)
+{
+	t->dirty = true;
+	long_set_bit(tp->touch_masks.dirty, tp_touch_index(tp, t));
+}
+
 static inline void
 tp_new_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 {
@@ -212,11 +243,11 @@ tp_new_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 	 * don't know if it's a touch down or not. And BTN_TOUCH may happen
 	 * after ABS_MT_TRACKING_ID */
 	tp_motion_history_reset(t);
-	t->dirty = true;
+	tp_touch_set_dirty(tp, t);
 	t->has_ended = false;
 	t->was_down = false;
 	t->state = TOUCH_HOVERING;
-	t->pinned.is_pinned = false;
+	t->is_pinned = false;
 	t->millis = time;
 	tp->queued |= TOUCHPAD_EVENT_MOTION;
 }
@@ -224,15 +255,19 @@ tp_new_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 static inline void
 tp_begin_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 {
-	t->dirty = true;
+	unsigned int idx = tp_touch_index(tp, t);
+
+	tp_touch_set_dirty(tp, t);
+	long_set_bit(tp->touch_masks.active, idx);
+	long_set_bit(tp->touch_masks.began, idx);
 	t->state = TOUCH_BEGIN;
 	t->millis = time;
 	t->was_down = true;
 	tp->nfingers_down++;
-	t->palm.time = time;
-	t->thumb.state = THUMB_STATE_MAYBE;
-	t->thumb.first_touch_time = time;
-	t->tap.is_thumb = false;
+	t->cold->palm.time = time;
+	t->thumb_state = THUMB_STATE_MAYBE;
+	t->cold->thumb.first_touch_time = time;
+	t->cold->tap.is_thumb = false;
 	assert(tp->nfingers_down >= 1);
 }
 
@@ -242,6 +277,8 @@ tp_begin_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 static inline void
 tp_end_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 {
+	unsigned int idx = tp_touch_index(tp, t);
+
 	switch (t->state) {
 	case TOUCH_HOVERING:
 		t->state = TOUCH_NONE;
@@ -255,12 +292,14 @@ tp_end_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 
 	}
 
-	t->dirty = true;
-	t->palm.state = PALM_NONE;
+	tp_touch_set_dirty(tp, t);
+	long_clear_bit(tp->touch_masks.active, idx);
+	long_set_bit(tp->touch_masks.ended, idx);
+	t->palm_state = PALM_NONE;
 	t->state = TOUCH_END;
-	t->pinned.is_pinned = false;
+	t->is_pinned = false;
 	t->millis = time;
-	t->palm.time = 0;
+	t->cold->palm.time = 0;
 	assert(tp->nfingers_down >= 1);
 	tp->nfingers_down--;
 	tp->queued |= TOUCHPAD_EVENT_MOTION;
@@ -307,7 +346,7 @@ tp_process_absolute(struct tp_dispatch *tp,
 						  e->value);
 		t->point.x = e->value;
 		t->millis = time;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_MOTION;
 		break;
 	case ABS_MT_POSITION_Y:
@@ -316,7 +355,7 @@ tp_process_absolute(struct tp_dispatch *tp,
 						  e->value);
 		t->point.y = e->value;
 		t->millis = time;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_MOTION;
 		break;
 	case ABS_MT_SLOT:
@@ -330,7 +369,7 @@ tp_process_absolute(struct tp_dispatch *tp,
 		break;
 	case ABS_MT_PRESSURE:
 		t->pressure = e->value;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_OTHERAXIS;
 		break;
 	}
@@ -350,7 +389,7 @@ tp_process_absolute_st(struct tp_dispatch *tp,
 						  e->value);
 		t->point.x = e->value;
 		t->millis = time;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_MOTION;
 		break;
 	case ABS_Y:
@@ -359,12 +398,12 @@ tp_process_absolute_st(struct tp_dispatch *tp,
 						  e->value);
 		t->point.y = e->value;
 		t->millis = time;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_MOTION;
 		break;
 	case ABS_PRESSURE:
 		t->pressure = e->value;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_OTHERAXIS;
 		break;
 	}
@@ -401,6 +440,8 @@ tp_restore_synaptics_touches(struct tp_dispatch *tp,
 		tp_new_touch(tp, t, time);
 		tp_begin_touch(tp, t, time);
 		t->state = TOUCH_UPDATE;
+		long_clear_bit(tp->touch_masks.began, i);
+		long_clear_bit(tp->touch_masks.ended, i);
 	}
 }
 
@@ -497,17 +538,17 @@ tp_unpin_finger(const struct tp_dispatch *tp, struct tp_touch *t)
 	struct phys_coords mm;
 	struct device_coords delta;
 
-	if (!t->pinned.is_pinned)
+	if (!t->is_pinned)
 		return;
 
-	delta.x = abs(t->point.x - t->pinned.center.x);
-	delta.y = abs(t->point.y - t->pinned.center.y);
+	delta.x = abs(t->point.x - t->cold->pinned.center.x);
+	delta.y = abs(t->point.y - t->cold->pinned.center.y);
 
 	mm = evdev_device_unit_delta_to_mm(tp->device, &delta);
 
 	/* 1.5mm movement -> unpin */
 	if (hypot(mm.x, mm.y) >= 1.5) {
-		t->pinned.is_pinned = false;
+		t->is_pinned = false;
 		return;
 	}
 }
@@ -518,8 +559,8 @@ tp_pin_fingers(struct tp_dispatch *tp)
 	struct tp_touch *t;
 
 	tp_for_each_touch(tp, t) {
-		t->pinned.is_pinned = true;
-		t->pinned.center = t->point;
+		t->is_pinned = true;
+		t->cold->pinned.center = t->point;
 	}
 }
 
@@ -527,9 +568,9 @@ bool
 tp_touch_active(const struct tp_dispatch *tp, const struct tp_touch *t)
 {
 	return (t->state == TOUCH_BEGIN || t->state == TOUCH_UPDATE) &&
-		t->palm.state == PALM_NONE &&
-		!t->pinned.is_pinned &&
-		t->thumb.state != THUMB_STATE_YES &&
+		t->palm_state == PALM_NONE &&
+		!t->is_pinned &&
+		t->thumb_state != THUMB_STATE_YES &&
 		tp_button_touch_active(tp, t) &&
 		tp_edge_scroll_touch_active(tp, t);
 }
@@ -563,21 +604,21 @@ tp_palm_detect_dwt_triggered(struct tp_dispatch *tp,
 	if (tp->dwt.dwt_enabled &&
 	    tp->dwt.keyboard_active &&
 	    t->state == TOUCH_BEGIN) {
-		t->palm.state = PALM_TYPING;
-		t->palm.first = t->point;
+		t->palm_state = PALM_TYPING;
+		t->cold->palm.first = t->point;
 		return true;
 	} else if (!tp->dwt.keyboard_active &&
 		   t->state == TOUCH_UPDATE &&
-		   t->palm.state == PALM_TYPING) {
+		   t->palm_state == PALM_TYPING) {
 		/* If a touch has started before the first or after the last
 		   key press, release it on timeout. Benefit: a palm rested
 		   while typing on the touchpad will be ignored, but a touch
 		   started once we stop typing will be able to control the
 		   pointer (alas not tap, etc.).
 		   */
-		if (t->palm.time == 0 ||
-		    t->palm.time > tp->dwt.keyboard_last_press_time) {
-			t->palm.state = PALM_NONE;
+		if (t->cold->palm.time == 0 ||
+		    t->cold->palm.time > tp->dwt.keyboard_last_press_time) {
+			t->palm_state = PALM_NONE;
 			evdev_log_debug(tp->device,
 					"palm: touch released, timeout after typing\n");
 		}
@@ -594,18 +635,18 @@ tp_palm_detect_trackpoint_triggered(struct tp_dispatch *tp,
 	if (!tp->palm.monitor_trackpoint)
 		return false;
 
-	if (t->palm.state == PALM_NONE &&
+	if (t->palm_state == PALM_NONE &&
 	    t->state == TOUCH_BEGIN &&
 	    tp->palm.trackpoint_active) {
-		t->palm.state = PALM_TRACKPOINT;
+		t->palm_state = PALM_TRACKPOINT;
 		return true;
-	} else if (t->palm.state == PALM_TRACKPOINT &&
+	} else if (t->palm_state == PALM_TRACKPOINT &&
 		   t->state == TOUCH_UPDATE &&
 		   !tp->palm.trackpoint_active) {
 
-		if (t->palm.time == 0 ||
-		    t->palm.time > tp->palm.trackpoint_last_event_time) {
-			t->palm.state = PALM_NONE;
+		if (t->cold->palm.time == 0 ||
+		    t->cold->palm.time > tp->palm.trackpoint_last_event_time) {
+			t->palm_state = PALM_NONE;
 			evdev_log_debug(tp->device,
 				       "palm: touch released, timeout after trackpoint\n");
 		}
@@ -624,9 +665,9 @@ tp_palm_detect_move_out_of_edge(struct tp_dispatch *tp,
 	struct device_float_coords delta;
 	int dirs;
 
-	if (time < t->palm.time + PALM_TIMEOUT &&
+	if (time < t->cold->palm.time + PALM_TIMEOUT &&
 	    (t->point.x > tp->palm.left_edge && t->point.x < tp->palm.right_edge)) {
-		delta = device_delta(t->point, t->palm.first);
+		delta = device_delta(t->point, t->cold->palm.first);
 		dirs = phys_get_direction(tp_phys_delta(tp, delta));
 		if ((dirs & DIRECTIONS) && !(dirs & ~DIRECTIONS))
 			return true;
@@ -651,12 +692,12 @@ tp_palm_detect_multifinger(struct tp_dispatch *tp, struct tp_touch *t, uint64_t
 	 * frame the second touch will still be PALM_NONE and thus detected
 	 * here as non-palm touch. This is too niche to worry about for now.
 	 */
-	tp_for_each_touch(tp, other) {
+	tp_for_each_active_touch(tp, other) {
 		if (other == t)
 			continue;
 
 		if (tp_touch_active(tp, other) &&
-		    other->palm.state == PALM_NONE) {
+		    other->palm_state == PALM_NONE) {
 			return true;
 		}
 	}
@@ -674,9 +715,9 @@ tp_palm_detect(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 	if (tp_palm_detect_trackpoint_triggered(tp, t, time))
 		goto out;
 
-	if (t->palm.state == PALM_EDGE) {
+	if (t->palm_state == PALM_EDGE) {
 		if (tp_palm_detect_multifinger(tp, t, time)) {
-			t->palm.state = PALM_NONE;
+			t->palm_state = PALM_NONE;
 			evdev_log_debug(tp->device,
 				  "palm: touch released, multiple fingers\n");
 
@@ -685,7 +726,7 @@ tp_palm_detect(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 		   the direction is within 45 degrees of the horizontal.
 		 */
 		} else if (tp_palm_detect_move_out_of_edge(tp, t, time)) {
-			t->palm.state = PALM_NONE;
+			t->palm_state = PALM_NONE;
 			evdev_log_debug(tp->device,
 				  "palm: touch released, out of edge zone\n");
 		}
@@ -710,15 +751,15 @@ tp_palm_detect(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 	if (tp_touch_get_edge(tp, t) & EDGE_RIGHT)
 		return;
 
-	t->palm.state = PALM_EDGE;
-	t->palm.time = time;
-	t->palm.first = t->point;
+	t->palm_state = PALM_EDGE;
+	t->cold->palm.time = time;
+	t->cold->palm.first = t->point;
 
 out:
 	evdev_log_debug(tp->device,
 		  "palm: palm detected (%s)\n",
-		  t->palm.state == PALM_EDGE ? "edge" :
-		  t->palm.state == PALM_TYPING ? "typing" : "trackpoint");
+		  t->palm_state == PALM_EDGE ? "edge" :
+		  t->palm_state == PALM_TYPING ? "typing" : "trackpoint");
 }
 
 static inline const char*
@@ -736,31 +777,31 @@ thumb_state_to_str(enum tp_thumb_state state)
 static void
 tp_thumb_detect(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 {
-	enum tp_thumb_state state = t->thumb.state;
+	enum tp_thumb_state state = t->thumb_state;
 
 	/* once a thumb, always a thumb, once ruled out always ruled out */
 	if (!tp->thumb.detect_thumbs ||
-	    t->thumb.state != THUMB_STATE_MAYBE)
+	    t->thumb_state != THUMB_STATE_MAYBE)
 		return;
 
 	if (t->point.y < tp->thumb.upper_thumb_line) {
 		/* if a potential thumb is above the line, it won't ever
 		 * label as thumb */
-		t->thumb.state = THUMB_STATE_NO;
+		t->thumb_state = THUMB_STATE_NO;
 		goto out;
 	}
 
 	/* If the thumb moves by more than 7mm, it's not a resting thumb */
 	if (t->state == TOUCH_BEGIN)
-		t->thumb.initial = t->point;
+		t->cold->thumb.initial = t->point;
 	else if (t->state == TOUCH_UPDATE) {
 		struct device_float_coords delta;
 		struct phys_coords mm;
 
-		delta = device_delta(t->point, t->thumb.initial);
+		delta = device_delta(t->point, t->cold->thumb.initial);
 		mm = tp_phys_delta(tp, delta);
 		if (length_in_mm(mm) > 7) {
-			t->thumb.state = THUMB_STATE_NO;
+			t->thumb_state = THUMB_STATE_NO;
 			goto out;
 		}
 	}
@@ -772,11 +813,11 @@ tp_thumb_detect(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 	 * a thumb.
 	 */
 	if (t->pressure > tp->thumb.threshold)
-		t->thumb.state = THUMB_STATE_YES;
+		t->thumb_state = THUMB_STATE_YES;
 	else if (t->point.y > tp->thumb.lower_thumb_line &&
 		 tp->scroll.method != LIBINPUT_CONFIG_SCROLL_EDGE &&
-		 t->thumb.first_touch_time + THUMB_MOVE_TIMEOUT < time)
-		t->thumb.state = THUMB_STATE_YES;
+		 t->cold->thumb.first_touch_time + THUMB_MOVE_TIMEOUT < time)
+		t->thumb_state = THUMB_STATE_YES;
 
 	/* now what? we marked it as thumb, so:
 	 *
@@ -789,11 +830,11 @@ tp_thumb_detect(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 	 *   this gets a tad complicated otherwise
 	 */
 out:
-	if (t->thumb.state != state)
+	if (t->thumb_state != state)
 		evdev_log_debug(tp->device,
 			  "thumb state: %s → %s\n",
 			  thumb_state_to_str(state),
-			  thumb_state_to_str(t->thumb.state));
+			  thumb_state_to_str(t->thumb_state));
 }
 
 static void
@@ -975,8 +1016,8 @@ tp_position_fake_touches(struct tp_dispatch *tp)
 
 		t->point = topmost->point;
 		t->pressure = topmost->pressure;
-		if (!t->dirty)
-			t->dirty = topmost->dirty;
+		if (!t->dirty && topmost->dirty)
+			tp_touch_set_dirty(tp, t);
 	}
 }
 
@@ -1052,9 +1093,9 @@ static void
 tp_process_state(struct tp_dispatch *tp, uint64_t time)
 {
 	struct tp_touch *t;
-	unsigned int i;
 	bool restart_filter = false;
 	bool want_motion_reset;
+	uint64_t start;
 
 	tp_process_fake_touches(tp, time);
 	tp_unhover_touches(tp, time);
@@ -1062,20 +1103,22 @@ tp_process_state(struct tp_dispatch *tp, uint64_t time)
 
 	want_motion_reset = tp_need_motion_history_reset(tp);
 
-	for (i = 0; i < tp->ntouches; i++) {
-		t = tp_get_touch(tp, i);
-
-		if (want_motion_reset) {
-			tp_motion_history_reset(t);
-			t->quirks.reset_motion_history = true;
-		} else if (t->quirks.reset_motion_history) {
-			tp_motion_history_reset(t);
-			t->quirks.reset_motion_history = false;
+	/* Resetting the history affects all touches, not just the dirty
+	 * ones. This is rare enough that we don't care about the loop */
+	if (want_motion_reset || tp->quirks.reset_motion_history_pending) {
+		tp_for_each_touch(tp, t) {
+			if (want_motion_reset) {
+				tp_motion_history_reset(t);
+				t->cold->quirks.reset_motion_history = true;
+			} else if (t->cold->quirks.reset_motion_history) {
+				tp_motion_history_reset(t);
+				t->cold->quirks.reset_motion_history = false;
+			}
 		}
+		tp->quirks.reset_motion_history_pending = want_motion_reset;
+	}
 
-		if (!t->dirty)
-			continue;
-
+	tp_for_each_dirty_touch(tp, t) {
 		if (tp_detect_jumps(tp, t)) {
 			if (!tp->semi_mt)
 				evdev_log_bug_kernel(tp->device,
@@ -1085,10 +1128,13 @@ tp_process_state(struct tp_dispatch *tp, uint64_t time)
 			tp_motion_history_reset(t);
 		}
 
+		start = tp_cpu_account_begin(tp);
 		tp_thumb_detect(tp, t, time);
 		tp_palm_detect(tp, t, time);
+		tp_cpu_account_end(tp, LIBINPUT_CPU_STAT_TOUCHPAD_PALM, start);
 
 		tp_motion_hysteresis(tp, t);
+		tp_motion_smoothing(tp, t, time);
 		tp_motion_history_push(t);
 
 		tp_unpin_finger(tp, t);
@@ -1100,8 +1146,13 @@ tp_process_state(struct tp_dispatch *tp, uint64_t time)
 	if (restart_filter)
 		filter_restart(tp->device->pointer.filter, tp, time);
 
+	start = tp_cpu_account_begin(tp);
 	tp_button_handle_state(tp, time);
+	tp_cpu_account_end(tp, LIBINPUT_CPU_STAT_TOUCHPAD_BUTTONS, start);
+
+	start = tp_cpu_account_begin(tp);
 	tp_edge_scroll_handle_state(tp, time);
+	tp_cpu_account_end(tp, LIBINPUT_CPU_STAT_TOUCHPAD_EDGE_SCROLL, start);
 
 	/*
 	 * We have a physical button down event on a clickpad. To avoid
@@ -1113,7 +1164,9 @@ tp_process_state(struct tp_dispatch *tp, uint64_t time)
 	    tp->buttons.is_clickpad)
 		tp_pin_fingers(tp);
 
+	start = tp_cpu_account_begin(tp);
 	tp_gesture_handle_state(tp, time);
+	tp_cpu_account_end(tp, LIBINPUT_CPU_STAT_TOUCHPAD_GESTURES, start);
 }
 
 static void
@@ -1121,11 +1174,7 @@ tp_post_process_state(struct tp_dispatch *tp, uint64_t time)
 {
 	struct tp_touch *t;
 
-	tp_for_each_touch(tp, t) {
-
-		if (!t->dirty)
-			continue;
-
+	tp_for_each_dirty_touch(tp, t) {
 		if (t->state == TOUCH_END) {
 			if (t->has_ended)
 				t->state = TOUCH_NONE;
@@ -1138,6 +1187,13 @@ tp_post_process_state(struct tp_dispatch *tp, uint64_t time)
 		t->dirty = false;
 	}
 
+	memset(tp->touch_masks.dirty, 0,
+	       tp->touch_masks.nlongs * sizeof(unsigned long));
+	memset(tp->touch_masks.began, 0,
+	       tp->touch_masks.nlongs * sizeof(unsigned long));
+	memset(tp->touch_masks.ended, 0,
+	       tp->touch_masks.nlongs * sizeof(unsigned long));
+
 	tp->old_nfingers_down = tp->nfingers_down;
 	tp->buttons.old_state = tp->buttons.state;
 
@@ -1150,28 +1206,49 @@ static void
 tp_post_events(struct tp_dispatch *tp, uint64_t time)
 {
 	int filter_motion = 0;
+	int scrolled;
+	uint64_t start;
 
 	/* Only post (top) button events while suspended */
 	if (tp->device->is_suspended) {
+		start = tp_cpu_account_begin(tp);
 		tp_post_button_events(tp, time);
+		tp_cpu_account_end(tp, LIBINPUT_CPU_STAT_TOUCHPAD_BUTTONS, start);
 		return;
 	}
 
+	start = tp_cpu_account_begin(tp);
 	filter_motion |= tp_tap_handle_state(tp, time);
+	tp_cpu_account_end(tp, LIBINPUT_CPU_STAT_TOUCHPAD_TAP, start);
+
+	start = tp_cpu_account_begin(tp);
 	filter_motion |= tp_post_button_events(tp, time);
+	tp_cpu_account_end(tp, LIBINPUT_CPU_STAT_TOUCHPAD_BUTTONS, start);
 
 	if (filter_motion ||
 	    tp->palm.trackpoint_active ||
 	    tp->dwt.keyboard_active) {
+		start = tp_cpu_account_begin(tp);
 		tp_edge_scroll_stop_events(tp, time);
+		tp_cpu_account_end(tp, LIBINPUT_CPU_STAT_TOUCHPAD_EDGE_SCROLL,
+				   start);
+
+		start = tp_cpu_account_begin(tp);
 		tp_gesture_cancel(tp, time);
+		tp_cpu_account_end(tp, LIBINPUT_CPU_STAT_TOUCHPAD_GESTURES,
+				   start);
 		return;
 	}
 
-	if (tp_edge_scroll_post_events(tp, time) != 0)
+	start = tp_cpu_account_begin(tp);
+	scrolled = tp_edge_scroll_post_events(tp, time);
+	tp_cpu_account_end(tp, LIBINPUT_CPU_STAT_TOUCHPAD_EDGE_SCROLL, start);
+	if (scrolled != 0)
 		return;
 
+	start = tp_cpu_account_begin(tp);
 	tp_gesture_post_events(tp, time);
+	tp_cpu_account_end(tp, LIBINPUT_CPU_STAT_TOUCHPAD_GESTURES, start);
 }
 
 static void
@@ -1249,6 +1326,8 @@ tp_interface_destroy(struct evdev_dispatch *dispatch)
 {
 	struct tp_dispatch *tp = tp_dispatch(dispatch);
 
+	free(tp->touch_masks.dirty);
+	free(tp->touches_cold);
 	free(tp->touches);
 	free(tp);
 }
@@ -1706,7 +1785,7 @@ evdev_tag_touchpad(struct evdev_device *device,
 	int bustype, vendor;
 	const char *prop;
 
-	prop = udev_device_get_property_value(udev_device,
+	prop = evdev_device_get_udev_property(device,
 					      "ID_INPUT_TOUCHPAD_INTEGRATION");
 	if (prop) {
 		if (streq(prop, "internal")) {
@@ -1790,13 +1869,16 @@ static struct evdev_dispatch_interface tp_interface = {
 	tp_interface_device_added,   /* device_resumed, treat as add */
 	NULL,                        /* post_added */
 	tp_interface_toggle_touch,
+	NULL, /* sync_touches */
 };
 
 static void
 tp_init_touch(struct tp_dispatch *tp,
-	      struct tp_touch *t)
+	      struct tp_touch *t,
+	      struct tp_touch_cold *cold)
 {
 	t->tp = tp;
+	t->cold = cold;
 	t->has_ended = true;
 }
 
@@ -1910,8 +1992,22 @@ tp_init_slots(struct tp_dispatch *tp,
 	if (!tp->touches)
 		return false;
 
+	tp->touches_cold = calloc(tp->ntouches, sizeof(struct tp_touch_cold));
+	if (!tp->touches_cold)
+		return false;
+
+	/* one allocation for all masks, freed through the dirty mask */
+	tp->touch_masks.nlongs = NLONGS(tp->ntouches);
+	tp->touch_masks.dirty = calloc(4 * tp->touch_masks.nlongs,
+				       sizeof(unsigned long));
+	if (!tp->touch_masks.dirty)
+		return false;
+	tp->touch_masks.active = tp->touch_masks.dirty + tp->touch_masks.nlongs;
+	tp->touch_masks.began = tp->touch_masks.active + tp->touch_masks.nlongs;
+	tp->touch_masks.ended = tp->touch_masks.began + tp->touch_masks.nlongs;
+
 	for (i = 0; i < tp->ntouches; i++)
-		tp_init_touch(tp, &tp->touches[i]);
+		tp_init_touch(tp, &tp->touches[i], &tp->touches_cold[i]);
 
 	/* Always sync the first touch so we get ABS_X/Y synced on
 	 * single-touch touchpads */
@@ -2158,7 +2254,7 @@ tp_is_tpkb_combo_below(struct evdev_device *device)
 	const char *prop;
 	enum tpkbcombo_layout layout = TPKBCOMBO_LAYOUT_UNKNOWN;
 
-	prop = udev_device_get_property_value(device->udev_device,
+	prop = evdev_device_get_udev_property(device,
 					      "LIBINPUT_ATTR_TPKBCOMBO_LAYOUT");
 	if (!prop)
 		return false;
@@ -2185,6 +2281,65 @@ tp_init_dwt(struct tp_dispatch *tp,
 	return;
 }
 
+static int
+tp_smoothing_config_is_available(struct libinput_device *device)
+{
+	return 1;
+}
+
+static enum libinput_config_status
+tp_smoothing_config_set(struct libinput_device *device,
+			enum libinput_config_smoothing_state enable)
+{
+	struct evdev_device *evdev = evdev_device(device);
+	struct tp_dispatch *tp = (struct tp_dispatch*)evdev->dispatch;
+
+	switch(enable) {
+	case LIBINPUT_CONFIG_SMOOTHING_ENABLED:
+	case LIBINPUT_CONFIG_SMOOTHING_DISABLED:
+		break;
+	default:
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+	}
+
+	tp->smoothing.enabled = (enable == LIBINPUT_CONFIG_SMOOTHING_ENABLED);
+
+	return LIBINPUT_CONFIG_STATUS_SUCCESS;
+}
+
+static enum libinput_config_smoothing_state
+tp_smoothing_config_get(struct libinput_device *device)
+{
+	struct evdev_device *evdev = evdev_device(device);
+	struct tp_dispatch *tp = (struct tp_dispatch*)evdev->dispatch;
+
+	return tp->smoothing.enabled ?
+		LIBINPUT_CONFIG_SMOOTHING_ENABLED :
+		LIBINPUT_CONFIG_SMOOTHING_DISABLED;
+}
+
+static enum libinput_config_smoothing_state
+tp_smoothing_config_get_default(struct libinput_device *device)
+{
+	return LIBINPUT_CONFIG_SMOOTHING_DISABLED;
+}
+
+static void
+tp_init_smoothing(struct tp_dispatch *tp,
+		  struct evdev_device *device)
+{
+	smoothing_params_init(&tp->smoothing.params,
+			      device->abs.absinfo_x->resolution,
+			      device->abs.absinfo_y->resolution);
+
+	tp->smoothing.config.is_available = tp_smoothing_config_is_available;
+	tp->smoothing.config.set_enabled = tp_smoothing_config_set;
+	tp->smoothing.config.get_enabled = tp_smoothing_config_get;
+	tp->smoothing.config.get_default_enabled = tp_smoothing_config_get_default;
+	tp->smoothing.enabled = false;
+	device->base.config.smoothing = &tp->smoothing.config;
+}
+
 static void
 tp_init_palmdetect(struct tp_dispatch *tp,
 		   struct evdev_device *device)
@@ -2225,10 +2380,12 @@ tp_init_sendevents(struct tp_dispatch *tp,
 {
 	libinput_timer_init(&tp->palm.trackpoint_timer,
 			    tp_libinput_context(tp),
+			    &tp->device->base,
 			    tp_trackpoint_timeout, tp);
 
 	libinput_timer_init(&tp->dwt.keyboard_timer,
 			    tp_libinput_context(tp),
+			    &tp->device->base,
 			    tp_keyboard_timeout, tp);
 }
 
@@ -2421,6 +2578,7 @@ tp_init(struct tp_dispatch *tp,
 	device->dpi = device->abs.absinfo_x->resolution * 25.4;
 
 	tp_init_hysteresis(tp);
+	tp_init_smoothing(tp, device);
 
 	if (!tp_init_accel(tp))
 		return false;
@@ -146,18 +146,12 @@ enum tp_thumb_state {
 	THUMB_STATE_MAYBE,
 };
 
-struct tp_touch {
-	struct tp_dispatch *tp;
-	enum touch_state state;
-	bool has_ended;				/* TRACKING_ID == -1 */
-	bool dirty;
-	struct device_coords point;
-	uint64_t millis;
-	int pressure;
-
-	bool was_down; /* if distance == 0, false for pure hovering
-			  touches */
-
+/* Per-touch state that is only needed when the touch itself is processed,
+ * i.e. the subsystem state machines, timers and filters. This is kept
+ * apart from struct tp_touch so that a scan over all touches doesn't
+ * pull it into the cache.
+ */
+struct tp_touch_cold {
 	struct {
 		/* A quirk mostly used on Synaptics touchpads. In a
 		   transition to/from fake touches > num_slots, the current
@@ -167,26 +161,21 @@ struct tp_touch {
 		bool reset_motion_history;
 	} quirks;
 
-	struct {
-		struct device_coords samples[TOUCHPAD_HISTORY_LENGTH];
-		unsigned int index;
-		unsigned int count;
-	} history;
-
-	struct device_coords hysteresis_center;
+	struct smoothing_filter smoothing;
+	/* t->point after smoothing, this is what the motion history
+	 * records. Same as t->point if smoothing is disabled */
+	struct device_coords smoothed;
 
 	/* A pinned touchpoint is the one that pressed the physical button
 	 * on a clickpad. After the release, it won't move until the center
 	 * moves more than a threshold away from the original coordinates
 	 */
 	struct {
-		bool is_pinned;
 		struct device_coords center;
 	} pinned;
 
 	/* Software-button state and timeout if applicable */
 	struct {
-		enum button_state state;
 		/* We use button_event here so we can use == on events */
 		enum button_event curr;
 		struct libinput_timer timer;
@@ -199,7 +188,6 @@ struct tp_touch {
 	} tap;
 
 	struct {
-		enum tp_edge_scroll_touch_state edge_state;
 		uint32_t edge;
 		int direction;
 		struct libinput_timer timer;
@@ -207,7 +195,6 @@ struct tp_touch {
 	} scroll;
 
 	struct {
-		enum touch_palm_state state;
 		struct device_coords first; /* first coordinates if is_palm == true */
 		uint64_t time; /* first timestamp if is_palm == true */
 	} palm;
@@ -217,12 +204,45 @@ struct tp_touch {
 	} gesture;
 
 	struct {
-		enum tp_thumb_state state;
 		uint64_t first_touch_time;
 		struct device_coords initial;
 	} thumb;
 };
 
+/* Per-touch state read on every frame. Keep this small, anything that's
+ * not needed for every touch in every frame goes into struct
+ * tp_touch_cold.
+ */
+struct tp_touch {
+	struct tp_dispatch *tp;
+	struct tp_touch_cold *cold;
+	enum touch_state state;
+	int pressure;
+	struct device_coords point;
+	uint64_t millis;
+	struct device_coords hysteresis_center;
+
+	struct {
+		struct device_coords samples[TOUCHPAD_HISTORY_LENGTH];
+		unsigned int index;
+		unsigned int count;
+	} history;
+
+	/* The subsystem states tp_touch_active() checks, for every
+	 * touch in every frame. The rest of their state is in
+	 * struct tp_touch_cold. */
+	enum touch_palm_state palm_state;
+	enum tp_thumb_state thumb_state;
+	enum button_state button_state;
+	enum tp_edge_scroll_touch_state edge_state;
+	bool is_pinned;
+
+	bool has_ended;				/* TRACKING_ID == -1 */
+	bool dirty;
+	bool was_down; /* if distance == 0, false for pure hovering
+			  touches */
+};
+
 struct tp_dispatch {
 	struct evdev_dispatch base;
 	struct evdev_device *device;
@@ -239,6 +259,20 @@ struct tp_dispatch {
 	unsigned int num_slots;			/* number of slots */
 	unsigned int ntouches;			/* no slots inc. fakes */
 	struct tp_touch *touches;		/* len == ntouches */
+	struct tp_touch_cold *touches_cold;	/* len == ntouches */
+
+	/* Touch bitmasks, bit n is touches[n]. dirty, began and ended are
+	 * reset at the end of each frame, active has all touches in
+	 * TOUCH_BEGIN or TOUCH_UPDATE. Use tp_for_each_touch_in_mask() to
+	 * only look at the touches that matter for a frame.
+	 */
+	struct {
+		size_t nlongs;
+		unsigned long *dirty;
+		unsigned long *active;
+		unsigned long *began;
+		unsigned long *ended;
+	} touch_masks;
 	/* bit 0: BTN_TOUCH
 	 * bit 1: BTN_TOOL_FINGER
 	 * bit 2: BTN_TOOL_DOUBLETAP
@@ -256,6 +290,12 @@ struct tp_dispatch {
 
 	struct device_coords hysteresis_margin;
 
+	struct {
+		struct libinput_device_config_smoothing config;
+		bool enabled;
+		struct smoothing_params params;
+	} smoothing;
+
 	struct {
 		double x_scale_coeff;
 		double y_scale_coeff;
@@ -335,6 +375,10 @@ struct tp_dispatch {
 
 		bool drag_enabled;
 		bool drag_lock_enabled;
+
+		/* press and release on finger up, correct later */
+		bool speculative_enabled;
+		bool want_speculative_enabled;
 	} tap;
 
 	struct {
@@ -384,6 +428,10 @@ struct tp_dispatch {
 		 * event with the jump.
 		 */
 		unsigned int nonmotion_event_count;
+
+		/* true if the motion history of all touches was reset in
+		 * the last frame, see tp_process_state() */
+		bool reset_motion_history_pending;
 	} quirks;
 
 	struct {
@@ -405,12 +453,66 @@ tp_dispatch(struct evdev_dispatch *dispatch)
 #define tp_for_each_touch(_tp, _t) \
 	for (unsigned int _i = 0; _i < (_tp)->ntouches && (_t = &(_tp)->touches[_i]); _i++)
 
+static inline unsigned int
+tp_touch_index(const struct tp_dispatch *tp, const struct tp_touch *t)
+{
+	return t - tp->touches;
+}
+
+/* Index of the first touch at or after from that is set in mask, or
+ * tp->ntouches if there is none */
+static inline unsigned int
+tp_touch_mask_next(const struct tp_dispatch *tp,
+		   const unsigned long *mask,
+		   unsigned int from)
+{
+	size_t i = from / LONG_BITS;
+	unsigned long bits;
+
+	if (from >= tp->ntouches)
+		return tp->ntouches;
+
+	bits = mask[i] & (~0UL << (from % LONG_BITS));
+	while (bits == 0) {
+		if (++i >= tp->touch_masks.nlongs)
+			return tp->ntouches;
+		bits = mask[i];
+	}
+
+	return min(i * LONG_BITS + __builtin_ctzl(bits), tp->ntouches);
+}
+
+#define tp_for_each_touch_in_mask(_tp, _t, _mask) \
+	for (unsigned int _i = tp_touch_mask_next((_tp), (_mask), 0); \
+	     _i < (_tp)->ntouches && (_t = &(_tp)->touches[_i]); \
+	     _i = tp_touch_mask_next((_tp), (_mask), _i + 1))
+
+#define tp_for_each_dirty_touch(_tp, _t) \
+	tp_for_each_touch_in_mask((_tp), (_t), (_tp)->touch_masks.dirty)
+
+#define tp_for_each_active_touch(_tp, _t) \
+	tp_for_each_touch_in_mask((_tp), (_t), (_tp)->touch_masks.active)
+
 static inline struct libinput*
 tp_libinput_context(const struct tp_dispatch *tp)
 {
 	return evdev_libinput_context(tp->device);
 }
 
+static inline uint64_t
+tp_cpu_account_begin(const struct tp_dispatch *tp)
+{
+	return cpu_account_begin(tp_libinput_context(tp));
+}
+
+static inline void
+tp_cpu_account_end(struct tp_dispatch *tp,
+		   enum libinput_cpu_stat stat,
+		   uint64_t start)
+{
+	cpu_account_end(&tp->device->base, stat, start);
+}
+
 static inline struct normalized_coords
 tp_normalize_delta(const struct tp_dispatch *tp,
 		   struct device_float_coords delta)
@@ -196,7 +196,7 @@ pad_group_new_basic(struct pad_dispatch *pad,
 static inline bool
 is_litest_device(struct evdev_device *device)
 {
-	return !!udev_device_get_property_value(device->udev_device,
+	return !!evdev_device_get_udev_property(device,
 						"LIBINPUT_TEST_DEVICE");
 }
 
@@ -257,13 +257,17 @@ pad_led_get_sysfs_base_path(struct evdev_device *device,
 
 	/* For testing purposes only allow for a base path set through a
 	 * udev rule. We still expect the normal directory hierarchy inside */
-	test_path = udev_device_get_property_value(udev_device,
+	test_path = evdev_device_get_udev_property(device,
 						   "LIBINPUT_TEST_TABLET_PAD_SYSFS_PATH");
 	if (test_path) {
 		rc = snprintf(path_out, path_out_sz, "%s", test_path);
 		return rc != -1;
 	}
 
+	/* no sysfs for virtual devices */
+	if (!udev_device)
+		return false;
+
 	parent = udev_device_get_parent_with_subsystem_devtype(udev_device,
 							       "input",
 							       NULL);
@@ -502,6 +506,9 @@ pad_init_leds_from_libwacom(struct pad_dispatch *pad,
 	WacomDevice *wacom = NULL;
 	int rc = 1;
 
+	if (evdev_device_is_virtual(device))
+		goto out;
+
 	db = libwacom_database_new();
 	if (!db) {
 		evdev_log_info(device,
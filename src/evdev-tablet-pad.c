@@ -514,6 +514,7 @@ static struct evdev_dispatch_interface pad_interface = {
 	NULL, /* device_resumed */
 	NULL, /* post_added */
 	NULL, /* toggle_touch */
+	NULL, /* sync_touches */
 };
 
 static void
@@ -386,9 +386,30 @@ tablet_handle_xy(struct tablet_dispatch *tablet,
 	*point_out = point;
 }
 
+static inline void
+tablet_handle_prediction(struct tablet_dispatch *tablet,
+			 struct evdev_device *device,
+			 struct device_coords *predicted_out,
+			 uint64_t time)
+{
+	struct device_coords predicted;
+
+	if (tablet_has_status(tablet, TABLET_TOOL_ENTERING_PROXIMITY))
+		prediction_filter_reset(&tablet->prediction.filter);
+
+	predicted = prediction_filter_apply(&tablet->prediction.filter,
+					    &tablet->axes.point,
+					    time,
+					    ms2us(tablet->prediction.ms));
+	tablet->axes.predicted = predicted;
+
+	evdev_transform_absolute(device, &predicted);
+	*predicted_out = predicted;
+}
+
 static inline struct normalized_coords
 tool_process_delta(struct libinput_tablet_tool *tool,
-		   const struct evdev_device *device,
+		   struct evdev_device *device,
 		   const struct device_coords *delta,
 		   uint64_t time)
 {
@@ -401,10 +422,7 @@ tool_process_delta(struct libinput_tablet_tool *tool,
 	if (device_float_is_zero(accel))
 		return zero;
 
-	return filter_dispatch(device->pointer.filter,
-			       &accel,
-			       tool,
-			       time);
+	return evdev_filter_dispatch(device, &accel, tool, time);
 }
 
 static inline double
@@ -547,6 +565,7 @@ tablet_check_notify_axes(struct tablet_dispatch *tablet,
 		return false;
 
 	tablet_handle_xy(tablet, device, &axes.point, &delta);
+	tablet_handle_prediction(tablet, device, &axes.predicted, time);
 	axes.pressure = tablet_handle_pressure(tablet, device, tool);
 	axes.distance = tablet_handle_distance(tablet, device);
 	axes.slider = tablet_handle_slider(tablet, device);
@@ -1270,6 +1289,95 @@ tablet_update_proximity_state(struct tablet_dispatch *tablet,
 	tablet_set_status(tablet, TABLET_TOOL_LEAVING_PROXIMITY);
 }
 
+static void
+tablet_history_flush(struct tablet_dispatch *tablet,
+		     struct evdev_device *device)
+{
+	unsigned int n = tablet->history.nsamples;
+
+	if (n == 0)
+		return;
+
+	libinput_timer_cancel(&tablet->history.timer);
+
+	tablet_notify_axis(&device->base,
+			   tablet->history.samples[n - 1].time,
+			   tablet->history.tool,
+			   tablet->history.tip_state,
+			   tablet->history.changed_axes,
+			   &tablet->history.axes,
+			   tablet->history.samples,
+			   n - 1);
+
+	libinput_tablet_tool_unref(tablet->history.tool);
+	tablet->history.tool = NULL;
+	tablet->history.nsamples = 0;
+	memset(tablet->history.changed_axes,
+	       0,
+	       sizeof(tablet->history.changed_axes));
+}
+
+static void
+tablet_history_timeout(uint64_t now, void *data)
+{
+	struct tablet_dispatch *tablet = data;
+
+	tablet_history_flush(tablet, tablet->device);
+}
+
+static void
+tablet_history_append(struct tablet_dispatch *tablet,
+		      struct evdev_device *device,
+		      struct libinput_tablet_tool *tool,
+		      enum libinput_tablet_tool_tip_state tip_state,
+		      const struct tablet_axes *axes,
+		      uint64_t time)
+{
+	struct tablet_axes *merged = &tablet->history.axes;
+	struct tablet_history_sample *sample;
+	uint64_t window = ms2us(tablet->history.ms);
+	size_t i;
+
+	if (tablet->history.nsamples > 0 &&
+	    (tablet->history.tool != tool ||
+	     tablet->history.tip_state != tip_state ||
+	     tablet->history.nsamples == TABLET_HISTORY_MAX_SAMPLES))
+		tablet_history_flush(tablet, device);
+
+	if (tablet->history.nsamples == 0) {
+		tablet->history.tool = libinput_tablet_tool_ref(tool);
+		tablet->history.tip_state = tip_state;
+		*merged = *axes;
+		libinput_timer_set(&tablet->history.timer, time + window);
+	} else {
+		struct normalized_coords delta = merged->delta;
+		double wheel = merged->wheel;
+		int wheel_discrete = merged->wheel_discrete;
+
+		/* The relative axes add up, all others are the most recent
+		 * value */
+		*merged = *axes;
+		merged->delta.x += delta.x;
+		merged->delta.y += delta.y;
+		merged->wheel += wheel;
+		merged->wheel_discrete += wheel_discrete;
+	}
+
+	for (i = 0; i < sizeof(tablet->changed_axes); i++)
+		tablet->history.changed_axes[i] |= tablet->changed_axes[i];
+
+	sample = &tablet->history.samples[tablet->history.nsamples++];
+	sample->time = time;
+	sample->point = axes->point;
+	sample->pressure = axes->pressure;
+	sample->tilt = axes->tilt;
+	sample->rotation = axes->rotation;
+
+	/* Don't rely on the timer if we're processing events late */
+	if (time - tablet->history.samples[0].time >= window)
+		tablet_history_flush(tablet, device);
+}
+
 static void
 tablet_send_axis_proximity_tip_down_events(struct tablet_dispatch *tablet,
 					   struct evdev_device *device,
@@ -1315,6 +1423,7 @@ tablet_send_axis_proximity_tip_down_events(struct tablet_dispatch *tablet,
 	}
 
 	if (tablet_has_status(tablet, TABLET_TOOL_ENTERING_CONTACT)) {
+		tablet_history_flush(tablet, device);
 		tablet_notify_tip(&device->base,
 				  time,
 				  tool,
@@ -1325,6 +1434,7 @@ tablet_send_axis_proximity_tip_down_events(struct tablet_dispatch *tablet,
 		tablet_unset_status(tablet, TABLET_TOOL_ENTERING_CONTACT);
 		tablet_set_status(tablet, TABLET_TOOL_IN_CONTACT);
 	} else if (tablet_has_status(tablet, TABLET_TOOL_LEAVING_CONTACT)) {
+		tablet_history_flush(tablet, device);
 		tablet_notify_tip(&device->base,
 				  time,
 				  tool,
@@ -1343,12 +1453,22 @@ tablet_send_axis_proximity_tip_down_events(struct tablet_dispatch *tablet,
 		else
 			tip_state = LIBINPUT_TABLET_TOOL_TIP_UP;
 
-		tablet_notify_axis(&device->base,
-				   time,
-				   tool,
-				   tip_state,
-				   tablet->changed_axes,
-				   &axes);
+		if (tablet->history.ms > 0)
+			tablet_history_append(tablet,
+					      device,
+					      tool,
+					      tip_state,
+					      &axes,
+					      time);
+		else
+			tablet_notify_axis(&device->base,
+					   time,
+					   tool,
+					   tip_state,
+					   tablet->changed_axes,
+					   &axes,
+					   NULL,
+					   0);
 		tablet_unset_status(tablet, TABLET_AXES_UPDATED);
 	}
 
@@ -1402,6 +1522,12 @@ tablet_flush(struct tablet_dispatch *tablet,
 						   tool,
 						   time);
 
+	/* A pending merged axis event goes out before any other event */
+	if (tablet_has_status(tablet, TABLET_BUTTONS_RELEASED) ||
+	    tablet_has_status(tablet, TABLET_BUTTONS_PRESSED) ||
+	    tablet_has_status(tablet, TABLET_TOOL_LEAVING_PROXIMITY))
+		tablet_history_flush(tablet, device);
+
 	if (tablet_has_status(tablet, TABLET_BUTTONS_RELEASED)) {
 		tablet_notify_buttons(tablet,
 				      device,
@@ -1519,6 +1645,7 @@ tablet_suspend(struct evdev_dispatch *dispatch,
 {
 	struct tablet_dispatch *tablet = tablet_dispatch(dispatch);
 
+	tablet_history_flush(tablet, device);
 	tablet_set_touch_device_enabled(tablet->touch_device, true);
 }
 
@@ -1528,6 +1655,10 @@ tablet_destroy(struct evdev_dispatch *dispatch)
 	struct tablet_dispatch *tablet = tablet_dispatch(dispatch);
 	struct libinput_tablet_tool *tool, *tmp;
 
+	libinput_timer_cancel(&tablet->history.timer);
+	if (tablet->history.tool)
+		libinput_tablet_tool_unref(tablet->history.tool);
+
 	list_for_each_safe(tool, tmp, &tablet->tool_list, link) {
 		libinput_tablet_tool_unref(tool);
 	}
@@ -1612,6 +1743,7 @@ static struct evdev_dispatch_interface tablet_interface = {
 	NULL, /* device_resumed */
 	tablet_check_initial_proximity,
 	NULL, /* toggle_touch */
+	NULL, /* sync_touches */
 };
 
 static void
@@ -1622,6 +1754,104 @@ tablet_init_calibration(struct tablet_dispatch *tablet,
 		evdev_init_calibration(device, &tablet->calibration);
 }
 
+static int
+tablet_prediction_config_is_available(struct libinput_device *device)
+{
+	return 1;
+}
+
+static enum libinput_config_status
+tablet_prediction_config_set(struct libinput_device *libinput_device,
+			     unsigned int ms)
+{
+	struct evdev_device *device = evdev_device(libinput_device);
+	struct tablet_dispatch *tablet = tablet_dispatch(device->dispatch);
+
+	tablet->prediction.ms = ms;
+
+	return LIBINPUT_CONFIG_STATUS_SUCCESS;
+}
+
+static unsigned int
+tablet_prediction_config_get(struct libinput_device *libinput_device)
+{
+	struct evdev_device *device = evdev_device(libinput_device);
+	struct tablet_dispatch *tablet = tablet_dispatch(device->dispatch);
+
+	return tablet->prediction.ms;
+}
+
+static unsigned int
+tablet_prediction_config_get_default(struct libinput_device *device)
+{
+	return 0;
+}
+
+static void
+tablet_init_prediction(struct tablet_dispatch *tablet,
+		       struct evdev_device *device)
+{
+	tablet->prediction.config.is_available = tablet_prediction_config_is_available;
+	tablet->prediction.config.set_time = tablet_prediction_config_set;
+	tablet->prediction.config.get_time = tablet_prediction_config_get;
+	tablet->prediction.config.get_default_time = tablet_prediction_config_get_default;
+	tablet->prediction.ms = 0;
+	prediction_filter_reset(&tablet->prediction.filter);
+	device->base.config.prediction = &tablet->prediction.config;
+}
+
+static int
+tablet_history_config_is_available(struct libinput_device *device)
+{
+	return 1;
+}
+
+static enum libinput_config_status
+tablet_history_config_set(struct libinput_device *libinput_device,
+			  unsigned int ms)
+{
+	struct evdev_device *device = evdev_device(libinput_device);
+	struct tablet_dispatch *tablet = tablet_dispatch(device->dispatch);
+
+	tablet_history_flush(tablet, device);
+	tablet->history.ms = ms;
+
+	return LIBINPUT_CONFIG_STATUS_SUCCESS;
+}
+
+static unsigned int
+tablet_history_config_get(struct libinput_device *libinput_device)
+{
+	struct evdev_device *device = evdev_device(libinput_device);
+	struct tablet_dispatch *tablet = tablet_dispatch(device->dispatch);
+
+	return tablet->history.ms;
+}
+
+static unsigned int
+tablet_history_config_get_default(struct libinput_device *device)
+{
+	return 0;
+}
+
+static void
+tablet_init_history(struct tablet_dispatch *tablet,
+		    struct evdev_device *device)
+{
+	tablet->history.config.is_available = tablet_history_config_is_available;
+	tablet->history.config.set_window = tablet_history_config_set;
+	tablet->history.config.get_window = tablet_history_config_get;
+	tablet->history.config.get_default_window = tablet_history_config_get_default;
+	tablet->history.ms = 0;
+	tablet->history.nsamples = 0;
+	libinput_timer_init(&tablet->history.timer,
+			    evdev_libinput_context(device),
+			    &device->base,
+			    tablet_history_timeout,
+			    tablet);
+	device->base.config.tablet_history = &tablet->history.config;
+}
+
 static void
 tablet_init_proximity_threshold(struct tablet_dispatch *tablet,
 				struct evdev_device *device)
@@ -1752,6 +1982,8 @@ tablet_init(struct tablet_dispatch *tablet,
 
 	tablet_init_calibration(tablet, device);
 	tablet_init_proximity_threshold(tablet, device);
+	tablet_init_prediction(tablet, device);
+	tablet_init_history(tablet, device);
 	rc = tablet_init_accel(tablet, device);
 	if (rc != 0)
 		return rc;
@@ -30,6 +30,10 @@
 #define LIBINPUT_TOOL_NONE 0
 #define LIBINPUT_TABLET_TOOL_TYPE_MAX LIBINPUT_TABLET_TOOL_TYPE_LENS
 
+/* Maximum number of frames merged into one axis event, the event is sent
+ * early when the window holds more frames than that */
+#define TABLET_HISTORY_MAX_SAMPLES 64
+
 enum tablet_status {
 	TABLET_NONE = 0,
 	TABLET_AXES_UPDATED = 1 << 0,
@@ -72,6 +76,30 @@ struct tablet_dispatch {
 
 	struct libinput_device_config_calibration calibration;
 
+	struct {
+		unsigned int ms;
+		struct prediction_filter filter;
+		struct libinput_device_config_prediction config;
+	} prediction;
+
+	struct {
+		unsigned int ms;
+		struct libinput_device_config_tablet_history config;
+		struct libinput_timer timer;
+
+		/* The pending axis event, its axes are those of the most
+		 * recent frame with the relative axes accumulated */
+		struct libinput_tablet_tool *tool;
+		enum libinput_tablet_tool_tip_state tip_state;
+		unsigned char changed_axes[NCHARS(LIBINPUT_TABLET_TOOL_AXIS_MAX + 1)];
+		struct tablet_axes axes;
+
+		/* All merged frames, oldest first. The last one is the
+		 * pending event itself and not part of its history */
+		struct tablet_history_sample samples[TABLET_HISTORY_MAX_SAMPLES];
+		unsigned int nsamples;
+	} history;
+
 	/* The paired touch device on devices with both pen & touch */
 	struct evdev_device *touch_device;
 };
@@ -42,6 +42,7 @@
 #include "evdev.h"
 #include "filter.h"
 #include "libinput-private.h"
+#include "libinput-trace.h"
 
 #if HAVE_LIBWACOM
 #include <libwacom/libwacom.h>
@@ -49,6 +50,8 @@
 
 #define DEFAULT_WHEEL_CLICK_ANGLE 15
 #define DEFAULT_BUTTON_SCROLL_TIMEOUT ms2us(200)
+#define MSC_TIMESTAMP_MAX_DELTA ms2us(100)
+#define EVDEV_BATCH_SIZE 128
 
 enum evdev_key_type {
 	EVDEV_KEY_TYPE_NONE,
@@ -102,7 +105,10 @@ parse_udev_flag(struct evdev_device *device,
 {
 	const char *val;
 
-	val = udev_device_get_property_value(udev_device, property);
+	if (udev_device)
+		val = udev_device_get_property_value(udev_device, property);
+	else
+		val = evdev_device_get_udev_property(device, property);
 	if (!val)
 		return false;
 
@@ -438,6 +444,41 @@ fallback_filter_defuzz_touch(struct fallback_dispatch *dispatch,
 	return false;
 }
 
+static inline void
+fallback_smooth_touch(struct fallback_dispatch *dispatch,
+		      struct smoothing_filter *filter,
+		      struct device_coords *point,
+		      uint64_t time)
+{
+	struct device_float_coords in, out;
+
+	if (!dispatch->smoothing.enabled) {
+		smoothing_filter_reset(filter);
+		return;
+	}
+
+	in.x = point->x;
+	in.y = point->y;
+	out = smoothing_filter_apply(filter,
+				     &dispatch->smoothing.params,
+				     &in,
+				     time);
+	point->x = round(out.x);
+	point->y = round(out.y);
+}
+
+static inline struct device_coords
+fallback_predict_touch(struct fallback_dispatch *dispatch,
+		       struct prediction_filter *filter,
+		       const struct device_coords *point,
+		       uint64_t time)
+{
+	return prediction_filter_apply(filter,
+				       point,
+				       time,
+				       ms2us(dispatch->prediction.ms));
+}
+
 static inline void
 fallback_rotate_relative(struct fallback_dispatch *dispatch,
 			 struct evdev_device *device)
@@ -462,35 +503,38 @@ fallback_flush_relative_motion(struct fallback_dispatch *dispatch,
 	struct libinput_device *base = &device->base;
 	struct normalized_coords accel, unaccel;
 	struct device_float_coords raw;
+	struct device_coords rel;
 
 	if (!(device->seat_caps & EVDEV_DEVICE_POINTER))
 		return;
 
 	fallback_rotate_relative(dispatch, device);
 
-	normalize_delta(device, &dispatch->rel, &unaccel);
-	raw.x = dispatch->rel.x;
-	raw.y = dispatch->rel.y;
+	rel = dispatch->rel;
+	raw.x = rel.x;
+	raw.y = rel.y;
 	dispatch->rel.x = 0;
 	dispatch->rel.y = 0;
 
-	/* Use unaccelerated deltas for pointing stick scroll */
-	if (evdev_post_trackpoint_scroll(device, unaccel, time))
-		return;
+	/* Use unaccelerated deltas for pointing stick scroll. Normalizing
+	 * is only needed for that, the event carries the raw delta */
+	if (device->scroll.method == LIBINPUT_CONFIG_SCROLL_ON_BUTTON_DOWN) {
+		normalize_delta(device, &rel, &unaccel);
+		if (evdev_post_trackpoint_scroll(device, unaccel, time))
+			return;
+	}
 
 	if (device->pointer.filter) {
 		/* Apply pointer acceleration. */
-		accel = filter_dispatch(device->pointer.filter,
-					&raw,
-					device,
-					time);
+		accel = evdev_filter_dispatch(device, &raw, device, time);
 	} else {
 		evdev_log_bug_libinput(device,
 				       "accel filter missing\n");
-		accel = unaccel;
+		normalize_delta(device, &rel, &accel);
 	}
 
-	if (normalized_is_zero(accel) && normalized_is_zero(unaccel))
+	/* the unaccelerated delta is zero if and only if the raw one is */
+	if (normalized_is_zero(accel) && rel.x == 0 && rel.y == 0)
 		return;
 
 	pointer_notify_motion(base, time, &accel, &raw);
@@ -521,7 +565,7 @@ fallback_flush_mt_down(struct fallback_dispatch *dispatch,
 {
 	struct libinput_device *base = &device->base;
 	struct libinput_seat *seat = base->seat;
-	struct device_coords point;
+	struct device_coords point, predicted;
 	struct mt_slot *slot;
 	int seat_slot;
 
@@ -535,19 +579,26 @@ fallback_flush_mt_down(struct fallback_dispatch *dispatch,
 		return false;
 	}
 
-	seat_slot = ffs(~seat->slot_map) - 1;
+	seat_slot = libinput_seat_slot_acquire(seat);
 	slot->seat_slot = seat_slot;
 
 	if (seat_slot == -1)
 		return false;
 
-	seat->slot_map |= 1 << seat_slot;
 	point = slot->point;
 	slot->hysteresis_center = point;
+	smoothing_filter_reset(&slot->smoothing);
+	fallback_smooth_touch(dispatch, &slot->smoothing, &point, time);
+	prediction_filter_reset(&slot->prediction);
+	predicted = fallback_predict_touch(dispatch,
+					   &slot->prediction,
+					   &point,
+					   time);
 	evdev_transform_absolute(device, &point);
+	evdev_transform_absolute(device, &predicted);
 
 	touch_notify_touch_down(base, time, slot_idx, seat_slot,
-				&point);
+				&point, &predicted);
 
 	return true;
 }
@@ -559,7 +610,7 @@ fallback_flush_mt_motion(struct fallback_dispatch *dispatch,
 			 uint64_t time)
 {
 	struct libinput_device *base = &device->base;
-	struct device_coords point;
+	struct device_coords point, predicted;
 	struct mt_slot *slot;
 	int seat_slot;
 
@@ -576,9 +627,15 @@ fallback_flush_mt_motion(struct fallback_dispatch *dispatch,
 	if (fallback_filter_defuzz_touch(dispatch, device, slot))
 		return false;
 
+	fallback_smooth_touch(dispatch, &slot->smoothing, &point, time);
+	predicted = fallback_predict_touch(dispatch,
+					   &slot->prediction,
+					   &point,
+					   time);
 	evdev_transform_absolute(device, &point);
+	evdev_transform_absolute(device, &predicted);
 	touch_notify_touch_motion(base, time, slot_idx, seat_slot,
-				  &point);
+				  &point, &predicted);
 
 	return true;
 }
@@ -604,7 +661,7 @@ fallback_flush_mt_up(struct fallback_dispatch *dispatch,
 	if (seat_slot == -1)
 		return false;
 
-	seat->slot_map &= ~(1 << seat_slot);
+	libinput_seat_slot_release(seat, seat_slot);
 
 	touch_notify_touch_up(base, time, slot_idx, seat_slot);
 
@@ -618,7 +675,7 @@ fallback_flush_st_down(struct fallback_dispatch *dispatch,
 {
 	struct libinput_device *base = &device->base;
 	struct libinput_seat *seat = base->seat;
-	struct device_coords point;
+	struct device_coords point, predicted;
 	int seat_slot;
 
 	if (!(device->seat_caps & EVDEV_DEVICE_TOUCH))
@@ -630,18 +687,24 @@ fallback_flush_st_down(struct fallback_dispatch *dispatch,
 		return false;
 	}
 
-	seat_slot = ffs(~seat->slot_map) - 1;
+	seat_slot = libinput_seat_slot_acquire(seat);
 	dispatch->abs.seat_slot = seat_slot;
 
 	if (seat_slot == -1)
 		return false;
 
-	seat->slot_map |= 1 << seat_slot;
-
 	point = dispatch->abs.point;
+	smoothing_filter_reset(&dispatch->abs.smoothing);
+	fallback_smooth_touch(dispatch, &dispatch->abs.smoothing, &point, time);
+	prediction_filter_reset(&dispatch->abs.prediction);
+	predicted = fallback_predict_touch(dispatch,
+					   &dispatch->abs.prediction,
+					   &point,
+					   time);
 	evdev_transform_absolute(device, &point);
+	evdev_transform_absolute(device, &predicted);
 
-	touch_notify_touch_down(base, time, -1, seat_slot, &point);
+	touch_notify_touch_down(base, time, -1, seat_slot, &point, &predicted);
 
 	return true;
 }
@@ -652,18 +715,25 @@ fallback_flush_st_motion(struct fallback_dispatch *dispatch,
 			 uint64_t time)
 {
 	struct libinput_device *base = &device->base;
-	struct device_coords point;
+	struct device_coords point, predicted;
 	int seat_slot;
 
-	point = dispatch->abs.point;
-	evdev_transform_absolute(device, &point);
-
 	seat_slot = dispatch->abs.seat_slot;
 
 	if (seat_slot == -1)
 		return false;
 
-	touch_notify_touch_motion(base, time, -1, seat_slot, &point);
+	point = dispatch->abs.point;
+	fallback_smooth_touch(dispatch, &dispatch->abs.smoothing, &point, time);
+	predicted = fallback_predict_touch(dispatch,
+					   &dispatch->abs.prediction,
+					   &point,
+					   time);
+	evdev_transform_absolute(device, &point);
+	evdev_transform_absolute(device, &predicted);
+
+	touch_notify_touch_motion(base, time, -1, seat_slot,
+				  &point, &predicted);
 
 	return true;
 }
@@ -686,7 +756,7 @@ fallback_flush_st_up(struct fallback_dispatch *dispatch,
 	if (seat_slot == -1)
 		return false;
 
-	seat->slot_map &= ~(1 << seat_slot);
+	libinput_seat_slot_release(seat, seat_slot);
 
 	touch_notify_touch_up(base, time, -1, seat_slot);
 
@@ -1274,6 +1344,60 @@ fallback_toggle_touch(struct evdev_dispatch *evdev_dispatch,
 	dispatch->ignore_events = ignore_events;
 }
 
+/* The position of the touch as last sent to the caller */
+static inline struct device_coords
+fallback_touch_position(struct evdev_device *device,
+			const struct smoothing_filter *smoothing,
+			const struct device_coords *point)
+{
+	struct device_coords p = *point;
+
+	if (smoothing->initialized) {
+		p.x = round(smoothing->value.x);
+		p.y = round(smoothing->value.y);
+	}
+	evdev_transform_absolute(device, &p);
+
+	return p;
+}
+
+static void
+fallback_sync_touches(struct evdev_dispatch *evdev_dispatch,
+		      struct evdev_device *device)
+{
+	struct fallback_dispatch *dispatch = fallback_dispatch(evdev_dispatch);
+	struct device_coords point;
+	unsigned int idx;
+
+	if (!(device->seat_caps & EVDEV_DEVICE_TOUCH))
+		return;
+
+	if (dispatch->abs.seat_slot != -1) {
+		point = fallback_touch_position(device,
+						&dispatch->abs.smoothing,
+						&dispatch->abs.point);
+		touch_notify_touch_active(&device->base,
+					  -1,
+					  dispatch->abs.seat_slot,
+					  &point);
+	}
+
+	for (idx = 0; idx < dispatch->mt.slots_len; idx++) {
+		struct mt_slot *slot = &dispatch->mt.slots[idx];
+
+		if (slot->seat_slot == -1)
+			continue;
+
+		point = fallback_touch_position(device,
+						&slot->smoothing,
+						&slot->point);
+		touch_notify_touch_active(&device->base,
+					  idx,
+					  slot->seat_slot,
+					  &point);
+	}
+}
+
 static void
 fallback_destroy(struct evdev_dispatch *evdev_dispatch)
 {
@@ -1335,6 +1459,7 @@ struct evdev_dispatch_interface fallback_interface = {
 	NULL, /* device_resumed */
 	NULL, /* post_added */
 	fallback_toggle_touch, /* toggle_touch */
+	fallback_sync_touches, /* sync_touches */
 };
 
 static uint32_t
@@ -1549,6 +1674,7 @@ evdev_init_button_scroll(struct evdev_device *device,
 {
 	libinput_timer_init(&device->scroll.timer,
 			    evdev_libinput_context(device),
+			    &device->base,
 			    evdev_button_scroll_timeout, device);
 	device->scroll.config.get_methods = evdev_scroll_get_methods;
 	device->scroll.config.set_method = evdev_scroll_set_method;
@@ -1669,6 +1795,119 @@ evdev_rotation_config_get_default_angle(struct libinput_device *device)
 	return 0;
 }
 
+static int
+evdev_smoothing_config_is_available(struct libinput_device *device)
+{
+	/* This function only gets called for touch devices */
+	return 1;
+}
+
+static enum libinput_config_status
+evdev_smoothing_config_set(struct libinput_device *libinput_device,
+			   enum libinput_config_smoothing_state enable)
+{
+	struct evdev_device *device = evdev_device(libinput_device);
+	struct fallback_dispatch *dispatch = fallback_dispatch(device->dispatch);
+
+	switch(enable) {
+	case LIBINPUT_CONFIG_SMOOTHING_ENABLED:
+	case LIBINPUT_CONFIG_SMOOTHING_DISABLED:
+		break;
+	default:
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+	}
+
+	dispatch->smoothing.enabled =
+		(enable == LIBINPUT_CONFIG_SMOOTHING_ENABLED);
+
+	return LIBINPUT_CONFIG_STATUS_SUCCESS;
+}
+
+static enum libinput_config_smoothing_state
+evdev_smoothing_config_get(struct libinput_device *libinput_device)
+{
+	struct evdev_device *device = evdev_device(libinput_device);
+	struct fallback_dispatch *dispatch = fallback_dispatch(device->dispatch);
+
+	return dispatch->smoothing.enabled ?
+		LIBINPUT_CONFIG_SMOOTHING_ENABLED :
+		LIBINPUT_CONFIG_SMOOTHING_DISABLED;
+}
+
+static enum libinput_config_smoothing_state
+evdev_smoothing_config_get_default(struct libinput_device *device)
+{
+	return LIBINPUT_CONFIG_SMOOTHING_DISABLED;
+}
+
+static void
+evdev_init_smoothing(struct evdev_device *device,
+		     struct fallback_dispatch *dispatch)
+{
+	if ((device->seat_caps & EVDEV_DEVICE_TOUCH) == 0)
+		return;
+
+	smoothing_params_init(&dispatch->smoothing.params,
+			      device->abs.absinfo_x->resolution,
+			      device->abs.absinfo_y->resolution);
+
+	dispatch->smoothing.config.is_available = evdev_smoothing_config_is_available;
+	dispatch->smoothing.config.set_enabled = evdev_smoothing_config_set;
+	dispatch->smoothing.config.get_enabled = evdev_smoothing_config_get;
+	dispatch->smoothing.config.get_default_enabled = evdev_smoothing_config_get_default;
+	dispatch->smoothing.enabled = false;
+	device->base.config.smoothing = &dispatch->smoothing.config;
+}
+
+static int
+evdev_prediction_config_is_available(struct libinput_device *device)
+{
+	/* This function only gets called for touch devices */
+	return 1;
+}
+
+static enum libinput_config_status
+evdev_prediction_config_set(struct libinput_device *libinput_device,
+			    unsigned int ms)
+{
+	struct evdev_device *device = evdev_device(libinput_device);
+	struct fallback_dispatch *dispatch = fallback_dispatch(device->dispatch);
+
+	dispatch->prediction.ms = ms;
+
+	return LIBINPUT_CONFIG_STATUS_SUCCESS;
+}
+
+static unsigned int
+evdev_prediction_config_get(struct libinput_device *libinput_device)
+{
+	struct evdev_device *device = evdev_device(libinput_device);
+	struct fallback_dispatch *dispatch = fallback_dispatch(device->dispatch);
+
+	return dispatch->prediction.ms;
+}
+
+static unsigned int
+evdev_prediction_config_get_default(struct libinput_device *device)
+{
+	return 0;
+}
+
+static void
+evdev_init_prediction(struct evdev_device *device,
+		      struct fallback_dispatch *dispatch)
+{
+	if ((device->seat_caps & EVDEV_DEVICE_TOUCH) == 0)
+		return;
+
+	dispatch->prediction.config.is_available = evdev_prediction_config_is_available;
+	dispatch->prediction.config.set_time = evdev_prediction_config_set;
+	dispatch->prediction.config.get_time = evdev_prediction_config_get;
+	dispatch->prediction.config.get_default_time = evdev_prediction_config_get_default;
+	dispatch->prediction.ms = 0;
+	device->base.config.prediction = &dispatch->prediction.config;
+}
+
 static void
 evdev_init_rotation(struct evdev_device *device,
 		    struct fallback_dispatch *dispatch)
@@ -1825,6 +2064,8 @@ fallback_dispatch_create(struct libinput_device *libinput_device)
 	evdev_init_calibration(device, &dispatch->calibration);
 	evdev_init_sendevents(device, &dispatch->base);
 	evdev_init_rotation(device, dispatch);
+	evdev_init_smoothing(device, dispatch);
+	evdev_init_prediction(device, dispatch);
 
 	/* BTN_MIDDLE is set on mice even when it's not present. So
 	 * we can only use the absence of BTN_MIDDLE to mean something, i.e.
@@ -1847,11 +2088,168 @@ fallback_dispatch_create(struct libinput_device *libinput_device)
 	return &dispatch->base;
 }
 
+/* Dispatching a batch of events reads them from libevdev before they are
+ * processed, so libevdev's state is ahead of the frame being processed.
+ * The fallback and touchpad dispatch only read that state on init and
+ * after SYN_DROPPED, the others read it for every frame (e.g. ABS_MISC on
+ * tablet pads) and process one event at a time. */
+static void
+evdev_msc_timestamp_init(struct evdev_device *device)
+{
+	if (!libevdev_has_event_code(device->evdev, EV_MSC, MSC_TIMESTAMP))
+		return;
+
+	switch (device->dispatch->dispatch_type) {
+	case DISPATCH_FALLBACK:
+	case DISPATCH_TOUCHPAD:
+		device->msc_timestamp.batch = true;
+		break;
+	default:
+		break;
+	}
+}
+
+bool
+evdev_msc_timestamp_get_stats(struct evdev_device *device,
+			      struct libinput_timestamp_stats *stats)
+{
+	if (!libevdev_has_event_code(device->evdev, EV_MSC, MSC_TIMESTAMP))
+		return false;
+
+	stats->frames = device->msc_timestamp.stats.frames;
+	stats->batched = device->msc_timestamp.stats.batched;
+	stats->resyncs = device->msc_timestamp.stats.resyncs;
+
+	return true;
+}
+
+/* Find the newest frame with MSC_TIMESTAMP in the events read in one go,
+ * the other frames of the batch are timed backwards from it */
+static void
+evdev_msc_timestamp_batch_begin(struct evdev_device *device,
+				const struct input_event *events,
+				size_t nevents)
+{
+	struct libinput *libinput = evdev_libinput_context(device);
+	const struct input_event *e;
+	size_t i = nevents;
+	uint64_t time;
+
+	device->msc_timestamp.have_batch_end = false;
+
+	while (i > 0 &&
+	       !libevdev_event_is_code(&events[i - 1], EV_SYN, SYN_REPORT))
+		i--;
+	if (i == 0)
+		return;
+
+	/* see evdev_device_dispatch_one() */
+	e = &events[--i];
+	if (libinput->clock)
+		time = libinput_now(libinput);
+	else
+		time = s2us(e->time.tv_sec) + e->time.tv_usec;
+
+	while (i > 0) {
+		e = &events[--i];
+		if (libevdev_event_is_code(e, EV_SYN, SYN_REPORT))
+			break;
+
+		if (libevdev_event_is_code(e, EV_MSC, MSC_TIMESTAMP)) {
+			device->msc_timestamp.have_batch_end = true;
+			device->msc_timestamp.batch_end_value = (uint32_t)e->value;
+			device->msc_timestamp.batch_end_time = time;
+			break;
+		}
+	}
+}
+
+static void
+evdev_msc_timestamp_frame(struct evdev_device *device, uint64_t time)
+{
+	uint32_t hw_delta;
+	uint64_t kernel_delta;
+	uint64_t corrected = time;
+
+	device->msc_timestamp.frame_kernel_time = time;
+	device->msc_timestamp.frame_time = 0;
+
+	if (!device->msc_timestamp.in_frame) {
+		device->msc_timestamp.have_last = false;
+		return;
+	}
+
+	device->msc_timestamp.in_frame = false;
+	device->msc_timestamp.stats.frames++;
+
+	/* MSC_TIMESTAMP is a free-running 32-bit µs counter, unsigned
+	 * subtraction handles the wraparound. Devices may reset the
+	 * counter after a period of inactivity, in which case the delta is
+	 * nonsensical and we use the kernel time. */
+	if (device->msc_timestamp.have_last &&
+	    time >= device->msc_timestamp.last_kernel_time) {
+		hw_delta = device->msc_timestamp.value -
+			   device->msc_timestamp.last_value;
+		kernel_delta = time - device->msc_timestamp.last_kernel_time;
+
+		if (hw_delta == 0 || hw_delta > MSC_TIMESTAMP_MAX_DELTA) {
+			device->msc_timestamp.stats.resyncs++;
+		} else if (kernel_delta * 2 < hw_delta) {
+			/* The kernel delivered this frame much closer to
+			 * the previous one than the hardware generated it */
+			device->msc_timestamp.stats.batched++;
+			evdev_log_debug_ratelimit(device,
+						  &device->msc_timestamp.batch_limit,
+						  "frames batched: kernel delta %dus, hw delta %uus\n",
+						  (int)kernel_delta,
+						  hw_delta);
+		}
+	} else if (device->msc_timestamp.have_last) {
+		device->msc_timestamp.stats.resyncs++;
+	}
+
+	/* The newest frame of a batch is the one generated closest to the
+	 * time the kernel delivered the batch, so its kernel time is the
+	 * anchor and each older frame is placed before it by the
+	 * MSC_TIMESTAMP difference. Anchoring forward from the previous
+	 * frame instead would clamp every frame of a burst to its receive
+	 * time. */
+	if (device->msc_timestamp.have_batch_end) {
+		hw_delta = device->msc_timestamp.batch_end_value -
+			   device->msc_timestamp.value;
+		if (hw_delta <= MSC_TIMESTAMP_MAX_DELTA &&
+		    hw_delta <= device->msc_timestamp.batch_end_time)
+			corrected = device->msc_timestamp.batch_end_time -
+				    hw_delta;
+	}
+
+	/* A frame can't have happened after the kernel saw it or before
+	 * the previous frame */
+	corrected = min(corrected, time);
+	if (device->msc_timestamp.have_last)
+		corrected = max(corrected,
+				min(device->msc_timestamp.last_time, time));
+
+	device->msc_timestamp.have_last = true;
+	device->msc_timestamp.last_value = device->msc_timestamp.value;
+	device->msc_timestamp.last_kernel_time = time;
+	device->msc_timestamp.last_time = corrected;
+	device->msc_timestamp.frame_time = corrected;
+}
+
 static inline void
 evdev_process_event(struct evdev_device *device, struct input_event *e)
 {
 	struct evdev_dispatch *dispatch = device->dispatch;
 	uint64_t time = s2us(e->time.tv_sec) + e->time.tv_usec;
+	uint64_t start;
+
+	if (libevdev_event_is_code(e, EV_MSC, MSC_TIMESTAMP)) {
+		device->msc_timestamp.in_frame = true;
+		device->msc_timestamp.value = (uint32_t)e->value;
+	} else if (libevdev_event_is_code(e, EV_SYN, SYN_REPORT)) {
+		evdev_msc_timestamp_frame(device, time);
+	}
 
 #if 0
 	if (libevdev_event_is_code(e, EV_SYN, SYN_REPORT))
@@ -1865,13 +2263,28 @@ evdev_process_event(struct evdev_device *device, struct input_event *e)
 			  e->value);
 #endif
 
+	start = cpu_account_begin(evdev_libinput_context(device));
 	dispatch->interface->process(dispatch, device, e, time);
+	cpu_account_end(&device->base, LIBINPUT_CPU_STAT_PROCESS, start);
+
+	if (libevdev_event_is_code(e, EV_SYN, SYN_REPORT))
+		trace_probe2(frame, &device->base, time);
 }
 
 static inline void
 evdev_device_dispatch_one(struct evdev_device *device,
 			  struct input_event *ev)
 {
+	struct libinput *libinput = evdev_libinput_context(device);
+
+	/* the kernel stamps events with the real clock */
+	if (libinput->clock) {
+		uint64_t now = libinput_now(libinput);
+
+		ev->time.tv_sec = now / s2us(1);
+		ev->time.tv_usec = now % s2us(1);
+	}
+
 	if (!device->mtdev) {
 		evdev_process_event(device, ev);
 	} else {
@@ -1886,6 +2299,25 @@ evdev_device_dispatch_one(struct evdev_device *device,
 	}
 }
 
+/* Dispatch the events read from the device in one go. On devices with
+ * MSC_TIMESTAMP the batch is scanned first, see
+ * evdev_msc_timestamp_frame() */
+static void
+evdev_device_dispatch_batch(struct evdev_device *device,
+			    struct input_event *events,
+			    size_t nevents)
+{
+	size_t i;
+
+	if (nevents == 0)
+		return;
+
+	evdev_msc_timestamp_batch_begin(device, events, nevents);
+	for (i = 0; i < nevents; i++)
+		evdev_device_dispatch_one(device, &events[i]);
+	device->msc_timestamp.have_batch_end = false;
+}
+
 static int
 evdev_sync_device(struct evdev_device *device)
 {
@@ -1909,8 +2341,13 @@ evdev_device_dispatch(void *data)
 	struct evdev_device *device = data;
 	struct libinput *libinput = evdev_libinput_context(device);
 	struct input_event ev;
+	struct input_event batch[EVDEV_BATCH_SIZE];
+	size_t nbatched = 0;
+	unsigned int nevents = 0;
 	int rc;
 
+	trace_probe1(dispatch__entry, &device->base);
+
 	/* If the compositor is repainting, this function is called only once
 	 * per frame and we have to process all the events available on the
 	 * fd, otherwise there will be input lag. */
@@ -1925,6 +2362,8 @@ evdev_device_dispatch(void *data)
 			/* send one more sync event so we handle all
 			   currently pending events before we sync up
 			   to the current state */
+			evdev_device_dispatch_batch(device, batch, nbatched);
+			nbatched = 0;
 			ev.code = SYN_REPORT;
 			evdev_device_dispatch_one(device, &ev);
 
@@ -1932,14 +2371,69 @@ evdev_device_dispatch(void *data)
 			if (rc == 0)
 				rc = LIBEVDEV_READ_STATUS_SUCCESS;
 		} else if (rc == LIBEVDEV_READ_STATUS_SUCCESS) {
-			evdev_device_dispatch_one(device, &ev);
+			/* Only MSC_TIMESTAMP needs to see the whole batch.
+			 * libevdev's state is ahead of the buffered events,
+			 * see evdev_msc_timestamp_init() for the devices
+			 * this is safe on. */
+			if (device->msc_timestamp.batch) {
+				batch[nbatched++] = ev;
+				if (nbatched == ARRAY_LENGTH(batch)) {
+					evdev_device_dispatch_batch(device,
+								    batch,
+								    nbatched);
+					nbatched = 0;
+				}
+			} else {
+				evdev_device_dispatch_one(device, &ev);
+			}
+			nevents++;
 		}
 	} while (rc == LIBEVDEV_READ_STATUS_SUCCESS);
 
+	evdev_device_dispatch_batch(device, batch, nbatched);
+
 	if (rc != -EAGAIN && rc != -EINTR) {
 		libinput_remove_source(libinput, device->source);
 		device->source = NULL;
 	}
+
+	trace_probe2(dispatch__return, &device->base, nevents);
+}
+
+static void
+evdev_device_dispatch_virtual(void *data)
+{
+	struct evdev_device *device = data;
+	struct libinput *libinput = evdev_libinput_context(device);
+	struct input_event batch[EVDEV_BATCH_SIZE];
+	size_t i, nevents;
+	ssize_t len;
+
+	while ((len = read(device->virtual.fd, batch, sizeof(batch))) > 0 &&
+	       len % sizeof(batch[0]) == 0) {
+		nevents = len / sizeof(batch[0]);
+
+		if (!device->msc_timestamp.batch) {
+			for (i = 0; i < nevents; i++)
+				evdev_device_inject_event(device, &batch[i]);
+			continue;
+		}
+
+		/* libevdev's state is updated on read, like for a real
+		 * device */
+		for (i = 0; i < nevents; i++)
+			libevdev_set_event_value(device->evdev,
+						 batch[i].type,
+						 batch[i].code,
+						 batch[i].value);
+		evdev_device_dispatch_batch(device, batch, nevents);
+	}
+
+	/* the writer went away or sent a partial event */
+	if (len != -1 || (errno != EAGAIN && errno != EINTR)) {
+		libinput_remove_source(libinput, device->source);
+		device->source = NULL;
+	}
 }
 
 static inline bool
@@ -2085,7 +2579,7 @@ evdev_read_wheel_click_prop(struct evdev_device *device,
 	int val;
 
 	*angle = DEFAULT_WHEEL_CLICK_ANGLE;
-	prop = udev_device_get_property_value(device->udev_device, prop);
+	prop = evdev_device_get_udev_property(device, prop);
 	if (!prop)
 		return false;
 
@@ -2110,7 +2604,7 @@ evdev_read_wheel_click_count_prop(struct evdev_device *device,
 {
 	int val;
 
-	prop = udev_device_get_property_value(device->udev_device, prop);
+	prop = evdev_device_get_udev_property(device, prop);
 	if (!prop)
 		return false;
 
@@ -2174,8 +2668,8 @@ evdev_get_trackpoint_dpi(struct evdev_device *device)
 	const char *trackpoint_accel;
 	double accel = DEFAULT_TRACKPOINT_ACCEL;
 
-	trackpoint_accel = udev_device_get_property_value(
-				device->udev_device, "POINTINGSTICK_CONST_ACCEL");
+	trackpoint_accel = evdev_device_get_udev_property(device,
+						"POINTINGSTICK_CONST_ACCEL");
 	if (trackpoint_accel) {
 		accel = parse_trackpoint_accel_property(trackpoint_accel);
 		if (accel == 0.0) {
@@ -2205,8 +2699,7 @@ evdev_read_dpi_prop(struct evdev_device *device)
 	if (device->tags & EVDEV_TAG_TRACKPOINT)
 		return evdev_get_trackpoint_dpi(device);
 
-	mouse_dpi = udev_device_get_property_value(device->udev_device,
-						   "MOUSE_DPI");
+	mouse_dpi = evdev_device_get_udev_property(device, "MOUSE_DPI");
 	if (mouse_dpi) {
 		dpi = parse_mouse_dpi_property(mouse_dpi);
 		if (!dpi) {
@@ -2285,12 +2778,10 @@ evdev_read_attr_res_prop(struct evdev_device *device,
 			 size_t *xres,
 			 size_t *yres)
 {
-	struct udev_device *udev;
 	const char *res_prop;
 
-	udev = device->udev_device;
-	res_prop = udev_device_get_property_value(udev,
-						   "LIBINPUT_ATTR_RESOLUTION_HINT");
+	res_prop = evdev_device_get_udev_property(device,
+						  "LIBINPUT_ATTR_RESOLUTION_HINT");
 	if (!res_prop)
 		return false;
 
@@ -2302,11 +2793,9 @@ evdev_read_attr_size_prop(struct evdev_device *device,
 			  size_t *size_x,
 			  size_t *size_y)
 {
-	struct udev_device *udev;
 	const char *size_prop;
 
-	udev = device->udev_device;
-	size_prop = udev_device_get_property_value(udev,
+	size_prop = evdev_device_get_udev_property(device,
 						   "LIBINPUT_ATTR_SIZE_HINT");
 	if (!size_prop)
 		return false;
@@ -2368,7 +2857,8 @@ evdev_device_get_udev_tags(struct evdev_device *device,
 	const struct evdev_udev_tag_match *match;
 	int i;
 
-	for (i = 0; i < 2 && udev_device; i++) {
+	/* a virtual device has its parent's properties merged in */
+	for (i = 0; i < 2; i++) {
 		match = evdev_udev_tag_matches;
 		while (match->name) {
 			if (parse_udev_flag(device,
@@ -2378,7 +2868,12 @@ evdev_device_get_udev_tags(struct evdev_device *device,
 
 			match++;
 		}
+
+		if (!udev_device)
+			break;
 		udev_device = udev_device_get_parent(udev_device);
+		if (!udev_device)
+			break;
 	}
 
 	return tags;
@@ -2736,14 +3231,13 @@ out:
 }
 
 static bool
-evdev_set_device_group(struct evdev_device *device,
-		       struct udev_device *udev_device)
+evdev_set_device_group(struct evdev_device *device)
 {
 	struct libinput *libinput = evdev_libinput_context(device);
 	struct libinput_device_group *group = NULL;
 	const char *udev_group;
 
-	udev_group = udev_device_get_property_value(udev_device,
+	udev_group = evdev_device_get_udev_property(device,
 						    "LIBINPUT_DEVICE_GROUP");
 	if (udev_group)
 		group = libinput_device_group_find_group(libinput, udev_group);
@@ -2836,56 +3330,38 @@ evdev_pre_configure_model_quirks(struct evdev_device *device)
 		libevdev_disable_event_code(device->evdev, EV_KEY, BTN_MIDDLE);
 }
 
-struct evdev_device *
-evdev_device_create(struct libinput_seat *seat,
-		    struct udev_device *udev_device)
+static struct evdev_device *
+evdev_device_alloc(struct libinput_seat *seat, struct libevdev *evdev)
 {
-	struct libinput *libinput = seat->libinput;
-	struct evdev_device *device = NULL;
-	int rc;
-	int fd;
-	int unhandled_device = 0;
-	const char *devnode = udev_device_get_devnode(udev_device);
-	const char *sysname = udev_device_get_sysname(udev_device);
-
-	/* Use non-blocking mode so that we can loop on read on
-	 * evdev_device_data() until all events on the fd are
-	 * read.  mtdev_get() also expects this. */
-	fd = open_restricted(libinput, devnode,
-			     O_RDWR | O_NONBLOCK | O_CLOEXEC);
-	if (fd < 0) {
-		log_info(libinput,
-			 "%s: opening input device '%s' failed (%s).\n",
-			 sysname,
-			 devnode,
-			 strerror(-fd));
-		return NULL;
-	}
-
-	if (!evdev_device_have_same_syspath(udev_device, fd))
-		goto err;
+	struct evdev_device *device;
 
 	device = zalloc(sizeof *device);
 	if (device == NULL)
-		goto err;
+		return NULL;
 
 	libinput_device_init(&device->base, seat);
 	libinput_seat_ref(seat);
 
-	evdev_drain_fd(fd);
+	device->evdev = evdev;
+	device->fd = -1;
+	device->virtual.fd = -1;
 
-	rc = libevdev_new_from_fd(fd, &device->evdev);
-	if (rc != 0)
-		goto err;
+	return device;
+}
 
-	libevdev_set_clock_id(device->evdev, CLOCK_MONOTONIC);
+/* Configures the device and adds it to its seat. On failure, the device
+ * and its fd are released */
+static struct evdev_device *
+evdev_device_add(struct evdev_device *device)
+{
+	struct libinput *libinput = evdev_libinput_context(device);
+	struct libinput_seat *seat = device->base.seat;
+	int unhandled_device = 0;
 
 	device->seat_caps = 0;
 	device->is_mt = 0;
 	device->mtdev = NULL;
-	device->udev_device = udev_device_ref(udev_device);
 	device->dispatch = NULL;
-	device->fd = fd;
 	device->devname = libevdev_get_name(device->evdev);
 	device->scroll.threshold = 5.0; /* Default may be overridden */
 	device->scroll.direction_lock_threshold = 5.0; /* Default may be overridden */
@@ -2900,6 +3376,8 @@ evdev_device_create(struct libinput_seat *seat,
 	ratelimit_init(&device->syn_drop_limit, s2us(30), 5);
 	/* at most 5 log-messages per 5s */
 	ratelimit_init(&device->nonpointer_rel_limit, s2us(5), 5);
+	/* at most 5 batching log-messages per 30s */
+	ratelimit_init(&device->msc_timestamp.batch_limit, s2us(30), 5);
 
 	matrix_init_identity(&device->abs.calibration);
 	matrix_init_identity(&device->abs.usermatrix);
@@ -2914,12 +3392,25 @@ evdev_device_create(struct libinput_seat *seat,
 		goto err;
 	}
 
-	device->source =
-		libinput_add_fd(libinput, fd, evdev_device_dispatch, device);
-	if (!device->source)
-		goto err;
+	evdev_msc_timestamp_init(device);
+
+	if (device->fd != -1) {
+		device->source = libinput_add_fd(libinput,
+						 device->fd,
+						 evdev_device_dispatch,
+						 device);
+		if (!device->source)
+			goto err;
+	} else if (device->virtual.fd != -1) {
+		device->source = libinput_add_fd(libinput,
+						 device->virtual.fd,
+						 evdev_device_dispatch_virtual,
+						 device);
+		if (!device->source)
+			goto err;
+	}
 
-	if (!evdev_set_device_group(device, udev_device))
+	if (!evdev_set_device_group(device))
 		goto err;
 
 	list_insert(seat->devices_list.prev, &device->base.link);
@@ -2929,14 +3420,148 @@ evdev_device_create(struct libinput_seat *seat,
 	return device;
 
 err:
-	if (fd >= 0)
-		close_restricted(libinput, fd);
-	if (device)
-		evdev_device_destroy(device);
+	if (device->fd != -1)
+		close_restricted(libinput, device->fd);
+	evdev_device_destroy(device);
 
 	return unhandled_device ? EVDEV_UNHANDLED_DEVICE :  NULL;
 }
 
+struct evdev_device *
+evdev_device_create(struct libinput_seat *seat,
+		    struct udev_device *udev_device)
+{
+	struct libinput *libinput = seat->libinput;
+	struct evdev_device *device;
+	struct libevdev *evdev;
+	int rc;
+	int fd;
+	const char *devnode = udev_device_get_devnode(udev_device);
+	const char *sysname = udev_device_get_sysname(udev_device);
+
+	/* Use non-blocking mode so that we can loop on read on
+	 * evdev_device_data() until all events on the fd are
+	 * read.  mtdev_get() also expects this. */
+	fd = open_restricted(libinput, devnode,
+			     O_RDWR | O_NONBLOCK | O_CLOEXEC);
+	if (fd < 0) {
+		log_info(libinput,
+			 "%s: opening input device '%s' failed (%s).\n",
+			 sysname,
+			 devnode,
+			 strerror(-fd));
+		return NULL;
+	}
+
+	if (!evdev_device_have_same_syspath(udev_device, fd))
+		goto err;
+
+	evdev_drain_fd(fd);
+
+	rc = libevdev_new_from_fd(fd, &evdev);
+	if (rc != 0)
+		goto err;
+
+	libevdev_set_clock_id(evdev, CLOCK_MONOTONIC);
+
+	device = evdev_device_alloc(seat, evdev);
+	if (device == NULL) {
+		libevdev_free(evdev);
+		goto err;
+	}
+
+	device->udev_device = udev_device_ref(udev_device);
+	device->fd = fd;
+
+	return evdev_device_add(device);
+
+err:
+	close_restricted(libinput, fd);
+
+	return NULL;
+}
+
+/**
+ * Create a device without a device node, e.g. to replay a recording.
+ * evdev describes the device and is owned by the device afterwards, even
+ * on failure. properties are the udev properties of the device and its
+ * parent, as NULL-terminated name/value pairs.
+ *
+ * Events are passed in with evdev_device_inject_event() or, if fd is not
+ * -1, read from fd whenever libinput dispatches. fd must deliver whole
+ * struct input_event, e.g. the read end of a pipe, and is owned by the
+ * device afterwards. Protocol A touch devices need mtdev and thus a device
+ * node, they are not supported.
+ */
+struct evdev_device *
+evdev_device_create_virtual(struct libinput_seat *seat,
+			    struct libevdev *evdev,
+			    const char *sysname,
+			    const char * const *properties,
+			    int fd)
+{
+	struct evdev_device *device;
+	size_t i, nprops = 0;
+
+	device = evdev_device_alloc(seat, evdev);
+	if (device == NULL) {
+		libevdev_free(evdev);
+		if (fd != -1)
+			close(fd);
+		return NULL;
+	}
+
+	device->virtual.fd = fd;
+
+	while (properties && properties[nprops])
+		nprops++;
+
+	device->virtual.sysname = strdup(sysname);
+	device->virtual.properties = zalloc((nprops + 1) * sizeof(char *));
+	if (!device->virtual.sysname || !device->virtual.properties)
+		goto err;
+
+	for (i = 0; i < nprops; i++) {
+		device->virtual.properties[i] = strdup(properties[i]);
+		if (!device->virtual.properties[i])
+			goto err;
+	}
+
+	return evdev_device_add(device);
+
+err:
+	evdev_device_destroy(device);
+	return NULL;
+}
+
+void
+evdev_device_inject_event(struct evdev_device *device,
+			  struct input_event *ev)
+{
+	/* libevdev updates its state while reading from the fd, the
+	 * dispatch code relies on it */
+	libevdev_set_event_value(device->evdev, ev->type, ev->code, ev->value);
+	evdev_device_dispatch_one(device, ev);
+}
+
+const char *
+evdev_device_get_udev_property(struct evdev_device *device,
+			       const char *property)
+{
+	char **p;
+
+	if (device->udev_device)
+		return udev_device_get_property_value(device->udev_device,
+						      property);
+
+	for (p = device->virtual.properties; p && p[0] && p[1]; p += 2) {
+		if (streq(p[0], property))
+			return p[1];
+	}
+
+	return NULL;
+}
+
 const char *
 evdev_device_get_output(struct evdev_device *device)
 {
@@ -2946,6 +3571,9 @@ evdev_device_get_output(struct evdev_device *device)
 const char *
 evdev_device_get_sysname(struct evdev_device *device)
 {
+	if (evdev_device_is_virtual(device))
+		return device->virtual.sysname;
+
 	return udev_device_get_sysname(device->udev_device);
 }
 
@@ -3051,7 +3679,7 @@ evdev_read_calibration_prop(struct evdev_device *device)
 	const char *prop;
 	float calibration[6];
 
-	prop = udev_device_get_property_value(device->udev_device,
+	prop = evdev_device_get_udev_property(device,
 					      "LIBINPUT_CALIBRATION_MATRIX");
 
 	if (prop == NULL)
@@ -3293,6 +3921,15 @@ evdev_notify_resumed_device(struct evdev_device *device)
 	device->is_suspended = false;
 }
 
+void
+evdev_device_sync_touches(struct evdev_device *device)
+{
+	struct evdev_dispatch *dispatch = device->dispatch;
+
+	if (dispatch->interface->sync_touches)
+		dispatch->interface->sync_touches(dispatch, device);
+}
+
 void
 evdev_device_suspend(struct evdev_device *device)
 {
@@ -3335,6 +3972,24 @@ evdev_device_resume(struct evdev_device *device)
 	if (device->was_removed)
 		return -ENODEV;
 
+	if (evdev_device_is_virtual(device)) {
+		/* events written while suspended are lost, like on a
+		 * closed fd */
+		if (device->virtual.fd != -1 && !device->source) {
+			evdev_drain_fd(device->virtual.fd);
+			device->source =
+				libinput_add_fd(libinput,
+						device->virtual.fd,
+						evdev_device_dispatch_virtual,
+						device);
+			if (!device->source)
+				return -ENOMEM;
+		}
+
+		evdev_notify_resumed_device(device);
+		return 0;
+	}
+
 	devnode = udev_device_get_devnode(device->udev_device);
 	fd = open_restricted(libinput, devnode,
 			     O_RDWR | O_NONBLOCK | O_CLOEXEC);
@@ -3431,6 +4086,16 @@ evdev_device_destroy(struct evdev_device *device)
 	libinput_seat_unref(device->base.seat);
 	libevdev_free(device->evdev);
 	udev_device_unref(device->udev_device);
+	if (device->virtual.properties) {
+		char **p;
+
+		for (p = device->virtual.properties; *p; p++)
+			free(*p);
+		free(device->virtual.properties);
+	}
+	if (evdev_device_is_virtual(device) && device->virtual.fd != -1)
+		close(device->virtual.fd);
+	free(device->virtual.sysname);
 	free(device);
 }
 
@@ -3444,6 +4109,9 @@ evdev_tablet_has_left_handed(struct evdev_device *device)
 	WacomError *error;
 	const char *devnode;
 
+	if (evdev_device_is_virtual(device))
+		goto out;
+
 	db = libwacom_database_new();
 	if (!db) {
 		evdev_log_info(device,
@@ -88,6 +88,9 @@ enum evdev_middlebutton_state {
 	MIDDLEBUTTON_PASSTHROUGH,
 };
 
+/* number of chord press gaps the timeout is learned from */
+#define MIDDLEBUTTON_GAP_HISTORY 64
+
 enum evdev_middlebutton_event {
 	MIDDLEBUTTON_EVENT_L_DOWN,
 	MIDDLEBUTTON_EVENT_R_DOWN,
@@ -140,6 +143,8 @@ struct mt_slot {
 	int32_t seat_slot;
 	struct device_coords point;
 	struct device_coords hysteresis_center;
+	struct smoothing_filter smoothing;
+	struct prediction_filter prediction;
 };
 
 struct evdev_device {
@@ -150,6 +155,13 @@ struct evdev_device {
 	struct evdev_dispatch *dispatch;
 	struct libevdev *evdev;
 	struct udev_device *udev_device;
+	/* Only for devices without a device node, see
+	 * evdev_device_create_virtual() */
+	struct {
+		char *sysname;
+		char **properties; /* NULL-terminated name/value pairs */
+		int fd; /* struct input_event stream, or -1 */
+	} virtual;
 	char *output_name;
 	const char *devname;
 	bool was_removed;
@@ -181,6 +193,39 @@ struct evdev_device {
 		} warning_range;
 	} abs;
 
+	/* EV_MSC/MSC_TIMESTAMP handling. Some devices (bluetooth
+	 * touchpads in particular) deliver several frames in one batch,
+	 * so the kernel timestamps are almost identical while the
+	 * hardware timestamps are spaced correctly. We use the latter to
+	 * reconstruct the frame time for the motion filters. */
+	struct {
+		bool batch;		/* see evdev_msc_timestamp_init() */
+		bool in_frame;		/* current frame has MSC_TIMESTAMP */
+		uint32_t value;		/* MSC_TIMESTAMP of current frame, µs */
+
+		/* newest frame of the batch being dispatched */
+		bool have_batch_end;
+		uint32_t batch_end_value;
+		uint64_t batch_end_time;
+
+		bool have_last;
+		uint32_t last_value;	/* MSC_TIMESTAMP of previous frame */
+		uint64_t last_kernel_time;
+		uint64_t last_time;	/* corrected time of previous frame */
+
+		uint64_t frame_kernel_time;
+		uint64_t frame_time;	/* corrected time of current frame */
+
+		struct ratelimit batch_limit;
+
+		/* see libinput_device_get_timestamp_stats() */
+		struct {
+			uint64_t frames;
+			uint64_t batched;
+			uint64_t resyncs;
+		} stats;
+	} msc_timestamp;
+
 	struct {
 		struct libinput_timer timer;
 		struct libinput_device_config_scroll_method config;
@@ -242,6 +287,17 @@ struct evdev_device {
 		struct libinput_timer timer;
 		uint32_t button_mask;
 		uint64_t first_event_time;
+		/* timed out waiting for the other button */
+		bool timed_out;
+
+		/* learned from the press gaps of previous chords */
+		uint64_t timeout;
+		struct {
+			uint64_t gaps[MIDDLEBUTTON_GAP_HISTORY];
+			unsigned int ngaps;
+			unsigned int nchords;
+			unsigned int nmissed;
+		} stats;
 	} middlebutton;
 };
 
@@ -298,6 +354,11 @@ struct evdev_dispatch_interface {
 	void (*toggle_touch)(struct evdev_dispatch *dispatch,
 			     struct evdev_device *device,
 			     bool enable);
+
+	/* Report each touch that is down with touch_notify_touch_active()
+	 * (may be NULL) */
+	void (*sync_touches)(struct evdev_dispatch *dispatch,
+			     struct evdev_device *device);
 };
 
 enum evdev_dispatch_type {
@@ -338,9 +399,22 @@ struct fallback_dispatch {
 		struct libinput_device_config_rotation config;
 	} rotation;
 
+	struct {
+		bool enabled;
+		struct smoothing_params params;
+		struct libinput_device_config_smoothing config;
+	} smoothing;
+
+	struct {
+		unsigned int ms;
+		struct libinput_device_config_prediction config;
+	} prediction;
+
 	struct {
 		struct device_coords point;
 		int32_t seat_slot;
+		struct smoothing_filter smoothing;
+		struct prediction_filter prediction;
 
 		struct {
 			struct device_coords min, max;
@@ -383,6 +457,27 @@ struct evdev_device *
 evdev_device_create(struct libinput_seat *seat,
 		    struct udev_device *device);
 
+struct evdev_device *
+evdev_device_create_virtual(struct libinput_seat *seat,
+			    struct libevdev *evdev,
+			    const char *sysname,
+			    const char * const *properties,
+			    int fd);
+
+void
+evdev_device_inject_event(struct evdev_device *device,
+			  struct input_event *ev);
+
+static inline bool
+evdev_device_is_virtual(struct evdev_device *device)
+{
+	return device->udev_device == NULL;
+}
+
+const char *
+evdev_device_get_udev_property(struct evdev_device *device,
+			       const char *property);
+
 void
 evdev_transform_absolute(struct evdev_device *device,
 			 struct device_coords *point);
@@ -501,6 +596,9 @@ double
 evdev_device_transform_y(struct evdev_device *device,
 			 double y,
 			 uint32_t height);
+void
+evdev_device_sync_touches(struct evdev_device *device);
+
 void
 evdev_device_suspend(struct evdev_device *device);
 
@@ -571,6 +669,15 @@ evdev_middlebutton_is_available(struct libinput_device *device);
 enum libinput_config_middle_emulation_state
 evdev_middlebutton_get_default(struct libinput_device *device);
 
+/* false if the device has no middle button emulation */
+bool
+evdev_middlebutton_get_stats(struct evdev_device *device,
+			     struct libinput_middle_emulation_stats *stats);
+
+bool
+evdev_msc_timestamp_get_stats(struct evdev_device *device,
+			      struct libinput_timestamp_stats *stats);
+
 static inline double
 evdev_convert_to_mm(const struct input_absinfo *absinfo, double v)
 {
@@ -714,6 +821,15 @@ evdev_log_msg_ratelimit(struct evdev_device *device,
 }
 
 #define evdev_log_debug(d_, ...) evdev_log_msg((d_), LIBINPUT_LOG_PRIORITY_DEBUG, __VA_ARGS__)
+/* A debug message that is also recorded in the trace buffer, see
+ * log_trace() for the restrictions on the format */
+#define evdev_log_debug_trace(d_, ...) \
+	do { \
+		log_trace(evdev_libinput_context(d_), \
+			  evdev_device_get_sysname(d_), \
+			  __VA_ARGS__); \
+		evdev_log_debug((d_), __VA_ARGS__); \
+	} while (0)
 #define evdev_log_info(d_, ...) evdev_log_msg((d_), LIBINPUT_LOG_PRIORITY_INFO, __VA_ARGS__)
 #define evdev_log_error(d_, ...) evdev_log_msg((d_), LIBINPUT_LOG_PRIORITY_ERROR, __VA_ARGS__)
 #define evdev_log_bug_kernel(d_, ...) evdev_log_msg((d_), LIBINPUT_LOG_PRIORITY_ERROR, "kernel bug: " __VA_ARGS__)
@@ -870,4 +986,46 @@ evdev_device_check_abs_axis_range(struct evdev_device *device,
 	}
 }
 
+/**
+ * Return the timestamp to feed into the motion filters for the frame
+ * with the given kernel timestamp. Where the device sends
+ * MSC_TIMESTAMP, this is the frame time reconstructed from the hardware
+ * timestamps, otherwise it is the kernel timestamp unmodified.
+ *
+ * @param device The device the frame belongs to
+ * @param time The kernel timestamp of the frame in µs
+ *
+ * @return The timestamp in µs
+ */
+static inline uint64_t
+evdev_filter_time(const struct evdev_device *device, uint64_t time)
+{
+	if (device->msc_timestamp.frame_time == 0 ||
+	    device->msc_timestamp.frame_kernel_time != time)
+		return time;
+
+	return device->msc_timestamp.frame_time;
+}
+
+/* filter_dispatch() on the device's pointer filter, with the filter time
+ * and CPU accounting taken care of */
+static inline struct normalized_coords
+evdev_filter_dispatch(struct evdev_device *device,
+		      const struct device_float_coords *unaccelerated,
+		      void *data,
+		      uint64_t time)
+{
+	struct normalized_coords accel;
+	uint64_t start;
+
+	start = cpu_account_begin(evdev_libinput_context(device));
+	accel = filter_dispatch(device->pointer.filter,
+				unaccelerated,
+				data,
+				evdev_filter_time(device, time));
+	cpu_account_end(&device->base, LIBINPUT_CPU_STAT_POINTER_ACCEL, start);
+
+	return accel;
+}
+
 #endif /* EVDEV_H */
@@ -1309,3 +1309,159 @@ create_pointer_accelerator_filter_tablet(int xres, int yres)
 
 	return &filter->base;
 }
+
+/* Defaults for the adaptive touch smoothing filter. A stationary touch is
+ * filtered with a 1Hz cutoff, every mm/s of speed adds 0.3Hz, i.e. at
+ * 100mm/s the cutoff is at 31Hz and the filter lags by ~5ms. */
+#define DEFAULT_SMOOTHING_MIN_CUTOFF 1.0	/* Hz */
+#define DEFAULT_SMOOTHING_BETA 0.3		/* Hz/(mm/s) */
+#define DEFAULT_SMOOTHING_DCUTOFF 1.0		/* Hz */
+
+void
+smoothing_params_init(struct smoothing_params *params,
+		      double xres,
+		      double yres)
+{
+	params->min_cutoff = DEFAULT_SMOOTHING_MIN_CUTOFF;
+	params->beta = DEFAULT_SMOOTHING_BETA;
+	params->dcutoff = DEFAULT_SMOOTHING_DCUTOFF;
+	params->xres = xres > 0 ? xres : 1;
+	params->yres = yres > 0 ? yres : 1;
+}
+
+void
+smoothing_filter_reset(struct smoothing_filter *filter)
+{
+	filter->initialized = false;
+}
+
+/* Smoothing factor for an exponential low-pass filter with the given
+ * cutoff frequency (Hz) and sampling interval (s) */
+static inline double
+smoothing_alpha(double cutoff, double dt)
+{
+	double tau = 1.0/(2 * M_PI * cutoff);
+
+	return 1.0/(1.0 + tau/dt);
+}
+
+struct device_float_coords
+smoothing_filter_apply(struct smoothing_filter *filter,
+		       const struct smoothing_params *params,
+		       const struct device_float_coords *in,
+		       uint64_t time)
+{
+	struct device_float_coords speed;
+	double dt, alpha, cutoff, mmps;
+
+	if (!filter->initialized) {
+		filter->initialized = true;
+		filter->time = time;
+		filter->value = *in;
+		filter->speed.x = 0.0;
+		filter->speed.y = 0.0;
+		return *in;
+	}
+
+	/* Two positions with the same timestamp, nothing sensible we can
+	 * do here */
+	if (time <= filter->time)
+		return filter->value;
+
+	dt = (time - filter->time)/1000000.0; /* in s */
+	filter->time = time;
+
+	/* Low-pass the speed first so the cutoff doesn't follow the
+	 * jitter we're trying to remove */
+	speed.x = (in->x - filter->value.x)/dt;
+	speed.y = (in->y - filter->value.y)/dt;
+	alpha = smoothing_alpha(params->dcutoff, dt);
+	filter->speed.x += alpha * (speed.x - filter->speed.x);
+	filter->speed.y += alpha * (speed.y - filter->speed.y);
+
+	/* Use the same cutoff for both axes, otherwise the filtered
+	 * direction of motion would lag behind the real one */
+	mmps = hypot(filter->speed.x/params->xres,
+		     filter->speed.y/params->yres);
+	cutoff = params->min_cutoff + params->beta * mmps;
+	alpha = smoothing_alpha(cutoff, dt);
+	filter->value.x += alpha * (in->x - filter->value.x);
+	filter->value.y += alpha * (in->y - filter->value.y);
+
+	return filter->value;
+}
+
+/* Positions older than this are too stale to say anything about the
+ * current velocity */
+#define PREDICTION_MAX_AGE ms2us(50)
+
+void
+prediction_filter_reset(struct prediction_filter *filter)
+{
+	filter->index = 0;
+	filter->count = 0;
+}
+
+struct device_coords
+prediction_filter_apply(struct prediction_filter *filter,
+			const struct device_coords *point,
+			uint64_t time,
+			uint64_t ahead)
+{
+	struct device_coords predicted = *point;
+	double mean_t = 0.0, mean_x = 0.0, mean_y = 0.0;
+	double var_t = 0.0, cov_x = 0.0, cov_y = 0.0;
+	unsigned int i, n = 0;
+
+	filter->index = (filter->index + 1) % PREDICTION_HISTORY_LENGTH;
+	filter->samples[filter->index].time = time;
+	filter->samples[filter->index].point = *point;
+	if (filter->count < PREDICTION_HISTORY_LENGTH)
+		filter->count++;
+
+	if (ahead == 0)
+		return predicted;
+
+	/* times relative to the newest sample in ms, to keep the numbers
+	 * sane */
+	for (i = 0; i < filter->count; i++) {
+		unsigned int idx = (filter->index + PREDICTION_HISTORY_LENGTH - i) %
+				   PREDICTION_HISTORY_LENGTH;
+
+		if (time - filter->samples[idx].time > PREDICTION_MAX_AGE)
+			break;
+
+		mean_t -= (time - filter->samples[idx].time)/1000.0;
+		mean_x += filter->samples[idx].point.x;
+		mean_y += filter->samples[idx].point.y;
+		n++;
+	}
+
+	if (n < 2)
+		return predicted;
+
+	mean_t /= n;
+	mean_x /= n;
+	mean_y /= n;
+
+	for (i = 0; i < n; i++) {
+		unsigned int idx = (filter->index + PREDICTION_HISTORY_LENGTH - i) %
+				   PREDICTION_HISTORY_LENGTH;
+		double t = -((time - filter->samples[idx].time)/1000.0) - mean_t;
+
+		var_t += t * t;
+		cov_x += t * (filter->samples[idx].point.x - mean_x);
+		cov_y += t * (filter->samples[idx].point.y - mean_y);
+	}
+
+	/* all samples with the same timestamp */
+	if (var_t == 0.0)
+		return predicted;
+
+	/* Extrapolate from the fitted line rather than the last sample,
+	 * the fit is less noisy */
+	predicted.x = round(mean_x + cov_x/var_t * (ahead/1000.0 - mean_t));
+	predicted.y = round(mean_y + cov_y/var_t * (ahead/1000.0 - mean_t));
+
+	return predicted;
+}
@@ -98,6 +98,86 @@ filter_get_speed(struct motion_filter *filter);
 enum libinput_config_accel_profile
 filter_get_type(struct motion_filter *filter);
 
+/* Adaptive low-pass filter for absolute touch coordinates, based on the
+ * "1€ filter" by Casiez et al. The cutoff frequency rises with the speed
+ * of the touch: a slow or stationary touch is smoothed heavily to remove
+ * jitter, a fast touch is barely filtered to keep the lag low.
+ */
+struct smoothing_params {
+	double min_cutoff;	/* Hz, cutoff at zero speed */
+	double beta;		/* Hz per mm/s, cutoff increase with speed */
+	double dcutoff;		/* Hz, cutoff for the speed estimate */
+	double xres, yres;	/* units/mm */
+};
+
+struct smoothing_filter {
+	bool initialized;
+	uint64_t time;
+	struct device_float_coords value;	/* filtered position, units */
+	struct device_float_coords speed;	/* filtered speed, units/s */
+};
+
+void
+smoothing_params_init(struct smoothing_params *params,
+		      double xres,
+		      double yres);
+
+void
+smoothing_filter_reset(struct smoothing_filter *filter);
+
+/**
+ * Apply the adaptive low-pass filter to a new position. The first
+ * position after a reset is passed through unmodified.
+ *
+ * @param filter The per-touch filter state
+ * @param params The filter parameters
+ * @param in The unfiltered position in device units
+ * @param time The time of the position in µs
+ *
+ * @return The filtered position in device units
+ */
+struct device_float_coords
+smoothing_filter_apply(struct smoothing_filter *filter,
+		       const struct smoothing_params *params,
+		       const struct device_float_coords *in,
+		       uint64_t time);
+
+/* Linear extrapolation of absolute positions, used to predict where a
+ * touch or tablet tool will be a few ms in the future. The velocity is a
+ * least-squares fit over the most recent positions.
+ */
+#define PREDICTION_HISTORY_LENGTH 4
+
+struct prediction_filter {
+	unsigned int index;
+	unsigned int count;
+	struct {
+		uint64_t time;
+		struct device_coords point;
+	} samples[PREDICTION_HISTORY_LENGTH];
+};
+
+void
+prediction_filter_reset(struct prediction_filter *filter);
+
+/**
+ * Add a new position to the filter and return the position predicted the
+ * given time ahead. Where not enough history is available to predict
+ * anything, the position is returned unmodified.
+ *
+ * @param filter The per-touch filter state
+ * @param point The current position in device units
+ * @param time The time of the position in µs
+ * @param ahead How far ahead to predict in µs
+ *
+ * @return The predicted position in device units
+ */
+struct device_coords
+prediction_filter_apply(struct prediction_filter *filter,
+			const struct device_coords *point,
+			uint64_t time,
+			uint64_t ahead);
+
 typedef double (*accel_profile_func_t)(struct motion_filter *filter,
 				       void *data,
 				       double velocity,
@@ -29,6 +29,7 @@
 
 #include <errno.h>
 #include <math.h>
+#include <time.h>
 
 #include "linux/input.h"
 
@@ -101,6 +102,7 @@ struct wheel_tilt_flags {
 
 struct tablet_axes {
 	struct device_coords point;
+	struct device_coords predicted;
 	struct normalized_coords delta;
 	double distance;
 	double pressure;
@@ -111,6 +113,16 @@ struct tablet_axes {
 	int wheel_discrete;
 };
 
+/* One axis frame merged into a tablet axis event, see
+ * libinput_event_tablet_tool_get_history_size() */
+struct tablet_history_sample {
+	uint64_t time;
+	struct device_coords point;
+	double pressure;
+	struct tilt_degrees tilt;
+	double rotation;
+};
+
 struct libinput_interface_backend {
 	int (*resume)(struct libinput *libinput);
 	void (*suspend)(struct libinput *libinput);
@@ -120,7 +132,8 @@ struct libinput_interface_backend {
 };
 
 struct libinput {
-	int epoll_fd;
+	int epoll_fd; /* the loop's epoll fd if attached to a loop */
+	struct list source_list;
 	struct list source_destroy_list;
 
 	struct list seat_list;
@@ -129,6 +142,9 @@ struct libinput {
 		struct list list;
 		struct libinput_source *source;
 		int fd;
+		/* true while timer callbacks run, the events they post have
+		 * no kernel timestamp */
+		bool expiring;
 	} timer;
 
 	struct libinput_event **events;
@@ -148,6 +164,55 @@ struct libinput {
 	int refcount;
 
 	struct list device_group_list;
+
+	/* one LIBINPUT_EVENT_TOUCH_FRAME per scan instead of per-slot
+	 * events, see libinput_set_compact_touch_frames() */
+	bool compact_touch_frames;
+
+	/* NULL for CLOCK_MONOTONIC, see libinput_clock_attach() */
+	struct libinput_clock *clock;
+	struct list clock_link;
+
+	/* see libinput_set_cpu_accounting() */
+	bool cpu_accounting;
+
+	/* see libinput_set_latency_accounting() */
+	bool latency_accounting;
+
+	/* see libinput_log_set_trace_buffer() */
+	struct {
+		struct libinput_trace_entry *entries; /* NULL if disabled */
+		unsigned int mask; /* the size - 1, the size is a power of 2 */
+		uint64_t head; /* number of entries ever recorded */
+	} trace;
+
+	/* NULL unless attached, see libinput_loop_attach() */
+	struct libinput_loop *loop;
+	struct list loop_link;
+};
+
+/* A virtual clock, shared by all contexts attached to it */
+struct libinput_clock {
+	uint64_t now; /* in µs */
+	struct list contexts;
+};
+
+/* An epoll set and timerfd shared by all contexts attached to it. The
+ * contexts' timers stay on their own lists and are also kept in one
+ * min-heap ordered by expiry, the timerfd is armed for the heap's top. */
+struct libinput_loop {
+	int refcount;
+	int epoll_fd;
+	struct {
+		int fd;
+		struct libinput_source *source;
+		struct libinput_timer **heap;
+		size_t nheap;
+		size_t heap_size;
+		uint64_t armed; /* UINT64_MAX if disarmed */
+		bool expiring; /* in libinput_loop_timer_handler() */
+	} timer;
+	struct list contexts;
 };
 
 typedef void (*libinput_seat_destroy_func) (struct libinput_seat *seat);
@@ -163,7 +228,13 @@ struct libinput_seat {
 	char *physical_name;
 	char *logical_name;
 
-	uint32_t slot_map;
+	/* seat slots in use, one bit per slot. The summary has one bit
+	 * per word of slots, set when that word has no free slot left. */
+	struct {
+		unsigned long *slots;
+		unsigned long *full;
+		size_t nwords;
+	} slot_map;
 
 	uint32_t button_count[KEY_CNT];
 };
@@ -189,6 +260,11 @@ struct libinput_device_config_tap {
 							    enum libinput_config_drag_lock_state);
 	enum libinput_config_drag_lock_state (*get_draglock_enabled)(struct libinput_device *device);
 	enum libinput_config_drag_lock_state (*get_default_draglock_enabled)(struct libinput_device *device);
+
+	enum libinput_config_status (*set_speculative_enabled)(struct libinput_device *device,
+							       enum libinput_config_tap_speculative_state);
+	enum libinput_config_tap_speculative_state (*get_speculative_enabled)(struct libinput_device *device);
+	enum libinput_config_tap_speculative_state (*get_default_speculative_enabled)(struct libinput_device *device);
 };
 
 struct libinput_device_config_calibration {
@@ -280,6 +356,42 @@ struct libinput_device_config_dwt {
 			 struct libinput_device *device);
 };
 
+struct libinput_device_config_smoothing {
+	int (*is_available)(struct libinput_device *device);
+	enum libinput_config_status (*set_enabled)(
+			 struct libinput_device *device,
+			 enum libinput_config_smoothing_state enable);
+	enum libinput_config_smoothing_state (*get_enabled)(
+			 struct libinput_device *device);
+	enum libinput_config_smoothing_state (*get_default_enabled)(
+			 struct libinput_device *device);
+};
+
+/* Maximum prediction time in ms, see libinput_device_config_prediction_set_time() */
+#define PREDICTION_MAX_TIME_MS 100
+
+struct libinput_device_config_prediction {
+	int (*is_available)(struct libinput_device *device);
+	enum libinput_config_status (*set_time)(
+			 struct libinput_device *device,
+			 unsigned int ms);
+	unsigned int (*get_time)(struct libinput_device *device);
+	unsigned int (*get_default_time)(struct libinput_device *device);
+};
+
+/* Maximum merge window in ms, see
+ * libinput_device_config_tablet_history_set_window() */
+#define TABLET_HISTORY_MAX_WINDOW_MS 100
+
+struct libinput_device_config_tablet_history {
+	int (*is_available)(struct libinput_device *device);
+	enum libinput_config_status (*set_window)(
+			 struct libinput_device *device,
+			 unsigned int ms);
+	unsigned int (*get_window)(struct libinput_device *device);
+	unsigned int (*get_default_window)(struct libinput_device *device);
+};
+
 struct libinput_device_config_rotation {
 	int (*is_available)(struct libinput_device *device);
 	enum libinput_config_status (*set_angle)(
@@ -301,6 +413,9 @@ struct libinput_device_config {
 	struct libinput_device_config_middle_emulation *middle_emulation;
 	struct libinput_device_config_dwt *dwt;
 	struct libinput_device_config_rotation *rotation;
+	struct libinput_device_config_smoothing *smoothing;
+	struct libinput_device_config_prediction *prediction;
+	struct libinput_device_config_tablet_history *tablet_history;
 };
 
 struct libinput_device_group {
@@ -311,6 +426,15 @@ struct libinput_device_group {
 	struct list link;
 };
 
+struct touch_frame_slot {
+	int32_t slot;
+	int32_t seat_slot;
+	enum libinput_touch_state state;
+	bool lifted; /* set down and lifted in the same frame */
+	struct device_coords point;
+	struct device_coords predicted;
+};
+
 struct libinput_device {
 	struct libinput_seat *seat;
 	struct libinput_device_group *group;
@@ -319,6 +443,22 @@ struct libinput_device {
 	void *user_data;
 	int refcount;
 	struct libinput_device_config config;
+
+	/* the touches down on the device, the content of the next
+	 * compact touch frame. Only tracked while compact touch frames are
+	 * enabled, rebuilt through evdev_device_sync_touches() when they
+	 * are switched on */
+	struct {
+		struct touch_frame_slot *slots;
+		unsigned int nslots;
+		unsigned int size;
+	} touch_frame;
+
+	/* indexed by enum libinput_latency_stage - 1 */
+	struct libinput_latency_stats latency[2];
+
+	/* indexed by enum libinput_cpu_stat - 1 */
+	struct libinput_cpu_stats cpu[LIBINPUT_CPU_STAT_TIMERS];
 };
 
 enum libinput_tablet_tool_axis {
@@ -373,6 +513,7 @@ struct libinput_tablet_pad_mode_group {
 struct libinput_event {
 	enum libinput_event_type type;
 	struct libinput_device *device;
+	uint64_t queue_time; /* in µs, 0 if the event has no timestamp */
 };
 
 struct libinput_event_listener {
@@ -383,6 +524,16 @@ struct libinput_event_listener {
 
 typedef void (*libinput_source_dispatch_t)(void *data);
 
+#define LOG_TRACE_MAX_ARGS 4
+
+/* One message in the trace buffer, formatted only when dumped */
+struct libinput_trace_entry {
+	uint64_t time;
+	const char *format;
+	char tag[16];
+	uint64_t args[LOG_TRACE_MAX_ARGS];
+};
+
 #define log_debug(li_, ...) log_msg((li_), LIBINPUT_LOG_PRIORITY_DEBUG, __VA_ARGS__)
 #define log_info(li_, ...) log_msg((li_), LIBINPUT_LOG_PRIORITY_INFO, __VA_ARGS__)
 #define log_error(li_, ...) log_msg((li_), LIBINPUT_LOG_PRIORITY_ERROR, __VA_ARGS__)
@@ -417,6 +568,32 @@ log_msg_va(struct libinput *libinput,
 	   va_list args)
 	LIBINPUT_ATTRIBUTE_PRINTF(3, 0);
 
+/* Records a message in the trace buffer, if enabled. Nothing is formatted
+ * until the buffer is dumped, so the format must be a string literal and
+ * string arguments must be static. Only the %d, %i, %u, %x, %X, %c, %s
+ * and %p conversions (without length modifiers) are supported, with at
+ * most LOG_TRACE_MAX_ARGS arguments. The tag is copied, it usually is the
+ * device's sysname.
+ */
+#define log_trace(li_, tag_, ...) \
+	do { \
+		if ((li_)->trace.entries) \
+			log_trace_record((li_), (tag_), \
+					 log_trace_args_(__VA_ARGS__, 0, 0, 0, 0, 0)); \
+	} while (0)
+
+#define log_trace_arg_(a_) ((uint64_t)(uintptr_t)(a_))
+#define log_trace_args_(fmt_, a_, b_, c_, d_, ...) \
+	(fmt_), \
+	log_trace_arg_(a_), log_trace_arg_(b_), \
+	log_trace_arg_(c_), log_trace_arg_(d_)
+
+void
+log_trace_record(struct libinput *libinput,
+		 const char *tag,
+		 const char *format,
+		 uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3);
+
 int
 libinput_init(struct libinput *libinput,
 	      const struct libinput_interface *interface,
@@ -450,6 +627,12 @@ libinput_seat_init(struct libinput_seat *seat,
 		   const char *logical_name,
 		   libinput_seat_destroy_func destroy);
 
+int
+libinput_seat_slot_acquire(struct libinput_seat *seat);
+
+void
+libinput_seat_slot_release(struct libinput_seat *seat, int seat_slot);
+
 void
 libinput_device_init(struct libinput_device *device,
 		     struct libinput_seat *seat);
@@ -499,6 +682,17 @@ pointer_notify_motion(struct libinput_device *device,
 		      const struct normalized_coords *delta,
 		      const struct device_float_coords *raw);
 
+/* Like pointer_notify_motion() but the unaccelerated delta is only
+ * converted to device units (unaccel / coeff) if the caller asks for it.
+ * Only the touchpad needs this, the fallback dispatch already has the
+ * raw delta from the kernel and tablets do not post pointer motion */
+void
+pointer_notify_motion_normalized(struct libinput_device *device,
+				 uint64_t time,
+				 const struct normalized_coords *delta,
+				 const struct normalized_coords *unaccel,
+				 double coeff);
+
 void
 pointer_notify_motion_absolute(struct libinput_device *device,
 			       uint64_t time,
@@ -523,14 +717,16 @@ touch_notify_touch_down(struct libinput_device *device,
 			uint64_t time,
 			int32_t slot,
 			int32_t seat_slot,
-			const struct device_coords *point);
+			const struct device_coords *point,
+			const struct device_coords *predicted);
 
 void
 touch_notify_touch_motion(struct libinput_device *device,
 			  uint64_t time,
 			  int32_t slot,
 			  int32_t seat_slot,
-			  const struct device_coords *point);
+			  const struct device_coords *point,
+			  const struct device_coords *predicted);
 
 void
 touch_notify_touch_up(struct libinput_device *device,
@@ -538,6 +734,12 @@ touch_notify_touch_up(struct libinput_device *device,
 		      int32_t slot,
 		      int32_t seat_slot);
 
+void
+touch_notify_touch_active(struct libinput_device *device,
+			  int32_t slot,
+			  int32_t seat_slot,
+			  const struct device_coords *point);
+
 void
 touch_notify_frame(struct libinput_device *device,
 		   uint64_t time);
@@ -579,7 +781,9 @@ tablet_notify_axis(struct libinput_device *device,
 		   struct libinput_tablet_tool *tool,
 		   enum libinput_tablet_tool_tip_state tip_state,
 		   unsigned char *changed_axes,
-		   const struct tablet_axes *axes);
+		   const struct tablet_axes *axes,
+		   const struct tablet_history_sample *history,
+		   unsigned int nhistory);
 
 void
 tablet_notify_proximity(struct libinput_device *device,
@@ -637,6 +841,9 @@ libinput_now(struct libinput *libinput)
 {
 	struct timespec ts = { 0, 0 };
 
+	if (libinput->clock)
+		return libinput->clock->now;
+
 	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
 		log_error(libinput, "clock_gettime failed: %s\n", strerror(errno));
 		return 0;
@@ -645,6 +852,40 @@ libinput_now(struct libinput *libinput)
 	return s2us(ts.tv_sec) + ns2us(ts.tv_nsec);
 }
 
+/* Returns the start of a CPU accounting section, or 0 if CPU accounting
+ * is disabled. This uses the real clock, not the context's clock */
+static inline uint64_t
+cpu_account_begin(struct libinput *libinput)
+{
+	struct timespec ts;
+
+	if (!libinput->cpu_accounting)
+		return 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return s2us(ts.tv_sec) * 1000 + ts.tv_nsec;
+}
+
+static inline void
+cpu_account_end(struct libinput_device *device,
+		enum libinput_cpu_stat stat,
+		uint64_t start)
+{
+	struct libinput_cpu_stats *stats;
+	struct timespec ts;
+	uint64_t now;
+
+	if (start == 0)
+		return;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	now = s2us(ts.tv_sec) * 1000 + ts.tv_nsec;
+
+	stats = &device->cpu[stat - 1];
+	stats->calls++;
+	stats->nsec += now - start;
+}
+
 static inline struct device_float_coords
 device_delta(struct device_coords a, struct device_coords b)
 {
@@ -0,0 +1,543 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libinput.h"
+#include "libinput-private.h"
+
+/* See @ref event_serialization for the format. All integers and doubles
+ * are little-endian, doubles are IEEE 754 binary64. */
+#define SERIALIZE_VERSION 1
+#define HEADER_SIZE 16
+
+#define KEYBOARD_KEY_SIZE 9
+#define POINTER_MOTION_SIZE 32
+#define POINTER_MOTION_ABSOLUTE_SIZE 32
+#define POINTER_BUTTON_SIZE 9
+#define POINTER_AXIS_SIZE 34
+#define TOUCH_POSITION_SIZE 40
+#define TOUCH_SLOT_SIZE 8
+#define TOUCH_FRAME_SIZE 0
+#define TABLET_TOOL_SIZE 132
+
+static inline uint8_t *
+put_u8(uint8_t *p, uint8_t v)
+{
+	*p = v;
+	return p + 1;
+}
+
+static inline uint8_t *
+put_u16(uint8_t *p, uint16_t v)
+{
+	p[0] = v & 0xff;
+	p[1] = v >> 8;
+	return p + 2;
+}
+
+static inline uint8_t *
+put_u32(uint8_t *p, uint32_t v)
+{
+	p[0] = v & 0xff;
+	p[1] = (v >> 8) & 0xff;
+	p[2] = (v >> 16) & 0xff;
+	p[3] = v >> 24;
+	return p + 4;
+}
+
+static inline uint8_t *
+put_u64(uint8_t *p, uint64_t v)
+{
+	p = put_u32(p, v & 0xffffffff);
+	return put_u32(p, v >> 32);
+}
+
+static inline uint8_t *
+put_double(uint8_t *p, double v)
+{
+	uint64_t bits;
+
+	memcpy(&bits, &v, sizeof(bits));
+	return put_u64(p, bits);
+}
+
+static inline const uint8_t *
+get_u8(const uint8_t *p, uint8_t *v)
+{
+	*v = *p;
+	return p + 1;
+}
+
+static inline const uint8_t *
+get_u16(const uint8_t *p, uint16_t *v)
+{
+	*v = p[0] | (uint16_t)p[1] << 8;
+	return p + 2;
+}
+
+static inline const uint8_t *
+get_u32(const uint8_t *p, uint32_t *v)
+{
+	*v = p[0] |
+	     (uint32_t)p[1] << 8 |
+	     (uint32_t)p[2] << 16 |
+	     (uint32_t)p[3] << 24;
+	return p + 4;
+}
+
+static inline const uint8_t *
+get_u64(const uint8_t *p, uint64_t *v)
+{
+	uint32_t lo, hi;
+
+	p = get_u32(p, &lo);
+	p = get_u32(p, &hi);
+	*v = (uint64_t)hi << 32 | lo;
+	return p;
+}
+
+static inline const uint8_t *
+get_double(const uint8_t *p, double *v)
+{
+	uint64_t bits;
+
+	p = get_u64(p, &bits);
+	memcpy(v, &bits, sizeof(*v));
+	return p;
+}
+
+static inline const uint8_t *
+get_i32(const uint8_t *p, int32_t *v)
+{
+	uint32_t u;
+
+	p = get_u32(p, &u);
+	*v = (int32_t)u;
+	return p;
+}
+
+static size_t
+payload_size(enum libinput_event_type type)
+{
+	switch (type) {
+	case LIBINPUT_EVENT_KEYBOARD_KEY:
+		return KEYBOARD_KEY_SIZE;
+	case LIBINPUT_EVENT_POINTER_MOTION:
+		return POINTER_MOTION_SIZE;
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+		return POINTER_MOTION_ABSOLUTE_SIZE;
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+		return POINTER_BUTTON_SIZE;
+	case LIBINPUT_EVENT_POINTER_AXIS:
+		return POINTER_AXIS_SIZE;
+	case LIBINPUT_EVENT_TOUCH_DOWN:
+	case LIBINPUT_EVENT_TOUCH_MOTION:
+		return TOUCH_POSITION_SIZE;
+	case LIBINPUT_EVENT_TOUCH_UP:
+	case LIBINPUT_EVENT_TOUCH_CANCEL:
+		return TOUCH_SLOT_SIZE;
+	case LIBINPUT_EVENT_TOUCH_FRAME:
+		return TOUCH_FRAME_SIZE;
+	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
+	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
+	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
+	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
+		return TABLET_TOOL_SIZE;
+	default:
+		return 0;
+	}
+}
+
+static uint64_t
+serialize_keyboard(uint8_t *p, struct libinput_event *event)
+{
+	struct libinput_event_keyboard_data d;
+
+	libinput_event_keyboard_get_data(libinput_event_get_keyboard_event(event),
+					 &d, sizeof(d));
+	p = put_u32(p, d.key);
+	p = put_u32(p, d.seat_key_count);
+	put_u8(p, d.state);
+
+	return d.time_usec;
+}
+
+static uint64_t
+serialize_pointer(uint8_t *p, struct libinput_event *event)
+{
+	struct libinput_event_pointer_data d;
+
+	libinput_event_pointer_get_data(libinput_event_get_pointer_event(event),
+					&d, sizeof(d));
+
+	switch (libinput_event_get_type(event)) {
+	case LIBINPUT_EVENT_POINTER_MOTION:
+		p = put_double(p, d.dx);
+		p = put_double(p, d.dy);
+		p = put_double(p, d.dx_unaccelerated);
+		p = put_double(p, d.dy_unaccelerated);
+		break;
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+		p = put_double(p, d.absolute_x);
+		p = put_double(p, d.absolute_y);
+		p = put_double(p, d.absolute_x_fraction);
+		p = put_double(p, d.absolute_y_fraction);
+		break;
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+		p = put_u32(p, d.button);
+		p = put_u32(p, d.seat_button_count);
+		p = put_u8(p, d.button_state);
+		break;
+	case LIBINPUT_EVENT_POINTER_AXIS:
+		p = put_u8(p, d.axis_source);
+		p = put_u8(p, d.axes);
+		p = put_double(p, d.axis_value_vertical);
+		p = put_double(p, d.axis_value_horizontal);
+		p = put_double(p, d.axis_value_discrete_vertical);
+		p = put_double(p, d.axis_value_discrete_horizontal);
+		break;
+	default:
+		abort();
+	}
+
+	return d.time_usec;
+}
+
+static uint64_t
+serialize_touch(uint8_t *p, struct libinput_event *event)
+{
+	struct libinput_event_touch_data d;
+	enum libinput_event_type type = libinput_event_get_type(event);
+
+	libinput_event_touch_get_data(libinput_event_get_touch_event(event),
+				      &d, sizeof(d));
+
+	if (type == LIBINPUT_EVENT_TOUCH_FRAME)
+		return d.time_usec;
+
+	p = put_u32(p, d.slot);
+	p = put_u32(p, d.seat_slot);
+
+	if (type == LIBINPUT_EVENT_TOUCH_DOWN ||
+	    type == LIBINPUT_EVENT_TOUCH_MOTION) {
+		p = put_double(p, d.x);
+		p = put_double(p, d.y);
+		p = put_double(p, d.x_fraction);
+		put_double(p, d.y_fraction);
+	}
+
+	return d.time_usec;
+}
+
+static uint64_t
+serialize_tablet_tool(uint8_t *p, struct libinput_event *event)
+{
+	struct libinput_event_tablet_tool_data d;
+
+	libinput_event_tablet_tool_get_data(libinput_event_get_tablet_tool_event(event),
+					    &d, sizeof(d));
+	p = put_u8(p, d.proximity_state);
+	p = put_u8(p, d.tip_state);
+	p = put_u8(p, d.button_state);
+	p = put_u8(p, d.tool_type);
+	p = put_u32(p, d.changed);
+	p = put_u64(p, d.tool_serial);
+	p = put_u32(p, d.button);
+	p = put_u32(p, d.seat_button_count);
+	p = put_double(p, d.x);
+	p = put_double(p, d.y);
+	p = put_double(p, d.x_fraction);
+	p = put_double(p, d.y_fraction);
+	p = put_double(p, d.dx);
+	p = put_double(p, d.dy);
+	p = put_double(p, d.pressure);
+	p = put_double(p, d.distance);
+	p = put_double(p, d.tilt_x);
+	p = put_double(p, d.tilt_y);
+	p = put_double(p, d.rotation);
+	p = put_double(p, d.slider);
+	p = put_double(p, d.wheel_delta);
+	put_u32(p, d.wheel_delta_discrete);
+
+	return d.time_usec;
+}
+
+LIBINPUT_EXPORT size_t
+libinput_event_serialize(struct libinput_event *event,
+			 void *buffer,
+			 size_t size)
+{
+	enum libinput_event_type type = libinput_event_get_type(event);
+	size_t len = payload_size(type);
+	uint8_t *p = buffer;
+	uint64_t time;
+
+	if (len == 0 && type != LIBINPUT_EVENT_TOUCH_FRAME) {
+		log_bug_client(libinput_event_get_context(event),
+			       "Event type %d cannot be serialized\n",
+			       type);
+		return 0;
+	}
+
+	if (size < HEADER_SIZE + len)
+		return HEADER_SIZE + len;
+
+	/* payload first, it gives us the time for the header */
+	switch (type) {
+	case LIBINPUT_EVENT_KEYBOARD_KEY:
+		time = serialize_keyboard(p + HEADER_SIZE, event);
+		break;
+	case LIBINPUT_EVENT_POINTER_MOTION:
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+	case LIBINPUT_EVENT_POINTER_AXIS:
+		time = serialize_pointer(p + HEADER_SIZE, event);
+		break;
+	case LIBINPUT_EVENT_TOUCH_DOWN:
+	case LIBINPUT_EVENT_TOUCH_MOTION:
+	case LIBINPUT_EVENT_TOUCH_UP:
+	case LIBINPUT_EVENT_TOUCH_CANCEL:
+	case LIBINPUT_EVENT_TOUCH_FRAME:
+		time = serialize_touch(p + HEADER_SIZE, event);
+		break;
+	default:
+		time = serialize_tablet_tool(p + HEADER_SIZE, event);
+		break;
+	}
+
+	p = put_u8(p, SERIALIZE_VERSION);
+	p = put_u8(p, 0); /* flags */
+	p = put_u16(p, type);
+	p = put_u16(p, len);
+	p = put_u16(p, 0); /* reserved */
+	put_u64(p, time);
+
+	return HEADER_SIZE + len;
+}
+
+static void
+parse_keyboard(const uint8_t *p,
+	       uint64_t time,
+	       union libinput_event_data *data,
+	       size_t size)
+{
+	struct libinput_event_keyboard_data d = {0};
+	uint8_t state;
+
+	d.time_usec = time;
+	p = get_u32(p, &d.key);
+	p = get_u32(p, &d.seat_key_count);
+	get_u8(p, &state);
+	d.state = state;
+
+	memcpy(data, &d, min(size, sizeof(d)));
+}
+
+static void
+parse_pointer(const uint8_t *p,
+	      enum libinput_event_type type,
+	      uint64_t time,
+	      union libinput_event_data *data,
+	      size_t size)
+{
+	struct libinput_event_pointer_data d = {0};
+	uint8_t u8;
+
+	d.time_usec = time;
+
+	switch (type) {
+	case LIBINPUT_EVENT_POINTER_MOTION:
+		p = get_double(p, &d.dx);
+		p = get_double(p, &d.dy);
+		p = get_double(p, &d.dx_unaccelerated);
+		get_double(p, &d.dy_unaccelerated);
+		break;
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+		p = get_double(p, &d.absolute_x);
+		p = get_double(p, &d.absolute_y);
+		p = get_double(p, &d.absolute_x_fraction);
+		get_double(p, &d.absolute_y_fraction);
+		break;
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+		p = get_u32(p, &d.button);
+		p = get_u32(p, &d.seat_button_count);
+		get_u8(p, &u8);
+		d.button_state = u8;
+		break;
+	case LIBINPUT_EVENT_POINTER_AXIS:
+		p = get_u8(p, &u8);
+		d.axis_source = u8;
+		p = get_u8(p, &u8);
+		d.axes = u8;
+		p = get_double(p, &d.axis_value_vertical);
+		p = get_double(p, &d.axis_value_horizontal);
+		p = get_double(p, &d.axis_value_discrete_vertical);
+		get_double(p, &d.axis_value_discrete_horizontal);
+		break;
+	default:
+		abort();
+	}
+
+	memcpy(data, &d, min(size, sizeof(d)));
+}
+
+static void
+parse_touch(const uint8_t *p,
+	    enum libinput_event_type type,
+	    uint64_t time,
+	    union libinput_event_data *data,
+	    size_t size)
+{
+	struct libinput_event_touch_data d = {0};
+
+	d.time_usec = time;
+
+	if (type != LIBINPUT_EVENT_TOUCH_FRAME) {
+		p = get_i32(p, &d.slot);
+		p = get_i32(p, &d.seat_slot);
+	}
+
+	if (type == LIBINPUT_EVENT_TOUCH_DOWN ||
+	    type == LIBINPUT_EVENT_TOUCH_MOTION) {
+		p = get_double(p, &d.x);
+		p = get_double(p, &d.y);
+		p = get_double(p, &d.x_fraction);
+		get_double(p, &d.y_fraction);
+		/* the prediction is local to the sender */
+		d.predicted_x = d.x;
+		d.predicted_y = d.y;
+		d.predicted_x_fraction = d.x_fraction;
+		d.predicted_y_fraction = d.y_fraction;
+	}
+
+	memcpy(data, &d, min(size, sizeof(d)));
+}
+
+static void
+parse_tablet_tool(const uint8_t *p,
+		  uint64_t time,
+		  union libinput_event_data *data,
+		  size_t size)
+{
+	struct libinput_event_tablet_tool_data d = {0};
+	uint8_t u8;
+	int32_t discrete;
+
+	d.time_usec = time;
+	d.tool = NULL;
+	p = get_u8(p, &u8);
+	d.proximity_state = u8;
+	p = get_u8(p, &u8);
+	d.tip_state = u8;
+	p = get_u8(p, &u8);
+	d.button_state = u8;
+	p = get_u8(p, &u8);
+	d.tool_type = u8;
+	p = get_u32(p, &d.changed);
+	p = get_u64(p, &d.tool_serial);
+	p = get_u32(p, &d.button);
+	p = get_u32(p, &d.seat_button_count);
+	p = get_double(p, &d.x);
+	p = get_double(p, &d.y);
+	p = get_double(p, &d.x_fraction);
+	p = get_double(p, &d.y_fraction);
+	p = get_double(p, &d.dx);
+	p = get_double(p, &d.dy);
+	p = get_double(p, &d.pressure);
+	p = get_double(p, &d.distance);
+	p = get_double(p, &d.tilt_x);
+	p = get_double(p, &d.tilt_y);
+	p = get_double(p, &d.rotation);
+	p = get_double(p, &d.slider);
+	p = get_double(p, &d.wheel_delta);
+	get_i32(p, &discrete);
+	d.wheel_delta_discrete = discrete;
+
+	memcpy(data, &d, min(size, sizeof(d)));
+}
+
+LIBINPUT_EXPORT size_t
+libinput_event_parse(const void *buffer,
+		     size_t size,
+		     enum libinput_event_type *type,
+		     union libinput_event_data *data,
+		     size_t data_size)
+{
+	const uint8_t *p = buffer;
+	uint8_t version;
+	uint16_t event_type, len;
+	uint64_t time;
+
+	if (size < HEADER_SIZE)
+		return 0;
+
+	p = get_u8(p, &version);
+	p += 1; /* flags, none defined yet */
+	p = get_u16(p, &event_type);
+	p = get_u16(p, &len);
+	p += 2; /* reserved */
+	p = get_u64(p, &time);
+
+	/* Newer encoders only ever append to the payload, a shorter
+	 * payload than ours is invalid, a longer one is fine */
+	if (version != SERIALIZE_VERSION ||
+	    size < HEADER_SIZE + (size_t)len ||
+	    len < payload_size(event_type))
+		return 0;
+
+	switch (event_type) {
+	case LIBINPUT_EVENT_KEYBOARD_KEY:
+		parse_keyboard(p, time, data, data_size);
+		break;
+	case LIBINPUT_EVENT_POINTER_MOTION:
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+	case LIBINPUT_EVENT_POINTER_AXIS:
+		parse_pointer(p, event_type, time, data, data_size);
+		break;
+	case LIBINPUT_EVENT_TOUCH_DOWN:
+	case LIBINPUT_EVENT_TOUCH_MOTION:
+	case LIBINPUT_EVENT_TOUCH_UP:
+	case LIBINPUT_EVENT_TOUCH_CANCEL:
+	case LIBINPUT_EVENT_TOUCH_FRAME:
+		parse_touch(p, event_type, time, data, data_size);
+		break;
+	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
+	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
+	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
+	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
+		parse_tablet_tool(p, time, data, data_size);
+		break;
+	default:
+		return 0;
+	}
+
+	*type = event_type;
+
+	return HEADER_SIZE + len;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef LIBINPUT_TRACE_H
+#define LIBINPUT_TRACE_H
+
+#include "config.h"
+
+/* Static tracepoints for perf, bpftrace, systemtap, etc. All probes use
+ * the "libinput" provider, a double underscore in the name becomes a dash,
+ * e.g. trace_probe1(dispatch__entry, ...) is libinput:dispatch-entry.
+ *
+ * An untraced probe is a single nop but its arguments are still evaluated,
+ * so only pass values that are already at hand: the device pointer rather
+ * than its sysname, the device-added probe maps one to the other.
+ * Without <sys/sdt.h> the probes compile to nothing.
+ * See the tracing documentation for the list of probes.
+ */
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+
+#define trace_probe1(name_, a1_) \
+	DTRACE_PROBE1(libinput, name_, a1_)
+#define trace_probe2(name_, a1_, a2_) \
+	DTRACE_PROBE2(libinput, name_, a1_, a2_)
+#define trace_probe3(name_, a1_, a2_, a3_) \
+	DTRACE_PROBE3(libinput, name_, a1_, a2_, a3_)
+#define trace_probe4(name_, a1_, a2_, a3_, a4_) \
+	DTRACE_PROBE4(libinput, name_, a1_, a2_, a3_, a4_)
+#else
+/* sizeof so the arguments count as used but are never evaluated */
+#define trace_probe1(name_, a1_) \
+	do { (void)sizeof(a1_); } while (0)
+#define trace_probe2(name_, a1_, a2_) \
+	do { (void)sizeof(a1_); (void)sizeof(a2_); } while (0)
+#define trace_probe3(name_, a1_, a2_, a3_) \
+	do { (void)sizeof(a1_); (void)sizeof(a2_); \
+	     (void)sizeof(a3_); } while (0)
+#define trace_probe4(name_, a1_, a2_, a3_, a4_) \
+	do { (void)sizeof(a1_); (void)sizeof(a2_); \
+	     (void)sizeof(a3_); (void)sizeof(a4_); } while (0)
+#endif
+
+#endif
@@ -25,6 +25,7 @@
 #include "config.h"
 
 #include <errno.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -36,6 +37,7 @@
 #include "libinput-private.h"
 #include "evdev.h"
 #include "timer.h"
+#include "libinput-trace.h"
 
 #define require_event_type(li_, type_, retval_, ...)	\
 	if (type_ == LIBINPUT_EVENT_NONE) abort(); \
@@ -92,12 +94,23 @@ struct libinput_event_keyboard {
 	enum libinput_key_state state;
 };
 
+/* Transformed coordinates are computed on first access, callers usually
+ * ask for the same width and height every time */
+struct transform_cache {
+	uint32_t width, height;
+	double x, y;
+};
+
 struct libinput_event_pointer {
 	struct libinput_event base;
 	uint64_t time;
 	struct normalized_coords delta;
 	struct device_float_coords delta_raw;
+	/* if set, delta_raw is computed from delta_unaccel on first access */
+	struct normalized_coords delta_unaccel;
+	double unaccel_coeff;
 	struct device_coords absolute;
+	struct transform_cache transformed;
 	struct discrete_coords discrete;
 	uint32_t button;
 	uint32_t seat_button_count;
@@ -112,6 +125,12 @@ struct libinput_event_touch {
 	int32_t slot;
 	int32_t seat_slot;
 	struct device_coords point;
+	struct device_coords predicted;
+	struct transform_cache transformed;
+
+	/* compact touch frames only */
+	unsigned int nframe_slots;
+	struct touch_frame_slot frame_slots[];
 };
 
 struct libinput_event_gesture {
@@ -136,6 +155,10 @@ struct libinput_event_tablet_tool {
 	struct libinput_tablet_tool *tool;
 	enum libinput_tablet_tool_proximity_state proximity_state;
 	enum libinput_tablet_tool_tip_state tip_state;
+	struct transform_cache transformed;
+	/* axis events only, the frames merged into this event */
+	unsigned int nhistory;
+	struct tablet_history_sample history[];
 };
 
 struct libinput_event_tablet_pad {
@@ -233,6 +256,240 @@ log_msg_ratelimit(struct libinput *libinput,
 			us2ms(ratelimit->interval));
 }
 
+void
+log_trace_record(struct libinput *libinput,
+		 const char *tag,
+		 const char *format,
+		 uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3)
+{
+	struct libinput_trace_entry *entry;
+
+	entry = &libinput->trace.entries[libinput->trace.head &
+					 libinput->trace.mask];
+	libinput->trace.head++;
+
+	entry->time = libinput_now(libinput);
+	entry->format = format;
+	strncpy(entry->tag, tag, sizeof(entry->tag) - 1);
+	entry->tag[sizeof(entry->tag) - 1] = '\0';
+	entry->args[0] = a0;
+	entry->args[1] = a1;
+	entry->args[2] = a2;
+	entry->args[3] = a3;
+}
+
+/* Formats one conversion of a trace entry, the spec is the conversion
+ * including the % and returns the number of characters written */
+static int
+log_trace_format_arg(char *buf, size_t len, const char *spec, uint64_t arg)
+{
+	const char *str;
+
+	switch (spec[strlen(spec) - 1]) {
+	case 'd':
+	case 'i':
+	case 'c':
+		return snprintf(buf, len, spec, (int)(int64_t)arg);
+	case 'u':
+	case 'x':
+	case 'X':
+		return snprintf(buf, len, spec, (unsigned int)arg);
+	case 's':
+		str = (const char *)(uintptr_t)arg;
+		return snprintf(buf, len, spec, str ? str : "(null)");
+	case 'p':
+		return snprintf(buf, len, spec, (void *)(uintptr_t)arg);
+	default:
+		return snprintf(buf, len, "<invalid conversion %s>", spec);
+	}
+}
+
+static void
+log_trace_format(const struct libinput_trace_entry *entry,
+		 char *buf,
+		 size_t len)
+{
+	const char *f = entry->format;
+	unsigned int narg = 0;
+	size_t pos = 0;
+	char spec[16];
+	size_t speclen;
+	int n;
+
+	while (*f && pos < len - 1) {
+		if (*f != '%') {
+			buf[pos++] = *f++;
+			continue;
+		}
+
+		if (f[1] == '%') {
+			buf[pos++] = '%';
+			f += 2;
+			continue;
+		}
+
+		/* flags, width and precision, then the conversion */
+		speclen = 1 + strspn(f + 1, "-+ #0123456789.");
+		if (f[speclen] == '\0' || speclen + 2 > sizeof(spec))
+			break;
+		speclen++;
+		memcpy(spec, f, speclen);
+		spec[speclen] = '\0';
+		f += speclen;
+
+		if (narg >= LOG_TRACE_MAX_ARGS)
+			break;
+
+		n = log_trace_format_arg(buf + pos,
+					 len - pos,
+					 spec,
+					 entry->args[narg++]);
+		if (n < 0)
+			break;
+		pos = min(pos + n, len - 1);
+	}
+
+	buf[pos] = '\0';
+}
+
+LIBINPUT_ATTRIBUTE_PRINTF(3, 4)
+static void
+log_trace_print(struct libinput *libinput,
+		enum libinput_log_priority priority,
+		const char *format, ...)
+{
+	va_list args;
+
+	/* bypasses the log priority, the caller asked for the trace */
+	va_start(args, format);
+	libinput->log_handler(libinput, priority, format, args);
+	va_end(args);
+}
+
+LIBINPUT_EXPORT int
+libinput_log_set_trace_buffer(struct libinput *libinput, unsigned int size)
+{
+	struct libinput_trace_entry *entries = NULL;
+	unsigned int nentries = 1;
+
+	if (size > 0) {
+		if (size > (1U << 24)) {
+			log_bug_client(libinput,
+				       "Invalid trace buffer size %u\n",
+				       size);
+			return -EINVAL;
+		}
+
+		while (nentries < size)
+			nentries <<= 1;
+
+		entries = calloc(nentries, sizeof(*entries));
+		if (!entries)
+			return -ENOMEM;
+	}
+
+	free(libinput->trace.entries);
+	libinput->trace.entries = entries;
+	libinput->trace.mask = entries ? nentries - 1 : 0;
+	libinput->trace.head = 0;
+
+	return 0;
+}
+
+LIBINPUT_EXPORT unsigned int
+libinput_log_get_trace_buffer(struct libinput *libinput)
+{
+	return libinput->trace.entries ? libinput->trace.mask + 1 : 0;
+}
+
+LIBINPUT_EXPORT void
+libinput_log_dump_trace(struct libinput *libinput)
+{
+	struct libinput_trace_entry *entry;
+	uint64_t i, first;
+	char buf[512];
+
+	if (!libinput->trace.entries || !libinput->log_handler)
+		return;
+
+	first = 0;
+	if (libinput->trace.head > libinput->trace.mask + 1)
+		first = libinput->trace.head - (libinput->trace.mask + 1);
+
+	if (first > 0)
+		log_trace_print(libinput,
+				LIBINPUT_LOG_PRIORITY_DEBUG,
+				"trace: %" PRIu64 " older messages dropped\n",
+				first);
+
+	for (i = first; i < libinput->trace.head; i++) {
+		entry = &libinput->trace.entries[i & libinput->trace.mask];
+		log_trace_format(entry, buf, sizeof(buf));
+		log_trace_print(libinput,
+				LIBINPUT_LOG_PRIORITY_DEBUG,
+				"[%" PRIu64 ".%06" PRIu64 "] %-7s - %s",
+				entry->time / 1000000,
+				entry->time % 1000000,
+				entry->tag,
+				buf);
+	}
+
+	libinput->trace.head = 0;
+}
+
+LIBINPUT_EXPORT void
+libinput_set_compact_touch_frames(struct libinput *libinput, int enable)
+{
+	struct libinput_seat *seat;
+	struct libinput_device *device;
+
+	if (!!enable == libinput->compact_touch_frames)
+		return;
+
+	libinput->compact_touch_frames = !!enable;
+	if (!enable)
+		return;
+
+	/* the touches aren't tracked while disabled, pick up the ones
+	 * already down */
+	list_for_each(seat, &libinput->seat_list, link) {
+		list_for_each(device, &seat->devices_list, link) {
+			device->touch_frame.nslots = 0;
+			evdev_device_sync_touches((struct evdev_device *)device);
+		}
+	}
+}
+
+LIBINPUT_EXPORT int
+libinput_get_compact_touch_frames(struct libinput *libinput)
+{
+	return libinput->compact_touch_frames;
+}
+
+LIBINPUT_EXPORT void
+libinput_set_cpu_accounting(struct libinput *libinput, int enable)
+{
+	libinput->cpu_accounting = !!enable;
+}
+
+LIBINPUT_EXPORT int
+libinput_get_cpu_accounting(struct libinput *libinput)
+{
+	return libinput->cpu_accounting;
+}
+
+LIBINPUT_EXPORT void
+libinput_set_latency_accounting(struct libinput *libinput, int enable)
+{
+	libinput->latency_accounting = !!enable;
+}
+
+LIBINPUT_EXPORT int
+libinput_get_latency_accounting(struct libinput *libinput)
+{
+	return libinput->latency_accounting;
+}
+
 LIBINPUT_EXPORT void
 libinput_log_set_priority(struct libinput *libinput,
 			  enum libinput_log_priority priority)
@@ -258,7 +515,8 @@ libinput_device_group_destroy(struct libinput_device_group *group);
 
 static void
 libinput_post_event(struct libinput *libinput,
-		    struct libinput_event *event);
+		    struct libinput_event *event,
+		    uint64_t time);
 
 LIBINPUT_EXPORT enum libinput_event_type
 libinput_event_get_type(struct libinput_event *event)
@@ -439,6 +697,78 @@ libinput_event_keyboard_get_seat_key_count(
 	return event->seat_key_count;
 }
 
+static inline double
+transform_cache_x(struct transform_cache *cache,
+		  struct evdev_device *device,
+		  double x,
+		  uint32_t width)
+{
+	/* A zeroed cache is valid for a width of 0 */
+	if (cache->width != width) {
+		cache->x = evdev_device_transform_x(device, x, width);
+		cache->width = width;
+	}
+
+	return cache->x;
+}
+
+static inline double
+transform_cache_y(struct transform_cache *cache,
+		  struct evdev_device *device,
+		  double y,
+		  uint32_t height)
+{
+	if (cache->height != height) {
+		cache->y = evdev_device_transform_y(device, y, height);
+		cache->height = height;
+	}
+
+	return cache->y;
+}
+
+static inline const struct device_float_coords *
+pointer_event_get_delta_raw(struct libinput_event_pointer *event)
+{
+	if (event->unaccel_coeff != 0.0) {
+		event->delta_raw.x = event->delta_unaccel.x/event->unaccel_coeff;
+		event->delta_raw.y = event->delta_unaccel.y/event->unaccel_coeff;
+		event->unaccel_coeff = 0.0;
+	}
+
+	return &event->delta_raw;
+}
+
+static inline size_t
+event_data_copy(void *data, size_t size, const void *full, size_t full_size)
+{
+	/* A caller built against an older libinput passes a smaller struct,
+	 * the fields are only ever appended */
+	size = min(size, full_size);
+	memcpy(data, full, size);
+
+	return size;
+}
+
+LIBINPUT_EXPORT size_t
+libinput_event_keyboard_get_data(struct libinput_event_keyboard *event,
+				 struct libinput_event_keyboard_data *data,
+				 size_t size)
+{
+	struct libinput_event_keyboard_data d = {0};
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_KEYBOARD_KEY);
+
+	d.time_usec = event->time;
+	d.key = event->key;
+	d.state = event->state;
+	d.seat_key_count = event->seat_key_count;
+
+	return event_data_copy(data, size, &d, sizeof(d));
+}
+
 LIBINPUT_EXPORT uint32_t
 libinput_event_pointer_get_time(struct libinput_event_pointer *event)
 {
@@ -498,7 +828,7 @@ libinput_event_pointer_get_dx_unaccelerated(
 			   0,
 			   LIBINPUT_EVENT_POINTER_MOTION);
 
-	return event->delta_raw.x;
+	return pointer_event_get_delta_raw(event)->x;
 }
 
 LIBINPUT_EXPORT double
@@ -510,7 +840,7 @@ libinput_event_pointer_get_dy_unaccelerated(
 			   0,
 			   LIBINPUT_EVENT_POINTER_MOTION);
 
-	return event->delta_raw.y;
+	return pointer_event_get_delta_raw(event)->y;
 }
 
 LIBINPUT_EXPORT double
@@ -551,7 +881,10 @@ libinput_event_pointer_get_absolute_x_transformed(
 			   0,
 			   LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE);
 
-	return evdev_device_transform_x(device, event->absolute.x, width);
+	return transform_cache_x(&event->transformed,
+				 device,
+				 event->absolute.x,
+				 width);
 }
 
 LIBINPUT_EXPORT double
@@ -566,7 +899,10 @@ libinput_event_pointer_get_absolute_y_transformed(
 			   0,
 			   LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE);
 
-	return evdev_device_transform_y(device, event->absolute.y, height);
+	return transform_cache_y(&event->transformed,
+				 device,
+				 event->absolute.y,
+				 height);
 }
 
 LIBINPUT_EXPORT uint32_t
@@ -687,6 +1023,65 @@ libinput_event_pointer_get_axis_source(struct libinput_event_pointer *event)
 	return event->source;
 }
 
+LIBINPUT_EXPORT size_t
+libinput_event_pointer_get_data(struct libinput_event_pointer *event,
+				struct libinput_event_pointer_data *data,
+				size_t size)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	struct libinput_event_pointer_data d = {0};
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_POINTER_MOTION,
+			   LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE,
+			   LIBINPUT_EVENT_POINTER_BUTTON,
+			   LIBINPUT_EVENT_POINTER_AXIS);
+
+	d.time_usec = event->time;
+
+	switch (event->base.type) {
+	case LIBINPUT_EVENT_POINTER_MOTION:
+		d.dx = event->delta.x;
+		d.dy = event->delta.y;
+		d.dx_unaccelerated = pointer_event_get_delta_raw(event)->x;
+		d.dy_unaccelerated = pointer_event_get_delta_raw(event)->y;
+		break;
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+		d.absolute_x = evdev_convert_to_mm(device->abs.absinfo_x,
+						   event->absolute.x);
+		d.absolute_y = evdev_convert_to_mm(device->abs.absinfo_y,
+						   event->absolute.y);
+		d.absolute_x_fraction =
+			evdev_device_transform_x(device, event->absolute.x, 1);
+		d.absolute_y_fraction =
+			evdev_device_transform_y(device, event->absolute.y, 1);
+		break;
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+		d.button = event->button;
+		d.button_state = event->state;
+		d.seat_button_count = event->seat_button_count;
+		break;
+	case LIBINPUT_EVENT_POINTER_AXIS:
+		d.axes = event->axes;
+		d.axis_source = event->source;
+		if (event->axes & AS_MASK(LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL)) {
+			d.axis_value_vertical = event->delta.y;
+			d.axis_value_discrete_vertical = event->discrete.y;
+		}
+		if (event->axes & AS_MASK(LIBINPUT_POINTER_AXIS_SCROLL_HORIZONTAL)) {
+			d.axis_value_horizontal = event->delta.x;
+			d.axis_value_discrete_horizontal = event->discrete.x;
+		}
+		break;
+	default:
+		break;
+	}
+
+	return event_data_copy(data, size, &d, sizeof(d));
+}
+
 LIBINPUT_EXPORT uint32_t
 libinput_event_touch_get_time(struct libinput_event_touch *event)
 {
@@ -771,7 +1166,10 @@ libinput_event_touch_get_x_transformed(struct libinput_event_touch *event,
 			   LIBINPUT_EVENT_TOUCH_DOWN,
 			   LIBINPUT_EVENT_TOUCH_MOTION);
 
-	return evdev_device_transform_x(device, event->point.x, width);
+	return transform_cache_x(&event->transformed,
+				 device,
+				 event->point.x,
+				 width);
 }
 
 LIBINPUT_EXPORT double
@@ -786,7 +1184,10 @@ libinput_event_touch_get_y_transformed(struct libinput_event_touch *event,
 			   LIBINPUT_EVENT_TOUCH_DOWN,
 			   LIBINPUT_EVENT_TOUCH_MOTION);
 
-	return evdev_device_transform_y(device, event->point.y, height);
+	return transform_cache_y(&event->transformed,
+				 device,
+				 event->point.y,
+				 height);
 }
 
 LIBINPUT_EXPORT double
@@ -803,134 +1204,465 @@ libinput_event_touch_get_y(struct libinput_event_touch *event)
 	return evdev_convert_to_mm(device->abs.absinfo_y, event->point.y);
 }
 
-LIBINPUT_EXPORT uint32_t
-libinput_event_gesture_get_time(struct libinput_event_gesture *event)
+LIBINPUT_EXPORT double
+libinput_event_touch_get_predicted_x(struct libinput_event_touch *event)
 {
+	struct evdev_device *device = evdev_device(event->base.device);
+
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
 			   0,
-			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
-			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
-			   LIBINPUT_EVENT_GESTURE_PINCH_END,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+			   LIBINPUT_EVENT_TOUCH_DOWN,
+			   LIBINPUT_EVENT_TOUCH_MOTION);
 
-	return us2ms(event->time);
+	return evdev_convert_to_mm(device->abs.absinfo_x, event->predicted.x);
 }
 
-LIBINPUT_EXPORT uint64_t
-libinput_event_gesture_get_time_usec(struct libinput_event_gesture *event)
+LIBINPUT_EXPORT double
+libinput_event_touch_get_predicted_y(struct libinput_event_touch *event)
 {
+	struct evdev_device *device = evdev_device(event->base.device);
+
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
 			   0,
-			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
-			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
-			   LIBINPUT_EVENT_GESTURE_PINCH_END,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+			   LIBINPUT_EVENT_TOUCH_DOWN,
+			   LIBINPUT_EVENT_TOUCH_MOTION);
 
-	return event->time;
+	return evdev_convert_to_mm(device->abs.absinfo_y, event->predicted.y);
 }
 
-LIBINPUT_EXPORT int
-libinput_event_gesture_get_finger_count(struct libinput_event_gesture *event)
+LIBINPUT_EXPORT double
+libinput_event_touch_get_predicted_x_transformed(struct libinput_event_touch *event,
+						 uint32_t width)
 {
+	struct evdev_device *device = evdev_device(event->base.device);
+
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
 			   0,
-			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
-			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
-			   LIBINPUT_EVENT_GESTURE_PINCH_END,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+			   LIBINPUT_EVENT_TOUCH_DOWN,
+			   LIBINPUT_EVENT_TOUCH_MOTION);
 
-	return event->finger_count;
+	return evdev_device_transform_x(device, event->predicted.x, width);
 }
 
-LIBINPUT_EXPORT int
-libinput_event_gesture_get_cancelled(struct libinput_event_gesture *event)
+LIBINPUT_EXPORT double
+libinput_event_touch_get_predicted_y_transformed(struct libinput_event_touch *event,
+						 uint32_t height)
 {
+	struct evdev_device *device = evdev_device(event->base.device);
+
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
 			   0,
-			   LIBINPUT_EVENT_GESTURE_PINCH_END,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+			   LIBINPUT_EVENT_TOUCH_DOWN,
+			   LIBINPUT_EVENT_TOUCH_MOTION);
 
-	return event->cancelled;
+	return evdev_device_transform_y(device, event->predicted.y, height);
 }
 
-LIBINPUT_EXPORT double
-libinput_event_gesture_get_dx(struct libinput_event_gesture *event)
+static inline const struct touch_frame_slot *
+touch_frame_get_slot(struct libinput_event_touch *event, unsigned int index)
 {
-	require_event_type(libinput_event_get_context(&event->base),
-			   event->base.type,
-			   0.0,
-			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
-			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
-			   LIBINPUT_EVENT_GESTURE_PINCH_END,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+	if (index >= event->nframe_slots) {
+		log_bug_client(libinput_event_get_context(&event->base),
+			       "invalid touch frame index %u\n",
+			       index);
+		return NULL;
+	}
 
-	return event->delta.x;
+	return &event->frame_slots[index];
 }
 
-LIBINPUT_EXPORT double
-libinput_event_gesture_get_dy(struct libinput_event_gesture *event)
+LIBINPUT_EXPORT unsigned int
+libinput_event_touch_get_frame_touch_count(struct libinput_event_touch *event)
 {
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
-			   0.0,
-			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
-			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
-			   LIBINPUT_EVENT_GESTURE_PINCH_END,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+			   0,
+			   LIBINPUT_EVENT_TOUCH_FRAME);
 
-	return event->delta.y;
+	return event->nframe_slots;
 }
 
-LIBINPUT_EXPORT double
-libinput_event_gesture_get_dx_unaccelerated(
-	struct libinput_event_gesture *event)
+LIBINPUT_EXPORT enum libinput_touch_state
+libinput_event_touch_get_frame_touch_state(struct libinput_event_touch *event,
+					   unsigned int index)
 {
+	const struct touch_frame_slot *t;
+
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
-			   0.0,
-			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
-			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
-			   LIBINPUT_EVENT_GESTURE_PINCH_END,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+			   0,
+			   LIBINPUT_EVENT_TOUCH_FRAME);
 
-	return event->delta_unaccel.x;
+	t = touch_frame_get_slot(event, index);
+
+	return t ? t->state : 0;
 }
 
-LIBINPUT_EXPORT double
-libinput_event_gesture_get_dy_unaccelerated(
-	struct libinput_event_gesture *event)
+LIBINPUT_EXPORT int32_t
+libinput_event_touch_get_frame_touch_slot(struct libinput_event_touch *event,
+					  unsigned int index)
 {
+	const struct touch_frame_slot *t;
+
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
-			   0.0,
-			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
-			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
-			   LIBINPUT_EVENT_GESTURE_PINCH_END,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
-			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+			   0,
+			   LIBINPUT_EVENT_TOUCH_FRAME);
 
-	return event->delta_unaccel.y;
+	t = touch_frame_get_slot(event, index);
+
+	return t ? t->slot : -1;
 }
 
-LIBINPUT_EXPORT double
-libinput_event_gesture_get_scale(struct libinput_event_gesture *event)
+LIBINPUT_EXPORT int32_t
+libinput_event_touch_get_frame_touch_seat_slot(struct libinput_event_touch *event,
+					       unsigned int index)
+{
+	const struct touch_frame_slot *t;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_FRAME);
+
+	t = touch_frame_get_slot(event, index);
+
+	return t ? t->seat_slot : -1;
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_frame_touch_x(struct libinput_event_touch *event,
+				       unsigned int index)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct touch_frame_slot *t;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_FRAME);
+
+	t = touch_frame_get_slot(event, index);
+	if (!t)
+		return 0;
+
+	return evdev_convert_to_mm(device->abs.absinfo_x, t->point.x);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_frame_touch_y(struct libinput_event_touch *event,
+				       unsigned int index)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct touch_frame_slot *t;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_FRAME);
+
+	t = touch_frame_get_slot(event, index);
+	if (!t)
+		return 0;
+
+	return evdev_convert_to_mm(device->abs.absinfo_y, t->point.y);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_frame_touch_x_transformed(struct libinput_event_touch *event,
+						   unsigned int index,
+						   uint32_t width)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct touch_frame_slot *t;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_FRAME);
+
+	t = touch_frame_get_slot(event, index);
+	if (!t)
+		return 0;
+
+	return evdev_device_transform_x(device, t->point.x, width);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_frame_touch_y_transformed(struct libinput_event_touch *event,
+						   unsigned int index,
+						   uint32_t height)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct touch_frame_slot *t;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_FRAME);
+
+	t = touch_frame_get_slot(event, index);
+	if (!t)
+		return 0;
+
+	return evdev_device_transform_y(device, t->point.y, height);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_frame_touch_predicted_x(struct libinput_event_touch *event,
+						 unsigned int index)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct touch_frame_slot *t;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_FRAME);
+
+	t = touch_frame_get_slot(event, index);
+	if (!t)
+		return 0;
+
+	return evdev_convert_to_mm(device->abs.absinfo_x, t->predicted.x);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_frame_touch_predicted_y(struct libinput_event_touch *event,
+						 unsigned int index)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct touch_frame_slot *t;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_FRAME);
+
+	t = touch_frame_get_slot(event, index);
+	if (!t)
+		return 0;
+
+	return evdev_convert_to_mm(device->abs.absinfo_y, t->predicted.y);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_frame_touch_predicted_x_transformed(struct libinput_event_touch *event,
+							     unsigned int index,
+							     uint32_t width)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct touch_frame_slot *t;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_FRAME);
+
+	t = touch_frame_get_slot(event, index);
+	if (!t)
+		return 0;
+
+	return evdev_device_transform_x(device, t->predicted.x, width);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_frame_touch_predicted_y_transformed(struct libinput_event_touch *event,
+							     unsigned int index,
+							     uint32_t height)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct touch_frame_slot *t;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_FRAME);
+
+	t = touch_frame_get_slot(event, index);
+	if (!t)
+		return 0;
+
+	return evdev_device_transform_y(device, t->predicted.y, height);
+}
+
+LIBINPUT_EXPORT size_t
+libinput_event_touch_get_data(struct libinput_event_touch *event,
+			      struct libinput_event_touch_data *data,
+			      size_t size)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	struct libinput_event_touch_data d = {0};
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_DOWN,
+			   LIBINPUT_EVENT_TOUCH_UP,
+			   LIBINPUT_EVENT_TOUCH_MOTION,
+			   LIBINPUT_EVENT_TOUCH_CANCEL,
+			   LIBINPUT_EVENT_TOUCH_FRAME);
+
+	d.time_usec = event->time;
+
+	if (event->base.type != LIBINPUT_EVENT_TOUCH_FRAME) {
+		d.slot = event->slot;
+		d.seat_slot = event->seat_slot;
+	}
+
+	if (event->base.type == LIBINPUT_EVENT_TOUCH_DOWN ||
+	    event->base.type == LIBINPUT_EVENT_TOUCH_MOTION) {
+		d.x = evdev_convert_to_mm(device->abs.absinfo_x,
+					  event->point.x);
+		d.y = evdev_convert_to_mm(device->abs.absinfo_y,
+					  event->point.y);
+		d.x_fraction = evdev_device_transform_x(device, event->point.x, 1);
+		d.y_fraction = evdev_device_transform_y(device, event->point.y, 1);
+		d.predicted_x = evdev_convert_to_mm(device->abs.absinfo_x,
+						    event->predicted.x);
+		d.predicted_y = evdev_convert_to_mm(device->abs.absinfo_y,
+						    event->predicted.y);
+		d.predicted_x_fraction =
+			evdev_device_transform_x(device, event->predicted.x, 1);
+		d.predicted_y_fraction =
+			evdev_device_transform_y(device, event->predicted.y, 1);
+	}
+
+	return event_data_copy(data, size, &d, sizeof(d));
+}
+
+LIBINPUT_EXPORT uint32_t
+libinput_event_gesture_get_time(struct libinput_event_gesture *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_PINCH_END,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+
+	return us2ms(event->time);
+}
+
+LIBINPUT_EXPORT uint64_t
+libinput_event_gesture_get_time_usec(struct libinput_event_gesture *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_PINCH_END,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+
+	return event->time;
+}
+
+LIBINPUT_EXPORT int
+libinput_event_gesture_get_finger_count(struct libinput_event_gesture *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_PINCH_END,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+
+	return event->finger_count;
+}
+
+LIBINPUT_EXPORT int
+libinput_event_gesture_get_cancelled(struct libinput_event_gesture *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_GESTURE_PINCH_END,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+
+	return event->cancelled;
+}
+
+LIBINPUT_EXPORT double
+libinput_event_gesture_get_dx(struct libinput_event_gesture *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0.0,
+			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_PINCH_END,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+
+	return event->delta.x;
+}
+
+LIBINPUT_EXPORT double
+libinput_event_gesture_get_dy(struct libinput_event_gesture *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0.0,
+			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_PINCH_END,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+
+	return event->delta.y;
+}
+
+LIBINPUT_EXPORT double
+libinput_event_gesture_get_dx_unaccelerated(
+	struct libinput_event_gesture *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0.0,
+			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_PINCH_END,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+
+	return event->delta_unaccel.x;
+}
+
+LIBINPUT_EXPORT double
+libinput_event_gesture_get_dy_unaccelerated(
+	struct libinput_event_gesture *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0.0,
+			   LIBINPUT_EVENT_GESTURE_PINCH_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_PINCH_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_PINCH_END,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
+			   LIBINPUT_EVENT_GESTURE_SWIPE_END);
+
+	return event->delta_unaccel.y;
+}
+
+LIBINPUT_EXPORT double
+libinput_event_gesture_get_scale(struct libinput_event_gesture *event)
 {
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
@@ -994,142 +1726,416 @@ libinput_event_tablet_tool_pressure_has_changed(
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
 			   0,
-			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
-			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
-			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
-			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	return bit_is_set(event->changed_axes,
+			  LIBINPUT_TABLET_TOOL_AXIS_PRESSURE);
+}
+
+LIBINPUT_EXPORT int
+libinput_event_tablet_tool_distance_has_changed(
+				struct libinput_event_tablet_tool *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	return bit_is_set(event->changed_axes,
+			  LIBINPUT_TABLET_TOOL_AXIS_DISTANCE);
+}
+
+LIBINPUT_EXPORT int
+libinput_event_tablet_tool_tilt_x_has_changed(
+				struct libinput_event_tablet_tool *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	return bit_is_set(event->changed_axes,
+			  LIBINPUT_TABLET_TOOL_AXIS_TILT_X);
+}
+
+LIBINPUT_EXPORT int
+libinput_event_tablet_tool_tilt_y_has_changed(
+				struct libinput_event_tablet_tool *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	return bit_is_set(event->changed_axes,
+			  LIBINPUT_TABLET_TOOL_AXIS_TILT_Y);
+}
+
+LIBINPUT_EXPORT int
+libinput_event_tablet_tool_rotation_has_changed(
+				struct libinput_event_tablet_tool *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	return bit_is_set(event->changed_axes,
+			  LIBINPUT_TABLET_TOOL_AXIS_ROTATION_Z);
+}
+
+LIBINPUT_EXPORT int
+libinput_event_tablet_tool_slider_has_changed(
+				struct libinput_event_tablet_tool *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	return bit_is_set(event->changed_axes,
+			  LIBINPUT_TABLET_TOOL_AXIS_SLIDER);
+}
+
+LIBINPUT_EXPORT int
+libinput_event_tablet_tool_wheel_has_changed(
+				struct libinput_event_tablet_tool *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	return bit_is_set(event->changed_axes,
+			  LIBINPUT_TABLET_TOOL_AXIS_REL_WHEEL);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_x(struct libinput_event_tablet_tool *event)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	return evdev_convert_to_mm(device->abs.absinfo_x,
+				   event->axes.point.x);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_y(struct libinput_event_tablet_tool *event)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	return evdev_convert_to_mm(device->abs.absinfo_y,
+				   event->axes.point.y);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_predicted_x(struct libinput_event_tablet_tool *event)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	return evdev_convert_to_mm(device->abs.absinfo_x,
+				   event->axes.predicted.x);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_predicted_y(struct libinput_event_tablet_tool *event)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	return evdev_convert_to_mm(device->abs.absinfo_y,
+				   event->axes.predicted.y);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_predicted_x_transformed(struct libinput_event_tablet_tool *event,
+						       uint32_t width)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	return evdev_device_transform_x(device,
+					event->axes.predicted.x,
+					width);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_predicted_y_transformed(struct libinput_event_tablet_tool *event,
+						       uint32_t height)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	return evdev_device_transform_y(device,
+					event->axes.predicted.y,
+					height);
+}
+
+static inline const struct tablet_history_sample *
+tablet_history_get_sample(struct libinput_event_tablet_tool *event,
+			  unsigned int index)
+{
+	if (index >= event->nhistory) {
+		log_bug_client(libinput_event_get_context(&event->base),
+			       "invalid tablet history index %u\n",
+			       index);
+		return NULL;
+	}
+
+	return &event->history[index];
+}
+
+LIBINPUT_EXPORT unsigned int
+libinput_event_tablet_tool_get_history_size(struct libinput_event_tablet_tool *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	return event->nhistory;
+}
+
+LIBINPUT_EXPORT uint64_t
+libinput_event_tablet_tool_get_history_time_usec(struct libinput_event_tablet_tool *event,
+						  unsigned int index)
+{
+	const struct tablet_history_sample *sample;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS);
 
-	return bit_is_set(event->changed_axes,
-			  LIBINPUT_TABLET_TOOL_AXIS_PRESSURE);
+	sample = tablet_history_get_sample(event, index);
+	if (!sample)
+		return 0;
+
+	return sample->time;
 }
 
-LIBINPUT_EXPORT int
-libinput_event_tablet_tool_distance_has_changed(
-				struct libinput_event_tablet_tool *event)
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_history_x(struct libinput_event_tablet_tool *event,
+					 unsigned int index)
 {
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct tablet_history_sample *sample;
+
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
 			   0,
-			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
-			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
-			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
-			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS);
 
-	return bit_is_set(event->changed_axes,
-			  LIBINPUT_TABLET_TOOL_AXIS_DISTANCE);
+	sample = tablet_history_get_sample(event, index);
+	if (!sample)
+		return 0;
+
+	return evdev_convert_to_mm(device->abs.absinfo_x,
+				   sample->point.x);
 }
 
-LIBINPUT_EXPORT int
-libinput_event_tablet_tool_tilt_x_has_changed(
-				struct libinput_event_tablet_tool *event)
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_history_y(struct libinput_event_tablet_tool *event,
+					 unsigned int index)
 {
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct tablet_history_sample *sample;
+
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
 			   0,
-			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
-			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
-			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
-			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS);
 
-	return bit_is_set(event->changed_axes,
-			  LIBINPUT_TABLET_TOOL_AXIS_TILT_X);
+	sample = tablet_history_get_sample(event, index);
+	if (!sample)
+		return 0;
+
+	return evdev_convert_to_mm(device->abs.absinfo_y,
+				   sample->point.y);
 }
 
-LIBINPUT_EXPORT int
-libinput_event_tablet_tool_tilt_y_has_changed(
-				struct libinput_event_tablet_tool *event)
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_history_x_transformed(struct libinput_event_tablet_tool *event,
+						     unsigned int index,
+						     uint32_t width)
 {
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct tablet_history_sample *sample;
+
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
 			   0,
-			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
-			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
-			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
-			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS);
 
-	return bit_is_set(event->changed_axes,
-			  LIBINPUT_TABLET_TOOL_AXIS_TILT_Y);
+	sample = tablet_history_get_sample(event, index);
+	if (!sample)
+		return 0;
+
+	return evdev_device_transform_x(device,
+					sample->point.x,
+					width);
 }
 
-LIBINPUT_EXPORT int
-libinput_event_tablet_tool_rotation_has_changed(
-				struct libinput_event_tablet_tool *event)
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_history_y_transformed(struct libinput_event_tablet_tool *event,
+						     unsigned int index,
+						     uint32_t height)
 {
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct tablet_history_sample *sample;
+
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
 			   0,
-			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
-			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
-			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
-			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS);
 
-	return bit_is_set(event->changed_axes,
-			  LIBINPUT_TABLET_TOOL_AXIS_ROTATION_Z);
+	sample = tablet_history_get_sample(event, index);
+	if (!sample)
+		return 0;
+
+	return evdev_device_transform_y(device,
+					sample->point.y,
+					height);
 }
 
-LIBINPUT_EXPORT int
-libinput_event_tablet_tool_slider_has_changed(
-				struct libinput_event_tablet_tool *event)
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_history_pressure(struct libinput_event_tablet_tool *event,
+						unsigned int index)
 {
+	const struct tablet_history_sample *sample;
+
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
 			   0,
-			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
-			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
-			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
-			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS);
 
-	return bit_is_set(event->changed_axes,
-			  LIBINPUT_TABLET_TOOL_AXIS_SLIDER);
+	sample = tablet_history_get_sample(event, index);
+	if (!sample)
+		return 0;
+
+	return sample->pressure;
 }
 
-LIBINPUT_EXPORT int
-libinput_event_tablet_tool_wheel_has_changed(
-				struct libinput_event_tablet_tool *event)
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_history_tilt_x(struct libinput_event_tablet_tool *event,
+					      unsigned int index)
 {
+	const struct tablet_history_sample *sample;
+
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
 			   0,
-			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
-			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
-			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
-			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS);
 
-	return bit_is_set(event->changed_axes,
-			  LIBINPUT_TABLET_TOOL_AXIS_REL_WHEEL);
+	sample = tablet_history_get_sample(event, index);
+	if (!sample)
+		return 0;
+
+	return sample->tilt.x;
 }
 
 LIBINPUT_EXPORT double
-libinput_event_tablet_tool_get_x(struct libinput_event_tablet_tool *event)
+libinput_event_tablet_tool_get_history_tilt_y(struct libinput_event_tablet_tool *event,
+					      unsigned int index)
 {
-	struct evdev_device *device = evdev_device(event->base.device);
+	const struct tablet_history_sample *sample;
 
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
 			   0,
-			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
-			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
-			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
-			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS);
 
-	return evdev_convert_to_mm(device->abs.absinfo_x,
-				   event->axes.point.x);
+	sample = tablet_history_get_sample(event, index);
+	if (!sample)
+		return 0;
+
+	return sample->tilt.y;
 }
 
 LIBINPUT_EXPORT double
-libinput_event_tablet_tool_get_y(struct libinput_event_tablet_tool *event)
+libinput_event_tablet_tool_get_history_rotation(struct libinput_event_tablet_tool *event,
+						unsigned int index)
 {
-	struct evdev_device *device = evdev_device(event->base.device);
+	const struct tablet_history_sample *sample;
 
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
 			   0,
-			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
-			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
-			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS);
 
-	return evdev_convert_to_mm(device->abs.absinfo_y,
-				   event->axes.point.y);
+	sample = tablet_history_get_sample(event, index);
+	if (!sample)
+		return 0;
+
+	return sample->rotation;
 }
 
 LIBINPUT_EXPORT double
@@ -1277,9 +2283,10 @@ libinput_event_tablet_tool_get_x_transformed(struct libinput_event_tablet_tool *
 			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
 			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
 
-	return evdev_device_transform_x(device,
-					event->axes.point.x,
-					width);
+	return transform_cache_x(&event->transformed,
+				 device,
+				 event->axes.point.x,
+				 width);
 }
 
 LIBINPUT_EXPORT double
@@ -1296,9 +2303,10 @@ libinput_event_tablet_tool_get_y_transformed(struct libinput_event_tablet_tool *
 			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
 			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
 
-	return evdev_device_transform_y(device,
-					event->axes.point.y,
-					height);
+	return transform_cache_y(&event->transformed,
+				 device,
+				 event->axes.point.y,
+				 height);
 }
 
 LIBINPUT_EXPORT struct libinput_tablet_tool *
@@ -1404,6 +2412,64 @@ libinput_event_tablet_tool_get_seat_button_count(struct libinput_event_tablet_to
 	return event->seat_button_count;
 }
 
+LIBINPUT_EXPORT size_t
+libinput_event_tablet_tool_get_data(struct libinput_event_tablet_tool *event,
+				    struct libinput_event_tablet_tool_data *data,
+				    size_t size)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	struct libinput_event_tablet_tool_data d = {0};
+	int axis;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	d.time_usec = event->time;
+	d.tool = event->tool;
+	d.tool_type = event->tool->type;
+	d.tool_serial = event->tool->serial;
+	d.proximity_state = event->proximity_state;
+	d.tip_state = event->tip_state;
+
+	for (axis = LIBINPUT_TABLET_TOOL_AXIS_X;
+	     axis <= LIBINPUT_TABLET_TOOL_AXIS_MAX;
+	     axis++) {
+		if (bit_is_set(event->changed_axes, axis))
+			d.changed |= AS_MASK(axis);
+	}
+
+	d.x = evdev_convert_to_mm(device->abs.absinfo_x, event->axes.point.x);
+	d.y = evdev_convert_to_mm(device->abs.absinfo_y, event->axes.point.y);
+	d.x_fraction = evdev_device_transform_x(device, event->axes.point.x, 1);
+	d.y_fraction = evdev_device_transform_y(device, event->axes.point.y, 1);
+
+	/* button events carry the axis state at the time of the button
+	 * press too, see tablet_notify_button() */
+	d.dx = event->axes.delta.x;
+	d.dy = event->axes.delta.y;
+	d.pressure = event->axes.pressure;
+	d.distance = event->axes.distance;
+	d.tilt_x = event->axes.tilt.x;
+	d.tilt_y = event->axes.tilt.y;
+	d.rotation = event->axes.rotation;
+	d.slider = event->axes.slider;
+	d.wheel_delta = event->axes.wheel;
+	d.wheel_delta_discrete = event->axes.wheel_discrete;
+
+	if (event->base.type == LIBINPUT_EVENT_TABLET_TOOL_BUTTON) {
+		d.button = event->button;
+		d.button_state = event->state;
+		d.seat_button_count = event->seat_button_count;
+	}
+
+	return event_data_copy(data, size, &d, sizeof(d));
+}
+
 LIBINPUT_EXPORT enum libinput_tablet_tool_type
 libinput_tablet_tool_get_type(struct libinput_tablet_tool *tool)
 {
@@ -1595,6 +2661,8 @@ libinput_add_fd(struct libinput *libinput,
 		return NULL;
 	}
 
+	list_insert(&libinput->source_list, &source->link);
+
 	return source;
 }
 
@@ -1604,6 +2672,7 @@ libinput_remove_source(struct libinput *libinput,
 {
 	epoll_ctl(libinput->epoll_fd, EPOLL_CTL_DEL, source->fd, NULL);
 	source->fd = -1;
+	list_remove(&source->link);
 	list_insert(&libinput->source_destroy_list, &source->link);
 }
 
@@ -1633,6 +2702,7 @@ libinput_init(struct libinput *libinput,
 	libinput->interface_backend = interface_backend;
 	libinput->user_data = user_data;
 	libinput->refcount = 1;
+	list_init(&libinput->source_list);
 	list_init(&libinput->source_destroy_list);
 	list_init(&libinput->seat_list);
 	list_init(&libinput->device_group_list);
@@ -1718,7 +2788,11 @@ libinput_unref(struct libinput *libinput)
 
 	libinput_timer_subsys_destroy(libinput);
 	libinput_drop_destroyed_sources(libinput);
-	close(libinput->epoll_fd);
+	if (libinput->loop)
+		libinput_loop_unref(libinput->loop);
+	else
+		close(libinput->epoll_fd);
+	free(libinput->trace.entries);
 	free(libinput);
 
 	return NULL;
@@ -1814,10 +2888,86 @@ libinput_seat_ref(struct libinput_seat *seat)
 	return seat;
 }
 
+static bool
+libinput_seat_slot_map_grow(struct libinput_seat *seat, size_t nwords)
+{
+	size_t old_nwords = seat->slot_map.nwords;
+	unsigned long *slots, *full;
+
+	nwords = max(nwords, old_nwords * 2);
+
+	slots = realloc(seat->slot_map.slots, nwords * sizeof(*slots));
+	if (!slots)
+		return false;
+	seat->slot_map.slots = slots;
+	memset(&slots[old_nwords], 0,
+	       (nwords - old_nwords) * sizeof(*slots));
+
+	full = realloc(seat->slot_map.full, NLONGS(nwords) * sizeof(*full));
+	if (!full)
+		return false;
+	seat->slot_map.full = full;
+	memset(&full[NLONGS(old_nwords)], 0,
+	       (NLONGS(nwords) - NLONGS(old_nwords)) * sizeof(*full));
+
+	seat->slot_map.nwords = nwords;
+
+	return true;
+}
+
+/* Returns the lowest free seat slot. Constant time for the first
+ * LONG_BITS * LONG_BITS slots, the summary has a single word until then.
+ */
+int
+libinput_seat_slot_acquire(struct libinput_seat *seat)
+{
+	size_t nfull = NLONGS(seat->slot_map.nwords);
+	size_t i, word;
+	unsigned long *w;
+	int bit;
+
+	for (i = 0; i < nfull; i++) {
+		if (seat->slot_map.full[i] != ~0UL)
+			break;
+	}
+
+	/* bits past nwords are never set in the summary, so this may
+	 * point just past the end */
+	word = i * LONG_BITS;
+	if (i < nfull)
+		word += __builtin_ctzl(~seat->slot_map.full[i]);
+
+	if (word >= seat->slot_map.nwords &&
+	    !libinput_seat_slot_map_grow(seat, word + 1))
+		return -1;
+
+	w = &seat->slot_map.slots[word];
+	bit = __builtin_ctzl(~*w);
+	*w |= 1UL << bit;
+	if (*w == ~0UL)
+		long_set_bit(seat->slot_map.full, word);
+
+	return word * LONG_BITS + bit;
+}
+
+void
+libinput_seat_slot_release(struct libinput_seat *seat, int seat_slot)
+{
+	size_t word = seat_slot / LONG_BITS;
+
+	if (seat_slot < 0 || word >= seat->slot_map.nwords)
+		return;
+
+	long_clear_bit(seat->slot_map.slots, seat_slot);
+	long_clear_bit(seat->slot_map.full, word);
+}
+
 static void
 libinput_seat_destroy(struct libinput_seat *seat)
 {
 	list_remove(&seat->link);
+	free(seat->slot_map.slots);
+	free(seat->slot_map.full);
 	free(seat->logical_name);
 	free(seat->physical_name);
 	seat->destroy(seat);
@@ -1886,6 +3036,7 @@ static void
 libinput_device_destroy(struct libinput_device *device)
 {
 	assert(list_empty(&device->event_listeners));
+	free(device->touch_frame.slots);
 	evdev_device_destroy(evdev_device(device));
 }
 
@@ -1905,31 +3056,200 @@ libinput_device_unref(struct libinput_device *device)
 LIBINPUT_EXPORT int
 libinput_get_fd(struct libinput *libinput)
 {
-	return libinput->epoll_fd;
+	return libinput->epoll_fd;
+}
+
+static int
+libinput_dispatch_sources(int epoll_fd)
+{
+	struct libinput_source *source;
+	struct epoll_event ep[32];
+	int i, count;
+
+	count = epoll_wait(epoll_fd, ep, ARRAY_LENGTH(ep), 0);
+	if (count < 0)
+		return -errno;
+
+	for (i = 0; i < count; ++i) {
+		source = ep[i].data.ptr;
+		if (source->fd == -1)
+			continue;
+
+		source->dispatch(source->user_data);
+	}
+
+	return 0;
+}
+
+LIBINPUT_EXPORT int
+libinput_dispatch(struct libinput *libinput)
+{
+	int rc;
+
+	if (libinput->loop)
+		return libinput_loop_dispatch(libinput->loop);
+
+	rc = libinput_dispatch_sources(libinput->epoll_fd);
+	if (rc < 0)
+		return rc;
+
+	libinput_drop_destroyed_sources(libinput);
+
+	return 0;
+}
+
+LIBINPUT_EXPORT struct libinput_loop *
+libinput_loop_create(void)
+{
+	struct libinput_loop *loop;
+	struct libinput_source *source;
+	struct epoll_event ep;
+
+	loop = zalloc(sizeof(*loop));
+	if (!loop)
+		return NULL;
+
+	loop->refcount = 1;
+	loop->timer.fd = -1;
+	loop->timer.armed = UINT64_MAX;
+	list_init(&loop->contexts);
+
+	loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (loop->epoll_fd < 0)
+		goto err;
+
+	if (libinput_loop_timer_init(loop) != 0)
+		goto err;
+
+	/* the loop's own source, it isn't on any context's lists */
+	source = zalloc(sizeof(*source));
+	if (!source)
+		goto err;
+
+	source->dispatch = libinput_loop_timer_handler;
+	source->user_data = loop;
+	source->fd = loop->timer.fd;
+	list_init(&source->link);
+	loop->timer.source = source;
+
+	memset(&ep, 0, sizeof ep);
+	ep.events = EPOLLIN;
+	ep.data.ptr = source;
+	if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, source->fd, &ep) < 0)
+		goto err;
+
+	return loop;
+
+err:
+	free(loop->timer.source);
+	if (loop->timer.fd >= 0)
+		close(loop->timer.fd);
+	if (loop->epoll_fd >= 0)
+		close(loop->epoll_fd);
+	free(loop);
+	return NULL;
+}
+
+LIBINPUT_EXPORT struct libinput_loop *
+libinput_loop_ref(struct libinput_loop *loop)
+{
+	loop->refcount++;
+	return loop;
+}
+
+LIBINPUT_EXPORT struct libinput_loop *
+libinput_loop_unref(struct libinput_loop *loop)
+{
+	if (loop == NULL)
+		return NULL;
+
+	assert(loop->refcount > 0);
+	loop->refcount--;
+	if (loop->refcount > 0)
+		return loop;
+
+	/* every attached context holds a reference */
+	assert(list_empty(&loop->contexts));
+
+	free(loop->timer.heap);
+	free(loop->timer.source);
+	close(loop->timer.fd);
+	close(loop->epoll_fd);
+	free(loop);
+
+	return NULL;
+}
+
+LIBINPUT_EXPORT int
+libinput_loop_attach(struct libinput_loop *loop, struct libinput *libinput)
+{
+	struct libinput_source *source;
+	struct epoll_event ep;
+	int rc;
+
+	if (libinput->loop || libinput->clock) {
+		log_bug_client(libinput,
+			       "Context is already attached to a %s\n",
+			       libinput->loop ? "loop" : "virtual clock");
+		return -EINVAL;
+	}
+
+	list_for_each(source, &libinput->source_list, link) {
+		/* our timer is replaced by the loop's */
+		if (source == libinput->timer.source)
+			continue;
+
+		memset(&ep, 0, sizeof ep);
+		ep.events = EPOLLIN;
+		ep.data.ptr = source;
+		if (epoll_ctl(loop->epoll_fd,
+			      EPOLL_CTL_ADD,
+			      source->fd,
+			      &ep) < 0)
+			goto err;
+	}
+
+	libinput_remove_source(libinput, libinput->timer.source);
+	libinput_drop_destroyed_sources(libinput);
+
+	close(libinput->epoll_fd);
+	libinput->epoll_fd = loop->epoll_fd;
+	libinput->loop = libinput_loop_ref(loop);
+	libinput_timer_subsys_attach_loop(libinput);
+
+	return 0;
+
+err:
+	rc = -errno;
+	list_for_each(source, &libinput->source_list, link) {
+		if (source != libinput->timer.source)
+			epoll_ctl(loop->epoll_fd,
+				  EPOLL_CTL_DEL,
+				  source->fd,
+				  NULL);
+	}
+
+	return rc;
+}
+
+LIBINPUT_EXPORT int
+libinput_loop_get_fd(struct libinput_loop *loop)
+{
+	return loop->epoll_fd;
 }
 
 LIBINPUT_EXPORT int
-libinput_dispatch(struct libinput *libinput)
+libinput_loop_dispatch(struct libinput_loop *loop)
 {
-	struct libinput_source *source;
-	struct epoll_event ep[32];
-	int i, count;
-
-	count = epoll_wait(libinput->epoll_fd, ep, ARRAY_LENGTH(ep), 0);
-	if (count < 0)
-		return -errno;
+	struct libinput *libinput;
+	int rc;
 
-	for (i = 0; i < count; ++i) {
-		source = ep[i].data.ptr;
-		if (source->fd == -1)
-			continue;
+	rc = libinput_dispatch_sources(loop->epoll_fd);
 
-		source->dispatch(source->user_data);
-	}
-
-	libinput_drop_destroyed_sources(libinput);
+	list_for_each(libinput, &loop->contexts, loop_link)
+		libinput_drop_destroyed_sources(libinput);
 
-	return 0;
+	return rc;
 }
 
 void
@@ -2016,7 +3336,7 @@ post_base_event(struct libinput_device *device,
 {
 	struct libinput *libinput = device->seat->libinput;
 	init_event_base(event, device, type);
-	libinput_post_event(libinput, event);
+	libinput_post_event(libinput, event, 0);
 }
 
 static void
@@ -2032,7 +3352,7 @@ post_device_event(struct libinput_device *device,
 	list_for_each_safe(listener, tmp, &device->event_listeners, link)
 		listener->notify_func(time, event, listener->notify_func_data);
 
-	libinput_post_event(device->seat->libinput, event);
+	libinput_post_event(device->seat->libinput, event, time);
 }
 
 void
@@ -2040,6 +3360,11 @@ notify_added_device(struct libinput_device *device)
 {
 	struct libinput_event_device_notify *added_device_event;
 
+	trace_probe3(device__added,
+		     device,
+		     libinput_device_get_sysname(device),
+		     libinput_device_get_name(device));
+
 	added_device_event = zalloc(sizeof *added_device_event);
 	if (!added_device_event)
 		return;
@@ -2054,6 +3379,8 @@ notify_removed_device(struct libinput_device *device)
 {
 	struct libinput_event_device_notify *removed_device_event;
 
+	trace_probe1(device__removed, device);
+
 	removed_device_event = zalloc(sizeof *removed_device_event);
 	if (!removed_device_event)
 		return;
@@ -2160,6 +3487,34 @@ pointer_notify_motion(struct libinput_device *device,
 			  &motion_event->base);
 }
 
+void
+pointer_notify_motion_normalized(struct libinput_device *device,
+				 uint64_t time,
+				 const struct normalized_coords *delta,
+				 const struct normalized_coords *unaccel,
+				 double coeff)
+{
+	struct libinput_event_pointer *motion_event;
+
+	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
+		return;
+
+	motion_event = zalloc(sizeof *motion_event);
+	if (!motion_event)
+		return;
+
+	*motion_event = (struct libinput_event_pointer) {
+		.time = time,
+		.delta = *delta,
+		.delta_unaccel = *unaccel,
+		.unaccel_coeff = coeff,
+	};
+
+	post_device_event(device, time,
+			  LIBINPUT_EVENT_POINTER_MOTION,
+			  &motion_event->base);
+}
+
 void
 pointer_notify_motion_absolute(struct libinput_device *device,
 			       uint64_t time,
@@ -2246,18 +3601,187 @@ pointer_notify_axis(struct libinput_device *device,
 			  &axis_event->base);
 }
 
+static inline bool
+touch_frame_is_compact(struct libinput_device *device)
+{
+	return device->seat->libinput->compact_touch_frames;
+}
+
+static struct touch_frame_slot *
+touch_frame_find(struct libinput_device *device, int32_t seat_slot)
+{
+	unsigned int i;
+
+	for (i = 0; i < device->touch_frame.nslots; i++) {
+		struct touch_frame_slot *t = &device->touch_frame.slots[i];
+
+		if (t->seat_slot == seat_slot &&
+		    t->state != LIBINPUT_TOUCH_STATE_UP &&
+		    !t->lifted)
+			return t;
+	}
+
+	return NULL;
+}
+
+static struct touch_frame_slot *
+touch_frame_add(struct libinput_device *device,
+		int32_t slot,
+		int32_t seat_slot)
+{
+	struct touch_frame_slot *t;
+
+	if (device->touch_frame.nslots == device->touch_frame.size) {
+		unsigned int size = max(device->touch_frame.size * 2, 8U);
+		struct touch_frame_slot *slots;
+
+		slots = realloc(device->touch_frame.slots,
+				size * sizeof(*slots));
+		if (!slots)
+			return NULL;
+
+		device->touch_frame.slots = slots;
+		device->touch_frame.size = size;
+	}
+
+	t = &device->touch_frame.slots[device->touch_frame.nslots++];
+	*t = (struct touch_frame_slot) {
+		.slot = slot,
+		.seat_slot = seat_slot,
+	};
+
+	return t;
+}
+
+/* Returns false if the touch could not be tracked, the caller then posts
+ * the uncompacted event instead */
+static bool
+touch_frame_update(struct libinput_device *device,
+		   int32_t slot,
+		   int32_t seat_slot,
+		   enum libinput_touch_state state,
+		   const struct device_coords *point,
+		   const struct device_coords *predicted)
+{
+	struct touch_frame_slot *t, up;
+
+	t = touch_frame_find(device, seat_slot);
+
+	switch (state) {
+	case LIBINPUT_TOUCH_STATE_DOWN:
+		if (!t)
+			t = touch_frame_add(device, slot, seat_slot);
+		if (!t)
+			return false;
+		t->state = state;
+		t->point = *point;
+		t->predicted = *predicted;
+		break;
+	case LIBINPUT_TOUCH_STATE_MOTION:
+		if (!t)
+			t = touch_frame_add(device, slot, seat_slot);
+		if (!t)
+			return false;
+		t->point = *point;
+		t->predicted = *predicted;
+		if (t->state != LIBINPUT_TOUCH_STATE_DOWN)
+			t->state = state;
+		break;
+	case LIBINPUT_TOUCH_STATE_UP:
+		if (!t) {
+			t = touch_frame_add(device, slot, seat_slot);
+			if (!t)
+				return false;
+			t->state = state;
+			break;
+		}
+
+		if (t->state != LIBINPUT_TOUCH_STATE_DOWN) {
+			t->state = state;
+			t->predicted = t->point;
+			break;
+		}
+
+		/* down and up in the same frame: the frame carries
+		 * both, the up at the position of the down */
+		up = *t;
+		up.state = state;
+		up.predicted = up.point;
+		t->lifted = true;
+		t = touch_frame_add(device, slot, seat_slot);
+		if (!t)
+			return false;
+		*t = up;
+		break;
+	case LIBINPUT_TOUCH_STATE_STATIONARY:
+		break;
+	}
+
+	return true;
+}
+
+/* Drop the touches that ended, the others carry over unchanged into the
+ * next frame */
+static void
+touch_frame_advance(struct libinput_device *device)
+{
+	unsigned int i, n = 0;
+
+	for (i = 0; i < device->touch_frame.nslots; i++) {
+		struct touch_frame_slot *t = &device->touch_frame.slots[i];
+
+		if (t->state == LIBINPUT_TOUCH_STATE_UP || t->lifted)
+			continue;
+
+		t->state = LIBINPUT_TOUCH_STATE_STATIONARY;
+		t->predicted = t->point;
+		device->touch_frame.slots[n++] = *t;
+	}
+
+	device->touch_frame.nslots = n;
+}
+
+/* A touch that is down but was not tracked, see
+ * libinput_set_compact_touch_frames() */
+void
+touch_notify_touch_active(struct libinput_device *device,
+			  int32_t slot,
+			  int32_t seat_slot,
+			  const struct device_coords *point)
+{
+	struct touch_frame_slot *t;
+
+	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
+		return;
+
+	t = touch_frame_add(device, slot, seat_slot);
+	if (!t)
+		return;
+
+	t->state = LIBINPUT_TOUCH_STATE_STATIONARY;
+	t->point = *point;
+	t->predicted = *point;
+}
+
 void
 touch_notify_touch_down(struct libinput_device *device,
 			uint64_t time,
 			int32_t slot,
 			int32_t seat_slot,
-			const struct device_coords *point)
+			const struct device_coords *point,
+			const struct device_coords *predicted)
 {
 	struct libinput_event_touch *touch_event;
 
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
+	if (touch_frame_is_compact(device) &&
+	    touch_frame_update(device, slot, seat_slot,
+			       LIBINPUT_TOUCH_STATE_DOWN,
+			       point, predicted))
+		return;
+
 	touch_event = zalloc(sizeof *touch_event);
 	if (!touch_event)
 		return;
@@ -2267,6 +3791,7 @@ touch_notify_touch_down(struct libinput_device *device,
 		.slot = slot,
 		.seat_slot = seat_slot,
 		.point = *point,
+		.predicted = *predicted,
 	};
 
 	post_device_event(device, time,
@@ -2279,13 +3804,20 @@ touch_notify_touch_motion(struct libinput_device *device,
 			  uint64_t time,
 			  int32_t slot,
 			  int32_t seat_slot,
-			  const struct device_coords *point)
+			  const struct device_coords *point,
+			  const struct device_coords *predicted)
 {
 	struct libinput_event_touch *touch_event;
 
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
+	if (touch_frame_is_compact(device) &&
+	    touch_frame_update(device, slot, seat_slot,
+			       LIBINPUT_TOUCH_STATE_MOTION,
+			       point, predicted))
+		return;
+
 	touch_event = zalloc(sizeof *touch_event);
 	if (!touch_event)
 		return;
@@ -2295,6 +3827,7 @@ touch_notify_touch_motion(struct libinput_device *device,
 		.slot = slot,
 		.seat_slot = seat_slot,
 		.point = *point,
+		.predicted = *predicted,
 	};
 
 	post_device_event(device, time,
@@ -2313,6 +3846,12 @@ touch_notify_touch_up(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
+	if (touch_frame_is_compact(device) &&
+	    touch_frame_update(device, slot, seat_slot,
+			       LIBINPUT_TOUCH_STATE_UP,
+			       NULL, NULL))
+		return;
+
 	touch_event = zalloc(sizeof *touch_event);
 	if (!touch_event)
 		return;
@@ -2333,18 +3872,34 @@ touch_notify_frame(struct libinput_device *device,
 		   uint64_t time)
 {
 	struct libinput_event_touch *touch_event;
+	unsigned int nslots = 0;
 
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
-	touch_event = zalloc(sizeof *touch_event);
-	if (!touch_event)
+	if (touch_frame_is_compact(device))
+		nslots = device->touch_frame.nslots;
+
+	touch_event = zalloc(sizeof *touch_event +
+			     nslots * sizeof(touch_event->frame_slots[0]));
+	if (!touch_event) {
+		if (nslots > 0)
+			touch_frame_advance(device);
 		return;
+	}
 
 	*touch_event = (struct libinput_event_touch) {
 		.time = time,
+		.nframe_slots = nslots,
 	};
 
+	if (nslots > 0)
+		memcpy(touch_event->frame_slots,
+		       device->touch_frame.slots,
+		       nslots * sizeof(touch_event->frame_slots[0]));
+	if (nslots > 0)
+		touch_frame_advance(device);
+
 	post_device_event(device, time,
 			  LIBINPUT_EVENT_TOUCH_FRAME,
 			  &touch_event->base);
@@ -2356,11 +3911,14 @@ tablet_notify_axis(struct libinput_device *device,
 		   struct libinput_tablet_tool *tool,
 		   enum libinput_tablet_tool_tip_state tip_state,
 		   unsigned char *changed_axes,
-		   const struct tablet_axes *axes)
+		   const struct tablet_axes *axes,
+		   const struct tablet_history_sample *history,
+		   unsigned int nhistory)
 {
 	struct libinput_event_tablet_tool *axis_event;
 
-	axis_event = zalloc(sizeof *axis_event);
+	axis_event = zalloc(sizeof *axis_event +
+			    nhistory * sizeof(axis_event->history[0]));
 	if (!axis_event)
 		return;
 
@@ -2370,11 +3928,16 @@ tablet_notify_axis(struct libinput_device *device,
 		.proximity_state = LIBINPUT_TABLET_TOOL_PROXIMITY_STATE_IN,
 		.tip_state = tip_state,
 		.axes = *axes,
+		.nhistory = nhistory,
 	};
 
 	memcpy(axis_event->changed_axes,
 	       changed_axes,
 	       sizeof(axis_event->changed_axes));
+	if (nhistory > 0)
+		memcpy(axis_event->history,
+		       history,
+		       nhistory * sizeof(axis_event->history[0]));
 
 	post_device_event(device,
 			  time,
@@ -2723,9 +4286,31 @@ switch_notify_toggle(struct libinput_device *device,
 			  &switch_event->base);
 }
 
+static inline void
+latency_record(struct libinput_device *device,
+	       enum libinput_latency_stage stage,
+	       uint64_t from,
+	       uint64_t to)
+{
+	struct libinput_latency_stats *stats = &device->latency[stage - 1];
+	uint64_t latency = to > from ? to - from : 0;
+	unsigned int bucket = 0;
+
+	while (latency >> (bucket + 1) &&
+	       bucket < LIBINPUT_LATENCY_STATS_BUCKETS - 1)
+		bucket++;
+
+	stats->count++;
+	stats->sum_usec += latency;
+	stats->max_usec = max(stats->max_usec, latency);
+	stats->buckets[bucket]++;
+}
+
+/* time is the event's timestamp in µs, or 0 for events without one */
 static void
 libinput_post_event(struct libinput *libinput,
-		    struct libinput_event *event)
+		    struct libinput_event *event,
+		    uint64_t time)
 {
 	struct libinput_event **events = libinput->events;
 	size_t events_len = libinput->events_len;
@@ -2764,12 +4349,26 @@ libinput_post_event(struct libinput *libinput,
 		libinput->events_len = events_len;
 	}
 
-	if (event->device)
+	if (event->device) {
 		libinput_device_ref(event->device);
 
+		/* A timer event's time is the timer's expiry, not a kernel
+		 * timestamp, it only counts for the time spent queued */
+		if (time != 0 && libinput->latency_accounting) {
+			event->queue_time = libinput_now(libinput);
+			if (!libinput->timer.expiring)
+				latency_record(event->device,
+					       LIBINPUT_LATENCY_STAGE_PROCESSING,
+					       time,
+					       event->queue_time);
+		}
+	}
+
 	libinput->events_count = events_count;
 	events[libinput->events_in] = event;
 	libinput->events_in = (libinput->events_in + 1) % libinput->events_len;
+
+	trace_probe4(post__event, event, event->device, event->type, time);
 }
 
 LIBINPUT_EXPORT struct libinput_event *
@@ -2785,6 +4384,14 @@ libinput_get_event(struct libinput *libinput)
 		(libinput->events_out + 1) % libinput->events_len;
 	libinput->events_count--;
 
+	if (event->queue_time != 0)
+		latency_record(event->device,
+			       LIBINPUT_LATENCY_STAGE_QUEUED,
+			       event->queue_time,
+			       libinput_now(libinput));
+
+	trace_probe3(get__event, event, event->device, event->type);
+
 	return event;
 }
 
@@ -2941,6 +4548,81 @@ libinput_device_keyboard_has_key(struct libinput_device *device, uint32_t code)
 	return evdev_device_has_key((struct evdev_device *)device, code);
 }
 
+LIBINPUT_EXPORT size_t
+libinput_device_get_latency_stats(struct libinput_device *device,
+				  enum libinput_latency_stage stage,
+				  struct libinput_latency_stats *stats,
+				  size_t size)
+{
+	switch (stage) {
+	case LIBINPUT_LATENCY_STAGE_PROCESSING:
+	case LIBINPUT_LATENCY_STAGE_QUEUED:
+		break;
+	default:
+		log_bug_client(libinput_device_get_context(device),
+			       "Invalid latency stage %d\n",
+			       stage);
+		return 0;
+	}
+
+	size = min(size, sizeof(*stats));
+	memcpy(stats, &device->latency[stage - 1], size);
+
+	return size;
+}
+
+LIBINPUT_EXPORT size_t
+libinput_device_get_cpu_stats(struct libinput_device *device,
+			      enum libinput_cpu_stat stat,
+			      struct libinput_cpu_stats *stats,
+			      size_t size)
+{
+	if (stat < LIBINPUT_CPU_STAT_PROCESS ||
+	    stat > LIBINPUT_CPU_STAT_TIMERS) {
+		log_bug_client(libinput_device_get_context(device),
+			       "Invalid CPU stat %d\n",
+			       stat);
+		return 0;
+	}
+
+	size = min(size, sizeof(*stats));
+	memcpy(stats, &device->cpu[stat - 1], size);
+
+	return size;
+}
+
+LIBINPUT_EXPORT size_t
+libinput_device_get_middle_emulation_stats(struct libinput_device *device,
+					   struct libinput_middle_emulation_stats *stats,
+					   size_t size)
+{
+	struct libinput_middle_emulation_stats s;
+
+	if (!evdev_middlebutton_get_stats((struct evdev_device *)device, &s))
+		return 0;
+
+	size = min(size, sizeof(*stats));
+	memcpy(stats, &s, size);
+
+	return size;
+}
+
+LIBINPUT_EXPORT size_t
+libinput_device_get_timestamp_stats(struct libinput_device *device,
+				    struct libinput_timestamp_stats *stats,
+				    size_t size)
+{
+	struct libinput_timestamp_stats s;
+
+	if (!evdev_msc_timestamp_get_stats((struct evdev_device *)device, &s))
+		return 0;
+
+	size = min(size, sizeof(*stats));
+	memcpy(stats, &s, size);
+
+	return size;
+}
+
 LIBINPUT_EXPORT int
 libinput_device_tablet_pad_get_num_buttons(struct libinput_device *device)
 {
@@ -3561,6 +5243,39 @@ libinput_device_config_tap_get_default_drag_lock_enabled(struct libinput_device
 	return device->config.tap->get_default_draglock_enabled(device);
 }
 
+LIBINPUT_EXPORT enum libinput_config_status
+libinput_device_config_tap_set_speculative_enabled(struct libinput_device *device,
+						   enum libinput_config_tap_speculative_state enable)
+{
+	if (enable != LIBINPUT_CONFIG_TAP_SPECULATIVE_ENABLED &&
+	    enable != LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED)
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+
+	if (libinput_device_config_tap_get_finger_count(device) == 0)
+		return enable ? LIBINPUT_CONFIG_STATUS_UNSUPPORTED :
+				LIBINPUT_CONFIG_STATUS_SUCCESS;
+
+	return device->config.tap->set_speculative_enabled(device, enable);
+}
+
+LIBINPUT_EXPORT enum libinput_config_tap_speculative_state
+libinput_device_config_tap_get_speculative_enabled(struct libinput_device *device)
+{
+	if (libinput_device_config_tap_get_finger_count(device) == 0)
+		return LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED;
+
+	return device->config.tap->get_speculative_enabled(device);
+}
+
+LIBINPUT_EXPORT enum libinput_config_tap_speculative_state
+libinput_device_config_tap_get_default_speculative_enabled(struct libinput_device *device)
+{
+	if (libinput_device_config_tap_get_finger_count(device) == 0)
+		return LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED;
+
+	return device->config.tap->get_default_speculative_enabled(device);
+}
+
 LIBINPUT_EXPORT int
 libinput_device_config_calibration_has_matrix(struct libinput_device *device)
 {
@@ -4026,6 +5741,130 @@ libinput_device_config_dwt_get_default_enabled(struct libinput_device *device)
 	return device->config.dwt->get_default_enabled(device);
 }
 
+LIBINPUT_EXPORT int
+libinput_device_config_smoothing_is_available(struct libinput_device *device)
+{
+	if (!device->config.smoothing)
+		return 0;
+
+	return device->config.smoothing->is_available(device);
+}
+
+LIBINPUT_EXPORT enum libinput_config_status
+libinput_device_config_smoothing_set_enabled(struct libinput_device *device,
+					     enum libinput_config_smoothing_state enable)
+{
+	if (enable != LIBINPUT_CONFIG_SMOOTHING_ENABLED &&
+	    enable != LIBINPUT_CONFIG_SMOOTHING_DISABLED)
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+
+	if (!libinput_device_config_smoothing_is_available(device))
+		return enable ? LIBINPUT_CONFIG_STATUS_UNSUPPORTED :
+				LIBINPUT_CONFIG_STATUS_SUCCESS;
+
+	return device->config.smoothing->set_enabled(device, enable);
+}
+
+LIBINPUT_EXPORT enum libinput_config_smoothing_state
+libinput_device_config_smoothing_get_enabled(struct libinput_device *device)
+{
+	if (!libinput_device_config_smoothing_is_available(device))
+		return LIBINPUT_CONFIG_SMOOTHING_DISABLED;
+
+	return device->config.smoothing->get_enabled(device);
+}
+
+LIBINPUT_EXPORT enum libinput_config_smoothing_state
+libinput_device_config_smoothing_get_default_enabled(struct libinput_device *device)
+{
+	if (!libinput_device_config_smoothing_is_available(device))
+		return LIBINPUT_CONFIG_SMOOTHING_DISABLED;
+
+	return device->config.smoothing->get_default_enabled(device);
+}
+
+LIBINPUT_EXPORT int
+libinput_device_config_prediction_is_available(struct libinput_device *device)
+{
+	if (!device->config.prediction)
+		return 0;
+
+	return device->config.prediction->is_available(device);
+}
+
+LIBINPUT_EXPORT enum libinput_config_status
+libinput_device_config_prediction_set_time(struct libinput_device *device,
+					   unsigned int ms)
+{
+	if (!libinput_device_config_prediction_is_available(device))
+		return ms ? LIBINPUT_CONFIG_STATUS_UNSUPPORTED :
+			    LIBINPUT_CONFIG_STATUS_SUCCESS;
+
+	if (ms > PREDICTION_MAX_TIME_MS)
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+
+	return device->config.prediction->set_time(device, ms);
+}
+
+LIBINPUT_EXPORT unsigned int
+libinput_device_config_prediction_get_time(struct libinput_device *device)
+{
+	if (!libinput_device_config_prediction_is_available(device))
+		return 0;
+
+	return device->config.prediction->get_time(device);
+}
+
+LIBINPUT_EXPORT unsigned int
+libinput_device_config_prediction_get_default_time(struct libinput_device *device)
+{
+	if (!libinput_device_config_prediction_is_available(device))
+		return 0;
+
+	return device->config.prediction->get_default_time(device);
+}
+
+LIBINPUT_EXPORT int
+libinput_device_config_tablet_history_is_available(struct libinput_device *device)
+{
+	if (!device->config.tablet_history)
+		return 0;
+
+	return device->config.tablet_history->is_available(device);
+}
+
+LIBINPUT_EXPORT enum libinput_config_status
+libinput_device_config_tablet_history_set_window(struct libinput_device *device,
+						 unsigned int ms)
+{
+	if (!libinput_device_config_tablet_history_is_available(device))
+		return ms ? LIBINPUT_CONFIG_STATUS_UNSUPPORTED :
+			    LIBINPUT_CONFIG_STATUS_SUCCESS;
+
+	if (ms > TABLET_HISTORY_MAX_WINDOW_MS)
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+
+	return device->config.tablet_history->set_window(device, ms);
+}
+
+LIBINPUT_EXPORT unsigned int
+libinput_device_config_tablet_history_get_window(struct libinput_device *device)
+{
+	if (!libinput_device_config_tablet_history_is_available(device))
+		return 0;
+
+	return device->config.tablet_history->get_window(device);
+}
+
+LIBINPUT_EXPORT unsigned int
+libinput_device_config_tablet_history_get_default_window(struct libinput_device *device)
+{
+	if (!libinput_device_config_tablet_history_is_available(device))
+		return 0;
+
+	return device->config.tablet_history->get_default_window(device);
+}
+
 LIBINPUT_EXPORT int
 libinput_device_config_rotation_is_available(struct libinput_device *device)
 {
@@ -46,6 +46,16 @@ extern "C" {
  */
 struct libinput;
 
+/**
+ * @ingroup base
+ * @struct libinput_loop
+ *
+ * An event loop shared by several libinput contexts, see
+ * libinput_loop_create(). This struct is refcounted, use
+ * libinput_loop_ref() and libinput_loop_unref().
+ */
+struct libinput_loop;
+
 /**
  * @ingroup device
  * @struct libinput_device
@@ -676,7 +686,9 @@ enum libinput_event_type {
 	LIBINPUT_EVENT_TOUCH_CANCEL,
 	/**
 	 * Signals the end of a set of touchpoints at one device sample
-	 * time. This event has no coordinate information attached.
+	 * time. This event has no coordinate information attached, unless
+	 * compact touch frames are enabled, see
+	 * libinput_set_compact_touch_frames().
 	 */
 	LIBINPUT_EVENT_TOUCH_FRAME,
 
@@ -1025,6 +1037,40 @@ uint32_t
 libinput_event_keyboard_get_seat_key_count(
 	struct libinput_event_keyboard *event);
 
+/**
+ * @ingroup event_keyboard
+ *
+ * All fields of a keyboard event, see libinput_event_keyboard_get_data().
+ *
+ * New fields are only ever added at the end of this struct.
+ */
+struct libinput_event_keyboard_data {
+	/** See libinput_event_keyboard_get_time_usec() */
+	uint64_t time_usec;
+	/** See libinput_event_keyboard_get_key() */
+	uint32_t key;
+	/** See libinput_event_keyboard_get_key_state() */
+	enum libinput_key_state state;
+	/** See libinput_event_keyboard_get_seat_key_count() */
+	uint32_t seat_key_count;
+};
+
+/**
+ * @ingroup event_keyboard
+ *
+ * Fill data with all fields of this event. See
+ * libinput_event_pointer_get_data() for how the size is handled.
+ *
+ * @param event The libinput keyboard event
+ * @param data The struct to fill
+ * @param size The size of the struct in bytes
+ * @return The number of bytes filled, or 0 for an invalid event type
+ */
+size_t
+libinput_event_keyboard_get_data(struct libinput_event_keyboard *event,
+				 struct libinput_event_keyboard_data *data,
+				 size_t size);
+
 /**
  * @defgroup event_pointer Pointer events
  *
@@ -1391,6 +1437,82 @@ libinput_event_pointer_get_axis_value_discrete(struct libinput_event_pointer *ev
 struct libinput_event *
 libinput_event_pointer_get_base_event(struct libinput_event_pointer *event);
 
+/**
+ * @ingroup event_pointer
+ *
+ * All fields of a pointer event, see libinput_event_pointer_get_data().
+ * Fields that do not apply to the event type are zero.
+ *
+ * New fields are only ever added at the end of this struct.
+ */
+struct libinput_event_pointer_data {
+	/** See libinput_event_pointer_get_time_usec() */
+	uint64_t time_usec;
+
+	/** See libinput_event_pointer_get_dx() */
+	double dx;
+	/** See libinput_event_pointer_get_dy() */
+	double dy;
+	/** See libinput_event_pointer_get_dx_unaccelerated() */
+	double dx_unaccelerated;
+	/** See libinput_event_pointer_get_dy_unaccelerated() */
+	double dy_unaccelerated;
+
+	/** See libinput_event_pointer_get_absolute_x() */
+	double absolute_x;
+	/** See libinput_event_pointer_get_absolute_y() */
+	double absolute_y;
+	/** The absolute x coordinate in the range [0, 1), multiplied by the
+	 * screen width this is libinput_event_pointer_get_absolute_x_transformed() */
+	double absolute_x_fraction;
+	/** The absolute y coordinate in the range [0, 1), multiplied by the
+	 * screen height this is libinput_event_pointer_get_absolute_y_transformed() */
+	double absolute_y_fraction;
+
+	/** See libinput_event_pointer_get_button() */
+	uint32_t button;
+	/** See libinput_event_pointer_get_button_state() */
+	enum libinput_button_state button_state;
+	/** See libinput_event_pointer_get_seat_button_count() */
+	uint32_t seat_button_count;
+
+	/** A bitmask of (1 << @ref libinput_pointer_axis) for the axes
+	 * set in this event, see libinput_event_pointer_has_axis() */
+	uint32_t axes;
+	/** See libinput_event_pointer_get_axis_source() */
+	enum libinput_pointer_axis_source axis_source;
+	/** See libinput_event_pointer_get_axis_value() */
+	double axis_value_vertical;
+	/** See libinput_event_pointer_get_axis_value() */
+	double axis_value_horizontal;
+	/** See libinput_event_pointer_get_axis_value_discrete() */
+	double axis_value_discrete_vertical;
+	/** See libinput_event_pointer_get_axis_value_discrete() */
+	double axis_value_discrete_horizontal;
+};
+
+/**
+ * @ingroup event_pointer
+ *
+ * Fill data with all fields of this event. This is equivalent to calling
+ * each accessor of this event but checks the event type only once.
+ *
+ * The caller passes the size of its struct, usually
+ * sizeof(struct libinput_event_pointer_data). If the caller's struct is
+ * smaller than the one known to libinput, only the fields that fit are
+ * filled. If it is larger, the fields not known to libinput are left
+ * untouched.
+ *
+ * @param event The libinput pointer event
+ * @param data The struct to fill
+ * @param size The size of the struct in bytes
+ * @return The number of bytes filled, or 0 for an invalid event type
+ */
+size_t
+libinput_event_pointer_get_data(struct libinput_event_pointer *event,
+				struct libinput_event_pointer_data *data,
+				size_t size);
+
 /**
  * @defgroup event_touch Touch events
  *
@@ -1539,6 +1661,98 @@ double
 libinput_event_touch_get_y_transformed(struct libinput_event_touch *event,
 				       uint32_t height);
 
+/**
+ * @ingroup event_touch
+ *
+ * Return the predicted absolute x coordinate of the touch event, in mm
+ * from the top left corner of the device. The prediction extrapolates the
+ * recent motion of the touch by the time configured with
+ * libinput_device_config_prediction_set_time(). If prediction is disabled
+ * or not available, this function returns the same value as
+ * libinput_event_touch_get_x(). See @ref touch_prediction for details.
+ *
+ * For events not of type @ref LIBINPUT_EVENT_TOUCH_DOWN, @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION, this function returns 0.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_DOWN or @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION.
+ *
+ * @param event The libinput touch event
+ * @return The predicted absolute x coordinate
+ */
+double
+libinput_event_touch_get_predicted_x(struct libinput_event_touch *event);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the predicted absolute y coordinate of the touch event, in mm
+ * from the top left corner of the device. The prediction extrapolates the
+ * recent motion of the touch by the time configured with
+ * libinput_device_config_prediction_set_time(). If prediction is disabled
+ * or not available, this function returns the same value as
+ * libinput_event_touch_get_y(). See @ref touch_prediction for details.
+ *
+ * For events not of type @ref LIBINPUT_EVENT_TOUCH_DOWN, @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION, this function returns 0.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_DOWN or @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION.
+ *
+ * @param event The libinput touch event
+ * @return The predicted absolute y coordinate
+ */
+double
+libinput_event_touch_get_predicted_y(struct libinput_event_touch *event);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the predicted absolute x coordinate of the touch event,
+ * transformed to screen coordinates. See
+ * libinput_event_touch_get_predicted_x() for details.
+ *
+ * For events not of type @ref LIBINPUT_EVENT_TOUCH_DOWN, @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION, this function returns 0.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_DOWN or @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION.
+ *
+ * @param event The libinput touch event
+ * @param width The current output screen width
+ * @return The predicted absolute x coordinate transformed to a screen
+ * coordinate
+ */
+double
+libinput_event_touch_get_predicted_x_transformed(struct libinput_event_touch *event,
+						 uint32_t width);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the predicted absolute y coordinate of the touch event,
+ * transformed to screen coordinates. See
+ * libinput_event_touch_get_predicted_y() for details.
+ *
+ * For events not of type @ref LIBINPUT_EVENT_TOUCH_DOWN, @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION, this function returns 0.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_DOWN or @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION.
+ *
+ * @param event The libinput touch event
+ * @param height The current output screen height
+ * @return The predicted absolute y coordinate transformed to a screen
+ * coordinate
+ */
+double
+libinput_event_touch_get_predicted_y_transformed(struct libinput_event_touch *event,
+						 uint32_t height);
+
 /**
  * @ingroup event_touch
  *
@@ -1547,6 +1761,321 @@ libinput_event_touch_get_y_transformed(struct libinput_event_touch *event,
 struct libinput_event *
 libinput_event_touch_get_base_event(struct libinput_event_touch *event);
 
+/**
+ * @ingroup event_touch
+ *
+ * All fields of a touch event, see libinput_event_touch_get_data().
+ * Fields that do not apply to the event type are zero.
+ *
+ * New fields are only ever added at the end of this struct.
+ */
+struct libinput_event_touch_data {
+	/** See libinput_event_touch_get_time_usec() */
+	uint64_t time_usec;
+	/** See libinput_event_touch_get_slot() */
+	int32_t slot;
+	/** See libinput_event_touch_get_seat_slot() */
+	int32_t seat_slot;
+	/** See libinput_event_touch_get_x() */
+	double x;
+	/** See libinput_event_touch_get_y() */
+	double y;
+	/** The x coordinate in the range [0, 1), multiplied by the screen
+	 * width this is libinput_event_touch_get_x_transformed() */
+	double x_fraction;
+	/** The y coordinate in the range [0, 1), multiplied by the screen
+	 * height this is libinput_event_touch_get_y_transformed() */
+	double y_fraction;
+	/** See libinput_event_touch_get_predicted_x() */
+	double predicted_x;
+	/** See libinput_event_touch_get_predicted_y() */
+	double predicted_y;
+	/** The predicted x coordinate in the range [0, 1), see x_fraction */
+	double predicted_x_fraction;
+	/** The predicted y coordinate in the range [0, 1), see y_fraction */
+	double predicted_y_fraction;
+};
+
+/**
+ * @ingroup event_touch
+ *
+ * Fill data with all fields of this event. This is equivalent to calling
+ * each accessor of this event but checks the event type only once. See
+ * libinput_event_pointer_get_data() for how the size is handled.
+ *
+ * @param event The libinput touch event
+ * @param data The struct to fill
+ * @param size The size of the struct in bytes
+ * @return The number of bytes filled, or 0 for an invalid event type
+ */
+size_t
+libinput_event_touch_get_data(struct libinput_event_touch *event,
+			      struct libinput_event_touch_data *data,
+			      size_t size);
+
+/**
+ * @ingroup event_touch
+ *
+ * The state of a touch in a compact touch frame, see
+ * libinput_set_compact_touch_frames().
+ */
+enum libinput_touch_state {
+	/** The touch was set down in this frame */
+	LIBINPUT_TOUCH_STATE_DOWN = 1,
+	/** The touch moved in this frame */
+	LIBINPUT_TOUCH_STATE_MOTION,
+	/** The touch is down but did not change in this frame */
+	LIBINPUT_TOUCH_STATE_STATIONARY,
+	/** The touch was lifted in this frame */
+	LIBINPUT_TOUCH_STATE_UP,
+};
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the number of touches in a compact touch frame. This includes
+ * all touches that are down and the touches that were lifted in this
+ * frame. If compact touch frames are not enabled, this function returns
+ * zero.
+ *
+ * For events not of type @ref LIBINPUT_EVENT_TOUCH_FRAME, this function
+ * returns 0.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_FRAME.
+ *
+ * @param event The libinput touch event
+ * @return The number of touches in this frame
+ *
+ * @see libinput_set_compact_touch_frames
+ */
+unsigned int
+libinput_event_touch_get_frame_touch_count(struct libinput_event_touch *event);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the state of the touch at the given index in a compact touch
+ * frame.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_FRAME or with an index equal to or
+ * larger than libinput_event_touch_get_frame_touch_count().
+ *
+ * @param event The libinput touch event
+ * @param index The index of the touch, starting at 0
+ * @return The state of the touch in this frame
+ */
+enum libinput_touch_state
+libinput_event_touch_get_frame_touch_state(struct libinput_event_touch *event,
+					   unsigned int index);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the slot of the touch at the given index in a compact touch
+ * frame, see libinput_event_touch_get_slot() for details.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_FRAME or with an index equal to or
+ * larger than libinput_event_touch_get_frame_touch_count().
+ *
+ * @param event The libinput touch event
+ * @param index The index of the touch, starting at 0
+ * @return The slot of the touch
+ */
+int32_t
+libinput_event_touch_get_frame_touch_slot(struct libinput_event_touch *event,
+					  unsigned int index);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the seat slot of the touch at the given index in a compact touch
+ * frame, see libinput_event_touch_get_seat_slot() for details.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_FRAME or with an index equal to or
+ * larger than libinput_event_touch_get_frame_touch_count().
+ *
+ * @param event The libinput touch event
+ * @param index The index of the touch, starting at 0
+ * @return The seat slot of the touch
+ */
+int32_t
+libinput_event_touch_get_frame_touch_seat_slot(struct libinput_event_touch *event,
+					       unsigned int index);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the current absolute x coordinate of the touch at the given
+ * index in a compact touch frame, in mm from the top left corner of the
+ * device. For a touch in state @ref LIBINPUT_TOUCH_STATE_UP, this is the
+ * last known position.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_FRAME or with an index equal to or
+ * larger than libinput_event_touch_get_frame_touch_count().
+ *
+ * @param event The libinput touch event
+ * @param index The index of the touch, starting at 0
+ * @return The current absolute x coordinate
+ */
+double
+libinput_event_touch_get_frame_touch_x(struct libinput_event_touch *event,
+				       unsigned int index);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the current absolute y coordinate of the touch at the given
+ * index in a compact touch frame, in mm from the top left corner of the
+ * device. For a touch in state @ref LIBINPUT_TOUCH_STATE_UP, this is the
+ * last known position.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_FRAME or with an index equal to or
+ * larger than libinput_event_touch_get_frame_touch_count().
+ *
+ * @param event The libinput touch event
+ * @param index The index of the touch, starting at 0
+ * @return The current absolute y coordinate
+ */
+double
+libinput_event_touch_get_frame_touch_y(struct libinput_event_touch *event,
+				       unsigned int index);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the current absolute x coordinate of the touch at the given
+ * index in a compact touch frame, transformed to screen coordinates.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_FRAME or with an index equal to or
+ * larger than libinput_event_touch_get_frame_touch_count().
+ *
+ * @param event The libinput touch event
+ * @param index The index of the touch, starting at 0
+ * @param width The current output screen width
+ * @return The current absolute x coordinate transformed to a screen
+ * coordinate
+ */
+double
+libinput_event_touch_get_frame_touch_x_transformed(struct libinput_event_touch *event,
+						   unsigned int index,
+						   uint32_t width);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the current absolute y coordinate of the touch at the given
+ * index in a compact touch frame, transformed to screen coordinates.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_FRAME or with an index equal to or
+ * larger than libinput_event_touch_get_frame_touch_count().
+ *
+ * @param event The libinput touch event
+ * @param index The index of the touch, starting at 0
+ * @param height The current output screen height
+ * @return The current absolute y coordinate transformed to a screen
+ * coordinate
+ */
+double
+libinput_event_touch_get_frame_touch_y_transformed(struct libinput_event_touch *event,
+						   unsigned int index,
+						   uint32_t height);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the predicted absolute x coordinate of the touch at the given
+ * index in a compact touch frame, in mm from the top left corner of the
+ * device. See libinput_event_touch_get_predicted_x() for details. For a
+ * touch in state @ref LIBINPUT_TOUCH_STATE_STATIONARY or @ref
+ * LIBINPUT_TOUCH_STATE_UP, this is the same value as
+ * libinput_event_touch_get_frame_touch_x().
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_FRAME or with an index equal to or
+ * larger than libinput_event_touch_get_frame_touch_count().
+ *
+ * @param event The libinput touch event
+ * @param index The index of the touch, starting at 0
+ * @return The predicted absolute x coordinate
+ */
+double
+libinput_event_touch_get_frame_touch_predicted_x(struct libinput_event_touch *event,
+						 unsigned int index);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the predicted absolute y coordinate of the touch at the given
+ * index in a compact touch frame, in mm from the top left corner of the
+ * device. See libinput_event_touch_get_predicted_y() for details. For a
+ * touch in state @ref LIBINPUT_TOUCH_STATE_STATIONARY or @ref
+ * LIBINPUT_TOUCH_STATE_UP, this is the same value as
+ * libinput_event_touch_get_frame_touch_y().
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_FRAME or with an index equal to or
+ * larger than libinput_event_touch_get_frame_touch_count().
+ *
+ * @param event The libinput touch event
+ * @param index The index of the touch, starting at 0
+ * @return The predicted absolute y coordinate
+ */
+double
+libinput_event_touch_get_frame_touch_predicted_y(struct libinput_event_touch *event,
+						 unsigned int index);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the predicted absolute x coordinate of the touch at the given
+ * index in a compact touch frame, transformed to screen coordinates. See
+ * libinput_event_touch_get_frame_touch_predicted_x() for details.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_FRAME or with an index equal to or
+ * larger than libinput_event_touch_get_frame_touch_count().
+ *
+ * @param event The libinput touch event
+ * @param index The index of the touch, starting at 0
+ * @param width The current output screen width
+ * @return The predicted absolute x coordinate transformed to a screen
+ * coordinate
+ */
+double
+libinput_event_touch_get_frame_touch_predicted_x_transformed(struct libinput_event_touch *event,
+							     unsigned int index,
+							     uint32_t width);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the predicted absolute y coordinate of the touch at the given
+ * index in a compact touch frame, transformed to screen coordinates. See
+ * libinput_event_touch_get_frame_touch_predicted_y() for details.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_FRAME or with an index equal to or
+ * larger than libinput_event_touch_get_frame_touch_count().
+ *
+ * @param event The libinput touch event
+ * @param index The index of the touch, starting at 0
+ * @param height The current output screen height
+ * @return The predicted absolute y coordinate transformed to a screen
+ * coordinate
+ */
+double
+libinput_event_touch_get_frame_touch_predicted_y_transformed(struct libinput_event_touch *event,
+							     unsigned int index,
+							     uint32_t height);
+
 /**
  * @defgroup event_gesture Gesture events
  *
@@ -2203,25 +2732,285 @@ libinput_event_tablet_tool_get_y_transformed(struct libinput_event_tablet_tool *
 /**
  * @ingroup event_tablet
  *
- * Returns the tool that was in use during this event.
- *
- * The returned tablet tool is not refcounted and may become invalid after
- * the next call to libinput. Use libinput_tablet_tool_ref() and
- * libinput_tablet_tool_unref() to continue using the handle outside of the
- * immediate scope.
- *
- * If the caller holds at least one reference, this struct is used
- * whenever the tools enters proximity again.
-  *
- * @note Physical tool tracking requires hardware support. If unavailable,
- * libinput creates one tool per type per tablet. See @ref
- * tablet-serial-numbers for more details.
+ * Return the predicted x coordinate of the tablet tool, in mm from the
+ * top left corner of the tablet in its current logical orientation. The
+ * prediction extrapolates the recent motion of the tool by the time
+ * configured with libinput_device_config_prediction_set_time(). If
+ * prediction is disabled or not available, this function returns the same
+ * value as libinput_event_tablet_tool_get_x(). See @ref
+ * touch_prediction for details.
  *
  * @param event The libinput tablet tool event
- * @return The new tool triggering this event
+ * @return The predicted axis value of this event
  */
-struct libinput_tablet_tool *
-libinput_event_tablet_tool_get_tool(struct libinput_event_tablet_tool *event);
+double
+libinput_event_tablet_tool_get_predicted_x(struct libinput_event_tablet_tool *event);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the predicted y coordinate of the tablet tool, in mm from the
+ * top left corner of the tablet in its current logical orientation. The
+ * prediction extrapolates the recent motion of the tool by the time
+ * configured with libinput_device_config_prediction_set_time(). If
+ * prediction is disabled or not available, this function returns the same
+ * value as libinput_event_tablet_tool_get_y(). See @ref
+ * touch_prediction for details.
+ *
+ * @param event The libinput tablet tool event
+ * @return The predicted axis value of this event
+ */
+double
+libinput_event_tablet_tool_get_predicted_y(struct libinput_event_tablet_tool *event);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the predicted x coordinate of the tablet tool, transformed to
+ * screen coordinates. See libinput_event_tablet_tool_get_predicted_x()
+ * for details.
+ *
+ * @param event The libinput tablet tool event
+ * @param width The current output screen width
+ * @return the predicted absolute x coordinate transformed to a screen
+ * coordinate
+ */
+double
+libinput_event_tablet_tool_get_predicted_x_transformed(struct libinput_event_tablet_tool *event,
+						       uint32_t width);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the predicted y coordinate of the tablet tool, transformed to
+ * screen coordinates. See libinput_event_tablet_tool_get_predicted_y()
+ * for details.
+ *
+ * @param event The libinput tablet tool event
+ * @param height The current output screen height
+ * @return the predicted absolute y coordinate transformed to a screen
+ * coordinate
+ */
+double
+libinput_event_tablet_tool_get_predicted_y_transformed(struct libinput_event_tablet_tool *event,
+						       uint32_t height);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the number of historical samples in this event. If a merge window
+ * is set with libinput_device_config_tablet_history_set_window(), the
+ * axis frames within that window are merged into one event of type @ref
+ * LIBINPUT_EVENT_TABLET_TOOL_AXIS. The axis values of the event are those
+ * of the most recent frame, relative axes like the wheel and the delta are
+ * the sum of all frames. The earlier frames are available as historical
+ * samples, ordered oldest first. See @ref tablet-history for details.
+ *
+ * For events other than @ref LIBINPUT_EVENT_TABLET_TOOL_AXIS and if the
+ * merge window is zero, this function returns 0.
+ *
+ * @param event The libinput tablet tool event
+ * @return The number of historical samples in this event
+ */
+unsigned int
+libinput_event_tablet_tool_get_history_size(struct libinput_event_tablet_tool *event);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the timestamp of the historical sample at the given index, see
+ * libinput_event_tablet_tool_get_history_size() for details.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TABLET_TOOL_AXIS or with an index equal to
+ * or larger than libinput_event_tablet_tool_get_history_size().
+ *
+ * @param event The libinput tablet tool event
+ * @param index The index of the sample, starting at 0 for the oldest sample
+ * @return The timestamp of the sample in microseconds
+ */
+uint64_t
+libinput_event_tablet_tool_get_history_time_usec(struct libinput_event_tablet_tool *event,
+						  unsigned int index);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the X coordinate of the historical sample at the given index, see
+ * libinput_event_tablet_tool_get_history_size() for details.
+ * The coordinate is in mm from the top left corner of the device, as
+ * returned by libinput_event_tablet_tool_get_x().
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TABLET_TOOL_AXIS or with an index equal to
+ * or larger than libinput_event_tablet_tool_get_history_size().
+ *
+ * @param event The libinput tablet tool event
+ * @param index The index of the sample, starting at 0 for the oldest sample
+ * @return The X coordinate of the sample in mm
+ */
+double
+libinput_event_tablet_tool_get_history_x(struct libinput_event_tablet_tool *event,
+					 unsigned int index);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the Y coordinate of the historical sample at the given index, see
+ * libinput_event_tablet_tool_get_history_size() for details.
+ * The coordinate is in mm from the top left corner of the device, as
+ * returned by libinput_event_tablet_tool_get_y().
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TABLET_TOOL_AXIS or with an index equal to
+ * or larger than libinput_event_tablet_tool_get_history_size().
+ *
+ * @param event The libinput tablet tool event
+ * @param index The index of the sample, starting at 0 for the oldest sample
+ * @return The Y coordinate of the sample in mm
+ */
+double
+libinput_event_tablet_tool_get_history_y(struct libinput_event_tablet_tool *event,
+					 unsigned int index);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the X coordinate, transformed to screen coordinates, of the historical sample at the given index, see
+ * libinput_event_tablet_tool_get_history_size() for details.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TABLET_TOOL_AXIS or with an index equal to
+ * or larger than libinput_event_tablet_tool_get_history_size().
+ *
+ * @param event The libinput tablet tool event
+ * @param index The index of the sample, starting at 0 for the oldest sample
+ * @param width The current output screen width
+ * @return The X coordinate of the sample transformed to a screen coordinate
+ */
+double
+libinput_event_tablet_tool_get_history_x_transformed(struct libinput_event_tablet_tool *event,
+						     unsigned int index,
+						     uint32_t width);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the Y coordinate, transformed to screen coordinates, of the historical sample at the given index, see
+ * libinput_event_tablet_tool_get_history_size() for details.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TABLET_TOOL_AXIS or with an index equal to
+ * or larger than libinput_event_tablet_tool_get_history_size().
+ *
+ * @param event The libinput tablet tool event
+ * @param index The index of the sample, starting at 0 for the oldest sample
+ * @param height The current output screen height
+ * @return The Y coordinate of the sample transformed to a screen coordinate
+ */
+double
+libinput_event_tablet_tool_get_history_y_transformed(struct libinput_event_tablet_tool *event,
+						     unsigned int index,
+						     uint32_t height);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the pressure of the historical sample at the given index, see
+ * libinput_event_tablet_tool_get_history_size() for details.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TABLET_TOOL_AXIS or with an index equal to
+ * or larger than libinput_event_tablet_tool_get_history_size().
+ *
+ * @param event The libinput tablet tool event
+ * @param index The index of the sample, starting at 0 for the oldest sample
+ * @return The normalized pressure of the sample, see
+ * libinput_event_tablet_tool_get_pressure()
+ */
+double
+libinput_event_tablet_tool_get_history_pressure(struct libinput_event_tablet_tool *event,
+						unsigned int index);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the tilt along the X axis of the historical sample at the given index, see
+ * libinput_event_tablet_tool_get_history_size() for details.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TABLET_TOOL_AXIS or with an index equal to
+ * or larger than libinput_event_tablet_tool_get_history_size().
+ *
+ * @param event The libinput tablet tool event
+ * @param index The index of the sample, starting at 0 for the oldest sample
+ * @return The tilt along the X axis of the sample in degrees, see
+ * libinput_event_tablet_tool_get_tilt_x()
+ */
+double
+libinput_event_tablet_tool_get_history_tilt_x(struct libinput_event_tablet_tool *event,
+					      unsigned int index);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the tilt along the Y axis of the historical sample at the given index, see
+ * libinput_event_tablet_tool_get_history_size() for details.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TABLET_TOOL_AXIS or with an index equal to
+ * or larger than libinput_event_tablet_tool_get_history_size().
+ *
+ * @param event The libinput tablet tool event
+ * @param index The index of the sample, starting at 0 for the oldest sample
+ * @return The tilt along the Y axis of the sample in degrees, see
+ * libinput_event_tablet_tool_get_tilt_y()
+ */
+double
+libinput_event_tablet_tool_get_history_tilt_y(struct libinput_event_tablet_tool *event,
+					      unsigned int index);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the rotation of the historical sample at the given index, see
+ * libinput_event_tablet_tool_get_history_size() for details.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TABLET_TOOL_AXIS or with an index equal to
+ * or larger than libinput_event_tablet_tool_get_history_size().
+ *
+ * @param event The libinput tablet tool event
+ * @param index The index of the sample, starting at 0 for the oldest sample
+ * @return The rotation of the sample in degrees, see
+ * libinput_event_tablet_tool_get_rotation()
+ */
+double
+libinput_event_tablet_tool_get_history_rotation(struct libinput_event_tablet_tool *event,
+						unsigned int index);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Returns the tool that was in use during this event.
+ *
+ * The returned tablet tool is not refcounted and may become invalid after
+ * the next call to libinput. Use libinput_tablet_tool_ref() and
+ * libinput_tablet_tool_unref() to continue using the handle outside of the
+ * immediate scope.
+ *
+ * If the caller holds at least one reference, this struct is used
+ * whenever the tools enters proximity again.
+  *
+ * @note Physical tool tracking requires hardware support. If unavailable,
+ * libinput creates one tool per type per tablet. See @ref
+ * tablet-serial-numbers for more details.
+ *
+ * @param event The libinput tablet tool event
+ * @return The new tool triggering this event
+ */
+struct libinput_tablet_tool *
+libinput_event_tablet_tool_get_tool(struct libinput_event_tablet_tool *event);
 
 /**
  * @ingroup event_tablet
@@ -2297,6 +3086,183 @@ libinput_event_tablet_tool_get_button_state(struct libinput_event_tablet_tool *e
 uint32_t
 libinput_event_tablet_tool_get_seat_button_count(struct libinput_event_tablet_tool *event);
 
+/**
+ * @ingroup event_tablet
+ *
+ * Bits in libinput_event_tablet_tool_data.changed, one for each axis with
+ * an @c _has_changed() accessor.
+ */
+enum libinput_tablet_tool_data_changed {
+	LIBINPUT_TABLET_TOOL_DATA_CHANGED_X = (1 << 1),
+	LIBINPUT_TABLET_TOOL_DATA_CHANGED_Y = (1 << 2),
+	LIBINPUT_TABLET_TOOL_DATA_CHANGED_DISTANCE = (1 << 3),
+	LIBINPUT_TABLET_TOOL_DATA_CHANGED_PRESSURE = (1 << 4),
+	LIBINPUT_TABLET_TOOL_DATA_CHANGED_TILT_X = (1 << 5),
+	LIBINPUT_TABLET_TOOL_DATA_CHANGED_TILT_Y = (1 << 6),
+	LIBINPUT_TABLET_TOOL_DATA_CHANGED_ROTATION = (1 << 7),
+	LIBINPUT_TABLET_TOOL_DATA_CHANGED_SLIDER = (1 << 8),
+	LIBINPUT_TABLET_TOOL_DATA_CHANGED_WHEEL = (1 << 9),
+};
+
+/**
+ * @ingroup event_tablet
+ *
+ * All fields of a tablet tool event, see
+ * libinput_event_tablet_tool_get_data(). The axis fields are filled for
+ * all tablet tool event types, including @ref
+ * LIBINPUT_EVENT_TABLET_TOOL_BUTTON. The button fields are zero for
+ * anything but @ref LIBINPUT_EVENT_TABLET_TOOL_BUTTON.
+ *
+ * New fields are only ever added at the end of this struct.
+ */
+struct libinput_event_tablet_tool_data {
+	/** See libinput_event_tablet_tool_get_time_usec() */
+	uint64_t time_usec;
+	/** See libinput_event_tablet_tool_get_tool(). The tool is not
+	 * refcounted, it is only valid as long as the event is */
+	struct libinput_tablet_tool *tool;
+	/** See libinput_event_tablet_tool_get_proximity_state() */
+	enum libinput_tablet_tool_proximity_state proximity_state;
+	/** See libinput_event_tablet_tool_get_tip_state() */
+	enum libinput_tablet_tool_tip_state tip_state;
+	/** A bitmask of @ref libinput_tablet_tool_data_changed */
+	uint32_t changed;
+
+	/** See libinput_event_tablet_tool_get_x() */
+	double x;
+	/** See libinput_event_tablet_tool_get_y() */
+	double y;
+	/** The x coordinate in the range [0, 1), multiplied by the screen
+	 * width this is libinput_event_tablet_tool_get_x_transformed() */
+	double x_fraction;
+	/** The y coordinate in the range [0, 1), multiplied by the screen
+	 * height this is libinput_event_tablet_tool_get_y_transformed() */
+	double y_fraction;
+	/** See libinput_event_tablet_tool_get_dx() */
+	double dx;
+	/** See libinput_event_tablet_tool_get_dy() */
+	double dy;
+	/** See libinput_event_tablet_tool_get_pressure() */
+	double pressure;
+	/** See libinput_event_tablet_tool_get_distance() */
+	double distance;
+	/** See libinput_event_tablet_tool_get_tilt_x() */
+	double tilt_x;
+	/** See libinput_event_tablet_tool_get_tilt_y() */
+	double tilt_y;
+	/** See libinput_event_tablet_tool_get_rotation() */
+	double rotation;
+	/** See libinput_event_tablet_tool_get_slider_position() */
+	double slider;
+	/** See libinput_event_tablet_tool_get_wheel_delta() */
+	double wheel_delta;
+	/** See libinput_event_tablet_tool_get_wheel_delta_discrete() */
+	int wheel_delta_discrete;
+
+	/** See libinput_event_tablet_tool_get_button() */
+	uint32_t button;
+	/** See libinput_event_tablet_tool_get_button_state() */
+	enum libinput_button_state button_state;
+	/** See libinput_event_tablet_tool_get_seat_button_count() */
+	uint32_t seat_button_count;
+
+	/** See libinput_tablet_tool_get_type() */
+	enum libinput_tablet_tool_type tool_type;
+	/** See libinput_tablet_tool_get_serial() */
+	uint64_t tool_serial;
+};
+
+/**
+ * @ingroup event_tablet
+ *
+ * Fill data with all fields of this event. This is equivalent to calling
+ * each accessor of this event but checks the event type only once. See
+ * libinput_event_pointer_get_data() for how the size is handled.
+ *
+ * @param event The libinput tablet tool event
+ * @param data The struct to fill
+ * @param size The size of the struct in bytes
+ * @return The number of bytes filled, or 0 for an invalid event type
+ */
+size_t
+libinput_event_tablet_tool_get_data(struct libinput_event_tablet_tool *event,
+				    struct libinput_event_tablet_tool_data *data,
+				    size_t size);
+
+/**
+ * @ingroup event
+ *
+ * The maximum size in bytes of an event serialized with
+ * libinput_event_serialize(). A buffer of this size can hold any event
+ * this version of libinput can serialize.
+ */
+#define LIBINPUT_EVENT_SERIALIZED_MAX_SIZE 256
+
+/**
+ * @ingroup event
+ *
+ * The data of a parsed event, see libinput_event_parse(). The member
+ * filled depends on the event type.
+ */
+union libinput_event_data {
+	struct libinput_event_keyboard_data keyboard;
+	struct libinput_event_pointer_data pointer;
+	struct libinput_event_touch_data touch;
+	struct libinput_event_tablet_tool_data tablet_tool;
+};
+
+/**
+ * @ingroup event
+ *
+ * Write the event into the buffer in the compact binary format described
+ * in @ref event_serialization. The format is independent of the libinput
+ * version and the architecture, the buffer may be passed to a different
+ * process or machine and read back with libinput_event_parse().
+ *
+ * Only keyboard key, pointer, touch and tablet tool events can be
+ * serialized. The device the event belongs to is not part of the
+ * serialized data.
+ *
+ * If size is smaller than the size required, nothing is written and the
+ * required size is returned. The required size is never larger than @ref
+ * LIBINPUT_EVENT_SERIALIZED_MAX_SIZE.
+ *
+ * @param event The libinput event
+ * @param buffer The buffer to write to
+ * @param size The size of the buffer in bytes
+ * @return The number of bytes required for this event, or 0 if the event
+ * type cannot be serialized
+ */
+size_t
+libinput_event_serialize(struct libinput_event *event,
+			 void *buffer,
+			 size_t size);
+
+/**
+ * @ingroup event
+ *
+ * Parse one event written by libinput_event_serialize(). On success, type
+ * is set to the event type and the matching member of data is filled as
+ * the respective get_data function would, e.g.
+ * libinput_event_pointer_get_data() for a pointer event. Pointers to
+ * libinput objects, e.g. the tablet tool, are always NULL. See
+ * libinput_event_pointer_get_data() for how data_size is handled.
+ *
+ * @param buffer The serialized event
+ * @param size The number of bytes available in the buffer
+ * @param type Set to the event type on success
+ * @param data The data to fill
+ * @param data_size The size of data in bytes
+ * @return The number of bytes consumed, or 0 if the buffer does not start
+ * with a complete event this version of libinput understands
+ */
+size_t
+libinput_event_parse(const void *buffer,
+		     size_t size,
+		     enum libinput_event_type *type,
+		     union libinput_event_data *data,
+		     size_t data_size);
+
 /**
  * @ingroup event_tablet
  *
@@ -2890,11 +3856,45 @@ libinput_udev_create_context(const struct libinput_interface *interface,
  * @param seat_id A seat identifier. This string must not be NULL.
  *
  * @return 0 on success or -1 on failure.
+ *
+ * @see libinput_udev_assign_seats
  */
 int
 libinput_udev_assign_seat(struct libinput *libinput,
 			  const char *seat_id);
 
+/**
+ * @ingroup base
+ *
+ * Assign a set of seats to this libinput context. This behaves like
+ * libinput_udev_assign_seat() but the context handles the devices of all
+ * given seats, with a single udev monitor and a single enumeration pass
+ * over the input devices.
+ *
+ * The seat a device belongs to is available through
+ * libinput_device_get_seat(), the physical seat name as returned by
+ * libinput_seat_get_physical_name() is the seat identifier the device was
+ * assigned to. Devices on different physical seats never share a @ref
+ * libinput_seat, even if their logical seat names are the same.
+ *
+ * This function may only be called once per context and is mutually
+ * exclusive with libinput_udev_assign_seat().
+ *
+ * @param libinput A libinput context initialized with
+ * libinput_udev_create_context()
+ * @param seat_ids An array of seat identifiers. Neither the array nor any
+ * of its elements may be NULL.
+ * @param nseats The number of elements in seat_ids, must be greater than 0
+ *
+ * @return 0 on success or -1 on failure.
+ *
+ * @see libinput_udev_assign_seat
+ */
+int
+libinput_udev_assign_seats(struct libinput *libinput,
+			   const char * const *seat_ids,
+			   size_t nseats);
+
 /**
  * @ingroup base
  *
@@ -2969,6 +3969,9 @@ libinput_path_remove_device(struct libinput_device *device);
  * libinput keeps a single file descriptor for all events. Call into
  * libinput_dispatch() if any events become available on this fd.
  *
+ * If the context is attached to a loop, this is the loop's file
+ * descriptor, see libinput_loop_attach().
+ *
  * @return The file descriptor used to notify of pending events.
  */
 int
@@ -2989,11 +3992,100 @@ libinput_get_fd(struct libinput *libinput);
  *
  * @param libinput A previously initialized libinput context
  *
+ * If the context is attached to a loop, this dispatches all contexts
+ * attached to that loop, see libinput_loop_attach().
+ *
  * @return 0 on success, or a negative errno on failure
  */
 int
 libinput_dispatch(struct libinput *libinput);
 
+/**
+ * @ingroup base
+ *
+ * Create a loop that several libinput contexts can share, e.g. one
+ * context per seat in the same process. Contexts attached to the loop
+ * share one file descriptor and one timer, see libinput_loop_attach().
+ *
+ * @return A new loop with a refcount of 1, or NULL on failure
+ *
+ * @see libinput_loop_unref
+ */
+struct libinput_loop *
+libinput_loop_create(void);
+
+/**
+ * @ingroup base
+ *
+ * Add a reference to the loop.
+ *
+ * @param loop A previously created loop
+ * @return The passed loop
+ */
+struct libinput_loop *
+libinput_loop_ref(struct libinput_loop *loop);
+
+/**
+ * @ingroup base
+ *
+ * Remove a reference from the loop. Each attached context holds a
+ * reference, the loop is destroyed once the last attached context has
+ * been destroyed.
+ *
+ * @param loop A previously created loop
+ * @return NULL if the loop was destroyed, otherwise the passed loop
+ */
+struct libinput_loop *
+libinput_loop_unref(struct libinput_loop *loop);
+
+/**
+ * @ingroup base
+ *
+ * Attach a context to the loop. From then on, libinput_get_fd() returns
+ * the loop's file descriptor and libinput_dispatch() dispatches all
+ * contexts attached to the loop. The events are still queued on each
+ * context, the caller must call libinput_get_event() on every attached
+ * context after dispatching.
+ *
+ * A context can only be attached to one loop and cannot be detached, it
+ * stays attached until it is destroyed. Attaching is best done before
+ * adding devices or assigning a seat, the caller must not poll on the
+ * context's previous file descriptor afterwards.
+ *
+ * @param loop A previously created loop
+ * @param libinput A previously initialized libinput context
+ * @return 0 on success, or a negative errno on failure
+ *
+ * @see libinput_loop_dispatch
+ */
+int
+libinput_loop_attach(struct libinput_loop *loop, struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * The file descriptor for all contexts attached to this loop. Call into
+ * libinput_loop_dispatch() if any events become available on this fd.
+ *
+ * @param loop A previously created loop
+ * @return The file descriptor used to notify of pending events
+ */
+int
+libinput_loop_get_fd(struct libinput_loop *loop);
+
+/**
+ * @ingroup base
+ *
+ * Dispatch all contexts attached to the loop, the equivalent of
+ * libinput_dispatch() for each of them. Use libinput_get_event() on
+ * each context to retrieve the events.
+ *
+ * @param loop A previously created loop
+ * @return 0 on success, or a negative errno on failure
+ */
+int
+libinput_loop_dispatch(struct libinput_loop *loop);
+
 /**
  * @ingroup base
  *
@@ -3120,6 +4212,116 @@ libinput_ref(struct libinput *libinput);
 struct libinput *
 libinput_unref(struct libinput *libinput);
 
+/**
+ * @ingroup base
+ *
+ * Enable or disable compact touch frames. By default, every touch that
+ * changes state in a device frame generates an event of type
+ * @ref LIBINPUT_EVENT_TOUCH_DOWN, @ref LIBINPUT_EVENT_TOUCH_MOTION or
+ * @ref LIBINPUT_EVENT_TOUCH_UP, followed by one @ref
+ * LIBINPUT_EVENT_TOUCH_FRAME event.
+ *
+ * With compact touch frames enabled, touch devices only generate the
+ * @ref LIBINPUT_EVENT_TOUCH_FRAME event. That event carries the
+ * position and state of all touches on the device, see
+ * libinput_event_touch_get_frame_touch_count() and related functions.
+ *
+ * This function may be called at any time. Touches that are already
+ * down when compact touch frames are enabled are included in the next
+ * frame, in state @ref LIBINPUT_TOUCH_STATE_STATIONARY unless they
+ * changed. A touch that is set down and lifted within the same device
+ * frame is included twice, once in state @ref LIBINPUT_TOUCH_STATE_DOWN
+ * and once in state @ref LIBINPUT_TOUCH_STATE_UP, both at the position
+ * of the touch down.
+ *
+ * Compact touch frames are disabled by default.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param enable Non-zero to enable compact touch frames, zero to disable
+ * them
+ *
+ * @see libinput_get_compact_touch_frames
+ */
+void
+libinput_set_compact_touch_frames(struct libinput *libinput, int enable);
+
+/**
+ * @ingroup base
+ *
+ * Check whether compact touch frames are enabled.
+ *
+ * @param libinput A previously initialized libinput context
+ * @return Non-zero if compact touch frames are enabled, zero otherwise
+ *
+ * @see libinput_set_compact_touch_frames
+ */
+int
+libinput_get_compact_touch_frames(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Enable or disable CPU accounting. With CPU accounting enabled, libinput
+ * measures the time spent in each device's event processing and its
+ * subsystems, see libinput_device_get_cpu_stats().
+ *
+ * CPU accounting reads the clock twice for every measured section, on
+ * busy devices this is a noticeable overhead. When disabled, the cost is
+ * negligible. CPU accounting is disabled by default.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param enable Non-zero to enable CPU accounting, zero to disable it
+ *
+ * @see libinput_get_cpu_accounting
+ */
+void
+libinput_set_cpu_accounting(struct libinput *libinput, int enable);
+
+/**
+ * @ingroup base
+ *
+ * Check whether CPU accounting is enabled.
+ *
+ * @param libinput A previously initialized libinput context
+ * @return Non-zero if CPU accounting is enabled, zero otherwise
+ *
+ * @see libinput_set_cpu_accounting
+ */
+int
+libinput_get_cpu_accounting(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Enable or disable latency accounting. With latency accounting enabled,
+ * libinput records how long each event took to be processed and queued,
+ * see libinput_device_get_latency_stats().
+ *
+ * Latency accounting reads the clock twice for every event, on busy
+ * devices this is a noticeable overhead. Latency accounting is disabled
+ * by default.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param enable Non-zero to enable latency accounting, zero to disable it
+ *
+ * @see libinput_get_latency_accounting
+ */
+void
+libinput_set_latency_accounting(struct libinput *libinput, int enable);
+
+/**
+ * @ingroup base
+ *
+ * Check whether latency accounting is enabled.
+ *
+ * @param libinput A previously initialized libinput context
+ * @return Non-zero if latency accounting is enabled, zero otherwise
+ *
+ * @see libinput_set_latency_accounting
+ */
+int
+libinput_get_latency_accounting(struct libinput *libinput);
+
 /**
  * @ingroup base
  *
@@ -3182,17 +4384,74 @@ typedef void (*libinput_log_handler)(struct libinput *libinput,
  * higher than the context's log priority will be passed to the given
  * log handler.
  *
- * The default log handler prints to stderr.
+ * The default log handler prints to stderr.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param log_handler The log handler for library messages.
+ *
+ * @see libinput_log_set_priority
+ * @see libinput_log_get_priority
+ */
+void
+libinput_log_set_handler(struct libinput *libinput,
+			 libinput_log_handler log_handler);
+
+/**
+ * @ingroup base
+ *
+ * Enable or disable the trace buffer. Where the trace buffer is enabled,
+ * libinput records the debug messages of its internal state machines in
+ * memory without formatting them, independent of the log priority.
+ * Recording a message is cheap enough to leave the trace buffer enabled
+ * at all times, the messages are only formatted when dumped with
+ * libinput_log_dump_trace().
+ *
+ * The buffer is a ring, once full, the oldest messages are overwritten.
+ * The size is rounded up to the next power of two. Changing the size
+ * discards all messages recorded so far. The trace buffer is disabled by
+ * default.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param size The number of messages to keep, or 0 to disable the trace
+ * buffer
+ * @return 0 on success or a negative errno on failure
+ *
+ * @see libinput_log_get_trace_buffer
+ * @see libinput_log_dump_trace
+ */
+int
+libinput_log_set_trace_buffer(struct libinput *libinput, unsigned int size);
+
+/**
+ * @ingroup base
+ *
+ * Get the size of the trace buffer.
+ *
+ * @param libinput A previously initialized libinput context
+ * @return The number of messages the trace buffer holds, or 0 if the
+ * trace buffer is disabled
+ *
+ * @see libinput_log_set_trace_buffer
+ */
+unsigned int
+libinput_log_get_trace_buffer(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Pass the messages in the trace buffer to the context's log handler,
+ * oldest first, with a priority of @ref LIBINPUT_LOG_PRIORITY_DEBUG.
+ * The context's log priority does not apply. The trace buffer is empty
+ * afterwards.
+ *
+ * If the trace buffer is disabled, this function does nothing.
  *
  * @param libinput A previously initialized libinput context
- * @param log_handler The log handler for library messages.
  *
- * @see libinput_log_set_priority
- * @see libinput_log_get_priority
+ * @see libinput_log_set_trace_buffer
  */
 void
-libinput_log_set_handler(struct libinput *libinput,
-			 libinput_log_handler log_handler);
+libinput_log_dump_trace(struct libinput *libinput);
 
 /**
  * @defgroup seat Initialization and manipulation of seats
@@ -3690,6 +4949,242 @@ libinput_device_tablet_pad_get_num_rings(struct libinput_device *device);
 int
 libinput_device_tablet_pad_get_num_strips(struct libinput_device *device);
 
+/**
+ * @ingroup device
+ *
+ * The stages of an event's latency, see
+ * libinput_device_get_latency_stats().
+ */
+enum libinput_latency_stage {
+	/**
+	 * From the kernel's timestamp of the input event to the libinput
+	 * event being added to the event queue, i.e. the time spent
+	 * before and during libinput_dispatch(). Events posted by a
+	 * timer, e.g. the button release of a tap, have no kernel
+	 * timestamp and are not recorded in this stage.
+	 */
+	LIBINPUT_LATENCY_STAGE_PROCESSING = 1,
+	/**
+	 * From the event being added to the event queue to the caller
+	 * retrieving it with libinput_get_event().
+	 */
+	LIBINPUT_LATENCY_STAGE_QUEUED,
+};
+
+/**
+ * @ingroup device
+ *
+ * The number of buckets in struct libinput_latency_stats.
+ */
+#define LIBINPUT_LATENCY_STATS_BUCKETS 20
+
+/**
+ * @ingroup device
+ *
+ * A latency histogram, see libinput_device_get_latency_stats().
+ *
+ * New fields are only ever added at the end of this struct.
+ */
+struct libinput_latency_stats {
+	/** The number of events recorded */
+	uint64_t count;
+	/** The sum of all latencies in µs */
+	uint64_t sum_usec;
+	/** The largest latency in µs */
+	uint64_t max_usec;
+	/**
+	 * Bucket n counts the latencies of at least 2^n µs and less than
+	 * 2^(n+1) µs. Bucket 0 includes latencies of 0 µs, the last bucket
+	 * includes all latencies above its lower bound.
+	 */
+	uint64_t buckets[LIBINPUT_LATENCY_STATS_BUCKETS];
+};
+
+/**
+ * @ingroup device
+ *
+ * Get the latency histogram of one stage of this device's events. libinput
+ * records the latency of every event with a timestamp while latency
+ * accounting is enabled, see libinput_set_latency_accounting(). Events
+ * without a timestamp, e.g. @ref LIBINPUT_EVENT_DEVICE_ADDED, are not
+ * recorded.
+ *
+ * The caller passes the size of its struct, usually
+ * sizeof(struct libinput_latency_stats), see
+ * libinput_event_pointer_get_data() for how the size is handled.
+ *
+ * @param device A current input device
+ * @param stage The latency stage
+ * @param stats The struct to fill
+ * @param size The size of the struct in bytes
+ * @return The number of bytes filled, or 0 for an invalid stage
+ */
+size_t
+libinput_device_get_latency_stats(struct libinput_device *device,
+				  enum libinput_latency_stage stage,
+				  struct libinput_latency_stats *stats,
+				  size_t size);
+
+/**
+ * @ingroup device
+ *
+ * The sections measured by CPU accounting, see
+ * libinput_device_get_cpu_stats(). Sections nest, e.g. the time spent in
+ * @ref LIBINPUT_CPU_STAT_TOUCHPAD_TAP is also included in @ref
+ * LIBINPUT_CPU_STAT_PROCESS.
+ */
+enum libinput_cpu_stat {
+	/** All processing of the device's evdev events */
+	LIBINPUT_CPU_STAT_PROCESS = 1,
+	/** Pointer acceleration */
+	LIBINPUT_CPU_STAT_POINTER_ACCEL,
+	/** The touchpad tapping state machine */
+	LIBINPUT_CPU_STAT_TOUCHPAD_TAP,
+	/** The touchpad software button state machine and button events */
+	LIBINPUT_CPU_STAT_TOUCHPAD_BUTTONS,
+	/** The touchpad edge scrolling state machine and scroll events */
+	LIBINPUT_CPU_STAT_TOUCHPAD_EDGE_SCROLL,
+	/** The touchpad gesture state machine, two-finger scrolling and
+	 * pointer motion */
+	LIBINPUT_CPU_STAT_TOUCHPAD_GESTURES,
+	/** Touchpad palm and thumb detection */
+	LIBINPUT_CPU_STAT_TOUCHPAD_PALM,
+	/** The device's timer callbacks, e.g. the tap timeout */
+	LIBINPUT_CPU_STAT_TIMERS,
+};
+
+/**
+ * @ingroup device
+ *
+ * The time spent in one section, see libinput_device_get_cpu_stats().
+ *
+ * New fields are only ever added at the end of this struct.
+ */
+struct libinput_cpu_stats {
+	/** The number of times the section was entered */
+	uint64_t calls;
+	/** The total time spent in the section in ns */
+	uint64_t nsec;
+};
+
+/**
+ * @ingroup device
+ *
+ * Get the time spent in one section of this device's processing while
+ * CPU accounting was enabled, see libinput_set_cpu_accounting(). The
+ * time is measured with CLOCK_MONOTONIC, preemption during a section is
+ * included.
+ *
+ * The caller passes the size of its struct, usually
+ * sizeof(struct libinput_cpu_stats), see
+ * libinput_event_pointer_get_data() for how the size is handled.
+ *
+ * @param device A current input device
+ * @param stat The section
+ * @param stats The struct to fill
+ * @param size The size of the struct in bytes
+ * @return The number of bytes filled, or 0 for an invalid section
+ */
+size_t
+libinput_device_get_cpu_stats(struct libinput_device *device,
+			      enum libinput_cpu_stat stat,
+			      struct libinput_cpu_stats *stats,
+			      size_t size);
+
+/**
+ * @ingroup device
+ *
+ * Statistics on the middle button emulation, see
+ * libinput_device_get_middle_emulation_stats().
+ *
+ * New fields are only ever added at the end of this struct.
+ */
+struct libinput_middle_emulation_stats {
+	/** The number of middle button presses emulated */
+	uint64_t chords;
+	/**
+	 * The number of left and right button presses that were too late
+	 * for the current timeout but would have made the default one.
+	 * These count towards the timeout like a chord.
+	 */
+	uint64_t missed;
+	/**
+	 * The time in µs that libinput currently waits for the other
+	 * button before a left or right button press is passed on.
+	 */
+	uint64_t timeout_usec;
+};
+
+/**
+ * @ingroup device
+ *
+ * Get the statistics the middle button emulation adapts its timeout
+ * from, see @ref middle_button_emulation. The statistics are kept while
+ * the middle button emulation is disabled.
+ *
+ * The caller passes the size of its struct, usually
+ * sizeof(struct libinput_middle_emulation_stats), see
+ * libinput_event_pointer_get_data() for how the size is handled.
+ *
+ * @param device A current input device
+ * @param stats The struct to fill
+ * @param size The size of the struct in bytes
+ * @return The number of bytes filled, or 0 if the device does not support
+ * middle button emulation
+ */
+size_t
+libinput_device_get_middle_emulation_stats(struct libinput_device *device,
+					   struct libinput_middle_emulation_stats *stats,
+					   size_t size);
+
+/**
+ * @ingroup device
+ *
+ * Statistics on the hardware timestamps of a device, see
+ * libinput_device_get_timestamp_stats().
+ *
+ * New fields are only ever added at the end of this struct.
+ */
+struct libinput_timestamp_stats {
+	/** The number of frames with a hardware timestamp */
+	uint64_t frames;
+	/**
+	 * The number of frames the kernel delivered in less than half the
+	 * time the hardware timestamps say passed since the previous
+	 * frame, i.e. the frames were batched.
+	 */
+	uint64_t batched;
+	/**
+	 * The number of frames where the hardware timestamp was unusable,
+	 * e.g. because the device reset its counter, and the kernel's
+	 * timestamp was used instead.
+	 */
+	uint64_t resyncs;
+};
+
+/**
+ * @ingroup device
+ *
+ * Get the statistics on how often the kernel's and the device's timing
+ * of the events disagree. libinput uses the hardware timestamps (the
+ * evdev MSC_TIMESTAMP event) to time frames the kernel delivered in a
+ * batch.
+ *
+ * The caller passes the size of its struct, usually
+ * sizeof(struct libinput_timestamp_stats), see
+ * libinput_event_pointer_get_data() for how the size is handled.
+ *
+ * @param device A current input device
+ * @param stats The struct to fill
+ * @param size The size of the struct in bytes
+ * @return The number of bytes filled, or 0 if the device does not send
+ * hardware timestamps
+ */
+size_t
+libinput_device_get_timestamp_stats(struct libinput_device *device,
+				    struct libinput_timestamp_stats *stats,
+				    size_t size);
+
 /**
  * @ingroup device
  *
@@ -3779,6 +5274,7 @@ libinput_device_group_get_user_data(struct libinput_device_group *group);
  *    - libinput_device_config_dwt_set_enabled()
  * - Touchscreens:
  *    - libinput_device_config_calibration_set_matrix()
+ *    - libinput_device_config_smoothing_set_enabled()
  * - Pointer devices (mice, trackballs, touchpads):
  *    - libinput_device_config_accel_set_speed()
  *    - libinput_device_config_accel_set_profile()
@@ -4136,6 +5632,92 @@ libinput_device_config_tap_get_drag_lock_enabled(struct libinput_device *device)
 enum libinput_config_drag_lock_state
 libinput_device_config_tap_get_default_drag_lock_enabled(struct libinput_device *device);
 
+/**
+ * @ingroup config
+ */
+enum libinput_config_tap_speculative_state {
+	/** Speculative tapping is to be disabled, or is currently disabled */
+	LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED,
+	/** Speculative tapping is to be enabled, or is currently enabled */
+	LIBINPUT_CONFIG_TAP_SPECULATIVE_ENABLED,
+};
+
+/**
+ * @ingroup config
+ *
+ * Enable or disable speculative tapping on this device. By default, a
+ * single-finger tap holds the button logically down until the
+ * tap-and-drag timeout expires, so the click is only complete once it is
+ * certain the tap is not the start of a drag or a double-tap. When
+ * speculative tapping is enabled, the button press and release are sent
+ * as soon as the finger lifts. If the tap turns out to be the start of a
+ * tap-and-drag or a double-tap, the button is pressed again when the
+ * next finger comes down. A tap-and-drag is thus seen by the caller as
+ * a click followed by a button press, see @ref tapping_speculative for
+ * details.
+ *
+ * Speculative tapping only affects single-finger taps, two- and
+ * three-finger taps are always sent on finger up. The change takes
+ * effect once no tap sequence is in progress.
+ *
+ * Enabling speculative tapping on a device that has tapping disabled is
+ * permitted, but has no effect until tapping is enabled.
+ *
+ * @param device The device to configure
+ * @param enable @ref LIBINPUT_CONFIG_TAP_SPECULATIVE_ENABLED to enable
+ * speculative tapping or @ref LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED to
+ * disable it
+ *
+ * @return A config status code. Disabling speculative tapping on a device
+ * that does not support tapping always succeeds.
+ *
+ * @see libinput_device_config_tap_get_speculative_enabled
+ * @see libinput_device_config_tap_get_default_speculative_enabled
+ */
+enum libinput_config_status
+libinput_device_config_tap_set_speculative_enabled(struct libinput_device *device,
+						   enum libinput_config_tap_speculative_state enable);
+
+/**
+ * @ingroup config
+ *
+ * Check if speculative tapping is enabled on this device. If the device
+ * does not support tapping, this function always returns
+ * @ref LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED.
+ *
+ * @param device The device to configure
+ *
+ * @retval LIBINPUT_CONFIG_TAP_SPECULATIVE_ENABLED If speculative tapping
+ * is currently enabled
+ * @retval LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED If speculative tapping
+ * is currently disabled
+ *
+ * @see libinput_device_config_tap_set_speculative_enabled
+ * @see libinput_device_config_tap_get_default_speculative_enabled
+ */
+enum libinput_config_tap_speculative_state
+libinput_device_config_tap_get_speculative_enabled(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Check if speculative tapping is enabled by default on this device. If
+ * the device does not support tapping, this function always returns
+ * @ref LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED.
+ *
+ * @param device The device to configure
+ *
+ * @retval LIBINPUT_CONFIG_TAP_SPECULATIVE_ENABLED If speculative tapping
+ * is enabled by default
+ * @retval LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED If speculative tapping
+ * is disabled by default
+ *
+ * @see libinput_device_config_tap_set_speculative_enabled
+ * @see libinput_device_config_tap_get_speculative_enabled
+ */
+enum libinput_config_tap_speculative_state
+libinput_device_config_tap_get_default_speculative_enabled(struct libinput_device *device);
+
 /**
  * @ingroup config
  *
@@ -5274,6 +6856,250 @@ libinput_device_config_rotation_get_angle(struct libinput_device *device);
 unsigned int
 libinput_device_config_rotation_get_default_angle(struct libinput_device *device);
 
+/**
+ * @ingroup config
+ *
+ * Possible states for the touch smoothing feature. See @ref
+ * touch_smoothing for details.
+ */
+enum libinput_config_smoothing_state {
+	LIBINPUT_CONFIG_SMOOTHING_DISABLED,
+	LIBINPUT_CONFIG_SMOOTHING_ENABLED,
+};
+
+/**
+ * @ingroup config
+ *
+ * Check if this device supports adaptive smoothing of touch coordinates.
+ * This feature is available on touchpads and touchscreens. See @ref
+ * touch_smoothing for details.
+ *
+ * @param device The device to configure
+ * @return 0 if this device does not support touch smoothing, or 1
+ * otherwise.
+ *
+ * @see libinput_device_config_smoothing_set_enabled
+ * @see libinput_device_config_smoothing_get_enabled
+ * @see libinput_device_config_smoothing_get_default_enabled
+ */
+int
+libinput_device_config_smoothing_is_available(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Enable or disable adaptive smoothing of touch coordinates. When enabled,
+ * touch coordinates are low-pass filtered with a cutoff frequency that
+ * depends on the speed of the touch, reducing jitter of slow or stationary
+ * touches without adding noticeable lag to fast movements. See @ref
+ * touch_smoothing for details.
+ *
+ * @note Enabling or disabling touch smoothing may not take effect
+ * immediately.
+ *
+ * @param device The device to configure
+ * @param enable @ref LIBINPUT_CONFIG_SMOOTHING_DISABLED to disable
+ * touch smoothing, @ref LIBINPUT_CONFIG_SMOOTHING_ENABLED to enable
+ *
+ * @return A config status code. Disabling touch smoothing on a device that
+ * does not support the feature always succeeds.
+ *
+ * @see libinput_device_config_smoothing_is_available
+ * @see libinput_device_config_smoothing_get_enabled
+ * @see libinput_device_config_smoothing_get_default_enabled
+ */
+enum libinput_config_status
+libinput_device_config_smoothing_set_enabled(struct libinput_device *device,
+					     enum libinput_config_smoothing_state enable);
+
+/**
+ * @ingroup config
+ *
+ * Check if touch smoothing is currently enabled on this device. If the
+ * device does not support touch smoothing, this function returns @ref
+ * LIBINPUT_CONFIG_SMOOTHING_DISABLED.
+ *
+ * @param device The device to configure
+ * @return @ref LIBINPUT_CONFIG_SMOOTHING_DISABLED if disabled, @ref
+ * LIBINPUT_CONFIG_SMOOTHING_ENABLED if enabled.
+ *
+ * @see libinput_device_config_smoothing_is_available
+ * @see libinput_device_config_smoothing_set_enabled
+ * @see libinput_device_config_smoothing_get_default_enabled
+ */
+enum libinput_config_smoothing_state
+libinput_device_config_smoothing_get_enabled(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Check if touch smoothing is enabled on this device by default. If the
+ * device does not support touch smoothing, this function returns @ref
+ * LIBINPUT_CONFIG_SMOOTHING_DISABLED.
+ *
+ * @param device The device to configure
+ * @return @ref LIBINPUT_CONFIG_SMOOTHING_DISABLED if disabled, @ref
+ * LIBINPUT_CONFIG_SMOOTHING_ENABLED if enabled.
+ *
+ * @see libinput_device_config_smoothing_is_available
+ * @see libinput_device_config_smoothing_set_enabled
+ * @see libinput_device_config_smoothing_get_enabled
+ */
+enum libinput_config_smoothing_state
+libinput_device_config_smoothing_get_default_enabled(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Check if this device supports predicting the position of a touch or
+ * tablet tool ahead of the current time. See @ref touch_prediction for
+ * details.
+ *
+ * @param device The device to configure
+ * @return 0 if this device does not support prediction, or 1 otherwise.
+ *
+ * @see libinput_device_config_prediction_set_time
+ * @see libinput_device_config_prediction_get_time
+ * @see libinput_device_config_prediction_get_default_time
+ */
+int
+libinput_device_config_prediction_is_available(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Set the time in ms the predicted position is ahead of the current
+ * position. A time of 0 disables prediction, the predicted coordinates are
+ * then identical to the current coordinates. The maximum time is 100ms.
+ * See @ref touch_prediction for details.
+ *
+ * Prediction does not affect the coordinates returned by
+ * libinput_event_touch_get_x() and friends, it only affects the
+ * coordinates returned by libinput_event_touch_get_predicted_x() and
+ * libinput_event_tablet_tool_get_predicted_x() and friends.
+ *
+ * @param device The device to configure
+ * @param ms The prediction time in ms, or 0 to disable prediction
+ *
+ * @return A config status code. Disabling prediction on a device that does
+ * not support it always succeeds.
+ *
+ * @see libinput_device_config_prediction_is_available
+ * @see libinput_device_config_prediction_get_time
+ * @see libinput_device_config_prediction_get_default_time
+ */
+enum libinput_config_status
+libinput_device_config_prediction_set_time(struct libinput_device *device,
+					   unsigned int ms);
+
+/**
+ * @ingroup config
+ *
+ * Get the current prediction time in ms for this device. If the device
+ * does not support prediction, this function returns 0.
+ *
+ * @param device The device to configure
+ * @return The prediction time in ms, or 0 if prediction is disabled
+ *
+ * @see libinput_device_config_prediction_is_available
+ * @see libinput_device_config_prediction_set_time
+ * @see libinput_device_config_prediction_get_default_time
+ */
+unsigned int
+libinput_device_config_prediction_get_time(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Get the default prediction time in ms for this device. If the device
+ * does not support prediction, this function returns 0.
+ *
+ * @param device The device to configure
+ * @return The default prediction time in ms, or 0 if prediction is
+ * disabled by default
+ *
+ * @see libinput_device_config_prediction_is_available
+ * @see libinput_device_config_prediction_set_time
+ * @see libinput_device_config_prediction_get_time
+ */
+unsigned int
+libinput_device_config_prediction_get_default_time(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Check if this device supports merging tablet tool axis events into one
+ * event with historical samples. See @ref tablet-history for details.
+ *
+ * @param device The device to configure
+ * @return 0 if this device does not support merging axis events, or 1
+ * otherwise.
+ *
+ * @see libinput_device_config_tablet_history_set_window
+ * @see libinput_device_config_tablet_history_get_window
+ * @see libinput_device_config_tablet_history_get_default_window
+ */
+int
+libinput_device_config_tablet_history_is_available(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Set the window in ms within which tablet tool axis events are merged.
+ * All axis frames within the window are sent as one event of type @ref
+ * LIBINPUT_EVENT_TABLET_TOOL_AXIS once the window has passed, the earlier
+ * frames are available with libinput_event_tablet_tool_get_history_size()
+ * and friends. Any other event from the tool sends the pending axis event
+ * first. A window of 0 disables merging. The maximum window is 100ms.
+ * See @ref tablet-history for details.
+ *
+ * @param device The device to configure
+ * @param ms The merge window in ms, or 0 to disable merging
+ *
+ * @return A config status code. Disabling merging on a device that does
+ * not support it always succeeds.
+ *
+ * @see libinput_device_config_tablet_history_is_available
+ * @see libinput_device_config_tablet_history_get_window
+ * @see libinput_device_config_tablet_history_get_default_window
+ */
+enum libinput_config_status
+libinput_device_config_tablet_history_set_window(struct libinput_device *device,
+						 unsigned int ms);
+
+/**
+ * @ingroup config
+ *
+ * Get the current merge window in ms for this device. If the device does
+ * not support merging axis events, this function returns 0.
+ *
+ * @param device The device to configure
+ * @return The merge window in ms, or 0 if merging is disabled
+ *
+ * @see libinput_device_config_tablet_history_is_available
+ * @see libinput_device_config_tablet_history_set_window
+ * @see libinput_device_config_tablet_history_get_default_window
+ */
+unsigned int
+libinput_device_config_tablet_history_get_window(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Get the default merge window in ms for this device. If the device does
+ * not support merging axis events, this function returns 0.
+ *
+ * @param device The device to configure
+ * @return The default merge window in ms, or 0 if merging is disabled by
+ * default
+ *
+ * @see libinput_device_config_tablet_history_is_available
+ * @see libinput_device_config_tablet_history_set_window
+ * @see libinput_device_config_tablet_history_get_window
+ */
+unsigned int
+libinput_device_config_tablet_history_get_default_window(struct libinput_device *device);
+
 #ifdef __cplusplus
 }
 #endif
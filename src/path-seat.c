@@ -253,6 +253,10 @@ path_device_change_seat(struct libinput_device *device,
 	struct udev_device *udev_device = NULL;
 	int rc = -1;
 
+	/* we'd need the evdev state to re-create it */
+	if (evdev_device_is_virtual(evdev))
+		return -1;
+
 	udev_device = evdev->udev_device;
 	udev_device_ref(udev_device);
 	libinput_path_remove_device(device);
@@ -388,3 +392,86 @@ libinput_path_remove_device(struct libinput_device *device)
 	path_disable_device(libinput, evdev);
 	libinput_seat_unref(seat);
 }
+
+static const char *
+virtual_property(const char * const *properties, const char *name)
+{
+	for (; properties && properties[0] && properties[1]; properties += 2) {
+		if (streq(properties[0], name))
+			return properties[1];
+	}
+
+	return NULL;
+}
+
+/**
+ * Add a device without a device node to a path context, see
+ * evdev_device_create_virtual(). Virtual devices are not re-added after
+ * libinput_resume().
+ */
+struct libinput_device *
+path_add_virtual_device(struct libinput *libinput,
+			struct libevdev *evdev,
+			const char *sysname,
+			const char * const *properties,
+			int fd)
+{
+	struct path_input *input = (struct path_input *)libinput;
+	struct path_seat *seat;
+	struct evdev_device *device;
+	const char *seat_name, *seat_logical_name, *output_name;
+
+	if (libinput->interface_backend != &interface_backend) {
+		log_bug_client(libinput, "Mismatching backends.\n");
+		libevdev_free(evdev);
+		if (fd != -1)
+			close(fd);
+		return NULL;
+	}
+
+	seat_name = virtual_property(properties, "ID_SEAT");
+	if (!seat_name)
+		seat_name = default_seat;
+	seat_logical_name = virtual_property(properties, "WL_SEAT");
+	if (!seat_logical_name)
+		seat_logical_name = default_seat_name;
+
+	seat = path_seat_get_named(input, seat_name, seat_logical_name);
+	if (seat) {
+		libinput_seat_ref(&seat->base);
+	} else {
+		seat = path_seat_create(input, seat_name, seat_logical_name);
+		if (!seat) {
+			libevdev_free(evdev);
+			if (fd != -1)
+				close(fd);
+			return NULL;
+		}
+	}
+
+	device = evdev_device_create_virtual(&seat->base,
+					     evdev,
+					     sysname,
+					     properties,
+					     fd);
+	libinput_seat_unref(&seat->base);
+
+	if (device == EVDEV_UNHANDLED_DEVICE) {
+		log_info(libinput,
+			 "%-7s - not using virtual input device.\n",
+			 sysname);
+		return NULL;
+	} else if (device == NULL) {
+		log_info(libinput,
+			 "%-7s - failed to create virtual input device.\n",
+			 sysname);
+		return NULL;
+	}
+
+	evdev_read_calibration_prop(device);
+	output_name = evdev_device_get_udev_property(device, "WL_OUTPUT");
+	if (output_name)
+		device->output_name = strdup(output_name);
+
+	return &device->base;
+}
@@ -27,6 +27,8 @@
 #include "config.h"
 #include "libinput-private.h"
 
+struct libevdev;
+
 struct path_input {
 	struct libinput base;
 	struct udev *udev;
@@ -42,4 +44,11 @@ struct path_seat {
 	struct libinput_seat base;
 };
 
+struct libinput_device *
+path_add_virtual_device(struct libinput *libinput,
+			struct libevdev *evdev,
+			const char *sysname,
+			const char * const *properties,
+			int fd);
+
 #endif
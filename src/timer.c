@@ -26,46 +26,184 @@
 #include <assert.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/timerfd.h>
 #include <unistd.h>
 
 #include "libinput-private.h"
 #include "timer.h"
+#include "libinput-trace.h"
 
 void
 libinput_timer_init(struct libinput_timer *timer, struct libinput *libinput,
+		    struct libinput_device *device,
 		    void (*timer_func)(uint64_t now, void *timer_func_data),
 		    void *timer_func_data)
 {
 	timer->libinput = libinput;
+	timer->device = device;
 	timer->timer_func = timer_func;
 	timer->timer_func_data = timer_func_data;
 }
 
-static void
-libinput_timer_arm_timer_fd(struct libinput *libinput)
+static uint64_t
+libinput_timer_earliest_expire(struct libinput *libinput)
 {
-	int r;
 	struct libinput_timer *timer;
-	struct itimerspec its = { { 0, 0 }, { 0, 0 } };
 	uint64_t earliest_expire = UINT64_MAX;
 
+	/* virtual timers are expired by libinput_clock_set_time(), the
+	 * timerfd stays disarmed */
 	list_for_each(timer, &libinput->timer.list, link) {
+		if (libinput->clock)
+			break;
 		if (timer->expire < earliest_expire)
 			earliest_expire = timer->expire;
 	}
 
-	if (earliest_expire != UINT64_MAX) {
-		its.it_value.tv_sec = earliest_expire / ms2us(1000);
-		its.it_value.tv_nsec = (earliest_expire % ms2us(1000)) * 1000;
+	return earliest_expire;
+}
+
+static int
+timerfd_arm(int fd, uint64_t expire)
+{
+	struct itimerspec its = { { 0, 0 }, { 0, 0 } };
+
+	if (expire != UINT64_MAX) {
+		its.it_value.tv_sec = expire / ms2us(1000);
+		its.it_value.tv_nsec = (expire % ms2us(1000)) * 1000;
+	}
+
+	return timerfd_settime(fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+static void
+libinput_timer_arm_timer_fd(struct libinput *libinput)
+{
+	struct libinput_loop *loop = libinput->loop;
+	uint64_t earliest_expire;
+	int fd;
+
+	if (loop) {
+		/* libinput_loop_timer_handler() arms it once it's done */
+		if (loop->timer.expiring)
+			return;
+
+		earliest_expire = loop->timer.nheap > 0 ?
+				  loop->timer.heap[0]->expire : UINT64_MAX;
+		if (earliest_expire == loop->timer.armed)
+			return;
+		loop->timer.armed = earliest_expire;
+		fd = loop->timer.fd;
+	} else {
+		earliest_expire = libinput_timer_earliest_expire(libinput);
+		fd = libinput->timer.fd;
 	}
 
-	r = timerfd_settime(libinput->timer.fd, TFD_TIMER_ABSTIME, &its, NULL);
-	if (r)
+	if (timerfd_arm(fd, earliest_expire))
 		log_error(libinput, "timer: timerfd_settime error: %s\n", strerror(errno));
 }
 
+/* The timers of all contexts attached to a loop are kept in one binary
+ * min-heap ordered by expiry, in addition to their context's list. */
+static inline void
+loop_heap_set(struct libinput_loop *loop,
+	      size_t idx,
+	      struct libinput_timer *timer)
+{
+	loop->timer.heap[idx] = timer;
+	timer->heap_index = idx;
+}
+
+static void
+loop_heap_sift_up(struct libinput_loop *loop, size_t idx)
+{
+	struct libinput_timer *timer = loop->timer.heap[idx];
+	size_t parent;
+
+	while (idx > 0) {
+		parent = (idx - 1)/2;
+		if (loop->timer.heap[parent]->expire <= timer->expire)
+			break;
+		loop_heap_set(loop, idx, loop->timer.heap[parent]);
+		idx = parent;
+	}
+	loop_heap_set(loop, idx, timer);
+}
+
+static void
+loop_heap_sift_down(struct libinput_loop *loop, size_t idx)
+{
+	struct libinput_timer *timer = loop->timer.heap[idx];
+	size_t child;
+
+	while ((child = 2 * idx + 1) < loop->timer.nheap) {
+		if (child + 1 < loop->timer.nheap &&
+		    loop->timer.heap[child + 1]->expire <
+		    loop->timer.heap[child]->expire)
+			child++;
+		if (timer->expire <= loop->timer.heap[child]->expire)
+			break;
+		loop_heap_set(loop, idx, loop->timer.heap[child]);
+		idx = child;
+	}
+	loop_heap_set(loop, idx, timer);
+}
+
+static bool
+loop_heap_insert(struct libinput_loop *loop, struct libinput_timer *timer)
+{
+	if (loop->timer.nheap == loop->timer.heap_size) {
+		size_t size = max(loop->timer.heap_size * 2, 16U);
+		struct libinput_timer **heap;
+
+		heap = realloc(loop->timer.heap, size * sizeof(*heap));
+		if (!heap)
+			return false;
+
+		loop->timer.heap = heap;
+		loop->timer.heap_size = size;
+	}
+
+	loop_heap_set(loop, loop->timer.nheap++, timer);
+	loop_heap_sift_up(loop, timer->heap_index);
+
+	return true;
+}
+
+static void
+loop_heap_remove(struct libinput_loop *loop, struct libinput_timer *timer)
+{
+	size_t idx = timer->heap_index;
+	struct libinput_timer *last;
+
+	last = loop->timer.heap[--loop->timer.nheap];
+	if (last == timer)
+		return;
+
+	loop_heap_set(loop, idx, last);
+	loop_heap_sift_up(loop, idx);
+	loop_heap_sift_down(loop, last->heap_index);
+}
+
+/* Put the timer on its context's list and, for a context attached to a
+ * loop, in the loop's heap. timer->expire is set already. */
+static void
+libinput_timer_add(struct libinput_timer *timer)
+{
+	struct libinput *libinput = timer->libinput;
+
+	if (libinput->loop &&
+	    !loop_heap_insert(libinput->loop, timer)) {
+		log_error(libinput, "timer: failed to allocate the loop's timer heap\n");
+		timer->expire = 0;
+		return;
+	}
+
+	list_insert(&libinput->timer.list, &timer->link);
+}
+
 void
 libinput_timer_set_flags(struct libinput_timer *timer,
 			 uint64_t expire,
@@ -88,10 +226,19 @@ libinput_timer_set_flags(struct libinput_timer *timer,
 
 	assert(expire);
 
-	if (!timer->expire)
-		list_insert(&timer->libinput->timer.list, &timer->link);
+	if (!timer->expire) {
+		timer->expire = expire;
+		libinput_timer_add(timer);
+	} else {
+		timer->expire = expire;
+		if (timer->libinput->loop) {
+			loop_heap_sift_up(timer->libinput->loop,
+					  timer->heap_index);
+			loop_heap_sift_down(timer->libinput->loop,
+					    timer->heap_index);
+		}
+	}
 
-	timer->expire = expire;
 	libinput_timer_arm_timer_fd(timer->libinput);
 }
 
@@ -109,14 +256,46 @@ libinput_timer_cancel(struct libinput_timer *timer)
 
 	timer->expire = 0;
 	list_remove(&timer->link);
+	if (timer->libinput->loop)
+		loop_heap_remove(timer->libinput->loop, timer);
 	libinput_timer_arm_timer_fd(timer->libinput);
 }
 
+static void
+libinput_timer_fire(struct libinput_timer *timer, uint64_t now)
+{
+	struct libinput *libinput = timer->libinput;
+	uint64_t start;
+
+	/* Clear the timer before calling timer_func,
+	   as timer_func may re-arm it */
+	trace_probe3(timer__fire, timer, timer->expire, now);
+	libinput_timer_cancel(timer);
+	start = timer->device ? cpu_account_begin(libinput) : 0;
+	libinput->timer.expiring = true;
+	timer->timer_func(now, timer->timer_func_data);
+	libinput->timer.expiring = false;
+	if (start)
+		cpu_account_end(timer->device,
+				LIBINPUT_CPU_STAT_TIMERS,
+				start);
+}
+
+static void
+libinput_timer_expire(struct libinput *libinput, uint64_t now)
+{
+	struct libinput_timer *timer, *tmp;
+
+	list_for_each_safe(timer, tmp, &libinput->timer.list, link) {
+		if (timer->expire <= now)
+			libinput_timer_fire(timer, now);
+	}
+}
+
 static void
 libinput_timer_handler(void *data)
 {
 	struct libinput *libinput = data;
-	struct libinput_timer *timer, *tmp;
 	uint64_t now;
 	uint64_t discard;
 	int r;
@@ -132,14 +311,7 @@ libinput_timer_handler(void *data)
 	if (now == 0)
 		return;
 
-	list_for_each_safe(timer, tmp, &libinput->timer.list, link) {
-		if (timer->expire <= now) {
-			/* Clear the timer before calling timer_func,
-			   as timer_func may re-arm it */
-			libinput_timer_cancel(timer);
-			timer->timer_func(now, timer->timer_func_data);
-		}
-	}
+	libinput_timer_expire(libinput, now);
 }
 
 int
@@ -170,6 +342,176 @@ libinput_timer_subsys_destroy(struct libinput *libinput)
 	/* All timer users should have destroyed their timers now */
 	assert(list_empty(&libinput->timer.list));
 
+	if (libinput->clock)
+		list_remove(&libinput->clock_link);
+
+	if (libinput->loop) {
+		list_remove(&libinput->loop_link);
+		return;
+	}
+
 	libinput_remove_source(libinput, libinput->timer.source);
 	close(libinput->timer.fd);
 }
+
+void
+libinput_timer_subsys_attach_loop(struct libinput *libinput)
+{
+	struct libinput_timer *timer, *tmp;
+
+	assert(libinput->loop != NULL);
+
+	/* our own timerfd was already removed from the epoll set */
+	close(libinput->timer.fd);
+	libinput->timer.fd = -1;
+	libinput->timer.source = NULL;
+
+	list_insert(&libinput->loop->contexts, &libinput->loop_link);
+
+	/* the timers that are already armed move to the loop's heap */
+	list_for_each_safe(timer, tmp, &libinput->timer.list, link) {
+		if (!loop_heap_insert(libinput->loop, timer)) {
+			log_error(libinput, "timer: failed to allocate the loop's timer heap\n");
+			list_remove(&timer->link);
+			timer->expire = 0;
+		}
+	}
+
+	libinput_timer_arm_timer_fd(libinput);
+}
+
+int
+libinput_loop_timer_init(struct libinput_loop *loop)
+{
+	loop->timer.fd = timerfd_create(CLOCK_MONOTONIC,
+					TFD_CLOEXEC | TFD_NONBLOCK);
+
+	return loop->timer.fd < 0 ? -errno : 0;
+}
+
+void
+libinput_loop_timer_handler(void *data)
+{
+	struct libinput_loop *loop = data;
+	struct libinput *libinput;
+	struct libinput_timer *timer;
+	uint64_t now;
+	uint64_t discard;
+	int r, err;
+
+	/* the timerfd is shared, every context's timers are affected */
+	r = read(loop->timer.fd, &discard, sizeof(discard));
+	if (r == -1 && errno != EAGAIN) {
+		err = errno;
+		list_for_each(libinput, &loop->contexts, loop_link)
+			log_bug_libinput(libinput,
+					 "timer: error %d reading from timerfd (%s)",
+					 err,
+					 strerror(err));
+	}
+
+	if (loop->timer.nheap == 0)
+		return;
+
+	/* a loop's contexts all run on CLOCK_MONOTONIC */
+	now = libinput_now(loop->timer.heap[0]->libinput);
+	if (now == 0)
+		return;
+
+	/* Timers are fired in order of expiry. A timer_func that re-arms
+	 * its timer for a time before now fires again. */
+	loop->timer.expiring = true;
+	while (loop->timer.nheap > 0 &&
+	       (timer = loop->timer.heap[0])->expire <= now)
+		libinput_timer_fire(timer, now);
+	loop->timer.expiring = false;
+
+	/* the timerfd expired, it needs to be armed again if any timers
+	 * are left */
+	loop->timer.armed = UINT64_MAX;
+	if (loop->timer.nheap > 0)
+		libinput_timer_arm_timer_fd(loop->timer.heap[0]->libinput);
+}
+
+struct libinput_clock *
+libinput_clock_create_virtual(uint64_t now)
+{
+	struct libinput_clock *clock = zalloc(sizeof(*clock));
+
+	if (!clock)
+		return NULL;
+
+	clock->now = now;
+	list_init(&clock->contexts);
+
+	return clock;
+}
+
+void
+libinput_clock_destroy(struct libinput_clock *clock)
+{
+	if (!clock)
+		return;
+
+	assert(list_empty(&clock->contexts));
+	free(clock);
+}
+
+void
+libinput_clock_attach(struct libinput_clock *clock,
+		      struct libinput *libinput)
+{
+	assert(libinput->clock == NULL);
+	assert(libinput->loop == NULL);
+
+	libinput->clock = clock;
+	list_insert(&clock->contexts, &libinput->clock_link);
+	libinput_timer_arm_timer_fd(libinput);
+}
+
+uint64_t
+libinput_clock_get_time(struct libinput_clock *clock)
+{
+	return clock->now;
+}
+
+static uint64_t
+libinput_clock_next_expiry(struct libinput_clock *clock)
+{
+	struct libinput *libinput;
+	struct libinput_timer *timer;
+	uint64_t next = UINT64_MAX;
+
+	list_for_each(libinput, &clock->contexts, clock_link) {
+		list_for_each(timer, &libinput->timer.list, link) {
+			if (timer->expire < next)
+				next = timer->expire;
+		}
+	}
+
+	return next;
+}
+
+void
+libinput_clock_set_time(struct libinput_clock *clock, uint64_t now)
+{
+	struct libinput *libinput;
+	uint64_t next;
+
+	if (now < clock->now)
+		return;
+
+	list_for_each(libinput, &clock->contexts, clock_link)
+		libinput_dispatch(libinput);
+
+	/* Expire the timers in order, so each timer_func sees the time it
+	 * would have seen with the real clock and timers re-armed by a
+	 * timer_func still fire if they expire before now */
+	while ((next = libinput_clock_next_expiry(clock)) <= now) {
+		clock->now = max(next, clock->now);
+		list_for_each(libinput, &clock->contexts, clock_link)
+			libinput_timer_expire(libinput, clock->now);
+	}
+
+	clock->now = now;
+}
@@ -29,10 +29,14 @@
 #include "libinput-util.h"
 
 struct libinput;
+struct libinput_device;
+struct libinput_loop;
 
 struct libinput_timer {
 	struct libinput *libinput;
+	struct libinput_device *device; /* for CPU accounting, may be NULL */
 	struct list link;
+	size_t heap_index; /* in the loop's heap, if attached to a loop */
 	uint64_t expire; /* in absolute us CLOCK_MONOTONIC */
 	void (*timer_func)(uint64_t now, void *timer_func_data);
 	void *timer_func_data;
@@ -40,6 +44,7 @@ struct libinput_timer {
 
 void
 libinput_timer_init(struct libinput_timer *timer, struct libinput *libinput,
+		    struct libinput_device *device,
 		    void (*timer_func)(uint64_t now, void *timer_func_data),
 		    void *timer_func_data);
 
@@ -66,4 +71,43 @@ libinput_timer_subsys_init(struct libinput *libinput);
 void
 libinput_timer_subsys_destroy(struct libinput *libinput);
 
+/* Switch the context from its own timerfd to its loop's, the caller has
+ * removed the context's timer source already */
+void
+libinput_timer_subsys_attach_loop(struct libinput *libinput);
+
+int
+libinput_loop_timer_init(struct libinput_loop *loop);
+
+/* The source dispatch function for the loop's timerfd */
+void
+libinput_loop_timer_handler(void *data);
+
+/* Create a virtual clock starting at now (in µs). Contexts attached to
+ * it see the virtual time in libinput_now(), events read from the kernel
+ * are stamped with it and timers only expire when the clock is moved
+ * forward with libinput_clock_set_time(). Used by the test suite and
+ * replay tools. */
+struct libinput_clock *
+libinput_clock_create_virtual(uint64_t now);
+
+/* All contexts must have been destroyed before the clock */
+void
+libinput_clock_destroy(struct libinput_clock *clock);
+
+/* Attach before any device is added, a context can't go back to the real
+ * clock */
+void
+libinput_clock_attach(struct libinput_clock *clock,
+		      struct libinput *libinput);
+
+uint64_t
+libinput_clock_get_time(struct libinput_clock *clock);
+
+/* Move the clock forward to now (in µs). Each attached context first
+ * reads the pending events from its devices, so they are stamped with the
+ * old time, then the timers that expire up to now run in order. */
+void
+libinput_clock_set_time(struct libinput_clock *clock, uint64_t now);
+
 #endif
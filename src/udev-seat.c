@@ -41,7 +41,22 @@ udev_seat_create(struct udev_input *input,
 		 const char *device_seat,
 		 const char *seat_name);
 static struct udev_seat *
-udev_seat_get_named(struct udev_input *input, const char *seat_name);
+udev_seat_get_named(struct udev_input *input,
+		    const char *device_seat,
+		    const char *seat_name);
+
+static bool
+udev_input_has_seat(struct udev_input *input, const char *device_seat)
+{
+	size_t i;
+
+	for (i = 0; i < input->nseat_ids; i++) {
+		if (streq(device_seat, input->seat_ids[i]))
+			return true;
+	}
+
+	return false;
+}
 
 static int
 device_added(struct udev_device *udev_device,
@@ -57,7 +72,7 @@ device_added(struct udev_device *udev_device,
 	if (!device_seat)
 		device_seat = default_seat;
 
-	if (!streq(device_seat, input->seat_id))
+	if (!udev_input_has_seat(input, device_seat))
 		return 0;
 
 	if (ignore_litest_test_suite_device(udev_device))
@@ -72,7 +87,7 @@ device_added(struct udev_device *udev_device,
 	if (!seat_name)
 		seat_name = default_seat_name;
 
-	seat = udev_seat_get_named(input, seat_name);
+	seat = udev_seat_get_named(input, device_seat, seat_name);
 
 	if (seat)
 		libinput_seat_ref(&seat->base);
@@ -273,12 +288,15 @@ static void
 udev_input_destroy(struct libinput *input)
 {
 	struct udev_input *udev_input = (struct udev_input*)input;
+	size_t i;
 
 	if (input == NULL)
 		return;
 
 	udev_unref(udev_input->udev);
-	free(udev_input->seat_id);
+	for (i = 0; i < udev_input->nseat_ids; i++)
+		free(udev_input->seat_ids[i]);
+	free(udev_input->seat_ids);
 }
 
 static void
@@ -306,13 +324,18 @@ udev_seat_create(struct udev_input *input,
 	return seat;
 }
 
+/* With more than one physical seat per context, two physical seats may
+ * both have a logical seat "default", so we need to match on both */
 static struct udev_seat *
-udev_seat_get_named(struct udev_input *input, const char *seat_name)
+udev_seat_get_named(struct udev_input *input,
+		    const char *device_seat,
+		    const char *seat_name)
 {
 	struct udev_seat *seat;
 
 	list_for_each(seat, &input->base.seat_list, base.link) {
-		if (streq(seat->base.logical_name, seat_name))
+		if (streq(seat->base.physical_name, device_seat) &&
+		    streq(seat->base.logical_name, seat_name))
 			return seat;
 	}
 
@@ -373,21 +396,51 @@ libinput_udev_create_context(const struct libinput_interface *interface,
 LIBINPUT_EXPORT int
 libinput_udev_assign_seat(struct libinput *libinput,
 			  const char *seat_id)
+{
+	const char *seat_ids[] = { seat_id };
+
+	return libinput_udev_assign_seats(libinput, seat_ids, 1);
+}
+
+LIBINPUT_EXPORT int
+libinput_udev_assign_seats(struct libinput *libinput,
+			   const char * const *seat_ids,
+			   size_t nseats)
 {
 	struct udev_input *input = (struct udev_input*)libinput;
+	size_t i;
 
-	if (!seat_id)
+	if (!seat_ids || nseats == 0)
 		return -1;
 
+	for (i = 0; i < nseats; i++) {
+		if (!seat_ids[i])
+			return -1;
+	}
+
 	if (libinput->interface_backend != &interface_backend) {
 		log_bug_client(libinput, "Mismatching backends.\n");
 		return -1;
 	}
 
-	if (input->seat_id != NULL)
+	if (input->seat_ids != NULL)
 		return -1;
 
-	input->seat_id = strdup(seat_id);
+	input->seat_ids = zalloc(nseats * sizeof(*input->seat_ids));
+	if (!input->seat_ids)
+		return -1;
+
+	for (i = 0; i < nseats; i++) {
+		input->seat_ids[i] = strdup(seat_ids[i]);
+		if (!input->seat_ids[i]) {
+			while (i--)
+				free(input->seat_ids[i]);
+			free(input->seat_ids);
+			input->seat_ids = NULL;
+			return -1;
+		}
+	}
+	input->nseat_ids = nseats;
 
 	if (udev_input_enable(&input->base) < 0)
 		return -1;
@@ -38,7 +38,8 @@ struct udev_input {
 	struct udev *udev;
 	struct udev_monitor *udev_monitor;
 	struct libinput_source *udev_monitor_source;
-	char *seat_id;
+	char **seat_ids;
+	size_t nseat_ids;
 };
 
 #endif
@@ -0,0 +1,528 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <fnmatch.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "litest.h"
+#include "litest-int.h"
+#include "evdev.h"
+#include "path-seat.h"
+#include "evdev-recording.h"
+
+/* The benchmarks use the litest devices in --in-process mode: a batch of
+ * frames is written into the device's pipe with the usual litest helpers,
+ * then the time libinput takes to read and process the batch and hand out
+ * the resulting events is measured. Recordings made with evdev-record are
+ * injected into virtual devices directly.
+ */
+
+static bool counting_allocations = false;
+static uint64_t nallocations = 0;
+
+#ifdef __GLIBC__
+/* Count the allocations during the measured sections by interposing on
+ * glibc's allocator, libinput is linked into this binary statically */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *
+malloc(size_t size)
+{
+	if (counting_allocations)
+		nallocations++;
+	return __libc_malloc(size);
+}
+
+void *
+calloc(size_t nmemb, size_t size)
+{
+	if (counting_allocations)
+		nallocations++;
+	return __libc_calloc(nmemb, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+	if (counting_allocations)
+		nallocations++;
+	return __libc_realloc(ptr, size);
+}
+#define HAVE_ALLOCATION_COUNT 1
+#else
+#define HAVE_ALLOCATION_COUNT 0
+#endif
+
+struct result {
+	const char *name;
+	char *device;
+	uint64_t nframes;
+	uint64_t nevents;
+	uint64_t nallocations;
+	uint64_t ns;
+};
+
+struct benchmark {
+	const char *name;
+	enum litest_device_type device;
+	/* writes one batch of frames, called once per iteration */
+	void (*batch)(struct litest_device *d, int iteration);
+};
+
+static inline uint64_t
+now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Process everything pending and count it towards r */
+static void
+measure(struct libinput *li, struct result *r)
+{
+	struct libinput_event *event;
+	uint64_t start;
+
+	nallocations = 0;
+	counting_allocations = true;
+	start = now_ns();
+
+	libinput_dispatch(li);
+	while ((event = libinput_get_event(li))) {
+		r->nevents++;
+		libinput_event_destroy(event);
+	}
+
+	r->ns += now_ns() - start;
+	counting_allocations = false;
+	r->nallocations += nallocations;
+}
+
+static void
+batch_pointer_motion(struct litest_device *d, int iteration)
+{
+	int i;
+
+	for (i = 0; i < 20; i++) {
+		litest_event(d, EV_REL, REL_X, (iteration % 2) ? 2 : -2);
+		litest_event(d, EV_REL, REL_Y, 1);
+		litest_event(d, EV_SYN, SYN_REPORT, 0);
+	}
+}
+
+static void
+batch_pointer_button(struct litest_device *d, int iteration)
+{
+	litest_button_click(d, BTN_LEFT, true);
+	litest_button_click(d, BTN_LEFT, false);
+}
+
+static void
+batch_keyboard(struct litest_device *d, int iteration)
+{
+	unsigned int key = KEY_Q + iteration % 10;
+
+	litest_keyboard_key(d, key, true);
+	litest_keyboard_key(d, key, false);
+}
+
+static void
+batch_touch_motion(struct litest_device *d, int iteration)
+{
+	litest_touch_down(d, 0, 30, 30);
+	litest_touch_move_to(d, 0, 30, 30, 70, 60, 20, 0);
+	litest_touch_up(d, 0);
+}
+
+static void
+batch_touchpad_scroll(struct litest_device *d, int iteration)
+{
+	litest_touch_down(d, 0, 40, 30);
+	litest_touch_down(d, 1, 60, 30);
+	litest_touch_move_two_touches(d, 40, 30, 60, 30, 0, 30, 20, 0);
+	litest_touch_up(d, 1);
+	litest_touch_up(d, 0);
+}
+
+static void
+batch_tablet_motion(struct litest_device *d, int iteration)
+{
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ -1, -1 }
+	};
+	int i;
+
+	litest_tablet_proximity_in(d, 10, 10, axes);
+	for (i = 0; i < 20; i++)
+		litest_tablet_motion(d, 10 + i * 3, 10 + i * 2, axes);
+	litest_tablet_proximity_out(d);
+}
+
+static void
+batch_pad_ring(struct litest_device *d, int iteration)
+{
+	int i;
+
+	litest_pad_ring_start(d, 10);
+	for (i = 1; i <= 10; i++)
+		litest_pad_ring_change(d, 10 + i * 5);
+	litest_pad_ring_end(d);
+	litest_button_click(d, BTN_0, true);
+	litest_button_click(d, BTN_0, false);
+}
+
+static void
+batch_lid_switch(struct litest_device *d, int iteration)
+{
+	litest_lid_action(d, LIBINPUT_SWITCH_STATE_ON);
+	litest_lid_action(d, LIBINPUT_SWITCH_STATE_OFF);
+}
+
+static const struct benchmark benchmarks[] = {
+	{ "pointer-motion", LITEST_MOUSE, batch_pointer_motion },
+	{ "pointer-button", LITEST_MOUSE, batch_pointer_button },
+	{ "keyboard-key", LITEST_KEYBOARD, batch_keyboard },
+	{ "touchscreen-motion", LITEST_GENERIC_MULTITOUCH_SCREEN,
+	  batch_touch_motion },
+	{ "touchpad-motion", LITEST_SYNAPTICS_CLICKPAD_X220,
+	  batch_touch_motion },
+	{ "touchpad-scroll", LITEST_SYNAPTICS_CLICKPAD_X220,
+	  batch_touchpad_scroll },
+	{ "tablet-motion", LITEST_WACOM_INTUOS, batch_tablet_motion },
+	{ "pad-ring", LITEST_WACOM_INTUOS5_PAD, batch_pad_ring },
+	{ "lid-switch", LITEST_LID_SWITCH, batch_lid_switch },
+};
+
+static void
+run_benchmark(const struct benchmark *b, int iterations, struct result *r)
+{
+	struct litest_device *d;
+	struct libinput *li;
+	int i;
+
+	d = litest_create_device(b->device);
+	li = d->libinput;
+	litest_drain_events(li);
+
+	r->name = b->name;
+	r->device = strdup(libinput_device_get_name(d->libinput_device));
+
+	for (i = 0; i < iterations; i++) {
+		unsigned int nframes = d->in_process.nframes;
+
+		b->batch(d, i);
+		r->nframes += d->in_process.nframes - nframes;
+		measure(li, r);
+	}
+
+	litest_delete_device(d);
+}
+
+static int
+run_recording(const char *path, struct result *r)
+{
+	struct recording_device *recording;
+	struct evdev_device **devices;
+	struct libinput_clock *clock;
+	struct libinput *li;
+	struct input_event ev;
+	unsigned int ndevices, index, i;
+	uint64_t first = 0, start_us, time = 0;
+	FILE *fp;
+	int rc;
+
+	fp = fopen(path, "r");
+	if (!fp) {
+		fprintf(stderr, "Failed to open %s (%s)\n",
+			path, strerror(errno));
+		return -errno;
+	}
+
+	rc = recording_read_header(fp, &recording, &ndevices);
+	if (rc < 0) {
+		fprintf(stderr, "Invalid recording %s\n", path);
+		fclose(fp);
+		return rc;
+	}
+
+	/* replayed as fast as possible, the timers follow the recorded
+	 * event times */
+	start_us = now_ns() / 1000;
+	clock = libinput_clock_create_virtual(start_us);
+	litest_assert_notnull(clock);
+	li = litest_create_context();
+	libinput_clock_attach(clock, li);
+
+	devices = zalloc(ndevices * sizeof(*devices));
+	for (i = 0; i < ndevices; i++) {
+		struct libinput_device *device;
+
+		device = path_add_virtual_device(li,
+						 recording[i].evdev,
+						 recording[i].sysname,
+						 (const char * const *)
+							recording[i].properties,
+						 -1);
+		recording[i].evdev = NULL;
+		if (device)
+			devices[i] = evdev_device(device);
+	}
+	litest_drain_events(li);
+
+	r->name = path;
+	r->device = strdup(ndevices == 1 ? recording[0].sysname : "multiple");
+
+	while ((rc = recording_read_event(fp, &index, &ev)) > 0) {
+		uint64_t start;
+
+		if (index >= ndevices || !devices[index])
+			continue;
+
+		time = (uint64_t)ev.time.tv_sec * 1000000 + ev.time.tv_usec;
+		if (first == 0)
+			first = time;
+		time = start_us + (time - first);
+		ev.time.tv_sec = time / 1000000;
+		ev.time.tv_usec = time % 1000000;
+
+		counting_allocations = true;
+		nallocations = 0;
+		start = now_ns();
+		libinput_clock_set_time(clock, time);
+		evdev_device_inject_event(devices[index], &ev);
+		r->ns += now_ns() - start;
+		counting_allocations = false;
+		r->nallocations += nallocations;
+
+		if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+			r->nframes++;
+			measure(li, r);
+		}
+	}
+
+	/* flush pending timeouts */
+	libinput_clock_set_time(clock, time + s2us(1));
+	measure(li, r);
+
+	libinput_unref(li);
+	libinput_clock_destroy(clock);
+	free(devices);
+	recording_devices_free(recording, ndevices);
+	fclose(fp);
+
+	if (rc < 0)
+		fprintf(stderr, "Failed to read %s\n", path);
+
+	return rc;
+}
+
+/* Device names come from the recordings and may contain anything */
+static void
+print_json_string(const char *str)
+{
+	const unsigned char *c;
+
+	putchar('"');
+	for (c = (const unsigned char *)str; *c; c++) {
+		if (*c == '"' || *c == '\\')
+			printf("\\%c", *c);
+		else if (*c < 0x20)
+			printf("\\u%04x", *c);
+		else
+			putchar(*c);
+	}
+	putchar('"');
+}
+
+static void
+print_results(const struct result *results,
+	      unsigned int nresults,
+	      bool machine_readable)
+{
+	unsigned int i;
+
+	if (machine_readable) {
+		/* one JSON object per benchmark, easy to diff and parse */
+		printf("[\n");
+		for (i = 0; i < nresults; i++) {
+			const struct result *r = &results[i];
+			uint64_t nframes = max(r->nframes, 1U);
+
+			printf("  {\"name\": ");
+			print_json_string(r->name);
+			printf(", \"device\": ");
+			print_json_string(r->device);
+			printf(", \"frames\": %" PRIu64 ", "
+			       "\"ns_per_frame\": %.1f, ",
+			       r->nframes,
+			       (double)r->ns/nframes);
+			if (HAVE_ALLOCATION_COUNT)
+				printf("\"allocations_per_frame\": %.3f, ",
+				       (double)r->nallocations/nframes);
+			else
+				printf("\"allocations_per_frame\": null, ");
+			printf("\"events_per_frame\": %.3f}%s\n",
+			       (double)r->nevents/nframes,
+			       i < nresults - 1 ? "," : "");
+		}
+		printf("]\n");
+		return;
+	}
+
+	printf("%-20s %-40s %8s %10s %8s %8s\n",
+	       "benchmark", "device", "frames", "ns/frame",
+	       "allocs", "events");
+	for (i = 0; i < nresults; i++) {
+		const struct result *r = &results[i];
+		uint64_t nframes = max(r->nframes, 1U);
+
+		printf("%-20s %-40s %8" PRIu64 " %10.1f %8.3f %8.3f\n",
+		       r->name,
+		       r->device,
+		       r->nframes,
+		       (double)r->ns/nframes,
+		       HAVE_ALLOCATION_COUNT ?
+			       (double)r->nallocations/nframes : -1.0,
+		       (double)r->nevents/nframes);
+	}
+}
+
+static void
+usage(void)
+{
+	printf("Usage: %s [options] [recording ...]\n",
+	       program_invocation_short_name);
+	printf("\n"
+	       "Benchmarks libinput's device dispatch with synthetic event\n"
+	       "streams on the test suite's devices and with recordings made\n"
+	       "by evdev-record. No uinput or root privileges are required.\n"
+	       "\n"
+	       "Options:\n"
+	       "--filter=<name> ...... only run benchmarks matching the glob\n"
+	       "--iterations=<n> ..... number of batches per benchmark\n"
+	       "                       (default 1000)\n"
+	       "--machine-readable ... print the results as JSON\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	struct result *results;
+	unsigned int nresults = 0, i;
+	const char *filter = NULL;
+	bool machine_readable = false;
+	int iterations = 1000;
+	int rc = 0;
+
+	enum {
+		OPT_HELP = 1,
+		OPT_FILTER,
+		OPT_ITERATIONS,
+		OPT_MACHINE_READABLE,
+	};
+
+	while (1) {
+		int c;
+		int option_index = 0;
+		static struct option long_options[] = {
+			{"help", 0, 0, OPT_HELP },
+			{"filter", 1, 0, OPT_FILTER },
+			{"iterations", 1, 0, OPT_ITERATIONS },
+			{"machine-readable", 0, 0, OPT_MACHINE_READABLE },
+			{0, 0, 0, 0}
+		};
+
+		c = getopt_long(argc, argv, "",
+				long_options, &option_index);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case OPT_HELP:
+			usage();
+			exit(0);
+			break;
+		case OPT_FILTER:
+			filter = optarg;
+			break;
+		case OPT_ITERATIONS:
+			iterations = atoi(optarg);
+			if (iterations <= 0) {
+				usage();
+				exit(1);
+			}
+			break;
+		case OPT_MACHINE_READABLE:
+			machine_readable = true;
+			break;
+		default:
+			usage();
+			exit(1);
+			break;
+		}
+	}
+
+	litest_set_in_process();
+
+	results = zalloc((ARRAY_LENGTH(benchmarks) + argc - optind) *
+			 sizeof(*results));
+
+	for (i = 0; i < ARRAY_LENGTH(benchmarks); i++) {
+		if (filter && fnmatch(filter, benchmarks[i].name, 0) != 0)
+			continue;
+		run_benchmark(&benchmarks[i], iterations, &results[nresults++]);
+	}
+
+	for (i = optind; i < (unsigned int)argc; i++) {
+		if (run_recording(argv[i], &results[nresults]) < 0) {
+			free(results[nresults].device);
+			memset(&results[nresults], 0, sizeof(*results));
+			rc = 1;
+		} else {
+			nresults++;
+		}
+	}
+
+	print_results(results, nresults, machine_readable);
+
+	for (i = 0; i < nresults; i++)
+		free(results[i].device);
+	free(results);
+
+	return rc;
+}
@@ -0,0 +1,667 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/* Support for running the test suite with --in-process: test devices are
+ * created inside libinput without uinput, udev or the kernel. This file
+ * emulates the parts of those that libinput relies on: the udev properties
+ * of a device and the kernel's filtering of the events we write. */
+
+#include "config.h"
+
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "litest.h"
+#include "litest-int.h"
+#include "libinput-util.h"
+#include "path-seat.h"
+
+static unsigned int sysnum = 0;
+
+struct properties {
+	char **pairs; /* name/value pairs, NULL-terminated */
+	size_t npairs;
+};
+
+static const char *
+prop_get(struct properties *props, const char *name)
+{
+	size_t i;
+
+	for (i = 0; i < props->npairs; i++) {
+		if (streq(props->pairs[2 * i], name))
+			return props->pairs[2 * i + 1];
+	}
+
+	return NULL;
+}
+
+static void
+prop_set(struct properties *props, const char *name, const char *value)
+{
+	size_t i;
+
+	for (i = 0; i < props->npairs; i++) {
+		if (streq(props->pairs[2 * i], name)) {
+			free(props->pairs[2 * i + 1]);
+			props->pairs[2 * i + 1] = strdup(value);
+			return;
+		}
+	}
+
+	props->pairs = realloc(props->pairs,
+			       (2 * props->npairs + 3) * sizeof(char *));
+	litest_assert_notnull(props->pairs);
+	props->pairs[2 * i] = strdup(name);
+	props->pairs[2 * i + 1] = strdup(value);
+	props->pairs[2 * i + 2] = NULL;
+	props->npairs++;
+}
+
+/* A simplified version of udev's input_id builtin */
+static void
+input_id_properties(struct libevdev *evdev, struct properties *props)
+{
+	bool has_abs, has_mt, has_rel, has_mouse_button, has_pen,
+	     has_finger, has_touch, is_direct, has_joystick;
+	bool is_tablet = false, is_touchpad = false, is_mouse = false,
+	     is_touchscreen = false, is_joystick = false;
+	bool has_keys = false;
+	unsigned int code;
+
+	prop_set(props, "ID_INPUT", "1");
+
+	has_abs = libevdev_has_event_code(evdev, EV_ABS, ABS_X) &&
+		  libevdev_has_event_code(evdev, EV_ABS, ABS_Y);
+	has_mt = libevdev_has_event_code(evdev, EV_ABS, ABS_MT_POSITION_X) &&
+		 libevdev_has_event_code(evdev, EV_ABS, ABS_MT_POSITION_Y);
+	has_rel = libevdev_has_event_code(evdev, EV_REL, REL_X) &&
+		  libevdev_has_event_code(evdev, EV_REL, REL_Y);
+	has_mouse_button = libevdev_has_event_code(evdev, EV_KEY, BTN_LEFT);
+	has_pen = libevdev_has_event_code(evdev, EV_KEY, BTN_STYLUS) ||
+		  libevdev_has_event_code(evdev, EV_KEY, BTN_TOOL_PEN);
+	has_finger = libevdev_has_event_code(evdev, EV_KEY, BTN_TOOL_FINGER) &&
+		     !libevdev_has_event_code(evdev, EV_KEY, BTN_TOOL_PEN);
+	has_touch = libevdev_has_event_code(evdev, EV_KEY, BTN_TOUCH);
+	is_direct = libevdev_has_property(evdev, INPUT_PROP_DIRECT);
+	has_joystick = libevdev_has_event_code(evdev, EV_KEY, BTN_TRIGGER) ||
+		       libevdev_has_event_code(evdev, EV_KEY, BTN_A) ||
+		       libevdev_has_event_code(evdev, EV_ABS, ABS_RX) ||
+		       libevdev_has_event_code(evdev, EV_ABS, ABS_THROTTLE);
+
+	if (has_abs) {
+		if (has_pen)
+			is_tablet = true;
+		else if (has_finger && !is_direct)
+			is_touchpad = true;
+		else if (has_mouse_button)
+			is_mouse = true;
+		else if (has_touch || is_direct)
+			is_touchscreen = true;
+		else if (has_joystick)
+			is_joystick = true;
+	} else if (has_joystick) {
+		is_joystick = true;
+	}
+
+	if (has_mt) {
+		if (has_pen)
+			is_tablet = true;
+		else if (has_finger && !is_direct)
+			is_touchpad = true;
+		else if (has_touch || is_direct)
+			is_touchscreen = true;
+	}
+
+	if (!is_tablet && !is_touchpad && !is_joystick &&
+	    has_mouse_button && (has_rel || !has_abs))
+		is_mouse = true;
+
+	if (libevdev_has_property(evdev, INPUT_PROP_POINTING_STICK))
+		prop_set(props, "ID_INPUT_POINTINGSTICK", "1");
+	if (is_mouse)
+		prop_set(props, "ID_INPUT_MOUSE", "1");
+	if (is_touchpad)
+		prop_set(props, "ID_INPUT_TOUCHPAD", "1");
+	if (is_touchscreen)
+		prop_set(props, "ID_INPUT_TOUCHSCREEN", "1");
+	if (is_joystick)
+		prop_set(props, "ID_INPUT_JOYSTICK", "1");
+	if (is_tablet)
+		prop_set(props, "ID_INPUT_TABLET", "1");
+	if (is_tablet && libevdev_has_event_code(evdev, EV_KEY, BTN_0))
+		prop_set(props, "ID_INPUT_TABLET_PAD", "1");
+
+	for (code = KEY_ESC; code < BTN_MISC && !has_keys; code++)
+		has_keys = libevdev_has_event_code(evdev, EV_KEY, code);
+	for (code = KEY_OK; code < BTN_TRIGGER_HAPPY && !has_keys; code++)
+		has_keys = libevdev_has_event_code(evdev, EV_KEY, code);
+	if (has_keys)
+		prop_set(props, "ID_INPUT_KEY", "1");
+
+	/* ESC, numbers, and Q to D, like udev does */
+	has_keys = true;
+	for (code = KEY_ESC; code <= KEY_D && has_keys; code++)
+		has_keys = libevdev_has_event_code(evdev, EV_KEY, code);
+	if (has_keys)
+		prop_set(props, "ID_INPUT_KEYBOARD", "1");
+
+	if (libevdev_has_event_type(evdev, EV_SW))
+		prop_set(props, "ID_INPUT_SWITCH", "1");
+}
+
+/* udev-style patterns, with | for alternatives */
+static bool
+pattern_match(const char *pattern, const char *str)
+{
+	char **alternatives;
+	size_t i;
+	bool match = false;
+
+	alternatives = strv_from_string(pattern, "|");
+	if (!alternatives)
+		return fnmatch(pattern, str, 0) == 0;
+
+	for (i = 0; alternatives[i] && !match; i++)
+		match = fnmatch(alternatives[i], str, 0) == 0;
+	strv_free(alternatives);
+
+	return match;
+}
+
+static bool
+rule_condition(const char *key,
+	       const char *pattern,
+	       const char *name,
+	       const char *sysname,
+	       struct properties *props)
+{
+	const char *value;
+
+	if (streq(key, "ACTION"))
+		value = "add";
+	else if (streq(key, "KERNEL"))
+		value = sysname;
+	else if (streq(key, "KERNELS"))
+		return pattern_match(pattern, sysname) ||
+		       pattern_match(pattern, "input0");
+	else if (streq(key, "SUBSYSTEM") || streq(key, "SUBSYSTEMS"))
+		value = "input";
+	else if (streq(key, "ATTRS{name}") || streq(key, "ATTR{name}"))
+		value = name;
+	else if (strneq(key, "ENV{", 4)) {
+		char prop[256];
+
+		snprintf(prop, sizeof(prop), "%.*s",
+			 (int)strlen(key) - 5, key + 4);
+		value = prop_get(props, prop);
+		if (!value)
+			value = "";
+		return pattern_match(pattern, value);
+	} else
+		return false;
+
+	return pattern_match(pattern, value);
+}
+
+/* Interprets the subset of the udev rules syntax our test rules use:
+ * ACTION, KERNEL(S), SUBSYSTEM(S), ATTR(S){name} and ENV{} matches, ENV{}
+ * assignments and GOTO/LABEL. Everything else is ignored */
+static void
+apply_udev_rules(const char *rules,
+		 const char *name,
+		 const char *sysname,
+		 struct properties *props)
+{
+	char *text, *line, *saveptr = NULL;
+	char *goto_label = NULL;
+	char *p;
+
+	/* join continuation lines */
+	text = strdup(rules);
+	litest_assert_notnull(text);
+	for (p = text; *p; p++) {
+		if (p[0] == '\\' && p[1] == '\n')
+			p[0] = p[1] = ' ';
+	}
+
+	for (line = strtok_r(text, "\n", &saveptr);
+	     line;
+	     line = strtok_r(NULL, "\n", &saveptr)) {
+		struct properties assignments = {0};
+		char *token = line;
+		bool match = true;
+		char *label = NULL, *new_goto = NULL;
+		size_t i;
+
+		while (*token) {
+			char key[128], op[3] = {0}, value[512];
+			int n = 0;
+
+			while (*token == ' ' || *token == ',' || *token == '\t')
+				token++;
+			if (*token == '\0' || *token == '#')
+				break;
+
+			if (sscanf(token, "%127[^=!+ ]%2[=!+]\"%511[^\"]\"%n",
+				   key, op, value, &n) != 3) {
+				/* empty value */
+				value[0] = '\0';
+				if (sscanf(token, "%127[^=!+ ]%2[=!+]\"\"%n",
+					   key, op, &n) != 2)
+					break;
+			}
+			token += n;
+
+			if (streq(key, "LABEL") && streq(op, "=")) {
+				label = strdup(value);
+			} else if (streq(op, "==") || streq(op, "!=")) {
+				bool m = rule_condition(key, value, name,
+							sysname, props);
+				if (m != streq(op, "=="))
+					match = false;
+			} else if (streq(key, "GOTO")) {
+				free(new_goto);
+				new_goto = strdup(value);
+			} else if (strneq(key, "ENV{", 4) &&
+				   streq(op, "=")) {
+				key[strlen(key) - 1] = '\0';
+				prop_set(&assignments, key + 4, value);
+			}
+		}
+
+		if (goto_label) {
+			if (label && streq(label, goto_label)) {
+				free(goto_label);
+				goto_label = NULL;
+			}
+		} else if (match) {
+			for (i = 0; i < assignments.npairs; i++)
+				prop_set(props,
+					 assignments.pairs[2 * i],
+					 assignments.pairs[2 * i + 1]);
+			goto_label = new_goto;
+			new_goto = NULL;
+		}
+
+		free(label);
+		free(new_goto);
+		strv_free(assignments.pairs);
+	}
+
+	free(goto_label);
+	free(text);
+}
+
+static char *
+read_file(const char *path)
+{
+	FILE *fp;
+	char *buf;
+	long size;
+
+	fp = fopen(path, "r");
+	if (!fp)
+		return NULL;
+
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	rewind(fp);
+
+	buf = zalloc(size + 1);
+	if (size > 0 && fread(buf, size, 1, fp) != 1) {
+		free(buf);
+		buf = NULL;
+	}
+	fclose(fp);
+
+	return buf;
+}
+
+/* Applies the properties of all records in the hwdb file that match any
+ * of the keys, in file order */
+static void
+apply_hwdb(const char *path, char **keys, struct properties *props)
+{
+	char *text, *line, *saveptr = NULL;
+	bool in_match = false, match = false;
+
+	text = read_file(path);
+	litest_assert_notnull(text);
+
+	for (line = strtok_r(text, "\n", &saveptr);
+	     line;
+	     line = strtok_r(NULL, "\n", &saveptr)) {
+		size_t i;
+
+		if (line[0] == '#')
+			continue;
+
+		if (line[0] != ' ') {
+			/* a new record starts after its properties */
+			if (!in_match)
+				match = false;
+			in_match = true;
+			for (i = 0; keys[i] && !match; i++)
+				match = fnmatch(line, keys[i], 0) == 0;
+		} else {
+			char *value;
+
+			in_match = false;
+			line += strspn(line, " ");
+			value = strchr(line, '=');
+			if (!match || !value)
+				continue;
+			*value++ = '\0';
+			prop_set(props, line, value);
+		}
+	}
+
+	free(text);
+}
+
+static void
+model_quirks_properties(struct libevdev *evdev, struct properties *props)
+{
+	char *keys[4] = { NULL };
+	char modalias[64];
+	char *dmi;
+	int n = 0;
+
+	dmi = read_file("/sys/class/dmi/id/modalias");
+	if (dmi)
+		dmi[strcspn(dmi, "\n")] = '\0';
+
+	snprintf(modalias, sizeof(modalias),
+		 "input:b%04Xv%04Xp%04Xe%04X-",
+		 libevdev_get_id_bustype(evdev),
+		 libevdev_get_id_vendor(evdev),
+		 libevdev_get_id_product(evdev),
+		 libevdev_get_id_version(evdev));
+
+	xasprintf(&keys[n++], "libinput:name:%s:%s",
+		  libevdev_get_name(evdev),
+		  dmi ? dmi : "");
+	if (prop_get(props, "ID_INPUT_TOUCHPAD"))
+		xasprintf(&keys[n++], "libinput:touchpad:%s", modalias);
+	if (prop_get(props, "ID_INPUT_MOUSE"))
+		xasprintf(&keys[n++], "libinput:mouse:%s", modalias);
+
+	apply_hwdb(LIBINPUT_MODEL_QUIRKS_UDEV_HWDB_FILE, keys, props);
+
+	while (n > 0)
+		free(keys[--n]);
+	free(dmi);
+}
+
+static char **
+udev_properties(struct libevdev *evdev,
+		const char *sysname,
+		const char *udev_rule)
+{
+	struct properties props = {0};
+	const char *name = libevdev_get_name(evdev);
+	char *rules;
+
+	input_id_properties(evdev, &props);
+	model_quirks_properties(evdev, &props);
+
+	rules = read_file(LIBINPUT_TEST_DEVICE_RULES_FILE);
+	litest_assert_notnull(rules);
+	apply_udev_rules(rules, name, sysname, &props);
+	free(rules);
+
+	if (udev_rule)
+		apply_udev_rules(udev_rule, name, sysname, &props);
+
+	if (!props.pairs)
+		props.pairs = zalloc(sizeof(char *));
+
+	return props.pairs;
+}
+
+static struct libevdev *
+copy_evdev(struct libevdev *evdev)
+{
+	struct libevdev *copy;
+	unsigned int type, code;
+
+	copy = libevdev_new();
+	litest_assert_notnull(copy);
+
+	libevdev_set_name(copy, libevdev_get_name(evdev));
+	libevdev_set_id_bustype(copy, libevdev_get_id_bustype(evdev));
+	libevdev_set_id_vendor(copy, libevdev_get_id_vendor(evdev));
+	libevdev_set_id_product(copy, libevdev_get_id_product(evdev));
+	libevdev_set_id_version(copy, libevdev_get_id_version(evdev));
+
+	for (code = 0; code <= INPUT_PROP_MAX; code++) {
+		if (libevdev_has_property(evdev, code))
+			libevdev_enable_property(copy, code);
+	}
+
+	for (type = EV_KEY; type < EV_MAX; type++) {
+		unsigned int max;
+
+		switch (type) {
+		case EV_KEY: max = KEY_MAX; break;
+		case EV_REL: max = REL_MAX; break;
+		case EV_ABS: max = ABS_MAX; break;
+		case EV_MSC: max = MSC_MAX; break;
+		case EV_SW: max = SW_MAX; break;
+		case EV_LED: max = LED_MAX; break;
+		default: continue;
+		}
+
+		for (code = 0; code <= max; code++) {
+			if (!libevdev_has_event_code(evdev, type, code))
+				continue;
+			libevdev_enable_event_code(copy, type, code,
+						   type == EV_ABS ?
+						   libevdev_get_abs_info(evdev, code) :
+						   NULL);
+		}
+	}
+
+	return copy;
+}
+
+struct libinput_device *
+litest_in_process_add_device(struct litest_device *d)
+{
+	struct libinput_device *device;
+	char sysname[64];
+	char **properties;
+	int fds[2];
+	int rc;
+
+	/* libinput reads from one end of the pipe, litest_event() writes
+	 * to the other. d->evdev is never attached to an fd, it only
+	 * tracks the state the kernel would have */
+	rc = pipe2(fds, O_CLOEXEC|O_NONBLOCK);
+	litest_assert_int_eq(rc, 0);
+	/* tests may send a lot of events before calling
+	 * libinput_dispatch(), a failure here is caught in write_event() */
+	fcntl(fds[1], F_SETPIPE_SZ, 1024 * 1024);
+
+	snprintf(sysname, sizeof(sysname), "event%u", sysnum++);
+	properties = udev_properties(d->evdev, sysname, d->in_process.udev_rule);
+
+	device = path_add_virtual_device(d->libinput,
+					 copy_evdev(d->evdev),
+					 sysname,
+					 (const char * const *)properties,
+					 fds[0]);
+	strv_free(properties);
+
+	if (device)
+		d->in_process.fd = fds[1];
+	else
+		close(fds[1]);
+
+	return device;
+}
+
+static inline int
+defuzz(int value, int old, int fuzz)
+{
+	/* same as the kernel's input_defuzz_abs_event() */
+	if (fuzz) {
+		if (value > old - fuzz / 2 && value < old + fuzz / 2)
+			return old;
+		if (value > old - fuzz && value < old + fuzz)
+			return (old * 3 + value) / 4;
+		if (value > old - fuzz * 2 && value < old + fuzz * 2)
+			return (old + value) / 2;
+	}
+
+	return value;
+}
+
+static void
+write_event(struct litest_device *d,
+	    unsigned int type,
+	    unsigned int code,
+	    int value)
+{
+	struct input_event ev;
+	struct timespec ts;
+	ssize_t rc;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ev.time.tv_sec = ts.tv_sec;
+	ev.time.tv_usec = ts.tv_nsec / 1000;
+	ev.type = type;
+	ev.code = code;
+	ev.value = value;
+
+	rc = write(d->in_process.fd, &ev, sizeof(ev));
+	litest_assert_msg(rc == sizeof(ev),
+			  "Failed to write event, too many events without "
+			  "libinput_dispatch()?\n");
+
+	if (type != EV_SYN)
+		d->in_process.nevents++;
+}
+
+/* Filters the events like the kernel's input core does before they reach
+ * the evdev fd: unsupported codes and unchanged state are dropped, fuzz is
+ * applied, ABS_MT_SLOT is only sent together with an event for that slot
+ * and empty frames are dropped. d->evdev keeps the kernel's state. */
+void
+litest_in_process_write_event(struct litest_device *d,
+			      unsigned int type,
+			      unsigned int code,
+			      int value)
+{
+	struct libevdev *evdev = d->evdev;
+	int old;
+
+	if (type == EV_SYN) {
+		if (code == SYN_REPORT && d->in_process.nevents == 0)
+			return;
+		write_event(d, type, code, value);
+		if (code == SYN_REPORT) {
+			d->in_process.nevents = 0;
+			d->in_process.nframes++;
+		}
+		return;
+	}
+
+	if (!libevdev_has_event_code(evdev, type, code))
+		return;
+
+	switch (type) {
+	case EV_KEY:
+		if (value != 2) {
+			if (!!libevdev_get_event_value(evdev, type, code) ==
+			    !!value)
+				return;
+			libevdev_set_event_value(evdev, type, code, value);
+		}
+		break;
+	case EV_SW:
+	case EV_LED:
+		if (!!libevdev_get_event_value(evdev, type, code) == !!value)
+			return;
+		libevdev_set_event_value(evdev, type, code, value);
+		break;
+	case EV_REL:
+		if (value == 0)
+			return;
+		break;
+	case EV_ABS: {
+		const struct input_absinfo *abs;
+		bool is_mt = code >= ABS_MT_TOUCH_MAJOR &&
+			     code <= ABS_MT_TOOL_Y &&
+			     libevdev_has_event_code(evdev, EV_ABS,
+						     ABS_MT_SLOT);
+
+		if (code == ABS_MT_SLOT) {
+			if (value >= 0 && value < libevdev_get_num_slots(evdev))
+				d->in_process.slot = value;
+			return;
+		}
+
+		abs = libevdev_get_abs_info(evdev, code);
+		if (is_mt)
+			old = libevdev_get_slot_value(evdev,
+						      d->in_process.slot,
+						      code);
+		else
+			old = libevdev_get_event_value(evdev, type, code);
+
+		value = defuzz(value, old, abs->fuzz);
+		if (value == old)
+			return;
+
+		if (is_mt) {
+			libevdev_set_slot_value(evdev,
+						d->in_process.slot,
+						code,
+						value);
+			if (libevdev_get_current_slot(evdev) !=
+			    d->in_process.slot) {
+				libevdev_set_event_value(evdev,
+							 EV_ABS,
+							 ABS_MT_SLOT,
+							 d->in_process.slot);
+				write_event(d, EV_ABS, ABS_MT_SLOT,
+					    d->in_process.slot);
+			}
+		} else {
+			libevdev_set_event_value(evdev, type, code, value);
+		}
+		break;
+	}
+	default:
+		break;
+	}
+
+	write_event(d, type, code, value);
+}
@@ -127,4 +127,11 @@ void litest_set_current_device(struct litest_device *device);
 int litest_scale(const struct litest_device *d, unsigned int axis, double val);
 void litest_generic_device_teardown(void);
 
+struct libinput_device *litest_in_process_add_device(struct litest_device *d);
+void litest_set_in_process(void);
+void litest_in_process_write_event(struct litest_device *d,
+				   unsigned int type,
+				   unsigned int code,
+				   int value);
+
 #endif
@@ -49,6 +49,7 @@
 #include "litest.h"
 #include "litest-int.h"
 #include "libinput-util.h"
+#include "timer.h"
 
 #define UDEV_RULES_D "/run/udev/rules.d"
 #define UDEV_RULE_PREFIX "99-litest-"
@@ -63,6 +64,11 @@
 static int jobs = 8;
 static int in_debugger = -1;
 static int verbose = 0;
+/* shared by all contexts when running with --virtual-clock */
+static struct libinput_clock *litest_clock = NULL;
+static bool use_virtual_clock = false;
+/* --in-process: devices are fed through a pipe, no uinput or udev */
+static bool in_process = false;
 const char *filter_test = NULL;
 const char *filter_device = NULL;
 const char *filter_group = NULL;
@@ -77,6 +83,10 @@ struct list created_files_list; /* list of all files to remove at the end of
 
 static void litest_init_udev_rules(struct list *created_files_list);
 static void litest_remove_udev_rules(struct list *created_files_list);
+static struct libevdev *litest_create_libevdev(const char *name,
+					       const struct input_id *id,
+					       const struct input_absinfo *abs,
+					       const int *events);
 
 /* defined for the litest selftest */
 #ifndef LITEST_DISABLE_BACKTRACE_LOGGING
@@ -509,6 +519,29 @@ litest_reload_udev_rules(void)
 	litest_system("udevadm hwdb --update");
 }
 
+static bool
+litest_in_process_skip_suite(const char *suite_name)
+{
+	if (!in_process)
+		return false;
+
+	/* the udev and path backends need device nodes, individual tests
+	 * check litest_in_process() themselves */
+	return fnmatch("udev:*", suite_name, 0) == 0 ||
+	       fnmatch("path:*", suite_name, 0) == 0;
+}
+
+static bool
+litest_in_process_skip_device(const struct litest_test_device *dev)
+{
+	if (!in_process)
+		return false;
+
+	/* Protocol A needs mtdev and thus a device node, a custom create
+	 * hook makes its own uinput device */
+	return (dev->features & LITEST_PROTOCOL_A) || dev->create;
+}
+
 static void
 litest_add_tcase_for_device(struct suite *suite,
 			    const char *funcname,
@@ -621,6 +654,7 @@ litest_add_tcase(const char *suite_name,
 	struct litest_test_device **dev = devices;
 	struct suite *suite;
 	bool added = false;
+	bool skipped = false;
 
 	litest_assert(required >= LITEST_DISABLE_DEVICE);
 	litest_assert(excluded >= LITEST_DISABLE_DEVICE);
@@ -633,6 +667,9 @@ litest_add_tcase(const char *suite_name,
 	    fnmatch(filter_group, suite_name, 0) != 0)
 		return;
 
+	if (litest_in_process_skip_suite(suite_name))
+		return;
+
 	suite = get_suite(suite_name);
 
 	if (required == LITEST_DISABLE_DEVICE &&
@@ -647,6 +684,10 @@ litest_add_tcase(const char *suite_name,
 			if (((*dev)->features & required) != required ||
 			    ((*dev)->features & excluded) != 0)
 				continue;
+			if (litest_in_process_skip_device(*dev)) {
+				skipped = true;
+				continue;
+			}
 
 			litest_add_tcase_for_device(suite,
 						    funcname,
@@ -660,6 +701,10 @@ litest_add_tcase(const char *suite_name,
 			if (filter_device &&
 			    fnmatch(filter_device, (*dev)->shortname, 0) != 0)
 				continue;
+			if (litest_in_process_skip_device(*dev)) {
+				skipped = true;
+				continue;
+			}
 
 			litest_add_tcase_for_device(suite,
 						    funcname,
@@ -670,7 +715,7 @@ litest_add_tcase(const char *suite_name,
 		}
 	}
 
-	if (!added &&
+	if (!added && !skipped &&
 	    filter_test == NULL &&
 	    filter_device == NULL &&
 	    filter_group == NULL) {
@@ -755,6 +800,9 @@ _litest_add_ranged_for_device(const char *name,
 	    fnmatch(filter_group, name, 0) != 0)
 		return;
 
+	if (litest_in_process_skip_suite(name))
+		return;
+
 	s = get_suite(name);
 	for (; *dev; dev++) {
 		if (filter_device &&
@@ -764,6 +812,9 @@ _litest_add_ranged_for_device(const char *name,
 		}
 
 		if ((*dev)->type == type) {
+			if (litest_in_process_skip_device(*dev))
+				return;
+
 			litest_add_tcase_for_device(s,
 						    funcname,
 						    func,
@@ -990,7 +1041,22 @@ litest_run(int argc, char **argv)
 	if (getenv("LITEST_VERBOSE"))
 		verbose = 1;
 
-	litest_init_udev_rules(&created_files_list);
+	if (getenv("LITEST_VIRTUAL_CLOCK"))
+		use_virtual_clock = true;
+
+	if (use_virtual_clock) {
+		struct timespec ts;
+
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		litest_clock = libinput_clock_create_virtual(
+					s2us(ts.tv_sec) + ns2us(ts.tv_nsec));
+		litest_assert_notnull(litest_clock);
+	}
+
+	/* the in-process devices emulate the rules, no need to install
+	 * them (or be root) */
+	if (!in_process)
+		litest_init_udev_rules(&created_files_list);
 
 	litest_setup_sighandler(SIGINT);
 
@@ -1001,7 +1067,8 @@ litest_run(int argc, char **argv)
 
 	litest_free_test_list(&all_tests);
 
-	litest_remove_udev_rules(&created_files_list);
+	if (!in_process)
+		litest_remove_udev_rules(&created_files_list);
 
 	return failed;
 }
@@ -1196,6 +1263,18 @@ litest_init_device_udev_rules(struct litest_test_device *dev)
 	return path;
 }
 
+void
+litest_set_in_process(void)
+{
+	in_process = true;
+}
+
+bool
+litest_in_process(void)
+{
+	return in_process;
+}
+
 static struct litest_device *
 litest_create(enum litest_device_type which,
 	      const char *name_override,
@@ -1222,6 +1301,7 @@ litest_create(enum litest_device_type which,
 
 	d = zalloc(sizeof(*d));
 	litest_assert(d != NULL);
+	d->in_process.fd = -1;
 
 	/* device has custom create method */
 	if ((*dev)->create) {
@@ -1238,10 +1318,15 @@ litest_create(enum litest_device_type which,
 	name = name_override ? name_override : (*dev)->name;
 	id = id_override ? id_override : (*dev)->id;
 
-	d->uinput = litest_create_uinput_device_from_description(name,
-								 id,
-								 abs,
-								 events);
+	if (in_process) {
+		d->evdev = litest_create_libevdev(name, id, abs, events);
+		d->in_process.udev_rule = (*dev)->udev_rule;
+	} else {
+		d->uinput = litest_create_uinput_device_from_description(name,
+									 id,
+									 abs,
+									 events);
+	}
 	d->interface = (*dev)->interface;
 
 	for (e = events; *e != -1; e += 2) {
@@ -1263,7 +1348,7 @@ litest_create(enum litest_device_type which,
 }
 
 struct libinput *
-litest_create_context(void)
+litest_create_context_with_clock(struct libinput_clock *clock)
 {
 	struct libinput *libinput =
 		libinput_path_create_context(&interface, NULL);
@@ -1273,9 +1358,18 @@ litest_create_context(void)
 	if (verbose)
 		libinput_log_set_priority(libinput, LIBINPUT_LOG_PRIORITY_DEBUG);
 
+	if (clock)
+		libinput_clock_attach(clock, libinput);
+
 	return libinput;
 }
 
+struct libinput *
+litest_create_context(void)
+{
+	return litest_create_context_with_clock(litest_clock);
+}
+
 void
 litest_disable_log_handler(struct libinput *libinput)
 {
@@ -1327,16 +1421,22 @@ litest_add_device_with_overrides(struct libinput *libinput,
 			  abs_override,
 			  events_override);
 
-	path = libevdev_uinput_get_devnode(d->uinput);
-	litest_assert(path != NULL);
-	fd = open(path, O_RDWR|O_NONBLOCK);
-	litest_assert_int_ne(fd, -1);
+	d->libinput = libinput;
 
-	rc = libevdev_new_from_fd(fd, &d->evdev);
-	litest_assert_int_eq(rc, 0);
+	if (in_process) {
+		d->libinput_device = litest_in_process_add_device(d);
+	} else {
+		path = libevdev_uinput_get_devnode(d->uinput);
+		litest_assert(path != NULL);
+		fd = open(path, O_RDWR|O_NONBLOCK);
+		litest_assert_int_ne(fd, -1);
 
-	d->libinput = libinput;
-	d->libinput_device = libinput_path_add_device(d->libinput, path);
+		rc = libevdev_new_from_fd(fd, &d->evdev);
+		litest_assert_int_eq(rc, 0);
+
+		d->libinput_device = libinput_path_add_device(d->libinput,
+							      path);
+	}
 	litest_assert(d->libinput_device != NULL);
 	libinput_device_ref(d->libinput_device);
 
@@ -1411,9 +1511,13 @@ litest_delete_device(struct litest_device *d)
 	libinput_path_remove_device(d->libinput_device);
 	if (d->owns_context)
 		libinput_unref(d->libinput);
-	close(libevdev_get_fd(d->evdev));
+	if (d->in_process.fd != -1)
+		close(d->in_process.fd);
+	else
+		close(libevdev_get_fd(d->evdev));
 	libevdev_free(d->evdev);
-	libevdev_uinput_destroy(d->uinput);
+	if (d->uinput)
+		libevdev_uinput_destroy(d->uinput);
 	free(d->private);
 	memset(d,0, sizeof(*d));
 	free(d);
@@ -1428,6 +1532,11 @@ litest_event(struct litest_device *d, unsigned int type,
 	if (d->skip_ev_syn && type == EV_SYN && code == SYN_REPORT)
 		return;
 
+	if (d->in_process.fd != -1) {
+		litest_in_process_write_event(d, type, code, value);
+		return;
+	}
+
 	ret = libevdev_uinput_write_event(d->uinput, type, code, value);
 	litest_assert_int_eq(ret, 0);
 }
@@ -1801,7 +1910,7 @@ litest_touch_move_to(struct litest_device *d,
 				  y_from + (y_to - y_from)/steps * i);
 		if (sleep_ms) {
 			libinput_dispatch(d->libinput);
-			msleep(sleep_ms);
+			litest_msleep(sleep_ms);
 			libinput_dispatch(d->libinput);
 		}
 	}
@@ -1823,7 +1932,7 @@ litest_touch_move_to_extended(struct litest_device *d,
 					   axes);
 		if (sleep_ms) {
 			libinput_dispatch(d->libinput);
-			msleep(sleep_ms);
+			litest_msleep(sleep_ms);
 			libinput_dispatch(d->libinput);
 		}
 	}
@@ -1922,7 +2031,7 @@ litest_touch_move_two_touches(struct litest_device *d,
 		litest_pop_event_frame(d);
 		if (sleep_ms) {
 			libinput_dispatch(d->libinput);
-			msleep(sleep_ms);
+			litest_msleep(sleep_ms);
 		}
 		libinput_dispatch(d->libinput);
 	}
@@ -1949,7 +2058,7 @@ litest_touch_move_three_touches(struct litest_device *d,
 					y2 + dy / steps * i);
 		if (sleep_ms) {
 			libinput_dispatch(d->libinput);
-			msleep(sleep_ms);
+			litest_msleep(sleep_ms);
 			libinput_dispatch(d->libinput);
 		}
 	}
@@ -2031,7 +2140,7 @@ litest_hover_move_to(struct litest_device *d,
 				  y_from + (y_to - y_from)/steps * i);
 		if (sleep_ms) {
 			libinput_dispatch(d->libinput);
-			msleep(sleep_ms);
+			litest_msleep(sleep_ms);
 			libinput_dispatch(d->libinput);
 		}
 	}
@@ -2054,7 +2163,7 @@ litest_hover_move_two_touches(struct litest_device *d,
 		litest_pop_event_frame(d);
 		if (sleep_ms) {
 			libinput_dispatch(d->libinput);
-			msleep(sleep_ms);
+			litest_msleep(sleep_ms);
 			libinput_dispatch(d->libinput);
 		}
 	}
@@ -2553,16 +2662,15 @@ litest_assert_empty_queue(struct libinput *li)
 	litest_assert(empty_queue);
 }
 
-static struct libevdev_uinput *
-litest_create_uinput(const char *name,
-		     const struct input_id *id,
-		     const struct input_absinfo *abs_info,
-		     const int *events)
+static struct libevdev *
+litest_create_libevdev(const char *name,
+		       const struct input_id *id,
+		       const struct input_absinfo *abs_info,
+		       const int *events)
 {
-	struct libevdev_uinput *uinput;
 	struct libevdev *dev;
 	int type, code;
-	int rc, fd;
+	int rc;
 	const struct input_absinfo *abs;
 	const struct input_absinfo default_abs = {
 		.value = 0,
@@ -2573,7 +2681,6 @@ litest_create_uinput(const char *name,
 		.resolution = 100
 	};
 	char buf[512];
-	const char *devnode;
 
 	dev = libevdev_new();
 	litest_assert(dev != NULL);
@@ -2611,6 +2718,27 @@ litest_create_uinput(const char *name,
 		litest_assert_int_eq(rc, 0);
 	}
 
+	return dev;
+}
+
+static struct libevdev_uinput *
+litest_create_uinput(const char *name,
+		     const struct input_id *id,
+		     const struct input_absinfo *abs_info,
+		     const int *events)
+{
+	struct libevdev_uinput *uinput;
+	struct libevdev *dev;
+	int rc, fd;
+	const struct input_absinfo *abs;
+	const char *devnode;
+
+	litest_assert_msg(!in_process,
+			  "Custom uinput devices are not supported with "
+			  "--in-process\n");
+
+	dev = litest_create_libevdev(name, id, abs_info, events);
+
 	rc = libevdev_uinput_create_from_device(dev,
 					        LIBEVDEV_UINPUT_OPEN_MANAGED,
 						&uinput);
@@ -3045,6 +3173,27 @@ litest_is_switch_event(struct libinput_event *event,
 	return swev;
 }
 
+void
+litest_serialize_round_trip(struct libinput_event *event,
+			    union libinput_event_data *data)
+{
+	uint8_t buffer[LIBINPUT_EVENT_SERIALIZED_MAX_SIZE];
+	enum libinput_event_type type;
+	size_t size;
+
+	size = libinput_event_serialize(event, buffer, sizeof(buffer));
+	litest_assert_int_gt(size, 0);
+	litest_assert_int_le(size, sizeof(buffer));
+
+	litest_assert_int_eq(libinput_event_parse(buffer,
+						  size,
+						  &type,
+						  data,
+						  sizeof(*data)),
+			     size);
+	litest_assert_int_eq(type, libinput_event_get_type(event));
+}
+
 void
 litest_assert_pad_button_event(struct libinput *li,
 			       unsigned int button,
@@ -3162,76 +3311,90 @@ litest_assert_touch_sequence(struct libinput *li)
 	libinput_event_destroy(event);
 }
 
+void
+litest_msleep(unsigned int ms)
+{
+	uint64_t now;
+
+	if (!litest_clock) {
+		msleep(ms);
+		return;
+	}
+
+	now = libinput_clock_get_time(litest_clock);
+	libinput_clock_set_time(litest_clock, now + ms2us(ms));
+}
+
 void
 litest_timeout_tap(void)
 {
-	msleep(200);
+	litest_msleep(200);
 }
 
 void
 litest_timeout_tapndrag(void)
 {
-	msleep(520);
+	litest_msleep(520);
 }
 
 void
 litest_timeout_softbuttons(void)
 {
-	msleep(300);
+	litest_msleep(300);
 }
 
 void
 litest_timeout_buttonscroll(void)
 {
-	msleep(300);
+	litest_msleep(300);
 }
 
 void
 litest_timeout_finger_switch(void)
 {
-	msleep(120);
+	litest_msleep(120);
 }
 
 void
 litest_timeout_edgescroll(void)
 {
-	msleep(300);
+	litest_msleep(300);
 }
 
 void
 litest_timeout_middlebutton(void)
 {
-	msleep(70);
+	litest_msleep(70);
 }
 
 void
 litest_timeout_dwt_short(void)
 {
-	msleep(220);
+	litest_msleep(220);
 }
 
 void
 litest_timeout_dwt_long(void)
 {
-	msleep(520);
+	litest_msleep(520);
 }
 
 void
 litest_timeout_gesture(void)
 {
-	msleep(120);
+	litest_msleep(120);
 }
 
 void
 litest_timeout_gesture_scroll(void)
 {
-	msleep(180);
+	litest_msleep(180);
 }
 
 void
 litest_timeout_trackpoint(void)
 {
-	msleep(320);
+	litest_msleep(320);
 }
 
 void
@@ -3427,6 +3590,8 @@ litest_parse_argv(int argc, char **argv)
 		OPT_JOBS,
 		OPT_LIST,
 		OPT_VERBOSE,
+		OPT_VIRTUAL_CLOCK,
+		OPT_IN_PROCESS,
 	};
 	static const struct option opts[] = {
 		{ "filter-test", 1, 0, OPT_FILTER_TEST },
@@ -3435,6 +3600,8 @@ litest_parse_argv(int argc, char **argv)
 		{ "jobs", 1, 0, OPT_JOBS },
 		{ "list", 0, 0, OPT_LIST },
 		{ "verbose", 0, 0, OPT_VERBOSE },
+		{ "virtual-clock", 0, 0, OPT_VIRTUAL_CLOCK },
+		{ "in-process", 0, 0, OPT_IN_PROCESS },
 		{ 0, 0, 0, 0}
 	};
 
@@ -3447,6 +3614,10 @@ litest_parse_argv(int argc, char **argv)
 	if (in_debugger)
 		want_jobs = JOBS_SINGLE;
 
+	/* before the tests are set up, they are filtered by it */
+	if (getenv("LITEST_IN_PROCESS"))
+		in_process = true;
+
 	while(1) {
 		int c;
 		int option_index = 0;
@@ -3480,6 +3651,12 @@ litest_parse_argv(int argc, char **argv)
 		case OPT_VERBOSE:
 			verbose = 1;
 			break;
+		case OPT_VIRTUAL_CLOCK:
+			use_virtual_clock = true;
+			break;
+		case OPT_IN_PROCESS:
+			in_process = true;
+			break;
 		default:
 			fprintf(stderr, "usage: %s [--list]\n", argv[0]);
 			return LITEST_MODE_ERROR;
@@ -295,6 +295,15 @@ struct litest_device {
 	int skip_ev_syn;
 	struct litest_semi_mt semi_mt; /** only used for semi-mt device */
 
+	/** only used with --in-process */
+	struct {
+		int fd; /* write end of the device's pipe, or -1 */
+		const char *udev_rule;
+		int slot; /* last ABS_MT_SLOT written */
+		unsigned int nevents; /* events since the last SYN_REPORT */
+		unsigned int nframes; /* SYN_REPORTs written */
+	} in_process;
+
 	void *private; /* device-specific data */
 };
 
@@ -320,6 +329,8 @@ litest_axis_set_value(struct axis_replacement *axes, int code, double value)
 	litest_abort_msg("Missing axis code %d\n", code);
 }
 
+struct libinput_clock;
+
 /* A loop range, resolves to:
    for (i = lower; i < upper; i++)
  */
@@ -329,6 +340,14 @@ struct range {
 };
 
 struct libinput *litest_create_context(void);
+/* Like litest_create_context() but the context runs on the given virtual
+ * clock, with or without --virtual-clock */
+struct libinput *
+litest_create_context_with_clock(struct libinput_clock *clock);
+/* True when the devices are emulated in-process. Tests that open the
+ * device node of their test device or create their own uinput device
+ * must return early in that case */
+bool litest_in_process(void);
 void litest_disable_log_handler(struct libinput *libinput);
 void litest_restore_log_handler(struct libinput *libinput);
 void litest_set_log_handler_bug(struct libinput *libinput);
@@ -628,6 +647,12 @@ litest_is_switch_event(struct libinput_event *event,
 		       enum libinput_switch sw,
 		       enum libinput_switch_state state);
 
+/* Serializes event and parses it back into data, asserting that both
+ * succeed and the event type survives the round trip */
+void
+litest_serialize_round_trip(struct libinput_event *event,
+			    union libinput_event_data *data);
+
 void
 litest_assert_button_event(struct libinput *li,
 			   unsigned int button,
@@ -666,6 +691,14 @@ litest_create_uinput_abs_device(const char *name,
 				const struct input_absinfo *abs,
 				...);
 
+/* Like msleep() but with --virtual-clock, moves the clock forward
+ * instead of sleeping. The clock only moves here, so with
+ * --virtual-clock all events sent between two calls have the same
+ * timestamp, regardless of how many frames they span. Tests that depend
+ * on the time between frames must call this between the frames. */
+void
+litest_msleep(unsigned int ms);
+
 void
 litest_timeout_tap(void);
 
@@ -880,6 +913,18 @@ litest_disable_drag_lock(struct libinput_device *device)
 	litest_assert_int_eq(status, expected);
 }
 
+static inline void
+litest_enable_speculative_tap(struct libinput_device *device)
+{
+	enum libinput_config_status status, expected;
+
+	expected = LIBINPUT_CONFIG_STATUS_SUCCESS;
+	status = libinput_device_config_tap_set_speculative_enabled(device,
+								    LIBINPUT_CONFIG_TAP_SPECULATIVE_ENABLED);
+
+	litest_assert_int_eq(status, expected);
+}
+
 static inline void
 litest_enable_middleemu(struct litest_device *dev)
 {
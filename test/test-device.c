@@ -848,6 +848,9 @@ START_TEST(device_group_leak)
 	struct libevdev_uinput *uinput;
 	struct libinput_device_group *group;
 
+	if (litest_in_process())
+		return;
+
 	uinput = litest_create_uinput_device("test device", NULL,
 					     EV_KEY, BTN_LEFT,
 					     EV_KEY, BTN_RIGHT,
@@ -877,6 +880,9 @@ START_TEST(abs_device_no_absx)
 	struct libinput *li;
 	struct libinput_device *device;
 
+	if (litest_in_process())
+		return;
+
 	uinput = litest_create_uinput_device("test device", NULL,
 					     EV_KEY, BTN_LEFT,
 					     EV_KEY, BTN_RIGHT,
@@ -900,6 +906,9 @@ START_TEST(abs_device_no_absy)
 	struct libinput *li;
 	struct libinput_device *device;
 
+	if (litest_in_process())
+		return;
+
 	uinput = litest_create_uinput_device("test device", NULL,
 					     EV_KEY, BTN_LEFT,
 					     EV_KEY, BTN_RIGHT,
@@ -923,6 +932,9 @@ START_TEST(abs_mt_device_no_absy)
 	struct libinput *li;
 	struct libinput_device *device;
 
+	if (litest_in_process())
+		return;
+
 	uinput = litest_create_uinput_device("test device", NULL,
 					     EV_KEY, BTN_LEFT,
 					     EV_KEY, BTN_RIGHT,
@@ -949,6 +961,9 @@ START_TEST(abs_mt_device_no_absx)
 	struct libinput *li;
 	struct libinput_device *device;
 
+	if (litest_in_process())
+		return;
+
 	uinput = litest_create_uinput_device("test device", NULL,
 					     EV_KEY, BTN_LEFT,
 					     EV_KEY, BTN_RIGHT,
@@ -1103,6 +1118,9 @@ START_TEST(ignore_joystick)
 		{ -1, -1, -1, -1, -1, -1 }
 	};
 
+	if (litest_in_process())
+		return;
+
 	li = litest_create_context();
 	litest_disable_log_handler(li);
 	litest_drain_events(li);
@@ -1144,6 +1162,9 @@ START_TEST(device_accelerometer)
 		{ -1, -1, -1, -1, -1, -1 }
 	};
 
+	if (litest_in_process())
+		return;
+
 	li = litest_create_context();
 	litest_disable_log_handler(li);
 
@@ -1263,6 +1284,9 @@ START_TEST(device_nonpointer_rel)
 	struct libinput_device *device;
 	int i;
 
+	if (litest_in_process())
+		return;
+
 	uinput = litest_create_uinput_device("test device",
 					     NULL,
 					     EV_KEY, KEY_A,
@@ -1305,6 +1329,9 @@ START_TEST(device_touchpad_rel)
 	};
 	int i;
 
+	if (litest_in_process())
+		return;
+
 	uinput = litest_create_uinput_abs_device("test device",
 						 NULL, abs,
 						 EV_KEY, BTN_TOOL_FINGER,
@@ -1345,6 +1372,9 @@ START_TEST(device_touch_rel)
 	};
 	int i;
 
+	if (litest_in_process())
+		return;
+
 	uinput = litest_create_uinput_abs_device("test device",
 						 NULL, abs,
 						 EV_KEY, BTN_TOUCH,
@@ -1382,6 +1412,9 @@ START_TEST(device_abs_rel)
 	};
 	int i;
 
+	if (litest_in_process())
+		return;
+
 	uinput = litest_create_uinput_abs_device("test device",
 						 NULL, abs,
 						 EV_KEY, BTN_TOUCH,
@@ -1595,6 +1628,232 @@ START_TEST(device_seat_phys_name)
 }
 END_TEST
 
+static inline uint64_t
+latency_buckets_sum(const struct libinput_latency_stats *stats)
+{
+	uint64_t sum = 0;
+	unsigned int i;
+
+	for (i = 0; i < LIBINPUT_LATENCY_STATS_BUCKETS; i++)
+		sum += stats->buckets[i];
+
+	return sum;
+}
+
+START_TEST(device_latency_stats)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	struct libinput *li = dev->libinput;
+	struct libinput_latency_stats processing, queued;
+	struct libinput_event *event;
+	size_t size;
+	int i, nevents = 0;
+
+	ck_assert_int_eq(libinput_get_latency_accounting(li), 0);
+
+	/* disabled by default, nothing is counted */
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_drain_events(li);
+
+	size = libinput_device_get_latency_stats(device,
+						 LIBINPUT_LATENCY_STAGE_PROCESSING,
+						 &processing,
+						 sizeof(processing));
+	ck_assert_int_eq(size, sizeof(processing));
+	size = libinput_device_get_latency_stats(device,
+						 LIBINPUT_LATENCY_STAGE_QUEUED,
+						 &queued,
+						 sizeof(queued));
+	ck_assert_int_eq(size, sizeof(queued));
+	ck_assert_int_eq(processing.count, 0);
+	ck_assert_int_eq(queued.count, 0);
+
+	libinput_set_latency_accounting(li, 1);
+	ck_assert_int_eq(libinput_get_latency_accounting(li), 1);
+
+	for (i = 0; i < 5; i++) {
+		litest_event(dev, EV_REL, REL_X, 1);
+		litest_event(dev, EV_REL, REL_Y, 1);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	}
+
+	libinput_dispatch(li);
+	while ((event = libinput_get_event(li))) {
+		nevents++;
+		libinput_event_destroy(event);
+	}
+	ck_assert_int_gt(nevents, 0);
+
+	libinput_device_get_latency_stats(device,
+					  LIBINPUT_LATENCY_STAGE_PROCESSING,
+					  &processing,
+					  sizeof(processing));
+	libinput_device_get_latency_stats(device,
+					  LIBINPUT_LATENCY_STAGE_QUEUED,
+					  &queued,
+					  sizeof(queued));
+
+	ck_assert_int_eq(processing.count, queued.count);
+	ck_assert_int_ge(processing.count, nevents);
+	ck_assert_int_eq(latency_buckets_sum(&processing), processing.count);
+	ck_assert_int_eq(latency_buckets_sum(&queued), queued.count);
+	ck_assert_int_ge(processing.sum_usec, processing.max_usec);
+	ck_assert_int_ge(queued.sum_usec, queued.max_usec);
+}
+END_TEST
+
+START_TEST(device_latency_stats_timer)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	struct libinput *li = dev->libinput;
+	struct libinput_latency_stats processing, queued;
+
+	litest_enable_tap(device);
+	litest_enable_tap_drag(device);
+	litest_drain_events(li);
+
+	libinput_set_latency_accounting(li, 1);
+
+	/* with tap-and-drag the button release is posted by the tap
+	 * timer */
+	litest_touch_down(dev, 0, 50, 50);
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+	litest_timeout_tap();
+	libinput_dispatch(li);
+
+	litest_assert_button_event(li,
+				   BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_PRESSED);
+	litest_assert_button_event(li,
+				   BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_RELEASED);
+
+	libinput_device_get_latency_stats(device,
+					  LIBINPUT_LATENCY_STAGE_PROCESSING,
+					  &processing,
+					  sizeof(processing));
+	libinput_device_get_latency_stats(device,
+					  LIBINPUT_LATENCY_STAGE_QUEUED,
+					  &queued,
+					  sizeof(queued));
+
+	ck_assert_int_lt(processing.count, queued.count);
+	ck_assert_int_eq(queued.count, 2);
+}
+END_TEST
+
+START_TEST(device_latency_stats_invalid)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	struct libinput_latency_stats stats;
+	size_t size;
+
+	litest_set_log_handler_bug(dev->libinput);
+	size = libinput_device_get_latency_stats(device,
+						 LIBINPUT_LATENCY_STAGE_QUEUED + 1,
+						 &stats,
+						 sizeof(stats));
+	ck_assert_int_eq(size, 0);
+	litest_restore_log_handler(dev->libinput);
+
+	/* a smaller struct only gets the fields that fit */
+	size = libinput_device_get_latency_stats(device,
+						 LIBINPUT_LATENCY_STAGE_QUEUED,
+						 &stats,
+						 sizeof(uint64_t));
+	ck_assert_int_eq(size, sizeof(uint64_t));
+}
+END_TEST
+
+START_TEST(device_cpu_stats)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	struct libinput *li = dev->libinput;
+	struct libinput_cpu_stats process, accel;
+	size_t size;
+	int i;
+
+	ck_assert_int_eq(libinput_get_cpu_accounting(li), 0);
+
+	litest_drain_events(li);
+
+	/* disabled by default, nothing is counted */
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_drain_events(li);
+
+	size = libinput_device_get_cpu_stats(device,
+					     LIBINPUT_CPU_STAT_PROCESS,
+					     &process,
+					     sizeof(process));
+	ck_assert_int_eq(size, sizeof(process));
+	ck_assert_int_eq(process.calls, 0);
+	ck_assert_int_eq(process.nsec, 0);
+
+	libinput_set_cpu_accounting(li, 1);
+	ck_assert_int_eq(libinput_get_cpu_accounting(li), 1);
+
+	for (i = 0; i < 5; i++) {
+		litest_event(dev, EV_REL, REL_X, 1);
+		litest_event(dev, EV_REL, REL_Y, 1);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	}
+	litest_drain_events(li);
+
+	libinput_device_get_cpu_stats(device,
+				      LIBINPUT_CPU_STAT_PROCESS,
+				      &process,
+				      sizeof(process));
+	libinput_device_get_cpu_stats(device,
+				      LIBINPUT_CPU_STAT_POINTER_ACCEL,
+				      &accel,
+				      sizeof(accel));
+	ck_assert_int_ge(process.calls, 15);
+	ck_assert_int_eq(accel.calls, 5);
+	ck_assert_int_ge(process.nsec, accel.nsec);
+
+	/* disabling keeps the counts */
+	libinput_set_cpu_accounting(li, 0);
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_drain_events(li);
+
+	libinput_device_get_cpu_stats(device,
+				      LIBINPUT_CPU_STAT_POINTER_ACCEL,
+				      &accel,
+				      sizeof(accel));
+	ck_assert_int_eq(accel.calls, 5);
+}
+END_TEST
+
+START_TEST(device_cpu_stats_invalid)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	struct libinput_cpu_stats stats;
+	size_t size;
+
+	litest_set_log_handler_bug(dev->libinput);
+	size = libinput_device_get_cpu_stats(device,
+					     LIBINPUT_CPU_STAT_PROCESS - 1,
+					     &stats,
+					     sizeof(stats));
+	ck_assert_int_eq(size, 0);
+	size = libinput_device_get_cpu_stats(device,
+					     LIBINPUT_CPU_STAT_TIMERS + 1,
+					     &stats,
+					     sizeof(stats));
+	ck_assert_int_eq(size, 0);
+	litest_restore_log_handler(dev->libinput);
+}
+END_TEST
+
 void
 litest_setup_tests_device(void)
 {
@@ -1675,4 +1934,11 @@ litest_setup_tests_device(void)
 	litest_add("device:output", device_no_output, LITEST_KEYS, LITEST_ANY);
 
 	litest_add("device:seat", device_seat_phys_name, LITEST_ANY, LITEST_ANY);
+
+	litest_add("device:latency", device_latency_stats, LITEST_RELATIVE, LITEST_ANY);
+	litest_add("device:latency", device_latency_stats_timer, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add("device:latency", device_latency_stats_invalid, LITEST_ANY, LITEST_ANY);
+
+	litest_add("device:cpu", device_cpu_stats, LITEST_RELATIVE, LITEST_ANY);
+	litest_add("device:cpu", device_cpu_stats_invalid, LITEST_ANY, LITEST_ANY);
 }
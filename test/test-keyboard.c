@@ -117,6 +117,9 @@ START_TEST(keyboard_ignore_no_pressed_release)
 		LIBINPUT_KEY_STATE_RELEASED,
 	};
 
+	if (litest_in_process())
+		return;
+
 	/* We can't send pressed -> released -> pressed events using uinput
 	 * as such non-symmetric events are dropped. Work-around this by first
 	 * adding the test device to the tested context after having sent an
@@ -422,6 +425,39 @@ START_TEST(keyboard_no_scroll)
 }
 END_TEST
 
+START_TEST(keyboard_serialize)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_keyboard *kev;
+	struct libinput_event_keyboard_data expected;
+	union libinput_event_data data;
+
+	litest_drain_events(li);
+
+	litest_keyboard_key(dev, KEY_A, true);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	kev = litest_is_keyboard_event(event,
+				       KEY_A,
+				       LIBINPUT_KEY_STATE_PRESSED);
+	libinput_event_keyboard_get_data(kev, &expected, sizeof(expected));
+	litest_serialize_round_trip(event, &data);
+	libinput_event_destroy(event);
+
+	ck_assert_int_eq(data.keyboard.time_usec, expected.time_usec);
+	ck_assert_int_eq(data.keyboard.key, KEY_A);
+	ck_assert_int_eq(data.keyboard.state, LIBINPUT_KEY_STATE_PRESSED);
+	ck_assert_int_eq(data.keyboard.seat_key_count,
+			 expected.seat_key_count);
+
+	litest_keyboard_key(dev, KEY_A, false);
+	litest_drain_events(li);
+}
+END_TEST
+
 void
 litest_setup_tests_keyboard(void)
 {
@@ -437,4 +473,6 @@ litest_setup_tests_keyboard(void)
 	litest_add("keyboard:leds", keyboard_leds, LITEST_ANY, LITEST_ANY);
 
 	litest_add("keyboard:scroll", keyboard_no_scroll, LITEST_KEYS, LITEST_WHEEL);
+
+	litest_add_for_device("keyboard:serialize", keyboard_serialize, LITEST_KEYBOARD);
 }
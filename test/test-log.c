@@ -27,6 +27,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <libinput.h>
+#include <stdio.h>
 #include <unistd.h>
 
 #include "litest.h"
@@ -185,6 +186,73 @@ START_TEST(log_axisrange_warning)
 }
 END_TEST
 
+static int trace_log_handler_called = 0;
+static int trace_log_handler_dropped = 0;
+
+LIBINPUT_ATTRIBUTE_PRINTF(3, 0)
+static void
+trace_log_handler(struct libinput *libinput,
+		  enum libinput_log_priority priority,
+		  const char *format,
+		  va_list args)
+{
+	char buf[1024];
+
+	ck_assert_int_eq(priority, LIBINPUT_LOG_PRIORITY_DEBUG);
+
+	vsnprintf(buf, sizeof(buf), format, args);
+	if (strstr(buf, "older messages dropped")) {
+		trace_log_handler_dropped++;
+		return;
+	}
+
+	trace_log_handler_called++;
+	litest_assert_notnull(strstr(buf, "state"));
+}
+
+START_TEST(log_trace_buffer)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	int i;
+
+	ck_assert_int_eq(libinput_log_get_trace_buffer(li), 0);
+	ck_assert_int_eq(libinput_log_set_trace_buffer(li, 5), 0);
+	ck_assert_int_eq(libinput_log_get_trace_buffer(li), 8);
+
+	litest_drain_events(li);
+
+	/* the trace buffer ignores the log priority */
+	libinput_log_set_priority(li, LIBINPUT_LOG_PRIORITY_ERROR);
+	libinput_log_set_handler(li, trace_log_handler);
+
+	litest_touch_down(dev, 0, 50, 50);
+	for (i = 0; i < 10; i++)
+		litest_touch_move_to(dev, 0, 50, 50, 60, 60 + i, 1, 0);
+	litest_touch_up(dev, 0);
+	litest_drain_events(li);
+
+	ck_assert_int_eq(trace_log_handler_called, 0);
+
+	/* the gesture state is logged on every frame, the ring is full */
+	libinput_log_dump_trace(li);
+	ck_assert_int_eq(trace_log_handler_dropped, 1);
+	ck_assert_int_eq(trace_log_handler_called, 8);
+
+	/* dumping empties the buffer */
+	trace_log_handler_called = 0;
+	trace_log_handler_dropped = 0;
+	libinput_log_dump_trace(li);
+	ck_assert_int_eq(trace_log_handler_called, 0);
+	ck_assert_int_eq(trace_log_handler_dropped, 0);
+
+	ck_assert_int_eq(libinput_log_set_trace_buffer(li, 0), 0);
+	ck_assert_int_eq(libinput_log_get_trace_buffer(li), 0);
+
+	litest_restore_log_handler(li);
+}
+END_TEST
+
 void
 litest_setup_tests_log(void)
 {
@@ -197,4 +265,6 @@ litest_setup_tests_log(void)
 
 	litest_add_ranged("log:warnings", log_axisrange_warning, LITEST_TOUCH, LITEST_ANY, &axes);
 	litest_add_ranged("log:warnings", log_axisrange_warning, LITEST_TOUCHPAD, LITEST_ANY, &axes);
+
+	litest_add("log:trace", log_trace_buffer, LITEST_TOUCHPAD, LITEST_ANY);
 }
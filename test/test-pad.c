@@ -96,7 +96,7 @@ START_TEST(pad_time)
 	libinput_event_destroy(ev);
 
 	litest_drain_events(li);
-	msleep(10);
+	litest_msleep(10);
 
 	litest_button_click(dev, code, 1);
 	litest_button_click(dev, code, 0);
@@ -27,6 +27,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <libinput.h>
+#include <poll.h>
 #include <stdio.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -933,6 +934,140 @@ START_TEST(path_seat_recycle)
 }
 END_TEST
 
+static void
+assert_loop_event(struct libinput *li, enum libinput_event_type type)
+{
+	struct libinput_event *ev;
+
+	ev = libinput_get_event(li);
+	ck_assert_notnull(ev);
+	ck_assert_int_eq(libinput_event_get_type(ev), type);
+	libinput_event_destroy(ev);
+}
+
+START_TEST(path_shared_loop)
+{
+	struct libinput *li1, *li2;
+	struct libinput_loop *loop;
+	struct libevdev_uinput *uinput;
+	struct libinput_device *device;
+	const char *devnode;
+
+	uinput = litest_create_uinput_device("test device", NULL,
+					     EV_KEY, BTN_LEFT,
+					     EV_KEY, BTN_RIGHT,
+					     EV_REL, REL_X,
+					     EV_REL, REL_Y,
+					     -1);
+	devnode = libevdev_uinput_get_devnode(uinput);
+
+	loop = libinput_loop_create();
+	ck_assert_notnull(loop);
+
+	li1 = libinput_path_create_context(&simple_interface, NULL);
+	li2 = libinput_path_create_context(&simple_interface, NULL);
+	ck_assert_int_eq(libinput_loop_attach(loop, li1), 0);
+	ck_assert_int_eq(libinput_get_fd(li1), libinput_loop_get_fd(loop));
+
+	/* attaching after adding a device moves the device's fd over */
+	device = libinput_path_add_device(li2, devnode);
+	ck_assert_notnull(device);
+	ck_assert_int_eq(libinput_loop_attach(loop, li2), 0);
+	ck_assert_int_eq(libinput_get_fd(li2), libinput_loop_get_fd(loop));
+
+	litest_set_log_handler_bug(li1);
+	ck_assert_int_eq(libinput_loop_attach(loop, li1), -EINVAL);
+	litest_restore_log_handler(li1);
+
+	device = libinput_path_add_device(li1, devnode);
+	ck_assert_notnull(device);
+
+	/* the contexts hold a reference each */
+	ck_assert(libinput_loop_unref(loop) == loop);
+
+	libinput_loop_dispatch(loop);
+	assert_loop_event(li1, LIBINPUT_EVENT_DEVICE_ADDED);
+	assert_loop_event(li2, LIBINPUT_EVENT_DEVICE_ADDED);
+
+	libevdev_uinput_write_event(uinput, EV_REL, REL_X, 1);
+	libevdev_uinput_write_event(uinput, EV_REL, REL_Y, 1);
+	libevdev_uinput_write_event(uinput, EV_SYN, SYN_REPORT, 0);
+
+	/* dispatching one context dispatches both */
+	litest_wait_for_event(li1);
+	assert_loop_event(li1, LIBINPUT_EVENT_POINTER_MOTION);
+	assert_loop_event(li2, LIBINPUT_EVENT_POINTER_MOTION);
+
+	libinput_unref(li1);
+	libinput_unref(li2);
+
+	libevdev_uinput_destroy(uinput);
+}
+END_TEST
+
+START_TEST(path_shared_loop_timer)
+{
+	struct libinput *li1, *li2;
+	struct libinput_loop *loop;
+	struct libevdev_uinput *uinput;
+	struct libinput_device *device;
+	struct libinput_event *ev;
+	struct pollfd fds;
+
+	/* no middle button, middle button emulation is enabled and holds
+	 * the left button press back until its timer fires */
+	uinput = litest_create_uinput_device("test device", NULL,
+					     EV_KEY, BTN_LEFT,
+					     EV_KEY, BTN_RIGHT,
+					     EV_REL, REL_X,
+					     EV_REL, REL_Y,
+					     -1);
+
+	loop = libinput_loop_create();
+	ck_assert_notnull(loop);
+
+	li1 = libinput_path_create_context(&simple_interface, NULL);
+	li2 = libinput_path_create_context(&simple_interface, NULL);
+	ck_assert_int_eq(libinput_loop_attach(loop, li1), 0);
+	ck_assert_int_eq(libinput_loop_attach(loop, li2), 0);
+	libinput_loop_unref(loop);
+
+	/* only the second context has a device and thus a timer */
+	device = libinput_path_add_device(li2,
+					  libevdev_uinput_get_devnode(uinput));
+	ck_assert_notnull(device);
+
+	libinput_loop_dispatch(loop);
+	assert_loop_event(li2, LIBINPUT_EVENT_DEVICE_ADDED);
+
+	fds.fd = libinput_loop_get_fd(loop);
+	fds.events = POLLIN;
+	fds.revents = 0;
+
+	libevdev_uinput_write_event(uinput, EV_KEY, BTN_LEFT, 1);
+	libevdev_uinput_write_event(uinput, EV_SYN, SYN_REPORT, 0);
+	ck_assert_int_eq(poll(&fds, 1, 1000), 1);
+	libinput_loop_dispatch(loop);
+	ck_assert(libinput_get_event(li2) == NULL);
+
+	/* the loop's fd wakes up for the timer */
+	litest_timeout_middlebutton();
+	ck_assert_int_eq(poll(&fds, 1, 0), 1);
+
+	libinput_loop_dispatch(loop);
+	ck_assert(libinput_get_event(li1) == NULL);
+	ev = libinput_get_event(li2);
+	ck_assert_notnull(ev);
+	litest_is_button_event(ev, BTN_LEFT, LIBINPUT_BUTTON_STATE_PRESSED);
+	libinput_event_destroy(ev);
+
+	libinput_unref(li1);
+	libinput_unref(li2);
+
+	libevdev_uinput_destroy(uinput);
+}
+END_TEST
+
 START_TEST(path_udev_assign_seat)
 {
 	struct litest_device *dev = litest_current_device();
@@ -956,6 +1091,8 @@ litest_setup_tests_path(void)
 	litest_add_no_device("path:create", path_create_destroy);
 	litest_add("path:create", path_force_destroy, LITEST_ANY, LITEST_ANY);
 	litest_add_no_device("path:create", path_set_user_data);
+	litest_add_no_device("path:loop", path_shared_loop);
+	litest_add_no_device("path:loop", path_shared_loop_timer);
 	litest_add_no_device("path:suspend", path_suspend);
 	litest_add_no_device("path:suspend", path_double_suspend);
 	litest_add_no_device("path:suspend", path_double_resume);
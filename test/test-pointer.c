@@ -23,6 +23,7 @@
 
 #include <config.h>
 
+#include <stddef.h>
 #include <stdio.h>
 #include <check.h>
 #include <errno.h>
@@ -34,6 +35,7 @@
 
 #include "libinput-util.h"
 #include "litest.h"
+#include "timer.h"
 
 static void
 test_relative_event(struct litest_device *dev, int dx, int dy)
@@ -251,6 +253,9 @@ START_TEST(pointer_absolute_initial_state)
 	struct libinput_event_pointer *p1, *p2;
 	int axis = _i; /* looped test */
 
+	if (litest_in_process())
+		return;
+
 	libinput1 = dev->libinput;
 	litest_touch_down(dev, 0, 40, 60);
 	litest_touch_up(dev, 0);
@@ -325,6 +330,106 @@ test_unaccel_event(struct litest_device *dev, int dx, int dy)
       litest_drain_events(dev->libinput);
 }
 
+START_TEST(pointer_motion_msc_timestamp_batched)
+{
+	struct libinput_clock *clock;
+	struct litest_device *ref, *dev;
+	struct libinput *li;
+	struct libinput_event *event;
+	struct libinput_event_pointer *ptrev;
+	int events[] = {
+		EV_KEY, BTN_LEFT,
+		EV_KEY, BTN_RIGHT,
+		EV_KEY, BTN_MIDDLE,
+		EV_REL, REL_X,
+		EV_REL, REL_Y,
+		EV_MSC, MSC_TIMESTAMP,
+		-1, -1,
+	};
+	struct libinput_timestamp_stats stats;
+	double expected[10];
+	uint32_t timestamp = 1000;
+	int i;
+	int nevents = 0;
+
+	clock = libinput_clock_create_virtual(s2us(100));
+	li = litest_create_context_with_clock(clock);
+	ref = litest_add_device(li, LITEST_MOUSE);
+	dev = litest_add_device_with_overrides(li,
+					       LITEST_MOUSE,
+					       "Batching mouse",
+					       NULL, NULL, events);
+	litest_drain_events(li);
+
+	/* The reference: frames 8ms apart, delivered when they happen */
+	for (i = 0; i < 10; i++) {
+		litest_event(ref, EV_REL, REL_X, 2);
+		litest_event(ref, EV_SYN, SYN_REPORT, 0);
+		libinput_dispatch(li);
+
+		event = libinput_get_event(li);
+		ptrev = litest_is_motion_event(event);
+		expected[i] = libinput_event_pointer_get_dx(ptrev);
+		libinput_event_destroy(event);
+
+		libinput_clock_set_time(clock,
+					libinput_clock_get_time(clock) + ms2us(8));
+	}
+
+	/* The same frames generated 8ms apart by the hardware but
+	 * delivered in one batch, i.e. with the same kernel timestamp. The
+	 * filter must see the same intervals as for the reference. */
+	for (i = 0; i < 10; i++) {
+		litest_event(dev, EV_REL, REL_X, 2);
+		litest_event(dev, EV_MSC, MSC_TIMESTAMP, timestamp);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+		timestamp += ms2us(8);
+	}
+	libinput_dispatch(li);
+
+	while ((event = libinput_get_event(li))) {
+		ptrev = litest_is_motion_event(event);
+		ck_assert_int_lt(nevents, 10);
+		ck_assert_double_eq(libinput_event_pointer_get_dx(ptrev),
+				    expected[nevents]);
+		ck_assert_double_eq(libinput_event_pointer_get_dy(ptrev), 0.0);
+		nevents++;
+		libinput_event_destroy(event);
+	}
+	ck_assert_int_eq(nevents, 10);
+
+	/* the first frame has nothing to compare against */
+	ck_assert_int_eq(libinput_device_get_timestamp_stats(dev->libinput_device,
+							     &stats,
+							     sizeof(stats)),
+			 sizeof(stats));
+	ck_assert_int_eq(stats.frames, 10);
+	ck_assert_int_eq(stats.batched, 9);
+	ck_assert_int_eq(stats.resyncs, 0);
+
+	/* a counter reset falls back to the kernel time */
+	litest_event(dev, EV_REL, REL_X, 2);
+	litest_event(dev, EV_MSC, MSC_TIMESTAMP, 0);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_drain_events(li);
+	libinput_device_get_timestamp_stats(dev->libinput_device,
+					    &stats,
+					    sizeof(stats));
+	ck_assert_int_eq(stats.frames, 11);
+	ck_assert_int_eq(stats.resyncs, 1);
+
+	ck_assert_int_eq(libinput_device_get_timestamp_stats(ref->libinput_device,
+							     &stats,
+							     sizeof(stats)),
+			 0);
+
+	litest_delete_device(ref);
+	litest_delete_device(dev);
+	libinput_unref(li);
+	libinput_clock_destroy(clock);
+}
+END_TEST
+
 START_TEST(pointer_motion_unaccel)
 {
       struct litest_device *dev = litest_current_device();
@@ -343,6 +448,202 @@ START_TEST(pointer_motion_unaccel)
 }
 END_TEST
 
+START_TEST(pointer_get_data)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_pointer *ptrev;
+	struct libinput_event_pointer_data data, untouched;
+	size_t size;
+
+	litest_drain_events(li);
+
+	litest_event(dev, EV_REL, REL_X, 10);
+	litest_event(dev, EV_REL, REL_Y, -5);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	ptrev = litest_is_motion_event(event);
+
+	size = libinput_event_pointer_get_data(ptrev, &data, sizeof(data));
+	ck_assert_int_eq(size, sizeof(data));
+	ck_assert_int_eq(data.time_usec,
+			 libinput_event_pointer_get_time_usec(ptrev));
+	ck_assert_double_eq(data.dx, libinput_event_pointer_get_dx(ptrev));
+	ck_assert_double_eq(data.dy, libinput_event_pointer_get_dy(ptrev));
+	ck_assert_double_eq(data.dx_unaccelerated,
+			    libinput_event_pointer_get_dx_unaccelerated(ptrev));
+	ck_assert_double_eq(data.dy_unaccelerated,
+			    libinput_event_pointer_get_dy_unaccelerated(ptrev));
+	ck_assert_int_eq(data.button, 0);
+	ck_assert_int_eq(data.axes, 0);
+
+	/* A caller with an older, smaller struct only gets what fits */
+	memset(&data, 0xab, sizeof(data));
+	memset(&untouched, 0xab, sizeof(untouched));
+	size = libinput_event_pointer_get_data(ptrev,
+					       &data,
+					       offsetof(struct libinput_event_pointer_data,
+							dx_unaccelerated));
+	ck_assert_int_eq(size,
+			 offsetof(struct libinput_event_pointer_data,
+				  dx_unaccelerated));
+	ck_assert_double_eq(data.dx, libinput_event_pointer_get_dx(ptrev));
+	ck_assert_int_eq(memcmp(&data.dx_unaccelerated,
+				&untouched.dx_unaccelerated,
+				sizeof(data) - size),
+			 0);
+
+	libinput_event_destroy(event);
+}
+END_TEST
+
+START_TEST(pointer_serialize)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_pointer *ptrev;
+	struct libinput_event_pointer_data expected;
+	union libinput_event_data data;
+	enum libinput_event_type type;
+	uint8_t buffer[LIBINPUT_EVENT_SERIALIZED_MAX_SIZE];
+	size_t size;
+
+	litest_drain_events(li);
+
+	litest_event(dev, EV_REL, REL_X, 10);
+	litest_event(dev, EV_REL, REL_Y, -5);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	ptrev = litest_is_motion_event(event);
+	libinput_event_pointer_get_data(ptrev, &expected, sizeof(expected));
+
+	/* too small, nothing is written */
+	memset(buffer, 0, sizeof(buffer));
+	size = libinput_event_serialize(event, buffer, 1);
+	ck_assert_int_gt(size, 1);
+	ck_assert_int_le(size, sizeof(buffer));
+	ck_assert_int_eq(buffer[0], 0);
+
+	ck_assert_int_eq(libinput_event_serialize(event,
+						  buffer,
+						  sizeof(buffer)),
+			 size);
+	libinput_event_destroy(event);
+
+	/* truncated buffers are rejected */
+	ck_assert_int_eq(libinput_event_parse(buffer,
+					      size - 1,
+					      &type,
+					      &data,
+					      sizeof(data)),
+			 0);
+
+	ck_assert_int_eq(libinput_event_parse(buffer,
+					      size,
+					      &type,
+					      &data,
+					      sizeof(data)),
+			 size);
+	ck_assert_int_eq(type, LIBINPUT_EVENT_POINTER_MOTION);
+	ck_assert_int_eq(data.pointer.time_usec, expected.time_usec);
+	ck_assert_double_eq(data.pointer.dx, expected.dx);
+	ck_assert_double_eq(data.pointer.dy, expected.dy);
+	ck_assert_double_eq(data.pointer.dx_unaccelerated,
+			    expected.dx_unaccelerated);
+	ck_assert_double_eq(data.pointer.dy_unaccelerated,
+			    expected.dy_unaccelerated);
+
+	/* an unknown version is rejected */
+	buffer[0] = 0xff;
+	ck_assert_int_eq(libinput_event_parse(buffer,
+					      size,
+					      &type,
+					      &data,
+					      sizeof(data)),
+			 0);
+}
+END_TEST
+
+START_TEST(pointer_serialize_button)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_pointer *ptrev;
+	struct libinput_event_pointer_data expected;
+	union libinput_event_data data;
+
+	libinput_device_config_middle_emulation_set_enabled(dev->libinput_device,
+							    LIBINPUT_CONFIG_MIDDLE_EMULATION_DISABLED);
+	litest_drain_events(li);
+
+	litest_button_click(dev, BTN_LEFT, true);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	ptrev = litest_is_button_event(event,
+				       BTN_LEFT,
+				       LIBINPUT_BUTTON_STATE_PRESSED);
+	libinput_event_pointer_get_data(ptrev, &expected, sizeof(expected));
+	litest_serialize_round_trip(event, &data);
+	libinput_event_destroy(event);
+
+	ck_assert_int_eq(data.pointer.time_usec, expected.time_usec);
+	ck_assert_int_eq(data.pointer.button, BTN_LEFT);
+	ck_assert_int_eq(data.pointer.button_state,
+			 LIBINPUT_BUTTON_STATE_PRESSED);
+	ck_assert_int_eq(data.pointer.seat_button_count,
+			 expected.seat_button_count);
+
+	litest_button_click(dev, BTN_LEFT, false);
+	litest_drain_events(li);
+}
+END_TEST
+
+START_TEST(pointer_serialize_axis)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_pointer *ptrev;
+	struct libinput_event_pointer_data expected;
+	union libinput_event_data data;
+
+	litest_drain_events(li);
+
+	litest_event(dev, EV_REL, REL_WHEEL, -1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	ptrev = litest_is_axis_event(event,
+				     LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL,
+				     LIBINPUT_POINTER_AXIS_SOURCE_WHEEL);
+	libinput_event_pointer_get_data(ptrev, &expected, sizeof(expected));
+	litest_serialize_round_trip(event, &data);
+	libinput_event_destroy(event);
+
+	ck_assert_int_eq(data.pointer.time_usec, expected.time_usec);
+	ck_assert_int_eq(data.pointer.axes, expected.axes);
+	ck_assert_int_eq(data.pointer.axis_source,
+			 LIBINPUT_POINTER_AXIS_SOURCE_WHEEL);
+	ck_assert_double_eq(data.pointer.axis_value_vertical,
+			    expected.axis_value_vertical);
+	ck_assert_double_eq(data.pointer.axis_value_horizontal,
+			    expected.axis_value_horizontal);
+	ck_assert_double_eq(data.pointer.axis_value_discrete_vertical,
+			    expected.axis_value_discrete_vertical);
+	ck_assert_double_eq(data.pointer.axis_value_discrete_horizontal,
+			    expected.axis_value_discrete_horizontal);
+}
+END_TEST
+
 static void
 test_button_event(struct litest_device *dev, unsigned int button, int state)
 {
@@ -1598,6 +1899,99 @@ START_TEST(middlebutton_timeout)
 }
 END_TEST
 
+START_TEST(middlebutton_adaptive_timeout)
+{
+	struct libinput_clock *clock;
+	struct litest_device *device;
+	struct libinput *li;
+	struct libinput_middle_emulation_stats stats;
+	enum libinput_config_status status;
+	uint64_t now;
+	int i;
+
+	/* The timeouts are checked to the ms, this needs a virtual clock */
+	clock = libinput_clock_create_virtual(s2us(100));
+	li = litest_create_context_with_clock(clock);
+	device = litest_add_device(li, LITEST_MOUSE);
+
+	status = libinput_device_config_middle_emulation_set_enabled(
+					    device->libinput_device,
+					    LIBINPUT_CONFIG_MIDDLE_EMULATION_ENABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+
+	ck_assert_int_eq(libinput_device_get_middle_emulation_stats(
+						device->libinput_device,
+						&stats,
+						sizeof(stats)),
+			 sizeof(stats));
+	ck_assert_int_eq(stats.chords, 0);
+	ck_assert_int_eq(stats.missed, 0);
+	ck_assert_int_eq(stats.timeout_usec, ms2us(50));
+
+	litest_drain_events(li);
+
+	/* a number of quick chords shrinks the timeout to the minimum */
+	for (i = 0; i < 10; i++) {
+		litest_button_click(device, BTN_LEFT, true);
+		litest_button_click(device, BTN_RIGHT, true);
+		litest_assert_button_event(li,
+					   BTN_MIDDLE,
+					   LIBINPUT_BUTTON_STATE_PRESSED);
+		litest_button_click(device, BTN_LEFT, false);
+		litest_button_click(device, BTN_RIGHT, false);
+		litest_assert_button_event(li,
+					   BTN_MIDDLE,
+					   LIBINPUT_BUTTON_STATE_RELEASED);
+	}
+	litest_assert_empty_queue(li);
+
+	libinput_device_get_middle_emulation_stats(device->libinput_device,
+						   &stats,
+						   sizeof(stats));
+	ck_assert_int_eq(stats.chords, 10);
+	ck_assert_int_eq(stats.missed, 0);
+	ck_assert_int_eq(stats.timeout_usec, ms2us(20));
+
+	/* a left press is now delivered after 20ms instead of 50ms */
+	litest_button_click(device, BTN_LEFT, true);
+	libinput_dispatch(li);
+	now = libinput_clock_get_time(clock);
+
+	libinput_clock_set_time(clock, now + ms2us(15));
+	libinput_dispatch(li);
+	litest_assert_empty_queue(li);
+
+	libinput_clock_set_time(clock, now + ms2us(25));
+	libinput_dispatch(li);
+	litest_assert_button_event(li,
+				   BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_PRESSED);
+
+	litest_button_click(device, BTN_LEFT, false);
+	litest_assert_button_event(li,
+				   BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_RELEASED);
+	litest_assert_empty_queue(li);
+
+	litest_delete_device(device);
+	libinput_unref(li);
+	libinput_clock_destroy(clock);
+}
+END_TEST
+
+START_TEST(middlebutton_stats_unsupported)
+{
+	struct litest_device *device = litest_current_device();
+	struct libinput_middle_emulation_stats stats;
+	size_t size;
+
+	size = libinput_device_get_middle_emulation_stats(device->libinput_device,
+							  &stats,
+							  sizeof(stats));
+	ck_assert_int_eq(size, 0);
+}
+END_TEST
+
 START_TEST(middlebutton_doubleclick)
 {
 	struct litest_device *device = litest_current_device();
@@ -2080,6 +2474,11 @@ litest_setup_tests_pointer(void)
 	litest_add_ranged("pointer:motion", pointer_motion_relative_min_decel, LITEST_RELATIVE, LITEST_ANY, &compass);
 	litest_add("pointer:motion", pointer_motion_absolute, LITEST_ABSOLUTE, LITEST_ANY);
 	litest_add("pointer:motion", pointer_motion_unaccel, LITEST_RELATIVE, LITEST_ANY);
+	litest_add("pointer:motion", pointer_get_data, LITEST_RELATIVE, LITEST_ANY);
+	litest_add("pointer:motion", pointer_serialize, LITEST_RELATIVE, LITEST_ANY);
+	litest_add("pointer:serialize", pointer_serialize_button, LITEST_RELATIVE|LITEST_BUTTON, LITEST_CLICKPAD);
+	litest_add("pointer:serialize", pointer_serialize_axis, LITEST_WHEEL, LITEST_TABLET);
+	litest_add_no_device("pointer:motion", pointer_motion_msc_timestamp_batched);
 	litest_add("pointer:button", pointer_button, LITEST_BUTTON, LITEST_CLICKPAD);
 	litest_add_no_device("pointer:button", pointer_button_auto_release);
 	litest_add_no_device("pointer:button", pointer_seat_button_count);
@@ -2120,6 +2519,8 @@ litest_setup_tests_pointer(void)
 	litest_add("pointer:middlebutton", middlebutton, LITEST_BUTTON, LITEST_CLICKPAD);
 	litest_add("pointer:middlebutton", middlebutton_nostart_while_down, LITEST_BUTTON, LITEST_CLICKPAD);
 	litest_add("pointer:middlebutton", middlebutton_timeout, LITEST_BUTTON, LITEST_CLICKPAD);
+	litest_add_no_device("pointer:middlebutton", middlebutton_adaptive_timeout);
+	litest_add("pointer:middlebutton", middlebutton_stats_unsupported, LITEST_KEYS, LITEST_BUTTON);
 	litest_add("pointer:middlebutton", middlebutton_doubleclick, LITEST_BUTTON, LITEST_CLICKPAD);
 	litest_add("pointer:middlebutton", middlebutton_middleclick, LITEST_BUTTON, LITEST_CLICKPAD);
 	litest_add("pointer:middlebutton", middlebutton_middleclick_during, LITEST_BUTTON, LITEST_CLICKPAD);
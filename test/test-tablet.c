@@ -2419,6 +2419,9 @@ START_TEST(tool_in_prox_before_start)
 	const char *devnode;
 	unsigned int serial;
 
+	if (litest_in_process())
+		return;
+
 	litest_tablet_proximity_in(dev, 10, 10, axes);
 
 	/* for simplicity, we create a new litest context */
@@ -4255,6 +4258,419 @@ START_TEST(cintiq_touch_arbitration_remove_tablet)
 }
 END_TEST
 
+START_TEST(tablet_prediction_config)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_config_status status;
+
+	ck_assert(libinput_device_config_prediction_is_available(device));
+	ck_assert_int_eq(libinput_device_config_prediction_get_default_time(device), 0);
+	ck_assert_int_eq(libinput_device_config_prediction_get_time(device), 0);
+
+	status = libinput_device_config_prediction_set_time(device, 20);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	ck_assert_int_eq(libinput_device_config_prediction_get_time(device), 20);
+
+	status = libinput_device_config_prediction_set_time(device, 1000);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_INVALID);
+	ck_assert_int_eq(libinput_device_config_prediction_get_time(device), 20);
+}
+END_TEST
+
+START_TEST(tablet_prediction_leads)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_tablet_tool *tev;
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ -1, -1 }
+	};
+	int naxis = 0;
+	int i;
+
+	libinput_device_config_prediction_set_time(dev->libinput_device, 16);
+
+	litest_tablet_proximity_in(dev, 10, 50, axes);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	tev = litest_is_tablet_event(event,
+				     LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+	/* nothing to extrapolate from on proximity in */
+	ck_assert_double_eq(libinput_event_tablet_tool_get_predicted_x(tev),
+			    libinput_event_tablet_tool_get_x(tev));
+	libinput_event_destroy(event);
+	litest_drain_events(li);
+
+	for (i = 0; i < 10; i++) {
+		litest_tablet_motion(dev, 12 + i * 2, 50, axes);
+		litest_msleep(2);
+	}
+	libinput_dispatch(li);
+
+	while ((event = libinput_get_event(li))) {
+		double x, predicted_x;
+
+		if (libinput_event_get_type(event) !=
+		    LIBINPUT_EVENT_TABLET_TOOL_AXIS) {
+			libinput_event_destroy(event);
+			continue;
+		}
+
+		tev = libinput_event_get_tablet_tool_event(event);
+		x = libinput_event_tablet_tool_get_x(tev);
+		predicted_x = libinput_event_tablet_tool_get_predicted_x(tev);
+		ck_assert_double_gt(predicted_x, x);
+		ck_assert_double_gt(libinput_event_tablet_tool_get_predicted_x_transformed(tev, 100),
+				    libinput_event_tablet_tool_get_x_transformed(tev, 100));
+
+		naxis++;
+		libinput_event_destroy(event);
+	}
+
+	ck_assert_int_ge(naxis, 5);
+}
+END_TEST
+
+START_TEST(tablet_history_config)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_config_status status;
+
+	ck_assert(libinput_device_config_tablet_history_is_available(device));
+	ck_assert_int_eq(libinput_device_config_tablet_history_get_default_window(device), 0);
+	ck_assert_int_eq(libinput_device_config_tablet_history_get_window(device), 0);
+
+	status = libinput_device_config_tablet_history_set_window(device, 16);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	ck_assert_int_eq(libinput_device_config_tablet_history_get_window(device), 16);
+
+	status = libinput_device_config_tablet_history_set_window(device, 1000);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_INVALID);
+	ck_assert_int_eq(libinput_device_config_tablet_history_get_window(device), 16);
+}
+END_TEST
+
+START_TEST(tablet_history_merge)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_tablet_tool *tev;
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ -1, -1 }
+	};
+	unsigned int nsamples = 0;
+	int i;
+
+	libinput_device_config_tablet_history_set_window(dev->libinput_device,
+							 50);
+
+	litest_tablet_proximity_in(dev, 10, 50, axes);
+	litest_drain_events(li);
+
+	for (i = 0; i < 5; i++)
+		litest_tablet_motion(dev, 12 + i * 2, 50, axes);
+	libinput_dispatch(li);
+
+	/* wait for the end of the window */
+	litest_msleep(60);
+	libinput_dispatch(li);
+
+	while ((event = libinput_get_event(li))) {
+		unsigned int n, j;
+		double x;
+
+		tev = litest_is_tablet_event(event,
+					     LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+		x = libinput_event_tablet_tool_get_x(tev);
+		n = libinput_event_tablet_tool_get_history_size(tev);
+
+		for (j = 0; j < n; j++) {
+			double hx;
+			uint64_t htime;
+
+			hx = libinput_event_tablet_tool_get_history_x(tev, j);
+			htime = libinput_event_tablet_tool_get_history_time_usec(tev, j);
+			ck_assert_double_lt(hx, x);
+			ck_assert_int_le(htime,
+					 libinput_event_tablet_tool_get_time_usec(tev));
+			ck_assert_double_lt(libinput_event_tablet_tool_get_history_x_transformed(tev, j, 100),
+					    libinput_event_tablet_tool_get_x_transformed(tev, 100));
+			if (j > 0)
+				ck_assert_double_lt(libinput_event_tablet_tool_get_history_x(tev, j - 1),
+						    hx);
+		}
+
+		nsamples += n + 1;
+		libinput_event_destroy(event);
+	}
+
+	/* The frames may be split if we're slow, but none may get lost */
+	ck_assert_int_eq(nsamples, 5);
+}
+END_TEST
+
+START_TEST(tablet_history_flush_on_button)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_tablet_tool *tev;
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ -1, -1 }
+	};
+	int i;
+
+	if (!libevdev_has_event_code(dev->evdev, EV_KEY, BTN_STYLUS))
+		return;
+
+	libinput_device_config_tablet_history_set_window(dev->libinput_device,
+							 100);
+
+	litest_tablet_proximity_in(dev, 10, 50, axes);
+	litest_drain_events(li);
+
+	for (i = 0; i < 3; i++)
+		litest_tablet_motion(dev, 12 + i * 2, 50, axes);
+	litest_event(dev, EV_KEY, BTN_STYLUS, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+
+	/* the pending axis event goes out before the button event */
+	event = libinput_get_event(li);
+	tev = litest_is_tablet_event(event, LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+	ck_assert_int_eq(libinput_event_tablet_tool_get_history_size(tev), 2);
+	libinput_event_destroy(event);
+
+	event = libinput_get_event(li);
+	tev = litest_is_tablet_event(event, LIBINPUT_EVENT_TABLET_TOOL_BUTTON);
+	ck_assert_int_eq(libinput_event_tablet_tool_get_button(tev),
+			 BTN_STYLUS);
+	ck_assert_int_eq(libinput_event_tablet_tool_get_history_size(tev), 0);
+	libinput_event_destroy(event);
+
+	litest_assert_empty_queue(li);
+}
+END_TEST
+
+START_TEST(tablet_get_data)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_tablet_tool *tev;
+	struct libinput_event_tablet_tool_data data;
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ -1, -1 }
+	};
+	size_t size;
+
+	litest_tablet_proximity_in(dev, 10, 50, axes);
+	litest_drain_events(li);
+
+	litest_tablet_motion(dev, 20, 40, axes);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	tev = litest_is_tablet_event(event, LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+
+	size = libinput_event_tablet_tool_get_data(tev, &data, sizeof(data));
+	ck_assert_int_eq(size, sizeof(data));
+	ck_assert_int_eq(data.time_usec,
+			 libinput_event_tablet_tool_get_time_usec(tev));
+	ck_assert_ptr_eq(data.tool, libinput_event_tablet_tool_get_tool(tev));
+	ck_assert_int_eq(data.proximity_state,
+			 libinput_event_tablet_tool_get_proximity_state(tev));
+	ck_assert_int_eq(data.tip_state,
+			 libinput_event_tablet_tool_get_tip_state(tev));
+	ck_assert_int_eq(!!(data.changed & LIBINPUT_TABLET_TOOL_DATA_CHANGED_X),
+			 libinput_event_tablet_tool_x_has_changed(tev));
+	ck_assert_int_eq(!!(data.changed & LIBINPUT_TABLET_TOOL_DATA_CHANGED_Y),
+			 libinput_event_tablet_tool_y_has_changed(tev));
+	ck_assert_int_eq(!!(data.changed & LIBINPUT_TABLET_TOOL_DATA_CHANGED_PRESSURE),
+			 libinput_event_tablet_tool_pressure_has_changed(tev));
+	ck_assert_double_eq(data.x, libinput_event_tablet_tool_get_x(tev));
+	ck_assert_double_eq(data.y, libinput_event_tablet_tool_get_y(tev));
+	ck_assert_double_ge(data.x_fraction * 1000,
+			    libinput_event_tablet_tool_get_x_transformed(tev, 1000) - 0.001);
+	ck_assert_double_le(data.x_fraction * 1000,
+			    libinput_event_tablet_tool_get_x_transformed(tev, 1000) + 0.001);
+	ck_assert_double_eq(data.dx, libinput_event_tablet_tool_get_dx(tev));
+	ck_assert_double_eq(data.dy, libinput_event_tablet_tool_get_dy(tev));
+	ck_assert_double_eq(data.pressure,
+			    libinput_event_tablet_tool_get_pressure(tev));
+	ck_assert_double_eq(data.distance,
+			    libinput_event_tablet_tool_get_distance(tev));
+	ck_assert_double_eq(data.tilt_x,
+			    libinput_event_tablet_tool_get_tilt_x(tev));
+	ck_assert_double_eq(data.tilt_y,
+			    libinput_event_tablet_tool_get_tilt_y(tev));
+	ck_assert_double_eq(data.rotation,
+			    libinput_event_tablet_tool_get_rotation(tev));
+	ck_assert_int_eq(data.button, 0);
+
+	libinput_event_destroy(event);
+}
+END_TEST
+
+START_TEST(tablet_get_data_button)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_tablet_tool *tev;
+	struct libinput_event_tablet_tool_data axis, button;
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ ABS_TILT_X, 20 },
+		{ ABS_TILT_Y, 30 },
+		{ -1, -1 }
+	};
+	size_t size;
+
+	if (!libevdev_has_event_code(dev->evdev, EV_KEY, BTN_STYLUS))
+		return;
+
+	litest_tablet_proximity_in(dev, 10, 50, axes);
+	litest_drain_events(li);
+
+	litest_tablet_motion(dev, 20, 40, axes);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	tev = litest_is_tablet_event(event, LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+	size = libinput_event_tablet_tool_get_data(tev, &axis, sizeof(axis));
+	ck_assert_int_eq(size, sizeof(axis));
+	libinput_event_destroy(event);
+	litest_drain_events(li);
+
+	litest_event(dev, EV_KEY, BTN_STYLUS, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	tev = litest_is_tablet_event(event, LIBINPUT_EVENT_TABLET_TOOL_BUTTON);
+	size = libinput_event_tablet_tool_get_data(tev, &button, sizeof(button));
+	ck_assert_int_eq(size, sizeof(button));
+
+	ck_assert_int_eq(button.button, BTN_STYLUS);
+	ck_assert_int_eq(button.button_state, LIBINPUT_BUTTON_STATE_PRESSED);
+	ck_assert_int_eq(button.seat_button_count, 1);
+
+	/* the button event carries the axis state of the tool */
+	ck_assert_double_eq(button.x, axis.x);
+	ck_assert_double_eq(button.y, axis.y);
+	ck_assert_double_eq(button.pressure, axis.pressure);
+	ck_assert_double_eq(button.distance, axis.distance);
+	ck_assert_double_eq(button.tilt_x, axis.tilt_x);
+	ck_assert_double_eq(button.tilt_y, axis.tilt_y);
+	ck_assert_double_eq(button.rotation, axis.rotation);
+	ck_assert_double_eq(button.slider, axis.slider);
+	if (libinput_tablet_tool_has_distance(button.tool))
+		ck_assert_double_ne(button.distance, 0.0);
+
+	libinput_event_destroy(event);
+
+	litest_event(dev, EV_KEY, BTN_STYLUS, 0);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_drain_events(li);
+}
+END_TEST
+
+START_TEST(tablet_serialize)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_tablet_tool *tev;
+	struct libinput_event_tablet_tool_data expected;
+	union libinput_event_data data;
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ -1, -1 }
+	};
+
+	litest_drain_events(li);
+
+	litest_tablet_proximity_in(dev, 10, 10, axes);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	tev = litest_is_tablet_event(event,
+				     LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+	libinput_event_tablet_tool_get_data(tev, &expected, sizeof(expected));
+	litest_serialize_round_trip(event, &data);
+	libinput_event_destroy(event);
+
+	/* the tool is a libinput object and not part of the format */
+	ck_assert(data.tablet_tool.tool == NULL);
+	ck_assert_int_eq(data.tablet_tool.time_usec, expected.time_usec);
+	ck_assert_int_eq(data.tablet_tool.proximity_state,
+			 LIBINPUT_TABLET_TOOL_PROXIMITY_STATE_IN);
+	ck_assert_int_eq(data.tablet_tool.tip_state, expected.tip_state);
+	ck_assert_int_eq(data.tablet_tool.changed, expected.changed);
+	ck_assert_double_eq(data.tablet_tool.x, expected.x);
+	ck_assert_double_eq(data.tablet_tool.y, expected.y);
+	ck_assert_double_eq(data.tablet_tool.x_fraction, expected.x_fraction);
+	ck_assert_double_eq(data.tablet_tool.y_fraction, expected.y_fraction);
+	ck_assert_double_eq(data.tablet_tool.pressure, expected.pressure);
+	ck_assert_double_eq(data.tablet_tool.distance, expected.distance);
+	ck_assert_double_eq(data.tablet_tool.tilt_x, expected.tilt_x);
+	ck_assert_double_eq(data.tablet_tool.tilt_y, expected.tilt_y);
+	ck_assert_int_eq(data.tablet_tool.tool_type, expected.tool_type);
+	ck_assert_int_eq(data.tablet_tool.tool_serial, expected.tool_serial);
+
+	if (libevdev_has_event_code(dev->evdev, EV_KEY, BTN_STYLUS)) {
+		litest_event(dev, EV_KEY, BTN_STYLUS, 1);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+		libinput_dispatch(li);
+
+		event = libinput_get_event(li);
+		tev = litest_is_tablet_event(event,
+					     LIBINPUT_EVENT_TABLET_TOOL_BUTTON);
+		libinput_event_tablet_tool_get_data(tev,
+						    &expected,
+						    sizeof(expected));
+		litest_serialize_round_trip(event, &data);
+		libinput_event_destroy(event);
+
+		/* button events carry the axes too */
+		ck_assert_int_eq(data.tablet_tool.button, BTN_STYLUS);
+		ck_assert_int_eq(data.tablet_tool.button_state,
+				 LIBINPUT_BUTTON_STATE_PRESSED);
+		ck_assert_double_eq(data.tablet_tool.x, expected.x);
+		ck_assert_double_eq(data.tablet_tool.y, expected.y);
+		ck_assert_double_eq(data.tablet_tool.pressure,
+				    expected.pressure);
+		ck_assert_double_eq(data.tablet_tool.distance,
+				    expected.distance);
+		ck_assert_double_eq(data.tablet_tool.tilt_x, expected.tilt_x);
+		ck_assert_double_eq(data.tablet_tool.tilt_y, expected.tilt_y);
+
+		litest_event(dev, EV_KEY, BTN_STYLUS, 0);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+		litest_drain_events(li);
+	}
+
+	litest_tablet_proximity_out(dev);
+	litest_drain_events(li);
+}
+END_TEST
+
 void
 litest_setup_tests_tablet(void)
 {
@@ -4339,6 +4755,14 @@ litest_setup_tests_tablet(void)
 	litest_add("tablet:relative", relative_delta, LITEST_TABLET, LITEST_ANY);
 	litest_add("tablet:relative", relative_calibration, LITEST_TABLET, LITEST_ANY);
 
+	litest_add("tablet:prediction", tablet_prediction_config, LITEST_TABLET, LITEST_ANY);
+	litest_add("tablet:prediction", tablet_prediction_leads, LITEST_TABLET, LITEST_ANY);
+	litest_add("tablet:history", tablet_history_config, LITEST_TABLET, LITEST_ANY);
+	litest_add("tablet:history", tablet_history_merge, LITEST_TABLET, LITEST_ANY);
+	litest_add("tablet:history", tablet_history_flush_on_button, LITEST_TABLET, LITEST_ANY);
+	litest_add("tablet:data", tablet_get_data, LITEST_TABLET, LITEST_ANY);
+	litest_add("tablet:data", tablet_get_data_button, LITEST_TABLET, LITEST_ANY);
+
 	litest_add_for_device("tablet:touch-arbitration", intuos_touch_arbitration, LITEST_WACOM_INTUOS);
 	litest_add_for_device("tablet:touch-arbitration", intuos_touch_arbitration_stop_touch, LITEST_WACOM_INTUOS);
 	litest_add_for_device("tablet:touch-arbitration", intuos_touch_arbitration_suspend_touch_device, LITEST_WACOM_FINGER);
@@ -4350,4 +4774,5 @@ litest_setup_tests_tablet(void)
 	litest_add_for_device("tablet:touch-arbitration", cintiq_touch_arbitration_suspend_touch_device, LITEST_WACOM_CINTIQ_13HDT_FINGER);
 	litest_add_for_device("tablet:touch-arbitration", cintiq_touch_arbitration_remove_touch, LITEST_WACOM_CINTIQ_13HDT_PEN);
 	litest_add_for_device("tablet:touch-arbitration", cintiq_touch_arbitration_remove_tablet, LITEST_WACOM_CINTIQ_13HDT_FINGER);
+	litest_add("tablet:serialize", tablet_serialize, LITEST_TABLET, LITEST_ANY);
 }
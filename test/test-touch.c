@@ -241,6 +241,65 @@ START_TEST(touch_many_slots)
 }
 END_TEST
 
+START_TEST(touch_many_seat_slots)
+{
+	struct libinput *li;
+	struct litest_device *devs[3];
+	const int num_tps = 100;
+	unsigned int i;
+	int slot;
+
+	struct input_absinfo abs[] = {
+		{ ABS_MT_SLOT, 0, num_tps - 1, 0, 0, 0 },
+		{ .value = -1 },
+	};
+
+	li = litest_create_context();
+	for (i = 0; i < ARRAY_LENGTH(devs); i++)
+		devs[i] = litest_add_device_with_overrides(li,
+							   LITEST_WACOM_TOUCH,
+							   "litest Multi-touch device",
+							   NULL, abs, NULL);
+	litest_drain_events(li);
+
+	/* more contacts on the seat than fit into a single word */
+	for (i = 0; i < ARRAY_LENGTH(devs); i++) {
+		for (slot = 0; slot < num_tps; slot++) {
+			litest_touch_down(devs[i], slot, 10, 10);
+			touch_assert_seat_slot(li,
+					       LIBINPUT_EVENT_TOUCH_DOWN,
+					       slot,
+					       i * num_tps + slot);
+		}
+	}
+
+	/* a released seat slot is the first one to be reused */
+	litest_touch_up(devs[1], 5);
+	touch_assert_seat_slot(li, LIBINPUT_EVENT_TOUCH_UP, 5, num_tps + 5);
+	litest_touch_down(devs[1], 5, 20, 20);
+	touch_assert_seat_slot(li, LIBINPUT_EVENT_TOUCH_DOWN, 5, num_tps + 5);
+
+	for (i = 0; i < ARRAY_LENGTH(devs); i++) {
+		for (slot = 0; slot < num_tps; slot++) {
+			litest_touch_up(devs[i], slot);
+			touch_assert_seat_slot(li,
+					       LIBINPUT_EVENT_TOUCH_UP,
+					       slot,
+					       i * num_tps + slot);
+		}
+	}
+
+	litest_touch_down(devs[2], 0, 10, 10);
+	touch_assert_seat_slot(li, LIBINPUT_EVENT_TOUCH_DOWN, 0, 0);
+	litest_touch_up(devs[2], 0);
+	touch_assert_seat_slot(li, LIBINPUT_EVENT_TOUCH_UP, 0, 0);
+
+	for (i = 0; i < ARRAY_LENGTH(devs); i++)
+		litest_delete_device(devs[i]);
+	libinput_unref(li);
+}
+END_TEST
+
 START_TEST(touch_double_touch_down_up)
 {
 	struct libinput *libinput;
@@ -761,6 +820,9 @@ START_TEST(touch_initial_state)
 	struct libinput_device *device1, *device2;
 	int axis = _i; /* looped test */
 
+	if (litest_in_process())
+		return;
+
 	dev = litest_current_device();
 	device1 = dev->libinput_device;
 	libinput_device_config_tap_set_enabled(device1,
@@ -887,15 +949,539 @@ START_TEST(touch_fuzz)
 }
 END_TEST
 
+START_TEST(touch_smoothing_config)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_config_status status;
+
+	ck_assert(libinput_device_config_smoothing_is_available(device));
+	ck_assert_int_eq(libinput_device_config_smoothing_get_default_enabled(device),
+			 LIBINPUT_CONFIG_SMOOTHING_DISABLED);
+	ck_assert_int_eq(libinput_device_config_smoothing_get_enabled(device),
+			 LIBINPUT_CONFIG_SMOOTHING_DISABLED);
+
+	status = libinput_device_config_smoothing_set_enabled(device,
+					LIBINPUT_CONFIG_SMOOTHING_ENABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	ck_assert_int_eq(libinput_device_config_smoothing_get_enabled(device),
+			 LIBINPUT_CONFIG_SMOOTHING_ENABLED);
+
+	status = libinput_device_config_smoothing_set_enabled(device, 3);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_INVALID);
+	ck_assert_int_eq(libinput_device_config_smoothing_get_enabled(device),
+			 LIBINPUT_CONFIG_SMOOTHING_ENABLED);
+}
+END_TEST
+
+static double
+touch_jitter_range(struct litest_device *dev)
+{
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	double min = INFINITY, max = -INFINITY;
+	int i;
+
+	litest_drain_events(li);
+
+	litest_touch_down(dev, 0, 50, 50);
+	for (i = 0; i < 20; i++)
+		litest_touch_move(dev, 0, i % 2 ? 52 : 48, 50);
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+
+	while ((event = libinput_get_event(li))) {
+		struct libinput_event_touch *tev;
+		double x;
+
+		if (libinput_event_get_type(event) ==
+		    LIBINPUT_EVENT_TOUCH_MOTION) {
+			tev = libinput_event_get_touch_event(event);
+			x = libinput_event_touch_get_x(tev);
+			min = min(min, x);
+			max = max(max, x);
+		}
+		libinput_event_destroy(event);
+	}
+
+	return max - min;
+}
+
+START_TEST(touch_smoothing_jitter)
+{
+	struct litest_device *dev = litest_current_device();
+	double raw, smoothed;
+
+	raw = touch_jitter_range(dev);
+	ck_assert_double_gt(raw, 0.0);
+
+	libinput_device_config_smoothing_set_enabled(dev->libinput_device,
+					LIBINPUT_CONFIG_SMOOTHING_ENABLED);
+	smoothed = touch_jitter_range(dev);
+
+	ck_assert_double_lt(smoothed, raw/2);
+}
+END_TEST
+
+START_TEST(touch_prediction_config)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_config_status status;
+
+	ck_assert(libinput_device_config_prediction_is_available(device));
+	ck_assert_int_eq(libinput_device_config_prediction_get_default_time(device), 0);
+	ck_assert_int_eq(libinput_device_config_prediction_get_time(device), 0);
+
+	status = libinput_device_config_prediction_set_time(device, 16);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	ck_assert_int_eq(libinput_device_config_prediction_get_time(device), 16);
+
+	status = libinput_device_config_prediction_set_time(device, 101);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_INVALID);
+	ck_assert_int_eq(libinput_device_config_prediction_get_time(device), 16);
+
+	status = libinput_device_config_prediction_set_time(device, 0);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	ck_assert_int_eq(libinput_device_config_prediction_get_time(device), 0);
+}
+END_TEST
+
+START_TEST(touch_prediction_leads)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_touch *tev;
+	bool enabled = _i; /* ranged test */
+	int nmotion = 0;
+	int i;
+
+	if (enabled)
+		libinput_device_config_prediction_set_time(dev->libinput_device,
+							   16);
+
+	litest_drain_events(li);
+
+	litest_touch_down(dev, 0, 20, 50);
+	for (i = 0; i < 10; i++) {
+		litest_touch_move(dev, 0, 22 + i * 2, 50);
+		litest_msleep(2);
+	}
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	tev = litest_is_touch_event(event, LIBINPUT_EVENT_TOUCH_DOWN);
+	/* nothing to extrapolate from on touch down */
+	ck_assert_double_eq(libinput_event_touch_get_predicted_x(tev),
+			    libinput_event_touch_get_x(tev));
+	ck_assert_double_eq(libinput_event_touch_get_predicted_x_transformed(tev, 100),
+			    libinput_event_touch_get_x_transformed(tev, 100));
+	libinput_event_destroy(event);
+
+	while ((event = libinput_get_event(li))) {
+		double x, predicted_x;
+
+		if (libinput_event_get_type(event) !=
+		    LIBINPUT_EVENT_TOUCH_MOTION) {
+			libinput_event_destroy(event);
+			continue;
+		}
+
+		tev = libinput_event_get_touch_event(event);
+		x = libinput_event_touch_get_x(tev);
+		predicted_x = libinput_event_touch_get_predicted_x(tev);
+
+		if (enabled)
+			ck_assert_double_gt(predicted_x, x);
+		else
+			ck_assert_double_eq(predicted_x, x);
+
+		ck_assert_double_eq(libinput_event_touch_get_predicted_y(tev),
+				    libinput_event_touch_get_y(tev));
+
+		nmotion++;
+		libinput_event_destroy(event);
+	}
+
+	ck_assert_int_ge(nmotion, 5);
+}
+END_TEST
+
+static struct libinput_event_touch *
+get_compact_frame(struct libinput *li, unsigned int ntouches)
+{
+	struct libinput_event *event;
+	struct libinput_event_touch *tev;
+
+	libinput_dispatch(li);
+	event = libinput_get_event(li);
+	tev = litest_is_touch_event(event, LIBINPUT_EVENT_TOUCH_FRAME);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_count(tev),
+			 ntouches);
+
+	return tev;
+}
+
+START_TEST(touch_compact_frame)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event_touch *tev;
+	double x, y;
+
+	libinput_set_compact_touch_frames(li, 1);
+	ck_assert_int_ne(libinput_get_compact_touch_frames(li), 0);
+
+	litest_drain_events(li);
+
+	litest_touch_down(dev, 0, 30, 30);
+	tev = get_compact_frame(li, 1);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 0),
+			 LIBINPUT_TOUCH_STATE_DOWN);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_slot(tev, 0), 0);
+	x = libinput_event_touch_get_frame_touch_x_transformed(tev, 0, 100);
+	ck_assert_double_ge(x, 29);
+	ck_assert_double_le(x, 31);
+	y = libinput_event_touch_get_frame_touch_y_transformed(tev, 0, 100);
+	ck_assert_double_ge(y, 29);
+	ck_assert_double_le(y, 31);
+	libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+	litest_assert_empty_queue(li);
+
+	litest_touch_down(dev, 1, 70, 60);
+	tev = get_compact_frame(li, 2);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 0),
+			 LIBINPUT_TOUCH_STATE_STATIONARY);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 1),
+			 LIBINPUT_TOUCH_STATE_DOWN);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_slot(tev, 1), 1);
+	ck_assert_int_ne(libinput_event_touch_get_frame_touch_seat_slot(tev, 0),
+			 libinput_event_touch_get_frame_touch_seat_slot(tev, 1));
+	x = libinput_event_touch_get_frame_touch_x_transformed(tev, 1, 100);
+	ck_assert_double_ge(x, 69);
+	ck_assert_double_le(x, 71);
+	y = libinput_event_touch_get_frame_touch_y_transformed(tev, 1, 100);
+	ck_assert_double_ge(y, 59);
+	ck_assert_double_le(y, 61);
+	libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+
+	litest_touch_move(dev, 1, 80, 60);
+	tev = get_compact_frame(li, 2);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 0),
+			 LIBINPUT_TOUCH_STATE_STATIONARY);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 1),
+			 LIBINPUT_TOUCH_STATE_MOTION);
+	x = libinput_event_touch_get_frame_touch_x_transformed(tev, 1, 100);
+	ck_assert_double_ge(x, 79);
+	ck_assert_double_le(x, 81);
+	libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+
+	litest_touch_up(dev, 0);
+	tev = get_compact_frame(li, 2);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 0),
+			 LIBINPUT_TOUCH_STATE_UP);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 1),
+			 LIBINPUT_TOUCH_STATE_STATIONARY);
+	libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+
+	litest_touch_up(dev, 1);
+	tev = get_compact_frame(li, 1);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 0),
+			 LIBINPUT_TOUCH_STATE_UP);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_slot(tev, 0), 1);
+	libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+
+	litest_assert_empty_queue(li);
+}
+END_TEST
+
+START_TEST(touch_compact_frame_down_up)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event_touch *tev;
+	double x, y;
+
+	libinput_set_compact_touch_frames(li, 1);
+	litest_drain_events(li);
+
+	litest_push_event_frame(dev);
+	litest_touch_down(dev, 0, 30, 30);
+	litest_touch_up(dev, 0);
+	litest_pop_event_frame(dev);
+
+	tev = get_compact_frame(li, 2);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 0),
+			 LIBINPUT_TOUCH_STATE_DOWN);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 1),
+			 LIBINPUT_TOUCH_STATE_UP);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_seat_slot(tev, 0),
+			 libinput_event_touch_get_frame_touch_seat_slot(tev, 1));
+	x = libinput_event_touch_get_frame_touch_x_transformed(tev, 1, 100);
+	ck_assert_double_ge(x, 29);
+	ck_assert_double_le(x, 31);
+	y = libinput_event_touch_get_frame_touch_y_transformed(tev, 1, 100);
+	ck_assert_double_ge(y, 29);
+	ck_assert_double_le(y, 31);
+	x = libinput_event_touch_get_frame_touch_predicted_x_transformed(tev,
+									 1,
+									 100);
+	ck_assert_double_ge(x, 29);
+	ck_assert_double_le(x, 31);
+	libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+
+	/* neither touch carries over */
+	litest_touch_down(dev, 1, 70, 60);
+	tev = get_compact_frame(li, 1);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 0),
+			 LIBINPUT_TOUCH_STATE_DOWN);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_slot(tev, 0), 1);
+	libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+
+	litest_touch_up(dev, 1);
+	tev = get_compact_frame(li, 1);
+	libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+
+	litest_assert_empty_queue(li);
+}
+END_TEST
+
+START_TEST(touch_compact_frame_toggle)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event_touch *tev;
+	double x;
+
+	litest_drain_events(li);
+
+	/* a touch set down before compact frames are enabled is still
+	 * included in the frames */
+	litest_touch_down(dev, 0, 30, 30);
+	litest_drain_events(li);
+
+	libinput_set_compact_touch_frames(li, 1);
+	litest_touch_move(dev, 0, 40, 30);
+	tev = get_compact_frame(li, 1);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 0),
+			 LIBINPUT_TOUCH_STATE_MOTION);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_slot(tev, 0), 0);
+	libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+
+	litest_touch_up(dev, 0);
+	tev = get_compact_frame(li, 1);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 0),
+			 LIBINPUT_TOUCH_STATE_UP);
+	x = libinput_event_touch_get_frame_touch_x_transformed(tev, 0, 100);
+	ck_assert_double_ge(x, 39);
+	ck_assert_double_le(x, 41);
+	libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+
+	/* a touch that ends while compact frames are disabled does not
+	 * linger in the frames once they are enabled again */
+	libinput_set_compact_touch_frames(li, 1);
+	litest_touch_down(dev, 0, 30, 30);
+	litest_drain_events(li);
+	libinput_set_compact_touch_frames(li, 0);
+	litest_touch_up(dev, 0);
+	litest_drain_events(li);
+	libinput_set_compact_touch_frames(li, 1);
+
+	litest_touch_down(dev, 1, 70, 60);
+	tev = get_compact_frame(li, 1);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 0),
+			 LIBINPUT_TOUCH_STATE_DOWN);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_slot(tev, 0), 1);
+	libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+
+	litest_touch_up(dev, 1);
+	tev = get_compact_frame(li, 1);
+	libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+
+	litest_assert_empty_queue(li);
+}
+END_TEST
+
+START_TEST(touch_compact_frame_enable_stationary)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event_touch *tev;
+	double x;
+
+	litest_drain_events(li);
+
+	/* a touch that does not move after compact frames are enabled is
+	 * in the frames from the start */
+	litest_touch_down(dev, 0, 30, 30);
+	litest_drain_events(li);
+
+	libinput_set_compact_touch_frames(li, 1);
+	litest_touch_down(dev, 1, 70, 60);
+	tev = get_compact_frame(li, 2);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 0),
+			 LIBINPUT_TOUCH_STATE_STATIONARY);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_slot(tev, 0), 0);
+	x = libinput_event_touch_get_frame_touch_x_transformed(tev, 0, 100);
+	ck_assert_double_ge(x, 29);
+	ck_assert_double_le(x, 31);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_state(tev, 1),
+			 LIBINPUT_TOUCH_STATE_DOWN);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_slot(tev, 1), 1);
+	libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+
+	litest_touch_up(dev, 0);
+	litest_touch_up(dev, 1);
+	litest_drain_events(li);
+}
+END_TEST
+
+START_TEST(touch_compact_frame_disabled)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_touch *tev;
+
+	ck_assert_int_eq(libinput_get_compact_touch_frames(li), 0);
+
+	litest_drain_events(li);
+
+	litest_touch_down(dev, 0, 30, 30);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	litest_is_touch_event(event, LIBINPUT_EVENT_TOUCH_DOWN);
+	libinput_event_destroy(event);
+
+	event = libinput_get_event(li);
+	tev = litest_is_touch_event(event, LIBINPUT_EVENT_TOUCH_FRAME);
+	ck_assert_int_eq(libinput_event_touch_get_frame_touch_count(tev), 0);
+	libinput_event_destroy(event);
+
+	litest_assert_empty_queue(li);
+}
+END_TEST
+
+START_TEST(touch_get_data)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_touch *tev;
+	struct libinput_event_touch_data data;
+	size_t size;
+
+	litest_drain_events(li);
+
+	litest_touch_down(dev, 0, 30, 70);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	tev = litest_is_touch_event(event, LIBINPUT_EVENT_TOUCH_DOWN);
+
+	size = libinput_event_touch_get_data(tev, &data, sizeof(data));
+	ck_assert_int_eq(size, sizeof(data));
+	ck_assert_int_eq(data.time_usec,
+			 libinput_event_touch_get_time_usec(tev));
+	ck_assert_int_eq(data.slot, libinput_event_touch_get_slot(tev));
+	ck_assert_int_eq(data.seat_slot,
+			 libinput_event_touch_get_seat_slot(tev));
+	ck_assert_double_eq(data.x, libinput_event_touch_get_x(tev));
+	ck_assert_double_eq(data.y, libinput_event_touch_get_y(tev));
+	ck_assert_double_eq(data.predicted_x,
+			    libinput_event_touch_get_predicted_x(tev));
+	ck_assert_double_eq(data.predicted_y,
+			    libinput_event_touch_get_predicted_y(tev));
+	ck_assert_double_ge(data.x_fraction * 1000,
+			    libinput_event_touch_get_x_transformed(tev, 1000) - 0.001);
+	ck_assert_double_le(data.x_fraction * 1000,
+			    libinput_event_touch_get_x_transformed(tev, 1000) + 0.001);
+	ck_assert_double_ge(data.y_fraction * 1000,
+			    libinput_event_touch_get_y_transformed(tev, 1000) - 0.001);
+	ck_assert_double_le(data.y_fraction * 1000,
+			    libinput_event_touch_get_y_transformed(tev, 1000) + 0.001);
+	libinput_event_destroy(event);
+
+	event = libinput_get_event(li);
+	tev = litest_is_touch_event(event, LIBINPUT_EVENT_TOUCH_FRAME);
+	size = libinput_event_touch_get_data(tev, &data, sizeof(data));
+	ck_assert_int_eq(size, sizeof(data));
+	ck_assert_double_eq(data.x, 0.0);
+	libinput_event_destroy(event);
+
+	litest_touch_up(dev, 0);
+	litest_drain_events(li);
+}
+END_TEST
+
+static void
+assert_touch_round_trip(struct libinput_event *event)
+{
+	struct libinput_event_touch *tev;
+	struct libinput_event_touch_data expected;
+	union libinput_event_data data;
+
+	tev = libinput_event_get_touch_event(event);
+	ck_assert_notnull(tev);
+	libinput_event_touch_get_data(tev, &expected, sizeof(expected));
+	litest_serialize_round_trip(event, &data);
+
+	ck_assert_int_eq(data.touch.time_usec, expected.time_usec);
+	ck_assert_int_eq(data.touch.slot, expected.slot);
+	ck_assert_int_eq(data.touch.seat_slot, expected.seat_slot);
+	ck_assert_double_eq(data.touch.x, expected.x);
+	ck_assert_double_eq(data.touch.y, expected.y);
+	ck_assert_double_eq(data.touch.x_fraction, expected.x_fraction);
+	ck_assert_double_eq(data.touch.y_fraction, expected.y_fraction);
+}
+
+START_TEST(touch_serialize)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+
+	litest_drain_events(li);
+
+	litest_touch_down(dev, 0, 30, 70);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	litest_is_touch_event(event, LIBINPUT_EVENT_TOUCH_DOWN);
+	assert_touch_round_trip(event);
+	libinput_event_destroy(event);
+
+	event = libinput_get_event(li);
+	litest_is_touch_event(event, LIBINPUT_EVENT_TOUCH_FRAME);
+	assert_touch_round_trip(event);
+	libinput_event_destroy(event);
+
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	litest_is_touch_event(event, LIBINPUT_EVENT_TOUCH_UP);
+	assert_touch_round_trip(event);
+	libinput_event_destroy(event);
+
+	litest_drain_events(li);
+}
+END_TEST
+
 void
 litest_setup_tests_touch(void)
 {
 	struct range axes = { ABS_X, ABS_Y + 1};
+	struct range onoff = { 0, 2 };
 
 	litest_add("touch:frame", touch_frame_events, LITEST_TOUCH, LITEST_ANY);
 	litest_add_no_device("touch:abs-transform", touch_abs_transform);
 	litest_add("touch:slots", touch_seat_slot, LITEST_TOUCH, LITEST_TOUCHPAD);
 	litest_add_no_device("touch:slots", touch_many_slots);
+	litest_add_no_device("touch:slots", touch_many_seat_slots);
 	litest_add("touch:double-touch-down-up", touch_double_touch_down_up, LITEST_TOUCH, LITEST_ANY);
 	litest_add("touch:calibration", touch_calibration_scale, LITEST_TOUCH, LITEST_TOUCHPAD);
 	litest_add("touch:calibration", touch_calibration_scale, LITEST_SINGLE_TOUCH, LITEST_TOUCHPAD);
@@ -918,6 +1504,22 @@ litest_setup_tests_touch(void)
 	litest_add_ranged("touch:state", touch_initial_state, LITEST_TOUCH, LITEST_PROTOCOL_A, &axes);
 
 	litest_add("touch:time", touch_time_usec, LITEST_TOUCH, LITEST_TOUCHPAD);
+	litest_add("touch:data", touch_get_data, LITEST_TOUCH, LITEST_TOUCHPAD);
 
 	litest_add_for_device("touch:fuzz", touch_fuzz, LITEST_MULTITOUCH_FUZZ_SCREEN);
+
+	litest_add("touch:smoothing", touch_smoothing_config, LITEST_TOUCH, LITEST_TOUCHPAD);
+	litest_add("touch:smoothing", touch_smoothing_config, LITEST_SINGLE_TOUCH, LITEST_TOUCHPAD);
+	litest_add_for_device("touch:smoothing", touch_smoothing_jitter, LITEST_GENERIC_MULTITOUCH_SCREEN);
+
+	litest_add("touch:prediction", touch_prediction_config, LITEST_TOUCH, LITEST_TOUCHPAD);
+	litest_add("touch:prediction", touch_prediction_config, LITEST_SINGLE_TOUCH, LITEST_TOUCHPAD);
+	litest_add_ranged_for_device("touch:prediction", touch_prediction_leads, LITEST_GENERIC_MULTITOUCH_SCREEN, &onoff);
+
+	litest_add_for_device("touch:compact-frame", touch_compact_frame, LITEST_GENERIC_MULTITOUCH_SCREEN);
+	litest_add_for_device("touch:compact-frame", touch_compact_frame_down_up, LITEST_GENERIC_MULTITOUCH_SCREEN);
+	litest_add_for_device("touch:compact-frame", touch_compact_frame_toggle, LITEST_GENERIC_MULTITOUCH_SCREEN);
+	litest_add_for_device("touch:compact-frame", touch_compact_frame_enable_stationary, LITEST_GENERIC_MULTITOUCH_SCREEN);
+	litest_add("touch:compact-frame", touch_compact_frame_disabled, LITEST_TOUCH, LITEST_TOUCHPAD|LITEST_PROTOCOL_A);
+	litest_add("touch:serialize", touch_serialize, LITEST_TOUCH, LITEST_TOUCHPAD|LITEST_PROTOCOL_A);
 }
@@ -132,7 +132,7 @@ START_TEST(touchpad_1fg_multitap)
 		litest_touch_down(dev, 0, 50, 50);
 		litest_touch_up(dev, 0);
 		libinput_dispatch(li);
-		msleep(10);
+		litest_msleep(10);
 	}
 
 	litest_timeout_tap();
@@ -180,7 +180,7 @@ START_TEST(touchpad_1fg_multitap_n_drag_move)
 		litest_touch_down(dev, 0, 50, 50);
 		litest_touch_up(dev, 0);
 		libinput_dispatch(li);
-		msleep(10);
+		litest_msleep(10);
 	}
 
 	libinput_dispatch(li);
@@ -249,12 +249,12 @@ START_TEST(touchpad_1fg_multitap_n_drag_2fg)
 		litest_touch_down(dev, 0, 50, 50);
 		litest_touch_up(dev, 0);
 		libinput_dispatch(li);
-		msleep(10);
+		litest_msleep(10);
 	}
 
 	libinput_dispatch(li);
 	litest_touch_down(dev, 0, 50, 50);
-	msleep(10);
+	litest_msleep(10);
 	litest_touch_down(dev, 1, 70, 50);
 	libinput_dispatch(li);
 
@@ -320,7 +320,7 @@ START_TEST(touchpad_1fg_multitap_n_drag_click)
 		litest_touch_down(dev, 0, 50, 50);
 		litest_touch_up(dev, 0);
 		libinput_dispatch(li);
-		msleep(10);
+		litest_msleep(10);
 	}
 
 	litest_touch_down(dev, 0, 50, 50);
@@ -380,7 +380,7 @@ START_TEST(touchpad_1fg_multitap_n_drag_timeout)
 		litest_touch_down(dev, 0, 50, 50);
 		litest_touch_up(dev, 0);
 		libinput_dispatch(li);
-		msleep(10);
+		litest_msleep(10);
 	}
 
 	libinput_dispatch(li);
@@ -451,7 +451,7 @@ START_TEST(touchpad_1fg_multitap_n_drag_tap)
 		litest_touch_down(dev, 0, 50, 50);
 		litest_touch_up(dev, 0);
 		libinput_dispatch(li);
-		msleep(10);
+		litest_msleep(10);
 	}
 
 	libinput_dispatch(li);
@@ -524,7 +524,7 @@ START_TEST(touchpad_1fg_multitap_n_drag_tap_click)
 		litest_touch_down(dev, 0, 50, 50);
 		litest_touch_up(dev, 0);
 		libinput_dispatch(li);
-		msleep(10);
+		litest_msleep(10);
 	}
 
 	libinput_dispatch(li);
@@ -2043,7 +2043,7 @@ START_TEST(touchpad_drag_disabled_immediate)
 	litest_drain_events(li);
 
 	litest_touch_down(dev, 0, 50, 50);
-	msleep(10); /* to force a time difference */
+	litest_msleep(10); /* to force a time difference */
 	libinput_dispatch(li);
 	litest_touch_up(dev, 0);
 	libinput_dispatch(li);
@@ -2086,7 +2086,7 @@ START_TEST(touchpad_drag_disabled_multitap_no_drag)
 		litest_touch_down(dev, 0, 50, 50);
 		litest_touch_up(dev, 0);
 		libinput_dispatch(li);
-		msleep(10);
+		litest_msleep(10);
 	}
 
 	libinput_dispatch(li);
@@ -2173,6 +2173,214 @@ START_TEST(touchpad_drag_lock_default_unavailable)
 }
 END_TEST
 
+START_TEST(touchpad_tap_speculative_default_disabled)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_config_status status;
+
+	ck_assert_int_eq(libinput_device_config_tap_get_speculative_enabled(device),
+			 LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED);
+	ck_assert_int_eq(libinput_device_config_tap_get_default_speculative_enabled(device),
+			 LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED);
+
+	status = libinput_device_config_tap_set_speculative_enabled(device,
+								    LIBINPUT_CONFIG_TAP_SPECULATIVE_ENABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	ck_assert_int_eq(libinput_device_config_tap_get_speculative_enabled(device),
+			 LIBINPUT_CONFIG_TAP_SPECULATIVE_ENABLED);
+
+	status = libinput_device_config_tap_set_speculative_enabled(device,
+								    LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	ck_assert_int_eq(libinput_device_config_tap_get_speculative_enabled(device),
+			 LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED);
+
+	status = libinput_device_config_tap_set_speculative_enabled(device,
+								    3);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_INVALID);
+}
+END_TEST
+
+START_TEST(touchpad_tap_speculative_unavailable)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_config_status status;
+
+	ck_assert_int_eq(libinput_device_config_tap_get_speculative_enabled(device),
+			 LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED);
+	ck_assert_int_eq(libinput_device_config_tap_get_default_speculative_enabled(device),
+			 LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED);
+
+	status = libinput_device_config_tap_set_speculative_enabled(device,
+								    LIBINPUT_CONFIG_TAP_SPECULATIVE_ENABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_UNSUPPORTED);
+
+	status = libinput_device_config_tap_set_speculative_enabled(device,
+								    LIBINPUT_CONFIG_TAP_SPECULATIVE_DISABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+}
+END_TEST
+
+START_TEST(touchpad_1fg_tap_speculative)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+
+	litest_enable_tap(dev->libinput_device);
+	litest_enable_speculative_tap(dev->libinput_device);
+
+	litest_drain_events(li);
+
+	litest_touch_down(dev, 0, 50, 50);
+	litest_touch_up(dev, 0);
+
+	/* don't use helper functions here, we expect both events
+	 * immediately, not after a timeout that the helper functions may
+	 * trigger.
+	 */
+	libinput_dispatch(li);
+	event = libinput_get_event(li);
+	litest_is_button_event(event,
+			       BTN_LEFT,
+			       LIBINPUT_BUTTON_STATE_PRESSED);
+	libinput_event_destroy(event);
+	event = libinput_get_event(li);
+	litest_is_button_event(event,
+			       BTN_LEFT,
+			       LIBINPUT_BUTTON_STATE_RELEASED);
+	libinput_event_destroy(event);
+
+	litest_timeout_tap();
+	libinput_dispatch(li);
+
+	litest_assert_empty_queue(li);
+}
+END_TEST
+
+START_TEST(touchpad_1fg_doubletap_speculative)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	int i;
+
+	litest_enable_tap(dev->libinput_device);
+	litest_enable_speculative_tap(dev->libinput_device);
+
+	litest_drain_events(li);
+
+	litest_touch_down(dev, 0, 50, 50);
+	litest_touch_up(dev, 0);
+	litest_touch_down(dev, 0, 50, 50);
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+
+	for (i = 0; i < 2; i++) {
+		event = libinput_get_event(li);
+		litest_is_button_event(event,
+				       BTN_LEFT,
+				       LIBINPUT_BUTTON_STATE_PRESSED);
+		libinput_event_destroy(event);
+		event = libinput_get_event(li);
+		litest_is_button_event(event,
+				       BTN_LEFT,
+				       LIBINPUT_BUTTON_STATE_RELEASED);
+		libinput_event_destroy(event);
+	}
+
+	/* both clicks were sent already, the timeout must not add another
+	 * one */
+	litest_timeout_tap();
+	libinput_dispatch(li);
+
+	litest_assert_empty_queue(li);
+}
+END_TEST
+
+START_TEST(touchpad_1fg_tap_n_drag_speculative)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+
+	litest_enable_tap(dev->libinput_device);
+	litest_disable_drag_lock(dev->libinput_device);
+	litest_enable_speculative_tap(dev->libinput_device);
+
+	litest_drain_events(li);
+
+	litest_touch_down(dev, 0, 50, 50);
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+
+	litest_assert_button_event(li, BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_PRESSED);
+	litest_assert_button_event(li, BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_RELEASED);
+
+	/* the second touch re-presses the button for the drag */
+	litest_touch_down(dev, 0, 50, 50);
+	libinput_dispatch(li);
+	litest_assert_button_event(li, BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_PRESSED);
+
+	litest_touch_move_to(dev, 0, 50, 50, 80, 80, 20, 2);
+	libinput_dispatch(li);
+	litest_assert_only_typed_events(li, LIBINPUT_EVENT_POINTER_MOTION);
+
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+	event = libinput_get_event(li);
+	litest_is_button_event(event,
+			       BTN_LEFT,
+			       LIBINPUT_BUTTON_STATE_RELEASED);
+	libinput_event_destroy(event);
+
+	litest_assert_empty_queue(li);
+}
+END_TEST
+
+START_TEST(touchpad_1fg_tap_speculative_toggle_during_tap)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+
+	litest_enable_tap(dev->libinput_device);
+
+	litest_drain_events(li);
+
+	/* A change while the button is logically down must not apply
+	 * until the tap sequence ends, otherwise we never release */
+	litest_touch_down(dev, 0, 50, 50);
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+	litest_assert_button_event(li, BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_PRESSED);
+
+	litest_enable_speculative_tap(dev->libinput_device);
+	litest_timeout_tap();
+	libinput_dispatch(li);
+	litest_assert_button_event(li, BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_RELEASED);
+	litest_assert_empty_queue(li);
+
+	/* now idle, the next tap is speculative */
+	litest_touch_down(dev, 0, 50, 50);
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+	litest_assert_button_event(li, BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_PRESSED);
+	litest_assert_button_event(li, BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_RELEASED);
+	litest_timeout_tap();
+	libinput_dispatch(li);
+	litest_assert_empty_queue(li);
+}
+END_TEST
+
 void
 litest_setup_tests_touchpad_tap(void)
 {
@@ -2243,6 +2451,13 @@ litest_setup_tests_touchpad_tap(void)
 	litest_add("tap:draglock", touchpad_drag_lock_default_disabled, LITEST_TOUCHPAD, LITEST_ANY);
 	litest_add("tap:draglock", touchpad_drag_lock_default_unavailable, LITEST_ANY, LITEST_TOUCHPAD);
 
+	litest_add("tap:speculative", touchpad_tap_speculative_default_disabled, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add("tap:speculative", touchpad_tap_speculative_unavailable, LITEST_ANY, LITEST_TOUCHPAD);
+	litest_add("tap:speculative", touchpad_1fg_tap_speculative, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add("tap:speculative", touchpad_1fg_doubletap_speculative, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add("tap:speculative", touchpad_1fg_tap_n_drag_speculative, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add("tap:speculative", touchpad_1fg_tap_speculative_toggle_during_tap, LITEST_TOUCHPAD, LITEST_ANY);
+
 	litest_add("tap:drag", touchpad_drag_default_disabled, LITEST_ANY, LITEST_TOUCHPAD);
 	litest_add("tap:drag", touchpad_drag_default_enabled, LITEST_TOUCHPAD, LITEST_BUTTON);
 	litest_add("tap:drag", touchpad_drag_config_invalid, LITEST_TOUCHPAD, LITEST_ANY);
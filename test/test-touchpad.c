@@ -65,6 +65,49 @@ START_TEST(touchpad_1fg_motion)
 }
 END_TEST
 
+START_TEST(touchpad_1fg_motion_unaccel)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_pointer *ptrev;
+	double motion = 0.0;
+
+	litest_disable_tap(dev->libinput_device);
+
+	litest_drain_events(li);
+
+	litest_touch_down(dev, 0, 50, 50);
+	litest_touch_move_to(dev, 0, 50, 50, 80, 50, 20, 0);
+	litest_touch_up(dev, 0);
+
+	libinput_dispatch(li);
+
+	while ((event = libinput_get_event(li))) {
+		struct libinput_event_pointer_data data;
+		double dx;
+
+		ptrev = litest_is_motion_event(event);
+
+		/* computed on first access, must not change afterwards */
+		dx = libinput_event_pointer_get_dx_unaccelerated(ptrev);
+		ck_assert_double_ge(dx, 0.0);
+		ck_assert_double_eq(libinput_event_pointer_get_dx_unaccelerated(ptrev),
+				    dx);
+		ck_assert_double_eq(libinput_event_pointer_get_dy_unaccelerated(ptrev),
+				    0.0);
+
+		libinput_event_pointer_get_data(ptrev, &data, sizeof(data));
+		ck_assert_double_eq(data.dx_unaccelerated, dx);
+
+		motion += dx;
+		libinput_event_destroy(event);
+	}
+
+	ck_assert_double_gt(motion, 0.0);
+}
+END_TEST
+
 START_TEST(touchpad_2fg_no_motion)
 {
 	struct litest_device *dev = litest_current_device();
@@ -2488,6 +2531,9 @@ START_TEST(touchpad_initial_state)
 	int axis = _i; /* looped test */
 	int x = 40, y = 60;
 
+	if (litest_in_process())
+		return;
+
 	dev = litest_current_device();
 	libinput1 = dev->libinput;
 
@@ -2722,7 +2768,7 @@ START_TEST(touchpad_dwt_enable_touch)
 
 	/* finger down after last key event, but
 	   we're still within timeout - no events */
-	msleep(10);
+	litest_msleep(10);
 	litest_touch_down(touchpad, 0, 50, 50);
 	litest_touch_move_to(touchpad, 0, 50, 50, 70, 50, 10, 1);
 	litest_assert_empty_queue(li);
@@ -2754,7 +2800,7 @@ START_TEST(touchpad_dwt_touch_hold)
 	litest_drain_events(li);
 
 	litest_keyboard_key(keyboard, KEY_A, true);
-	msleep(1); /* make sure touch starts after key press */
+	litest_msleep(1); /* make sure touch starts after key press */
 	litest_touch_down(touchpad, 0, 50, 50);
 	litest_touch_move_to(touchpad, 0, 50, 50, 70, 50, 5, 1);
 
@@ -3307,7 +3353,7 @@ START_TEST(touchpad_dwt_tap_drag)
 
 	litest_keyboard_key(keyboard, KEY_A, true);
 	libinput_dispatch(li);
-	msleep(1); /* make sure touch starts after key press */
+	litest_msleep(1); /* make sure touch starts after key press */
 	litest_touch_down(touchpad, 0, 50, 50);
 	litest_touch_up(touchpad, 0);
 	litest_touch_down(touchpad, 0, 50, 50);
@@ -4319,7 +4365,7 @@ START_TEST(touchpad_tool_tripletap_touch_count)
 	litest_event(dev, EV_KEY, BTN_TOUCH, 1);
 	litest_event(dev, EV_SYN, SYN_REPORT, 0);
 	libinput_dispatch(li);
-	msleep(2);
+	litest_msleep(2);
 
 	/* touch 2 down */
 	litest_event(dev, EV_ABS, ABS_MT_SLOT, 1);
@@ -4331,7 +4377,7 @@ START_TEST(touchpad_tool_tripletap_touch_count)
 	litest_event(dev, EV_KEY, BTN_TOOL_DOUBLETAP, 1);
 	litest_event(dev, EV_SYN, SYN_REPORT, 0);
 	libinput_dispatch(li);
-	msleep(2);
+	litest_msleep(2);
 
 	/* touch 3 down, coordinate jump + ends slot 1 */
 	litest_event(dev, EV_ABS, ABS_MT_SLOT, 0);
@@ -4347,7 +4393,7 @@ START_TEST(touchpad_tool_tripletap_touch_count)
 	litest_event(dev, EV_KEY, BTN_TOOL_TRIPLETAP, 1);
 	litest_event(dev, EV_SYN, SYN_REPORT, 0);
 	libinput_dispatch(li);
-	msleep(2);
+	litest_msleep(2);
 
 	/* slot 2 reactivated:
 	 * Note, slot is activated close enough that we don't accidentally
@@ -4368,7 +4414,7 @@ START_TEST(touchpad_tool_tripletap_touch_count)
 	litest_event(dev, EV_ABS, ABS_PRESSURE, 78);
 	litest_event(dev, EV_SYN, SYN_REPORT, 0);
 	libinput_dispatch(li);
-	msleep(2);
+	litest_msleep(2);
 
 	/* now a click should trigger middle click */
 	litest_event(dev, EV_KEY, BTN_LEFT, 1);
@@ -4458,6 +4504,9 @@ START_TEST(touchpad_finger_always_down)
 	struct litest_device *dev = litest_current_device();
 	struct libinput *li;
 
+	if (litest_in_process())
+		return;
+
 	/* Set BTN_TOOL_FINGER before a new context is initialized */
 	litest_event(dev, EV_KEY, BTN_TOOL_FINGER, 1);
 	litest_event(dev, EV_SYN, SYN_REPORT, 0);
@@ -4941,12 +4990,87 @@ START_TEST(touchpad_pressure_tap_2fg_1fg_light)
 }
 END_TEST
 
+START_TEST(touchpad_smoothing_config)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_config_status status;
+
+	ck_assert(libinput_device_config_smoothing_is_available(device));
+	ck_assert_int_eq(libinput_device_config_smoothing_get_default_enabled(device),
+			 LIBINPUT_CONFIG_SMOOTHING_DISABLED);
+	ck_assert_int_eq(libinput_device_config_smoothing_get_enabled(device),
+			 LIBINPUT_CONFIG_SMOOTHING_DISABLED);
+
+	status = libinput_device_config_smoothing_set_enabled(device,
+					LIBINPUT_CONFIG_SMOOTHING_ENABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	ck_assert_int_eq(libinput_device_config_smoothing_get_enabled(device),
+			 LIBINPUT_CONFIG_SMOOTHING_ENABLED);
+
+	status = libinput_device_config_smoothing_set_enabled(device,
+					LIBINPUT_CONFIG_SMOOTHING_DISABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	ck_assert_int_eq(libinput_device_config_smoothing_get_enabled(device),
+			 LIBINPUT_CONFIG_SMOOTHING_DISABLED);
+}
+END_TEST
+
+static double
+touchpad_jitter_motion(struct litest_device *dev)
+{
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	double motion = 0.0;
+	int i;
+
+	litest_drain_events(li);
+
+	litest_touch_down(dev, 0, 50, 50);
+	for (i = 0; i < 20; i++)
+		litest_touch_move(dev, 0, i % 2 ? 55 : 45, 50);
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+
+	while ((event = libinput_get_event(li))) {
+		struct libinput_event_pointer *ptrev;
+
+		if (libinput_event_get_type(event) ==
+		    LIBINPUT_EVENT_POINTER_MOTION) {
+			ptrev = libinput_event_get_pointer_event(event);
+			motion += fabs(libinput_event_pointer_get_dx_unaccelerated(ptrev));
+		}
+		libinput_event_destroy(event);
+	}
+
+	return motion;
+}
+
+START_TEST(touchpad_smoothing_jitter)
+{
+	struct litest_device *dev = litest_current_device();
+	double raw, smoothed;
+
+	litest_disable_tap(dev->libinput_device);
+
+	raw = touchpad_jitter_motion(dev);
+	ck_assert_double_gt(raw, 0.0);
+
+	libinput_device_config_smoothing_set_enabled(dev->libinput_device,
+					LIBINPUT_CONFIG_SMOOTHING_ENABLED);
+	smoothed = touchpad_jitter_motion(dev);
+
+	ck_assert_double_lt(smoothed, raw/2);
+}
+END_TEST
+
 void
 litest_setup_tests_touchpad(void)
 {
 	struct range axis_range = {ABS_X, ABS_Y + 1};
 
 	litest_add("touchpad:motion", touchpad_1fg_motion, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add("touchpad:motion", touchpad_1fg_motion_unaccel, LITEST_TOUCHPAD, LITEST_ANY);
 	litest_add("touchpad:motion", touchpad_2fg_no_motion, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH);
 
 	litest_add("touchpad:scroll", touchpad_2fg_scroll, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH|LITEST_SEMI_MT);
@@ -5089,4 +5213,7 @@ litest_setup_tests_touchpad(void)
 	litest_add("touchpad:pressure", touchpad_pressure_tap, LITEST_TOUCHPAD, LITEST_ANY);
 	litest_add("touchpad:pressure", touchpad_pressure_tap_2fg, LITEST_TOUCHPAD, LITEST_ANY);
 	litest_add("touchpad:pressure", touchpad_pressure_tap_2fg_1fg_light, LITEST_TOUCHPAD, LITEST_ANY);
+
+	litest_add("touchpad:smoothing", touchpad_smoothing_config, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add("touchpad:smoothing", touchpad_smoothing_jitter, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH);
 }
@@ -44,7 +44,7 @@ START_TEST(trackpoint_middlebutton)
 
 	/* A quick middle button click should get reported normally */
 	litest_button_click(dev, BTN_MIDDLE, 1);
-	msleep(2);
+	litest_msleep(2);
 	litest_button_click(dev, BTN_MIDDLE, 0);
 
 	litest_wait_for_event(li);
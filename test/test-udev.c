@@ -130,6 +130,71 @@ START_TEST(udev_create_empty_seat)
 }
 END_TEST
 
+START_TEST(udev_create_multiple_seats)
+{
+	struct libinput *li;
+	struct libinput_event *event;
+	struct libinput_device *device;
+	struct libinput_seat *seat;
+	struct udev *udev;
+	const char *seats[] = { "seatdoesntexist", "seat0" };
+	int seat0_found = 0;
+
+	udev = udev_new();
+	ck_assert(udev != NULL);
+
+	li = libinput_udev_create_context(&simple_interface, NULL, udev);
+	ck_assert(li != NULL);
+	ck_assert_int_eq(libinput_udev_assign_seats(li, seats, 2), 0);
+	libinput_dispatch(li);
+
+	while ((event = libinput_get_event(li))) {
+		if (libinput_event_get_type(event) !=
+		    LIBINPUT_EVENT_DEVICE_ADDED) {
+			libinput_event_destroy(event);
+			continue;
+		}
+
+		device = libinput_event_get_device(event);
+		seat = libinput_device_get_seat(device);
+		ck_assert_str_eq(libinput_seat_get_physical_name(seat),
+				 "seat0");
+		seat0_found = 1;
+		libinput_event_destroy(event);
+	}
+
+	ck_assert(seat0_found);
+
+	libinput_unref(li);
+	udev_unref(udev);
+}
+END_TEST
+
+START_TEST(udev_assign_seats_invalid)
+{
+	struct libinput *li;
+	struct udev *udev;
+	const char *seats[] = { "seat0", NULL };
+
+	udev = udev_new();
+	ck_assert(udev != NULL);
+
+	li = libinput_udev_create_context(&simple_interface, NULL, udev);
+	ck_assert(li != NULL);
+
+	ck_assert_int_eq(libinput_udev_assign_seats(li, NULL, 1), -1);
+	ck_assert_int_eq(libinput_udev_assign_seats(li, seats, 0), -1);
+	ck_assert_int_eq(libinput_udev_assign_seats(li, seats, 2), -1);
+
+	ck_assert_int_eq(libinput_udev_assign_seats(li, seats, 1), 0);
+	ck_assert_int_eq(libinput_udev_assign_seats(li, seats, 1), -1);
+	ck_assert_int_eq(libinput_udev_assign_seat(li, "seat0"), -1);
+
+	libinput_unref(li);
+	udev_unref(udev);
+}
+END_TEST
+
 START_TEST(udev_set_user_data)
 {
 	struct libinput *li;
@@ -566,6 +631,8 @@ litest_setup_tests_udev(void)
 	litest_add_no_device("udev:create", udev_create_NULL);
 	litest_add_no_device("udev:create", udev_create_seat0);
 	litest_add_no_device("udev:create", udev_create_empty_seat);
+	litest_add_no_device("udev:create", udev_create_multiple_seats);
+	litest_add_no_device("udev:create", udev_assign_seats_invalid);
 	litest_add_no_device("udev:create", udev_set_user_data);
 
 	litest_add_no_device("udev:seat", udev_added_seat_default);
@@ -0,0 +1,316 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <libudev.h>
+#include <libevdev/libevdev.h>
+
+#include "libinput-util.h"
+#include "evdev-recording.h"
+
+static volatile sig_atomic_t stop = 0;
+
+static void
+sighandler(int signal, siginfo_t *siginfo, void *userdata)
+{
+	stop = 1;
+}
+
+static bool
+has_udev_property(char **properties, size_t n, const char *name)
+{
+	size_t i;
+
+	for (i = 0; i < n; i += 2) {
+		if (streq(properties[i], name))
+			return true;
+	}
+
+	return false;
+}
+
+/* The device's properties merged with those of its parent, the input
+ * device, the same as evdev_device_create_virtual() expects them. Where
+ * both have a property, the device's own value wins. */
+static char **
+udev_properties(struct udev *udev, int fd)
+{
+	struct udev_device *udev_device, *sources[2];
+	struct udev_list_entry *entry;
+	struct stat st;
+	char **properties;
+	size_t n = 0;
+	int i;
+
+	if (fstat(fd, &st) < 0)
+		return zalloc(sizeof(char *));
+
+	udev_device = udev_device_new_from_devnum(udev, 'c', st.st_rdev);
+	if (!udev_device)
+		return zalloc(sizeof(char *));
+
+	/* the parent is owned by udev_device */
+	sources[0] = udev_device;
+	sources[1] = udev_device_get_parent(udev_device);
+
+	for (i = 0; i < 2 && sources[i]; i++) {
+		udev_list_entry_foreach(entry,
+				udev_device_get_properties_list_entry(sources[i]))
+			n++;
+	}
+
+	properties = zalloc((2 * n + 1) * sizeof(char *));
+	n = 0;
+	for (i = 0; i < 2 && sources[i]; i++) {
+		udev_list_entry_foreach(entry,
+				udev_device_get_properties_list_entry(sources[i])) {
+			const char *name = udev_list_entry_get_name(entry);
+
+			if (has_udev_property(properties, n, name))
+				continue;
+
+			properties[n++] = strdup(name);
+			properties[n++] = strdup(udev_list_entry_get_value(entry));
+		}
+	}
+
+	udev_device_unref(udev_device);
+
+	return properties;
+}
+
+static int
+open_device(struct udev *udev,
+	    const char *path,
+	    struct recording_device *device,
+	    int *fd_out)
+{
+	struct libevdev *evdev;
+	const char *sysname;
+	int fd, rc;
+
+	fd = open(path, O_RDONLY|O_NONBLOCK);
+	if (fd < 0) {
+		fprintf(stderr, "Failed to open %s (%s)\n",
+			path, strerror(errno));
+		return -errno;
+	}
+
+	rc = libevdev_new_from_fd(fd, &evdev);
+	if (rc != 0) {
+		fprintf(stderr, "Failed to init %s (%s)\n",
+			path, strerror(-rc));
+		close(fd);
+		return rc;
+	}
+
+	/* same clock as the timestamps libinput uses */
+	libevdev_set_clock_id(evdev, CLOCK_MONOTONIC);
+
+	sysname = strrchr(path, '/');
+	device->sysname = strdup(sysname ? sysname + 1 : path);
+	device->evdev = evdev;
+	device->properties = udev_properties(udev, fd);
+	*fd_out = fd;
+
+	return 0;
+}
+
+static int
+record(FILE *fp,
+       struct recording_device *devices,
+       struct pollfd *fds,
+       unsigned int ndevices)
+{
+	unsigned long count = 0;
+	unsigned int i;
+	int rc;
+
+	while (!stop && poll(fds, ndevices, -1) > -1) {
+		for (i = 0; i < ndevices; i++) {
+			struct libevdev *evdev = devices[i].evdev;
+			struct input_event ev;
+			unsigned int flags = LIBEVDEV_READ_FLAG_NORMAL;
+
+			if (!(fds[i].revents & POLLIN))
+				continue;
+
+			/* after a SYN_DROPPED we record the events that
+			 * restore the device state, the same as libinput
+			 * sees them */
+			while ((rc = libevdev_next_event(evdev, flags, &ev)) >= 0) {
+				if (rc == LIBEVDEV_READ_STATUS_SYNC &&
+				    flags == LIBEVDEV_READ_FLAG_NORMAL) {
+					flags = LIBEVDEV_READ_FLAG_SYNC;
+					ev.code = SYN_REPORT;
+				}
+
+				if (recording_write_event(fp, i, &ev) < 0)
+					return -EIO;
+				count++;
+			}
+
+			if (rc != -EAGAIN) {
+				fprintf(stderr, "Failed to read from %s (%s)\n",
+					devices[i].sysname, strerror(-rc));
+				return rc;
+			}
+		}
+	}
+
+	fprintf(stderr, "Recorded %lu events\n", count);
+
+	return 0;
+}
+
+static void
+usage(void)
+{
+	printf("Usage: %s --output=<file> /dev/input/event0 "
+	       "[/dev/input/event1 ...]\n",
+	       program_invocation_short_name);
+	printf("\n"
+	       "Records the evdev events of the given devices until Ctrl+C,\n"
+	       "together with each device's capabilities, touch state and\n"
+	       "udev properties.\n"
+	       "The recording can be replayed with evdev-replay.\n"
+	       "\n"
+	       "Options:\n"
+	       "--output=<file> .... the file to write the recording to\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	struct recording_device *devices;
+	struct pollfd *fds;
+	struct sigaction act;
+	struct udev *udev;
+	const char *output = NULL;
+	unsigned int ndevices, i;
+	FILE *fp;
+	int rc = 1;
+
+	enum {
+		OPT_HELP = 1,
+		OPT_OUTPUT,
+	};
+
+	while (1) {
+		int c;
+		int option_index = 0;
+		static struct option long_options[] = {
+			{"help", 0, 0, OPT_HELP },
+			{"output", 1, 0, OPT_OUTPUT },
+			{0, 0, 0, 0}
+		};
+
+		c = getopt_long(argc, argv, "",
+				long_options, &option_index);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case OPT_HELP:
+			usage();
+			exit(0);
+			break;
+		case OPT_OUTPUT:
+			output = optarg;
+			break;
+		default:
+			usage();
+			exit(1);
+			break;
+		}
+	}
+
+	if (!output || optind >= argc || argc - optind > UINT16_MAX) {
+		usage();
+		return 1;
+	}
+
+	ndevices = argc - optind;
+	devices = zalloc(ndevices * sizeof(*devices));
+	fds = zalloc(ndevices * sizeof(*fds));
+	udev = udev_new();
+	if (!devices || !fds || !udev)
+		return 1;
+
+	for (i = 0; i < ndevices; i++) {
+		fds[i].fd = -1;
+		fds[i].events = POLLIN;
+	}
+
+	for (i = 0; i < ndevices; i++) {
+		if (open_device(udev, argv[optind + i], &devices[i],
+				&fds[i].fd) < 0)
+			goto out;
+	}
+
+	fp = fopen(output, "w");
+	if (!fp) {
+		fprintf(stderr, "Failed to open %s (%s)\n",
+			output, strerror(errno));
+		goto out;
+	}
+
+	memset(&act, 0, sizeof(act));
+	act.sa_sigaction = sighandler;
+	act.sa_flags = SA_SIGINFO;
+	sigaction(SIGINT, &act, NULL);
+
+	if (recording_write_header(fp, devices, ndevices) == 0 &&
+	    record(fp, devices, fds, ndevices) == 0)
+		rc = 0;
+
+	if (fclose(fp) != 0)
+		rc = 1;
+
+	if (rc != 0)
+		fprintf(stderr, "Failed to write %s\n", output);
+
+out:
+	for (i = 0; i < ndevices; i++) {
+		if (fds[i].fd != -1)
+			close(fds[i].fd);
+	}
+	recording_devices_free(devices, ndevices);
+	free(fds);
+	udev_unref(udev);
+
+	return rc;
+}
@@ -0,0 +1,541 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <endian.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "evdev-recording.h"
+
+/* The file format, all integers are little-endian:
+ *
+ * header:  "LIEVREC\0", u32 version, u32 number of devices
+ * device:  str sysname, str name, u16 bustype, u16 vendor, u16 product,
+ *          u16 version, u32 number of properties, u16 property...,
+ *          u32 number of codes, code..., u32 number of slots, slot...,
+ *          u32 number of udev properties, (str name, str value)...
+ * code:    u16 type, u16 code, for EV_ABS followed by i32 value, minimum,
+ *          maximum, fuzz, flat, resolution
+ * slot:    the i32 value of each ABS_MT_* code the device has, in code
+ *          order, ABS_MT_SLOT itself excluded. Zero slots for devices
+ *          without ABS_MT_SLOT.
+ * str:     u16 length, the bytes without a trailing null byte
+ *
+ * followed by the events until the end of the file, 18 bytes each:
+ *          u16 device index, u16 type, u16 code, i32 value, u64 time in µs
+ */
+#define RECORDING_MAGIC "LIEVREC"
+#define RECORDING_VERSION 2
+
+static inline int
+write_u16(FILE *fp, uint16_t v)
+{
+	v = htole16(v);
+	return fwrite(&v, sizeof(v), 1, fp) == 1 ? 0 : -EIO;
+}
+
+static inline int
+write_u32(FILE *fp, uint32_t v)
+{
+	v = htole32(v);
+	return fwrite(&v, sizeof(v), 1, fp) == 1 ? 0 : -EIO;
+}
+
+static inline int
+write_u64(FILE *fp, uint64_t v)
+{
+	v = htole64(v);
+	return fwrite(&v, sizeof(v), 1, fp) == 1 ? 0 : -EIO;
+}
+
+static inline int
+write_str(FILE *fp, const char *str)
+{
+	size_t len = str ? strlen(str) : 0;
+
+	if (len > UINT16_MAX)
+		return -EINVAL;
+
+	if (write_u16(fp, len) < 0 ||
+	    (len > 0 && fwrite(str, len, 1, fp) != 1))
+		return -EIO;
+
+	return 0;
+}
+
+static inline int
+read_u16(FILE *fp, uint16_t *v)
+{
+	if (fread(v, sizeof(*v), 1, fp) != 1)
+		return -EIO;
+	*v = le16toh(*v);
+	return 0;
+}
+
+static inline int
+read_u32(FILE *fp, uint32_t *v)
+{
+	if (fread(v, sizeof(*v), 1, fp) != 1)
+		return -EIO;
+	*v = le32toh(*v);
+	return 0;
+}
+
+static inline int
+read_u64(FILE *fp, uint64_t *v)
+{
+	if (fread(v, sizeof(*v), 1, fp) != 1)
+		return -EIO;
+	*v = le64toh(*v);
+	return 0;
+}
+
+static inline int
+read_str(FILE *fp, char **str)
+{
+	uint16_t len;
+
+	if (read_u16(fp, &len) < 0)
+		return -EIO;
+
+	*str = calloc(len + 1, 1);
+	if (!*str)
+		return -ENOMEM;
+
+	if (len > 0 && fread(*str, len, 1, fp) != 1) {
+		free(*str);
+		*str = NULL;
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static int
+event_type_max(unsigned int type)
+{
+	switch (type) {
+	case EV_KEY: return KEY_MAX;
+	case EV_REL: return REL_MAX;
+	case EV_ABS: return ABS_MAX;
+	case EV_MSC: return MSC_MAX;
+	case EV_SW: return SW_MAX;
+	case EV_LED: return LED_MAX;
+	case EV_SND: return SND_MAX;
+	case EV_FF: return FF_MAX;
+	default: return -1;
+	}
+}
+
+static int
+write_codes(FILE *fp, struct libevdev *evdev)
+{
+	unsigned int type, code;
+	uint32_t ncodes = 0;
+	int pass, rc;
+
+	/* first pass counts, second pass writes */
+	for (pass = 0; pass < 2; pass++) {
+		if (pass == 1 && (rc = write_u32(fp, ncodes)) < 0)
+			return rc;
+
+		/* EV_SYN is implied, EV_REP is set up by the kernel */
+		for (type = EV_KEY; type < EV_MAX; type++) {
+			int max = event_type_max(type);
+
+			if (type == EV_REP || max == -1 ||
+			    !libevdev_has_event_type(evdev, type))
+				continue;
+
+			for (code = 0; code <= (unsigned int)max; code++) {
+				const struct input_absinfo *abs;
+
+				if (!libevdev_has_event_code(evdev, type, code))
+					continue;
+
+				if (pass == 0) {
+					ncodes++;
+					continue;
+				}
+
+				if (write_u16(fp, type) < 0 ||
+				    write_u16(fp, code) < 0)
+					return -EIO;
+
+				if (type != EV_ABS)
+					continue;
+
+				abs = libevdev_get_abs_info(evdev, code);
+				if (write_u32(fp, abs->value) < 0 ||
+				    write_u32(fp, abs->minimum) < 0 ||
+				    write_u32(fp, abs->maximum) < 0 ||
+				    write_u32(fp, abs->fuzz) < 0 ||
+				    write_u32(fp, abs->flat) < 0 ||
+				    write_u32(fp, abs->resolution) < 0)
+					return -EIO;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static inline bool
+is_slot_code(struct libevdev *evdev, unsigned int code)
+{
+	return code > ABS_MT_SLOT && code <= ABS_MT_TOOL_Y &&
+	       libevdev_has_event_code(evdev, EV_ABS, code);
+}
+
+/* The touches already down when the recording starts */
+static int
+write_slots(FILE *fp, struct libevdev *evdev)
+{
+	int nslots = libevdev_get_num_slots(evdev);
+	unsigned int code;
+	int slot;
+
+	if (nslots < 0)
+		nslots = 0;
+
+	if (write_u32(fp, nslots) < 0)
+		return -EIO;
+
+	for (slot = 0; slot < nslots; slot++) {
+		for (code = ABS_MT_SLOT + 1; code <= ABS_MT_TOOL_Y; code++) {
+			if (!is_slot_code(evdev, code))
+				continue;
+
+			if (write_u32(fp, libevdev_get_slot_value(evdev,
+								  slot,
+								  code)) < 0)
+				return -EIO;
+		}
+	}
+
+	return 0;
+}
+
+static int
+write_device(FILE *fp, const struct recording_device *device)
+{
+	struct libevdev *evdev = device->evdev;
+	unsigned int prop;
+	uint32_t nprops = 0;
+	char **p;
+	int rc;
+
+	if ((rc = write_str(fp, device->sysname)) < 0 ||
+	    (rc = write_str(fp, libevdev_get_name(evdev))) < 0 ||
+	    (rc = write_u16(fp, libevdev_get_id_bustype(evdev))) < 0 ||
+	    (rc = write_u16(fp, libevdev_get_id_vendor(evdev))) < 0 ||
+	    (rc = write_u16(fp, libevdev_get_id_product(evdev))) < 0 ||
+	    (rc = write_u16(fp, libevdev_get_id_version(evdev))) < 0)
+		return rc;
+
+	for (prop = 0; prop <= INPUT_PROP_MAX; prop++) {
+		if (libevdev_has_property(evdev, prop))
+			nprops++;
+	}
+	if ((rc = write_u32(fp, nprops)) < 0)
+		return rc;
+	for (prop = 0; prop <= INPUT_PROP_MAX; prop++) {
+		if (libevdev_has_property(evdev, prop) &&
+		    (rc = write_u16(fp, prop)) < 0)
+			return rc;
+	}
+
+	if ((rc = write_codes(fp, evdev)) < 0 ||
+	    (rc = write_slots(fp, evdev)) < 0)
+		return rc;
+
+	nprops = 0;
+	for (p = device->properties; p && p[0] && p[1]; p += 2)
+		nprops++;
+	if ((rc = write_u32(fp, nprops)) < 0)
+		return rc;
+	for (p = device->properties; p && p[0] && p[1]; p += 2) {
+		if ((rc = write_str(fp, p[0])) < 0 ||
+		    (rc = write_str(fp, p[1])) < 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+int
+recording_write_header(FILE *fp,
+		       const struct recording_device *devices,
+		       unsigned int ndevices)
+{
+	unsigned int i;
+	int rc;
+
+	if (fwrite(RECORDING_MAGIC, sizeof(RECORDING_MAGIC), 1, fp) != 1 ||
+	    write_u32(fp, RECORDING_VERSION) < 0 ||
+	    write_u32(fp, ndevices) < 0)
+		return -EIO;
+
+	for (i = 0; i < ndevices; i++) {
+		rc = write_device(fp, &devices[i]);
+		if (rc < 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+int
+recording_write_event(FILE *fp,
+		      unsigned int device,
+		      const struct input_event *ev)
+{
+	uint64_t time = (uint64_t)ev->time.tv_sec * 1000000 +
+			ev->time.tv_usec;
+
+	if (write_u16(fp, device) < 0 ||
+	    write_u16(fp, ev->type) < 0 ||
+	    write_u16(fp, ev->code) < 0 ||
+	    write_u32(fp, ev->value) < 0 ||
+	    write_u64(fp, time) < 0)
+		return -EIO;
+
+	return 0;
+}
+
+static int
+read_codes(FILE *fp, struct libevdev *evdev)
+{
+	uint32_t ncodes, i;
+	uint16_t type, code;
+
+	if (read_u32(fp, &ncodes) < 0)
+		return -EIO;
+
+	for (i = 0; i < ncodes; i++) {
+		struct input_absinfo abs;
+		uint32_t v[6];
+		int j;
+
+		if (read_u16(fp, &type) < 0 ||
+		    read_u16(fp, &code) < 0)
+			return -EIO;
+
+		if (type != EV_ABS) {
+			libevdev_enable_event_code(evdev, type, code, NULL);
+			continue;
+		}
+
+		for (j = 0; j < 6; j++) {
+			if (read_u32(fp, &v[j]) < 0)
+				return -EIO;
+		}
+
+		abs.value = (int32_t)v[0];
+		abs.minimum = (int32_t)v[1];
+		abs.maximum = (int32_t)v[2];
+		abs.fuzz = (int32_t)v[3];
+		abs.flat = (int32_t)v[4];
+		abs.resolution = (int32_t)v[5];
+		libevdev_enable_event_code(evdev, EV_ABS, code, &abs);
+	}
+
+	return 0;
+}
+
+static int
+read_slots(FILE *fp, struct libevdev *evdev)
+{
+	uint32_t nslots, slot, value;
+	unsigned int code;
+	int num_slots = libevdev_get_num_slots(evdev);
+
+	if (read_u32(fp, &nslots) < 0)
+		return -EIO;
+
+	if (nslots == 0)
+		return 0;
+
+	if (num_slots < 0 || nslots != (uint32_t)num_slots)
+		return -EINVAL;
+
+	for (slot = 0; slot < nslots; slot++) {
+		for (code = ABS_MT_SLOT + 1; code <= ABS_MT_TOOL_Y; code++) {
+			if (!is_slot_code(evdev, code))
+				continue;
+
+			if (read_u32(fp, &value) < 0)
+				return -EIO;
+
+			libevdev_set_slot_value(evdev,
+						slot,
+						code,
+						(int32_t)value);
+		}
+	}
+
+	return 0;
+}
+
+static int
+read_device(FILE *fp, struct recording_device *device)
+{
+	struct libevdev *evdev;
+	char *name = NULL;
+	uint16_t id[4], prop;
+	uint32_t nprops, i;
+	int rc;
+
+	evdev = libevdev_new();
+	if (!evdev)
+		return -ENOMEM;
+	device->evdev = evdev;
+
+	if ((rc = read_str(fp, &device->sysname)) < 0 ||
+	    (rc = read_str(fp, &name)) < 0)
+		return rc;
+	libevdev_set_name(evdev, name);
+	free(name);
+
+	for (i = 0; i < 4; i++) {
+		if (read_u16(fp, &id[i]) < 0)
+			return -EIO;
+	}
+	libevdev_set_id_bustype(evdev, id[0]);
+	libevdev_set_id_vendor(evdev, id[1]);
+	libevdev_set_id_product(evdev, id[2]);
+	libevdev_set_id_version(evdev, id[3]);
+
+	if (read_u32(fp, &nprops) < 0)
+		return -EIO;
+	for (i = 0; i < nprops; i++) {
+		if (read_u16(fp, &prop) < 0)
+			return -EIO;
+		libevdev_enable_property(evdev, prop);
+	}
+
+	if ((rc = read_codes(fp, evdev)) < 0 ||
+	    (rc = read_slots(fp, evdev)) < 0)
+		return rc;
+
+	if (read_u32(fp, &nprops) < 0)
+		return -EIO;
+	if (nprops > UINT16_MAX)
+		return -EINVAL;
+
+	device->properties = calloc(2 * nprops + 1, sizeof(char *));
+	if (!device->properties)
+		return -ENOMEM;
+
+	for (i = 0; i < 2 * nprops; i++) {
+		if ((rc = read_str(fp, &device->properties[i])) < 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+int
+recording_read_header(FILE *fp,
+		      struct recording_device **devices_out,
+		      unsigned int *ndevices_out)
+{
+	struct recording_device *devices;
+	char magic[sizeof(RECORDING_MAGIC)];
+	uint32_t version, ndevices, i;
+	int rc;
+
+	if (fread(magic, sizeof(magic), 1, fp) != 1 ||
+	    memcmp(magic, RECORDING_MAGIC, sizeof(magic)) != 0 ||
+	    read_u32(fp, &version) < 0 ||
+	    version != RECORDING_VERSION ||
+	    read_u32(fp, &ndevices) < 0 ||
+	    ndevices > UINT16_MAX)
+		return -EINVAL;
+
+	devices = calloc(ndevices, sizeof(*devices));
+	if (!devices)
+		return -ENOMEM;
+
+	for (i = 0; i < ndevices; i++) {
+		rc = read_device(fp, &devices[i]);
+		if (rc < 0) {
+			recording_devices_free(devices, i + 1);
+			return rc;
+		}
+	}
+
+	*devices_out = devices;
+	*ndevices_out = ndevices;
+
+	return 0;
+}
+
+int
+recording_read_event(FILE *fp,
+		     unsigned int *device,
+		     struct input_event *ev)
+{
+	uint16_t index, type, code;
+	uint32_t value;
+	uint64_t time;
+
+	if (read_u16(fp, &index) < 0)
+		return feof(fp) ? 0 : -EIO;
+
+	if (read_u16(fp, &type) < 0 ||
+	    read_u16(fp, &code) < 0 ||
+	    read_u32(fp, &value) < 0 ||
+	    read_u64(fp, &time) < 0)
+		return -EIO;
+
+	*device = index;
+	ev->type = type;
+	ev->code = code;
+	ev->value = (int32_t)value;
+	ev->time.tv_sec = time / 1000000;
+	ev->time.tv_usec = time % 1000000;
+
+	return 1;
+}
+
+void
+recording_devices_free(struct recording_device *devices,
+		       unsigned int ndevices)
+{
+	unsigned int i;
+	char **p;
+
+	for (i = 0; i < ndevices; i++) {
+		free(devices[i].sysname);
+		libevdev_free(devices[i].evdev);
+		for (p = devices[i].properties; p && *p; p++)
+			free(*p);
+		free(devices[i].properties);
+	}
+	free(devices);
+}
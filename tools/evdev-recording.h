@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _EVDEV_RECORDING_H_
+#define _EVDEV_RECORDING_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <linux/input.h>
+
+#include <libevdev/libevdev.h>
+
+/* A recorded device. evdev describes the device as it was at the start of
+ * the recording, including the touches already down, properties are the
+ * udev properties of the device and its parent as NULL-terminated
+ * name/value pairs. */
+struct recording_device {
+	char *sysname;
+	struct libevdev *evdev;
+	char **properties;
+};
+
+int
+recording_write_header(FILE *fp,
+		       const struct recording_device *devices,
+		       unsigned int ndevices);
+
+int
+recording_write_event(FILE *fp,
+		      unsigned int device,
+		      const struct input_event *ev);
+
+int
+recording_read_header(FILE *fp,
+		      struct recording_device **devices,
+		      unsigned int *ndevices);
+
+int
+recording_read_event(FILE *fp,
+		     unsigned int *device,
+		     struct input_event *ev);
+
+void
+recording_devices_free(struct recording_device *devices,
+		       unsigned int ndevices);
+
+#endif
@@ -0,0 +1,293 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libinput.h>
+
+#include "evdev.h"
+#include "path-seat.h"
+#include "evdev-recording.h"
+#include "shared.h"
+
+/* The replayer links against libinput-internal.la and feeds the recorded
+ * events straight into the device's dispatch code, there is no device
+ * node and no kernel involved. */
+
+struct replay_stats {
+	uint64_t nevents;
+	uint64_t nframes;
+	uint64_t nlibinput_events;
+	uint64_t processing_ns;
+};
+
+static void
+sleep_until_us(uint64_t usec)
+{
+	struct timespec ts;
+
+	ts.tv_sec = usec / 1000000;
+	ts.tv_nsec = (usec % 1000000) * 1000;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) ==
+	       EINTR)
+		;
+}
+
+static void
+drain(struct libinput *li, struct replay_stats *stats, bool verbose)
+{
+	struct libinput_event *event;
+
+	libinput_dispatch(li);
+	while ((event = libinput_get_event(li))) {
+		if (verbose)
+			printf("%s: event type %d\n",
+			       libinput_device_get_sysname(
+					libinput_event_get_device(event)),
+			       libinput_event_get_type(event));
+		stats->nlibinput_events++;
+		libinput_event_destroy(event);
+	}
+}
+
+static int
+replay(FILE *fp,
+       struct libinput *li,
+       struct libinput_clock *clock,
+       struct evdev_device **devices,
+       unsigned int ndevices,
+       bool verbose,
+       struct replay_stats *stats)
+{
+	struct input_event ev;
+	unsigned int index;
+	uint64_t first = 0, start_us, time, t;
+	int rc;
+
+	start_us = tools_now_ns() / 1000;
+	time = start_us;
+
+	while ((rc = recording_read_event(fp, &index, &ev)) > 0) {
+		if (index >= ndevices) {
+			fprintf(stderr, "Invalid device index %u\n", index);
+			return -EINVAL;
+		}
+
+		if (!devices[index])
+			continue;
+
+		time = (uint64_t)ev.time.tv_sec * 1000000 + ev.time.tv_usec;
+		if (first == 0)
+			first = time;
+
+		/* the original intervals, rebased to when we started */
+		time = start_us + (time - first);
+		ev.time.tv_sec = time / 1000000;
+		ev.time.tv_usec = time % 1000000;
+
+		if (!clock)
+			sleep_until_us(time);
+
+		/* moving the clock runs the timers that expired since the
+		 * last event, that counts as processing time */
+		t = tools_now_ns();
+		if (clock)
+			libinput_clock_set_time(clock, time);
+		evdev_device_inject_event(devices[index], &ev);
+		if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+			drain(li, stats, verbose);
+			stats->nframes++;
+		}
+		stats->processing_ns += tools_now_ns() - t;
+		stats->nevents++;
+	}
+
+	if (rc < 0) {
+		fprintf(stderr, "Failed to read the recording\n");
+		return rc;
+	}
+
+	/* anything left in the pipeline, e.g. pending timeouts */
+	if (clock)
+		libinput_clock_set_time(clock, time + s2us(1));
+	drain(li, stats, verbose);
+
+	return 0;
+}
+
+static void
+usage(void)
+{
+	printf("Usage: %s [--fast] [--verbose] <recording>\n",
+	       program_invocation_short_name);
+	printf("\n"
+	       "Replays a recording made with evdev-record through libinput's\n"
+	       "device dispatch code. No device nodes or uinput are required.\n"
+	       "Prints how long libinput spent processing the events.\n"
+	       "\n"
+	       "Options:\n"
+	       "--fast ....... replay as fast as possible instead of at the\n"
+	       "               recorded speed\n"
+	       "--verbose .... print each libinput event\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	struct recording_device *recording;
+	struct evdev_device **devices;
+	struct replay_stats stats = {0};
+	struct libinput_clock *clock = NULL;
+	struct libinput *li;
+	unsigned int ndevices, i;
+	bool fast = false, verbose = false;
+	FILE *fp;
+	int rc;
+
+	enum {
+		OPT_HELP = 1,
+		OPT_FAST,
+		OPT_VERBOSE,
+	};
+
+	while (1) {
+		int c;
+		int option_index = 0;
+		static struct option long_options[] = {
+			{"help", 0, 0, OPT_HELP },
+			{"fast", 0, 0, OPT_FAST },
+			{"verbose", 0, 0, OPT_VERBOSE },
+			{0, 0, 0, 0}
+		};
+
+		c = getopt_long(argc, argv, "",
+				long_options, &option_index);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case OPT_HELP:
+			usage();
+			exit(0);
+			break;
+		case OPT_FAST:
+			fast = true;
+			break;
+		case OPT_VERBOSE:
+			verbose = true;
+			break;
+		default:
+			usage();
+			exit(1);
+			break;
+		}
+	}
+
+	if (optind != argc - 1) {
+		usage();
+		return 1;
+	}
+
+	fp = fopen(argv[optind], "r");
+	if (!fp) {
+		fprintf(stderr, "Failed to open %s (%s)\n",
+			argv[optind], strerror(errno));
+		return 1;
+	}
+
+	rc = recording_read_header(fp, &recording, &ndevices);
+	if (rc < 0) {
+		fprintf(stderr, "Invalid recording %s\n", argv[optind]);
+		fclose(fp);
+		return 1;
+	}
+
+	li = libinput_path_create_context(&tools_virtual_interface, NULL);
+	devices = zalloc(ndevices * sizeof(*devices));
+	if (!li || !devices)
+		return 1;
+
+	/* As fast as possible means libinput's timers must not depend on
+	 * the real clock, the virtual clock follows the event times */
+	if (fast) {
+		clock = libinput_clock_create_virtual(tools_now_ns() / 1000);
+		if (!clock)
+			return 1;
+		libinput_clock_attach(clock, li);
+	}
+
+	for (i = 0; i < ndevices; i++) {
+		struct libinput_device *device;
+
+		device = path_add_virtual_device(li,
+						 recording[i].evdev,
+						 recording[i].sysname,
+						 (const char * const *)
+							recording[i].properties,
+						 -1);
+		/* the device owns the libevdev context now */
+		recording[i].evdev = NULL;
+		if (!device) {
+			fprintf(stderr,
+				"Skipping %s, libinput does not handle it\n",
+				recording[i].sysname);
+			continue;
+		}
+
+		devices[i] = evdev_device(device);
+	}
+
+	/* the device added events */
+	drain(li, &stats, verbose);
+	stats.nlibinput_events = 0;
+
+	rc = replay(fp, li, clock, devices, ndevices, verbose, &stats);
+
+	printf("evdev events: %" PRIu64 "\n", stats.nevents);
+	printf("frames: %" PRIu64 "\n", stats.nframes);
+	printf("libinput events: %" PRIu64 "\n", stats.nlibinput_events);
+	printf("processing time: %.3fms\n", stats.processing_ns/1e6);
+	if (stats.nframes > 0)
+		printf("µs/frame: %.3f\n",
+		       stats.processing_ns/1e3/stats.nframes);
+	if (stats.processing_ns > 0)
+		printf("evdev events/s: %.0f\n",
+		       1e9 * stats.nevents/stats.processing_ns);
+
+	libinput_unref(li);
+	libinput_clock_destroy(clock);
+	free(devices);
+	recording_devices_free(recording, ndevices);
+	fclose(fp);
+
+	return rc == 0 ? 0 : 1;
+}
@@ -24,9 +24,11 @@
 #define _GNU_SOURCE
 #include <errno.h>
 #include <inttypes.h>
+#include <math.h>
 #include <fcntl.h>
 #include <poll.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <signal.h>
 #include <string.h>
 #include <time.h>
@@ -47,100 +49,133 @@ struct tools_context context;
 static unsigned int stop = 0;
 static bool be_quiet = false;
 
+/* devices we keep stats for, see --show-latency, --show-cpu-stats,
+ * --stats and --binary */
+struct stats_device {
+	struct libinput_device *device;
+	struct stats_device *next;
+	uint32_t index; /* in order of DEVICE_ADDED */
+
+	/* for --stats, reset after printing */
+	uint64_t nevents;
+	struct {
+		enum libinput_event_type type;
+		uint64_t count;
+	} types[32];
+	unsigned int ntypes;
+
+	/* intervals between frames in µs, running mean and variance */
+	uint64_t last_time;
+	uint64_t nintervals;
+	double interval_mean, interval_m2;
+	uint64_t interval_min, interval_max;
+};
+static struct stats_device *stats_devices = NULL;
+static uint32_t stats_device_index = 0;
+
+/* libinput events read per wakeup, for --stats */
+static struct {
+	uint64_t nwakeups;
+	uint64_t nevents;
+	uint64_t max;
+} batch;
+static uint64_t stats_last_print; /* in ms */
+
+/* The --binary file format is a struct binary_header followed by one
+ * struct binary_record per event, in host byte order. Fields that do
+ * not apply to an event type are zero. */
+struct binary_header {
+	char magic[8]; /* "LIEVENTS" */
+	uint32_t version; /* 1 */
+	uint32_t record_size;
+};
+
+struct binary_record {
+	uint64_t time; /* in µs, 0 for device added/removed */
+	uint32_t type; /* enum libinput_event_type */
+	uint32_t device; /* the device's DEVICE_ADDED in this file, 0-based */
+	int32_t code; /* key, button, seat slot, finger count, ring... */
+	int32_t value; /* key/button/tip/proximity/switch state */
+	double x, y; /* deltas, positions or axis values */
+};
+static FILE *binary_fp = NULL;
+
 #define printq(...) ({ if (!be_quiet)  printf(__VA_ARGS__); })
 
-static void
-print_event_header(struct libinput_event *ev)
+static const char *
+event_type_to_str(enum libinput_event_type type)
 {
-	/* use for pointer value only, do not dereference */
-	static void *last_device = NULL;
-	struct libinput_device *dev = libinput_event_get_device(ev);
-	const char *type = NULL;
-	char prefix;
-
-	switch(libinput_event_get_type(ev)) {
+	switch(type) {
 	case LIBINPUT_EVENT_NONE:
 		abort();
 	case LIBINPUT_EVENT_DEVICE_ADDED:
-		type = "DEVICE_ADDED";
-		break;
+		return "DEVICE_ADDED";
 	case LIBINPUT_EVENT_DEVICE_REMOVED:
-		type = "DEVICE_REMOVED";
-		break;
+		return "DEVICE_REMOVED";
 	case LIBINPUT_EVENT_KEYBOARD_KEY:
-		type = "KEYBOARD_KEY";
-		break;
+		return "KEYBOARD_KEY";
 	case LIBINPUT_EVENT_POINTER_MOTION:
-		type = "POINTER_MOTION";
-		break;
+		return "POINTER_MOTION";
 	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
-		type = "POINTER_MOTION_ABSOLUTE";
-		break;
+		return "POINTER_MOTION_ABSOLUTE";
 	case LIBINPUT_EVENT_POINTER_BUTTON:
-		type = "POINTER_BUTTON";
-		break;
+		return "POINTER_BUTTON";
 	case LIBINPUT_EVENT_POINTER_AXIS:
-		type = "POINTER_AXIS";
-		break;
+		return "POINTER_AXIS";
 	case LIBINPUT_EVENT_TOUCH_DOWN:
-		type = "TOUCH_DOWN";
-		break;
+		return "TOUCH_DOWN";
 	case LIBINPUT_EVENT_TOUCH_MOTION:
-		type = "TOUCH_MOTION";
-		break;
+		return "TOUCH_MOTION";
 	case LIBINPUT_EVENT_TOUCH_UP:
-		type = "TOUCH_UP";
-		break;
+		return "TOUCH_UP";
 	case LIBINPUT_EVENT_TOUCH_CANCEL:
-		type = "TOUCH_CANCEL";
-		break;
+		return "TOUCH_CANCEL";
 	case LIBINPUT_EVENT_TOUCH_FRAME:
-		type = "TOUCH_FRAME";
-		break;
+		return "TOUCH_FRAME";
 	case LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN:
-		type = "GESTURE_SWIPE_BEGIN";
-		break;
+		return "GESTURE_SWIPE_BEGIN";
 	case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE:
-		type = "GESTURE_SWIPE_UPDATE";
-		break;
+		return "GESTURE_SWIPE_UPDATE";
 	case LIBINPUT_EVENT_GESTURE_SWIPE_END:
-		type = "GESTURE_SWIPE_END";
-		break;
+		return "GESTURE_SWIPE_END";
 	case LIBINPUT_EVENT_GESTURE_PINCH_BEGIN:
-		type = "GESTURE_PINCH_BEGIN";
-		break;
+		return "GESTURE_PINCH_BEGIN";
 	case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE:
-		type = "GESTURE_PINCH_UPDATE";
-		break;
+		return "GESTURE_PINCH_UPDATE";
 	case LIBINPUT_EVENT_GESTURE_PINCH_END:
-		type = "GESTURE_PINCH_END";
-		break;
+		return "GESTURE_PINCH_END";
 	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
-		type = "TABLET_TOOL_AXIS";
-		break;
+		return "TABLET_TOOL_AXIS";
 	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
-		type = "TABLET_TOOL_PROXIMITY";
-		break;
+		return "TABLET_TOOL_PROXIMITY";
 	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
-		type = "TABLET_TOOL_TIP";
-		break;
+		return "TABLET_TOOL_TIP";
 	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
-		type = "TABLET_TOOL_BUTTON";
-		break;
+		return "TABLET_TOOL_BUTTON";
 	case LIBINPUT_EVENT_TABLET_PAD_BUTTON:
-		type = "TABLET_PAD_BUTTON";
-		break;
+		return "TABLET_PAD_BUTTON";
 	case LIBINPUT_EVENT_TABLET_PAD_RING:
-		type = "TABLET_PAD_RING";
-		break;
+		return "TABLET_PAD_RING";
 	case LIBINPUT_EVENT_TABLET_PAD_STRIP:
-		type = "TABLET_PAD_STRIP";
-		break;
+		return "TABLET_PAD_STRIP";
 	case LIBINPUT_EVENT_SWITCH_TOGGLE:
-		type = "SWITCH_TOGGLE";
-		break;
+		return "SWITCH_TOGGLE";
 	}
 
+	return NULL;
+}
+
+static void
+print_event_header(struct libinput_event *ev)
+{
+	/* use for pointer value only, do not dereference */
+	static void *last_device = NULL;
+	struct libinput_device *dev = libinput_event_get_device(ev);
+	const char *type;
+	char prefix;
+
+	type = event_type_to_str(libinput_event_get_type(ev));
+
 	prefix = (last_device != dev) ? '-' : ' ';
 
 	printq("%c%-7s  %-16s ",
@@ -757,17 +792,503 @@ print_switch_event(struct libinput_event *ev)
 	printq("switch %s state %d\n", which, state);
 }
 
+static void
+print_latency_stage(struct libinput_device *dev,
+		    enum libinput_latency_stage stage,
+		    const char *name)
+{
+	struct libinput_latency_stats stats;
+	unsigned int i;
+
+	libinput_device_get_latency_stats(dev, stage, &stats, sizeof(stats));
+
+	printf("  %s: %" PRIu64 " events", name, stats.count);
+	if (stats.count == 0) {
+		printf("\n");
+		return;
+	}
+
+	printf(", avg %" PRIu64 "µs, max %" PRIu64 "µs\n",
+	       stats.sum_usec/stats.count,
+	       stats.max_usec);
+
+	for (i = 0; i < LIBINPUT_LATENCY_STATS_BUCKETS; i++) {
+		if (stats.buckets[i] == 0)
+			continue;
+
+		if (i == LIBINPUT_LATENCY_STATS_BUCKETS - 1)
+			printf("    >= %uµs", 1U << i);
+		else
+			printf("    %7u-%uµs", i == 0 ? 0 : 1U << i,
+			       (1U << (i + 1)) - 1);
+		printf("\t%" PRIu64 " (%.1f%%)\n",
+		       stats.buckets[i],
+		       100.0 * stats.buckets[i]/stats.count);
+	}
+}
+
+static void
+print_timestamp_stats(struct libinput_device *dev)
+{
+	struct libinput_timestamp_stats stats;
+
+	if (libinput_device_get_timestamp_stats(dev,
+						&stats,
+						sizeof(stats)) == 0 ||
+	    stats.frames == 0)
+		return;
+
+	printf("  hardware timestamps: %" PRIu64 " frames, "
+	       "%" PRIu64 " batched (%.1f%%), %" PRIu64 " resyncs\n",
+	       stats.frames,
+	       stats.batched,
+	       100.0 * stats.batched/stats.frames,
+	       stats.resyncs);
+}
+
+static void
+print_latency(struct libinput_device *dev)
+{
+	printf("Latency of %s (%s):\n",
+	       libinput_device_get_sysname(dev),
+	       libinput_device_get_name(dev));
+	print_latency_stage(dev,
+			    LIBINPUT_LATENCY_STAGE_PROCESSING,
+			    "kernel to queued");
+	print_latency_stage(dev,
+			    LIBINPUT_LATENCY_STAGE_QUEUED,
+			    "queued to read");
+	print_timestamp_stats(dev);
+}
+
+static void
+print_cpu_stats(struct libinput_device *dev)
+{
+	static const struct {
+		enum libinput_cpu_stat stat;
+		const char *name;
+	} stats[] = {
+		{ LIBINPUT_CPU_STAT_PROCESS, "process" },
+		{ LIBINPUT_CPU_STAT_POINTER_ACCEL, "pointer accel" },
+		{ LIBINPUT_CPU_STAT_TOUCHPAD_TAP, "tap" },
+		{ LIBINPUT_CPU_STAT_TOUCHPAD_BUTTONS, "buttons" },
+		{ LIBINPUT_CPU_STAT_TOUCHPAD_EDGE_SCROLL, "edge scroll" },
+		{ LIBINPUT_CPU_STAT_TOUCHPAD_GESTURES, "gestures" },
+		{ LIBINPUT_CPU_STAT_TOUCHPAD_PALM, "palm/thumb" },
+		{ LIBINPUT_CPU_STAT_TIMERS, "timers" },
+	};
+	struct libinput_cpu_stats cpu;
+	unsigned int i;
+
+	printf("CPU time of %s (%s):\n",
+	       libinput_device_get_sysname(dev),
+	       libinput_device_get_name(dev));
+
+	for (i = 0; i < sizeof(stats)/sizeof(stats[0]); i++) {
+		libinput_device_get_cpu_stats(dev,
+					      stats[i].stat,
+					      &cpu,
+					      sizeof(cpu));
+		if (cpu.calls == 0)
+			continue;
+
+		printf("  %-14s %10" PRIu64 " calls, %9.3fms, avg %.3fµs\n",
+		       stats[i].name,
+		       cpu.calls,
+		       cpu.nsec/1e6,
+		       cpu.nsec/1e3/cpu.calls);
+	}
+}
+
+static void
+print_device_stats(struct libinput_device *dev)
+{
+	if (context.options.show_latency)
+		print_latency(dev);
+	if (context.options.show_cpu_stats)
+		print_cpu_stats(dev);
+}
+
+static bool
+tracking_devices(void)
+{
+	return context.options.show_latency ||
+	       context.options.show_cpu_stats ||
+	       context.options.stats ||
+	       binary_fp;
+}
+
+static void
+track_device_added(struct libinput_event *ev)
+{
+	struct libinput_device *dev = libinput_event_get_device(ev);
+	struct stats_device *sd;
+
+	sd = calloc(1, sizeof(*sd));
+	if (!sd)
+		return;
+
+	sd->device = libinput_device_ref(dev);
+	sd->index = stats_device_index++;
+	sd->next = stats_devices;
+	stats_devices = sd;
+	libinput_device_set_user_data(dev, sd);
+}
+
+static void
+track_device_removed(struct libinput_event *ev)
+{
+	struct libinput_device *dev = libinput_event_get_device(ev);
+	struct stats_device **l, *sd;
+
+	for (l = &stats_devices; *l; l = &(*l)->next) {
+		if ((*l)->device != dev)
+			continue;
+
+		sd = *l;
+		*l = sd->next;
+		print_device_stats(sd->device);
+		libinput_device_set_user_data(sd->device, NULL);
+		libinput_device_unref(sd->device);
+		free(sd);
+		break;
+	}
+}
+
+static void
+print_all_device_stats(void)
+{
+	struct stats_device *sd;
+
+	while ((sd = stats_devices)) {
+		stats_devices = sd->next;
+		print_device_stats(sd->device);
+		libinput_device_unref(sd->device);
+		free(sd);
+	}
+}
+
+static void
+print_all_latency(void)
+{
+	struct stats_device *sd;
+
+	for (sd = stats_devices; sd; sd = sd->next)
+		print_latency(sd->device);
+	fflush(stdout);
+}
+
+static uint64_t
+event_time_usec(struct libinput_event *ev)
+{
+	switch (libinput_event_get_type(ev)) {
+	case LIBINPUT_EVENT_NONE:
+	case LIBINPUT_EVENT_DEVICE_ADDED:
+	case LIBINPUT_EVENT_DEVICE_REMOVED:
+		return 0;
+	case LIBINPUT_EVENT_KEYBOARD_KEY:
+		return libinput_event_keyboard_get_time_usec(
+				libinput_event_get_keyboard_event(ev));
+	case LIBINPUT_EVENT_POINTER_MOTION:
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+	case LIBINPUT_EVENT_POINTER_AXIS:
+		return libinput_event_pointer_get_time_usec(
+				libinput_event_get_pointer_event(ev));
+	case LIBINPUT_EVENT_TOUCH_DOWN:
+	case LIBINPUT_EVENT_TOUCH_UP:
+	case LIBINPUT_EVENT_TOUCH_MOTION:
+	case LIBINPUT_EVENT_TOUCH_CANCEL:
+	case LIBINPUT_EVENT_TOUCH_FRAME:
+		return libinput_event_touch_get_time_usec(
+				libinput_event_get_touch_event(ev));
+	case LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_SWIPE_END:
+	case LIBINPUT_EVENT_GESTURE_PINCH_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_PINCH_END:
+		return libinput_event_gesture_get_time_usec(
+				libinput_event_get_gesture_event(ev));
+	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
+	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
+	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
+	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
+		return libinput_event_tablet_tool_get_time_usec(
+				libinput_event_get_tablet_tool_event(ev));
+	case LIBINPUT_EVENT_TABLET_PAD_BUTTON:
+	case LIBINPUT_EVENT_TABLET_PAD_RING:
+	case LIBINPUT_EVENT_TABLET_PAD_STRIP:
+		return libinput_event_tablet_pad_get_time_usec(
+				libinput_event_get_tablet_pad_event(ev));
+	case LIBINPUT_EVENT_SWITCH_TOGGLE:
+		return libinput_event_switch_get_time_usec(
+				libinput_event_get_switch_event(ev));
+	}
+
+	return 0;
+}
+
+static void
+record_event_stats(struct libinput_event *ev)
+{
+	struct libinput_device *dev = libinput_event_get_device(ev);
+	struct stats_device *sd = libinput_device_get_user_data(dev);
+	enum libinput_event_type type = libinput_event_get_type(ev);
+	uint64_t time, interval;
+	double delta;
+	unsigned int i;
+
+	if (!sd)
+		return;
+
+	sd->nevents++;
+
+	for (i = 0; i < sd->ntypes; i++) {
+		if (sd->types[i].type == type)
+			break;
+	}
+	if (i == sd->ntypes) {
+		if (i == sizeof(sd->types)/sizeof(sd->types[0]))
+			return;
+		sd->types[i].type = type;
+		sd->types[i].count = 0;
+		sd->ntypes++;
+	}
+	sd->types[i].count++;
+
+	/* events of the same frame share the timestamp, only the first one
+	 * counts for the interval */
+	time = event_time_usec(ev);
+	if (time == 0 || time <= sd->last_time)
+		return;
+
+	if (sd->last_time != 0) {
+		interval = time - sd->last_time;
+		if (sd->nintervals == 0 || interval < sd->interval_min)
+			sd->interval_min = interval;
+		if (interval > sd->interval_max)
+			sd->interval_max = interval;
+
+		sd->nintervals++;
+		delta = interval - sd->interval_mean;
+		sd->interval_mean += delta/sd->nintervals;
+		sd->interval_m2 += delta * (interval - sd->interval_mean);
+	}
+	sd->last_time = time;
+}
+
+static void
+print_event_rates(uint64_t elapsed_ms)
+{
+	struct stats_device *sd;
+	unsigned int i;
+
+	if (elapsed_ms == 0)
+		return;
+
+	for (sd = stats_devices; sd; sd = sd->next) {
+		if (sd->nevents == 0)
+			continue;
+
+		printf("%-7s %8.1f events/s",
+		       libinput_device_get_sysname(sd->device),
+		       sd->nevents * 1000.0/elapsed_ms);
+		if (sd->nintervals > 1)
+			printf(", interval %.2fms ±%.2fms (%.2f-%.2fms)",
+			       sd->interval_mean/1000.0,
+			       sqrt(sd->interval_m2/(sd->nintervals - 1))/1000.0,
+			       sd->interval_min/1000.0,
+			       sd->interval_max/1000.0);
+		printf("\n");
+
+		for (i = 0; i < sd->ntypes; i++)
+			printf("        %-24s %" PRIu64 "\n",
+			       event_type_to_str(sd->types[i].type),
+			       sd->types[i].count);
+
+		sd->nevents = 0;
+		sd->ntypes = 0;
+		sd->nintervals = 0;
+		sd->interval_mean = 0;
+		sd->interval_m2 = 0;
+		sd->interval_max = 0;
+	}
+
+	if (batch.nwakeups > 0)
+		printf("events per wakeup: avg %.1f, max %" PRIu64 "\n",
+		       (double)batch.nevents/batch.nwakeups,
+		       batch.max);
+	memset(&batch, 0, sizeof(batch));
+	fflush(stdout);
+}
+
+static int
+write_binary_header(FILE *fp)
+{
+	struct binary_header header = {
+		.magic = { 'L', 'I', 'E', 'V', 'E', 'N', 'T', 'S' },
+		.version = 1,
+		.record_size = sizeof(struct binary_record),
+	};
+
+	return fwrite(&header, sizeof(header), 1, fp) == 1 ? 0 : -1;
+}
+
+static void
+write_binary_record(struct libinput_event *ev)
+{
+	struct libinput_device *dev = libinput_event_get_device(ev);
+	struct stats_device *sd = libinput_device_get_user_data(dev);
+	struct binary_record r = {0};
+	struct libinput_event_pointer *p;
+	struct libinput_event_touch *t;
+	struct libinput_event_gesture *g;
+	struct libinput_event_tablet_tool *tt;
+	struct libinput_event_tablet_pad *pad;
+
+	if (!sd)
+		return;
+
+	r.time = event_time_usec(ev);
+	r.type = libinput_event_get_type(ev);
+	r.device = sd->index;
+
+	switch (libinput_event_get_type(ev)) {
+	case LIBINPUT_EVENT_NONE:
+		abort();
+	case LIBINPUT_EVENT_DEVICE_ADDED:
+	case LIBINPUT_EVENT_DEVICE_REMOVED:
+	case LIBINPUT_EVENT_TOUCH_FRAME:
+		break;
+	case LIBINPUT_EVENT_KEYBOARD_KEY:
+		r.code = libinput_event_keyboard_get_key(
+				libinput_event_get_keyboard_event(ev));
+		r.value = libinput_event_keyboard_get_key_state(
+				libinput_event_get_keyboard_event(ev));
+		break;
+	case LIBINPUT_EVENT_POINTER_MOTION:
+		p = libinput_event_get_pointer_event(ev);
+		r.x = libinput_event_pointer_get_dx(p);
+		r.y = libinput_event_pointer_get_dy(p);
+		break;
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+		p = libinput_event_get_pointer_event(ev);
+		r.x = libinput_event_pointer_get_absolute_x_transformed(p,
+								screen_width);
+		r.y = libinput_event_pointer_get_absolute_y_transformed(p,
+								screen_height);
+		break;
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+		p = libinput_event_get_pointer_event(ev);
+		r.code = libinput_event_pointer_get_button(p);
+		r.value = libinput_event_pointer_get_button_state(p);
+		break;
+	case LIBINPUT_EVENT_POINTER_AXIS:
+		p = libinput_event_get_pointer_event(ev);
+		r.code = libinput_event_pointer_get_axis_source(p);
+		if (libinput_event_pointer_has_axis(p,
+				LIBINPUT_POINTER_AXIS_SCROLL_HORIZONTAL))
+			r.x = libinput_event_pointer_get_axis_value(p,
+				LIBINPUT_POINTER_AXIS_SCROLL_HORIZONTAL);
+		if (libinput_event_pointer_has_axis(p,
+				LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL))
+			r.y = libinput_event_pointer_get_axis_value(p,
+				LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL);
+		break;
+	case LIBINPUT_EVENT_TOUCH_DOWN:
+	case LIBINPUT_EVENT_TOUCH_MOTION:
+		t = libinput_event_get_touch_event(ev);
+		r.code = libinput_event_touch_get_seat_slot(t);
+		r.x = libinput_event_touch_get_x_transformed(t, screen_width);
+		r.y = libinput_event_touch_get_y_transformed(t, screen_height);
+		break;
+	case LIBINPUT_EVENT_TOUCH_UP:
+	case LIBINPUT_EVENT_TOUCH_CANCEL:
+		t = libinput_event_get_touch_event(ev);
+		r.code = libinput_event_touch_get_seat_slot(t);
+		break;
+	case LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_SWIPE_END:
+	case LIBINPUT_EVENT_GESTURE_PINCH_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_PINCH_END:
+		g = libinput_event_get_gesture_event(ev);
+		r.code = libinput_event_gesture_get_finger_count(g);
+		break;
+	case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE:
+		g = libinput_event_get_gesture_event(ev);
+		r.code = libinput_event_gesture_get_finger_count(g);
+		r.x = libinput_event_gesture_get_dx(g);
+		r.y = libinput_event_gesture_get_dy(g);
+		break;
+	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
+	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
+	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
+	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
+		tt = libinput_event_get_tablet_tool_event(ev);
+		r.x = libinput_event_tablet_tool_get_x_transformed(tt,
+								   screen_width);
+		r.y = libinput_event_tablet_tool_get_y_transformed(tt,
+								   screen_height);
+		if (r.type == LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY)
+			r.value = libinput_event_tablet_tool_get_proximity_state(tt);
+		else if (r.type == LIBINPUT_EVENT_TABLET_TOOL_TIP)
+			r.value = libinput_event_tablet_tool_get_tip_state(tt);
+		else if (r.type == LIBINPUT_EVENT_TABLET_TOOL_BUTTON) {
+			r.code = libinput_event_tablet_tool_get_button(tt);
+			r.value = libinput_event_tablet_tool_get_button_state(tt);
+		}
+		break;
+	case LIBINPUT_EVENT_TABLET_PAD_BUTTON:
+		pad = libinput_event_get_tablet_pad_event(ev);
+		r.code = libinput_event_tablet_pad_get_button_number(pad);
+		r.value = libinput_event_tablet_pad_get_button_state(pad);
+		break;
+	case LIBINPUT_EVENT_TABLET_PAD_RING:
+		pad = libinput_event_get_tablet_pad_event(ev);
+		r.code = libinput_event_tablet_pad_get_ring_number(pad);
+		r.x = libinput_event_tablet_pad_get_ring_position(pad);
+		break;
+	case LIBINPUT_EVENT_TABLET_PAD_STRIP:
+		pad = libinput_event_get_tablet_pad_event(ev);
+		r.code = libinput_event_tablet_pad_get_strip_number(pad);
+		r.x = libinput_event_tablet_pad_get_strip_position(pad);
+		break;
+	case LIBINPUT_EVENT_SWITCH_TOGGLE:
+		r.code = libinput_event_switch_get_switch(
+				libinput_event_get_switch_event(ev));
+		r.value = libinput_event_switch_get_switch_state(
+				libinput_event_get_switch_event(ev));
+		break;
+	}
+
+	fwrite(&r, sizeof(r), 1, binary_fp);
+}
+
 static int
 handle_and_print_events(struct libinput *li)
 {
 	int rc = -1;
 	struct libinput_event *ev;
+	enum libinput_event_type type;
+	uint64_t nevents = 0;
 
 	libinput_dispatch(li);
 	while ((ev = libinput_get_event(li))) {
+		type = libinput_event_get_type(ev);
+		nevents++;
+
+		if (type == LIBINPUT_EVENT_DEVICE_ADDED && tracking_devices())
+			track_device_added(ev);
+		if (context.options.stats)
+			record_event_stats(ev);
+		if (binary_fp)
+			write_binary_record(ev);
+
 		print_event_header(ev);
 
-		switch (libinput_event_get_type(ev)) {
+		switch (type) {
 		case LIBINPUT_EVENT_NONE:
 			abort();
 		case LIBINPUT_EVENT_DEVICE_ADDED:
@@ -775,6 +1296,9 @@ handle_and_print_events(struct libinput *li)
 			print_device_notify(ev);
 			tools_device_apply_config(libinput_event_get_device(ev),
 						  &context.options);
+			if (type == LIBINPUT_EVENT_DEVICE_REMOVED &&
+			    tracking_devices())
+				track_device_removed(ev);
 			break;
 		case LIBINPUT_EVENT_KEYBOARD_KEY:
 			print_key_event(li, ev);
@@ -854,9 +1378,48 @@ handle_and_print_events(struct libinput *li)
 		libinput_dispatch(li);
 		rc = 0;
 	}
+
+	if (nevents > 0) {
+		batch.nwakeups++;
+		batch.nevents += nevents;
+		if (nevents > batch.max)
+			batch.max = nevents;
+	}
+
 	return rc;
 }
 
+static uint64_t
+now_ms(void)
+{
+	struct timespec tp;
+
+	clock_gettime(CLOCK_MONOTONIC, &tp);
+	return tp.tv_sec * 1000ULL + tp.tv_nsec / 1000000;
+}
+
+/* The poll timeout until the next --stats or --show-latency output is
+ * due */
+static int
+stats_timeout(void)
+{
+	uint64_t now;
+
+	if (!context.options.stats && !context.options.show_latency)
+		return -1;
+
+	now = now_ms();
+	if (now - stats_last_print >= 1000) {
+		if (context.options.stats)
+			print_event_rates(now - stats_last_print);
+		if (context.options.show_latency)
+			print_all_latency();
+		stats_last_print = now;
+	}
+
+	return stats_last_print + 1000 - now;
+}
+
 static void
 sighandler(int signal, siginfo_t *siginfo, void *userdata)
 {
@@ -888,7 +1451,9 @@ mainloop(struct libinput *li)
 		fprintf(stderr, "Expected device added events on startup but got none. "
 				"Maybe you don't have the right permissions?\n");
 
-	while (!stop && poll(&fds, 1, -1) > -1)
+	stats_last_print = now_ms();
+
+	while (!stop && poll(&fds, 1, stats_timeout()) > -1)
 		handle_and_print_events(li);
 }
 
@@ -908,12 +1473,44 @@ main(int argc, char **argv)
 
 	be_quiet = context.options.quiet;
 
+	/* printing is the bottleneck on high-rate devices, these modes
+	 * replace it */
+	if (context.options.stats || context.options.binary)
+		be_quiet = true;
+
+	if (context.options.binary) {
+		binary_fp = fopen(context.options.binary, "w");
+		if (!binary_fp) {
+			fprintf(stderr, "Failed to open %s (%s)\n",
+				context.options.binary, strerror(errno));
+			return 1;
+		}
+		setvbuf(binary_fp, NULL, _IOFBF, 1 << 16);
+		if (write_binary_header(binary_fp) != 0) {
+			fprintf(stderr, "Failed to write to %s\n",
+				context.options.binary);
+			fclose(binary_fp);
+			return 1;
+		}
+	}
+
 	li = tools_open_backend(&context);
 	if (!li)
 		return 1;
 
+	if (context.options.show_cpu_stats)
+		libinput_set_cpu_accounting(li, 1);
+	if (context.options.show_latency)
+		libinput_set_latency_accounting(li, 1);
+
 	mainloop(li);
 
+	print_all_device_stats();
+	libinput_log_dump_trace(li);
+
+	if (binary_fp)
+		fclose(binary_fp);
+
 	libinput_unref(li);
 
 	return 0;
@@ -0,0 +1,1002 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <linux/memfd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include <libevdev/libevdev.h>
+#include <libevdev/libevdev-uinput.h>
+#include <libinput.h>
+
+#include "libinput-util.h"
+#include "shared.h"
+
+/* The ring is a memfd shared with all subscribers. There is exactly one
+ * writer, subscribers map the memfd read-only and never write to it, so
+ * any number of them can read without coordinating with each other or
+ * with the writer. Each slot is protected by a sequence number: odd while
+ * the writer is updating the slot, 2 * (n + 1) once it holds event n. A
+ * reader that finds a different sequence number after copying the slot
+ * was overtaken by the writer and skips the event.
+ */
+#ifndef F_SEAL_FUTURE_WRITE
+#define F_SEAL_FUTURE_WRITE 0x0010 /* Linux 5.1 */
+#endif
+
+#define RING_MAGIC 0x4c494652 /* LIFR */
+#define RING_VERSION 1
+#define DEFAULT_SLOTS 4096
+#define MAX_READERS 8
+/* events written before each dispatch in the benchmark, small enough to
+ * fit into the kernel's evdev client buffer */
+#define EVENTS_PER_BATCH 16
+
+struct ring_slot {
+	uint64_t seq;
+	uint64_t publish_usec;
+	uint32_t device_id;
+	uint32_t len;
+	uint8_t data[LIBINPUT_EVENT_SERIALIZED_MAX_SIZE];
+};
+
+struct ring_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t nslots;
+	uint32_t slot_size;
+	/* number of events published so far */
+	uint64_t head;
+	/* bumped after each batch, subscribers wait on it */
+	uint32_t futex;
+	uint32_t padding[9];
+	struct ring_slot slots[];
+};
+
+struct ring {
+	struct ring_header *header;
+	size_t size;
+	int fd;
+};
+
+struct reader {
+	const struct ring_header *header;
+	size_t size;
+	uint64_t next;
+	uint64_t dropped;
+};
+
+struct reader_result {
+	uint64_t events;
+	uint64_t dropped;
+	double latency_mean; /* µs */
+	double latency_p99; /* µs */
+	double latency_max; /* µs */
+	uint64_t cpu_usec;
+};
+
+static volatile sig_atomic_t stop = 0;
+
+static void
+sighandler(int signal)
+{
+	stop = 1;
+}
+
+static uint64_t
+cpu_usec(void)
+{
+	struct rusage usage;
+
+	getrusage(RUSAGE_SELF, &usage);
+	return (uint64_t)usage.ru_utime.tv_sec * 1000000 +
+		usage.ru_utime.tv_usec +
+		(uint64_t)usage.ru_stime.tv_sec * 1000000 +
+		usage.ru_stime.tv_usec;
+}
+
+static bool
+event_is_serializable(struct libinput_event *event)
+{
+	switch (libinput_event_get_type(event)) {
+	case LIBINPUT_EVENT_KEYBOARD_KEY:
+	case LIBINPUT_EVENT_POINTER_MOTION:
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+	case LIBINPUT_EVENT_POINTER_AXIS:
+	case LIBINPUT_EVENT_TOUCH_DOWN:
+	case LIBINPUT_EVENT_TOUCH_MOTION:
+	case LIBINPUT_EVENT_TOUCH_UP:
+	case LIBINPUT_EVENT_TOUCH_CANCEL:
+	case LIBINPUT_EVENT_TOUCH_FRAME:
+	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
+	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
+	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
+	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static int
+ring_create(struct ring *ring, uint32_t nslots)
+{
+	struct ring_header *header;
+	size_t size = sizeof(*header) + nslots * sizeof(struct ring_slot);
+	int fd, rc;
+
+	fd = syscall(__NR_memfd_create,
+		     "libinput-fanout",
+		     MFD_CLOEXEC|MFD_ALLOW_SEALING);
+	if (fd < 0)
+		return -errno;
+
+	/* subscribers must not be able to make their mapping invalid */
+	if (ftruncate(fd, size) < 0 ||
+	    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK|F_SEAL_GROW) < 0)
+		goto error;
+
+	header = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	if (header == MAP_FAILED)
+		goto error;
+
+	/* Our mapping stays writable, but nobody, including a subscriber
+	 * that reopens the memfd through /proc, can write to it or map it
+	 * writable from now on */
+	if (fcntl(fd, F_ADD_SEALS, F_SEAL_FUTURE_WRITE|F_SEAL_SEAL) < 0) {
+		int err = errno;
+
+		if (err == EINVAL)
+			fprintf(stderr,
+				"The kernel does not support F_SEAL_FUTURE_WRITE, "
+				"Linux 5.1 or later is required\n");
+		munmap(header, size);
+		close(fd);
+		return -err;
+	}
+
+	header->magic = RING_MAGIC;
+	header->version = RING_VERSION;
+	header->nslots = nslots;
+	header->slot_size = sizeof(struct ring_slot);
+
+	ring->header = header;
+	ring->size = size;
+	ring->fd = fd;
+
+	return 0;
+
+error:
+	rc = -errno;
+	close(fd);
+	return rc;
+}
+
+static void
+ring_destroy(struct ring *ring)
+{
+	munmap(ring->header, ring->size);
+	close(ring->fd);
+}
+
+/* A new file description for the memfd that can only be mapped
+ * read-only. The memfd is sealed with F_SEAL_FUTURE_WRITE, so a subscriber
+ * cannot get write access by reopening it with O_RDWR either */
+static int
+ring_open_readonly(struct ring *ring)
+{
+	char path[64];
+
+	snprintf(path, sizeof(path), "/proc/self/fd/%d", ring->fd);
+	return open(path, O_RDONLY|O_CLOEXEC);
+}
+
+static void
+ring_publish(struct ring *ring,
+	     struct libinput_event *event,
+	     uint32_t device_id)
+{
+	struct ring_header *header = ring->header;
+	uint64_t n = header->head;
+	struct ring_slot *slot = &header->slots[n % header->nslots];
+
+	__atomic_store_n(&slot->seq, 2 * n + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	slot->publish_usec = tools_now_ns() / 1000;
+	slot->device_id = device_id;
+	slot->len = libinput_event_serialize(event,
+					     slot->data,
+					     sizeof(slot->data));
+
+	__atomic_store_n(&slot->seq, 2 * n + 2, __ATOMIC_RELEASE);
+	__atomic_store_n(&header->head, n + 1, __ATOMIC_RELEASE);
+}
+
+/* Called once per batch, not per event, the futex syscall costs more than
+ * publishing */
+static void
+ring_wake(struct ring *ring)
+{
+	__atomic_add_fetch(&ring->header->futex, 1, __ATOMIC_RELEASE);
+	syscall(SYS_futex, &ring->header->futex, FUTEX_WAKE, INT_MAX,
+		NULL, NULL, 0);
+}
+
+static int
+reader_map(struct reader *reader, int fd)
+{
+	const struct ring_header *header;
+	struct stat st;
+
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(*header))
+		return -EINVAL;
+
+	header = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (header == MAP_FAILED)
+		return -errno;
+
+	if (header->magic != RING_MAGIC ||
+	    header->version != RING_VERSION ||
+	    header->slot_size != sizeof(struct ring_slot) ||
+	    sizeof(*header) + header->nslots * sizeof(struct ring_slot) >
+		    (size_t)st.st_size) {
+		munmap((void*)header, st.st_size);
+		return -EINVAL;
+	}
+
+	reader->header = header;
+	reader->size = st.st_size;
+	/* only events published from now on */
+	reader->next = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+	reader->dropped = 0;
+
+	return 0;
+}
+
+static void
+reader_unmap(struct reader *reader)
+{
+	munmap((void*)reader->header, reader->size);
+}
+
+/* Copies the next event into slot. Returns false if there is no event
+ * and block is false, or if the wait was interrupted by a signal. */
+static bool
+reader_next(struct reader *reader, struct ring_slot *slot, bool block)
+{
+	const struct ring_header *header = reader->header;
+
+	while (true) {
+		const struct ring_slot *s;
+		uint64_t head, expected, seq;
+		uint32_t futex;
+
+		head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+		if (reader->next == head) {
+			if (!block)
+				return false;
+
+			futex = __atomic_load_n(&header->futex,
+						__ATOMIC_ACQUIRE);
+			if (__atomic_load_n(&header->head,
+					    __ATOMIC_ACQUIRE) != head)
+				continue;
+			if (syscall(SYS_futex, &header->futex, FUTEX_WAIT,
+				    futex, NULL, NULL, 0) < 0 &&
+			    errno == EINTR)
+				return false;
+			continue;
+		}
+
+		/* we fell behind by more than the ring holds */
+		if (head - reader->next > header->nslots) {
+			reader->dropped += head - reader->next - header->nslots;
+			reader->next = head - header->nslots;
+		}
+
+		s = &header->slots[reader->next % header->nslots];
+		expected = 2 * reader->next + 2;
+		seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+		if (seq == expected) {
+			memcpy(slot, s, sizeof(*slot));
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			seq = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+		}
+
+		reader->next++;
+		if (seq == expected)
+			return true;
+
+		/* overwritten while we were looking at it */
+		reader->dropped++;
+	}
+}
+
+static int
+send_fd(int sock, int fd)
+{
+	char byte = 0;
+	struct iovec iov = { &byte, 1 };
+	union {
+		struct cmsghdr cmsg;
+		char buf[CMSG_SPACE(sizeof(int))];
+	} control;
+	struct msghdr msg;
+	struct cmsghdr *cmsg;
+
+	memset(&msg, 0, sizeof(msg));
+	memset(&control, 0, sizeof(control));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+	return sendmsg(sock, &msg, MSG_NOSIGNAL) < 0 ? -errno : 0;
+}
+
+static int
+recv_fd(int sock)
+{
+	char byte;
+	struct iovec iov = { &byte, 1 };
+	union {
+		struct cmsghdr cmsg;
+		char buf[CMSG_SPACE(sizeof(int))];
+	} control;
+	struct msghdr msg;
+	struct cmsghdr *cmsg;
+	int fd;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+
+	if (recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) <= 0)
+		return -1;
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	if (!cmsg ||
+	    cmsg->cmsg_level != SOL_SOCKET ||
+	    cmsg->cmsg_type != SCM_RIGHTS)
+		return -1;
+
+	memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+	return fd;
+}
+
+static int
+socket_open(const char *path, bool listening)
+{
+	struct sockaddr_un addr;
+	int sock;
+
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "Socket path too long: %s\n", path);
+		return -1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	sock = socket(AF_UNIX, SOCK_SEQPACKET|SOCK_CLOEXEC, 0);
+	if (sock < 0)
+		return -1;
+
+	if (listening) {
+		unlink(path);
+		if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+		    listen(sock, 16) < 0)
+			goto error;
+	} else if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+		goto error;
+	}
+
+	return sock;
+
+error:
+	fprintf(stderr, "Failed to open socket %s (%s)\n",
+		path, strerror(errno));
+	close(sock);
+	return -1;
+}
+
+/* Publishes all pending events, returns the number of events published */
+static int
+publish_events(struct libinput *li,
+	       struct ring *ring,
+	       struct tools_context *context)
+{
+	static uintptr_t next_device_id = 0;
+	struct libinput_event *event;
+	struct libinput_device *device;
+	uintptr_t device_id;
+	int n = 0;
+
+	libinput_dispatch(li);
+	while ((event = libinput_get_event(li))) {
+		device = libinput_event_get_device(event);
+
+		if (libinput_event_get_type(event) ==
+		    LIBINPUT_EVENT_DEVICE_ADDED) {
+			device_id = next_device_id++;
+			libinput_device_set_user_data(device,
+						      (void*)device_id);
+			if (context)
+				tools_device_apply_config(device,
+							  &context->options);
+		}
+
+		if (event_is_serializable(event)) {
+			device_id = (uintptr_t)
+				libinput_device_get_user_data(device);
+			ring_publish(ring, event, device_id);
+			n++;
+		}
+
+		libinput_event_destroy(event);
+	}
+
+	if (n > 0)
+		ring_wake(ring);
+
+	return n;
+}
+
+static int
+run_publisher(struct tools_context *context,
+	      const char *socket_path,
+	      uint32_t nslots)
+{
+	struct libinput *li;
+	struct ring ring;
+	struct pollfd fds[2];
+	int sock, rc;
+
+	rc = ring_create(&ring, nslots);
+	if (rc < 0) {
+		fprintf(stderr, "Failed to create the ring (%s)\n",
+			strerror(-rc));
+		return 1;
+	}
+
+	sock = socket_open(socket_path, true);
+	if (sock < 0) {
+		ring_destroy(&ring);
+		return 1;
+	}
+
+	li = tools_open_backend(context);
+	if (!li) {
+		close(sock);
+		unlink(socket_path);
+		ring_destroy(&ring);
+		return 1;
+	}
+
+	fds[0].fd = libinput_get_fd(li);
+	fds[0].events = POLLIN;
+	fds[1].fd = sock;
+	fds[1].events = POLLIN;
+
+	publish_events(li, &ring, context);
+
+	while (!stop && poll(fds, ARRAY_LENGTH(fds), -1) > -1) {
+		if (fds[0].revents)
+			publish_events(li, &ring, context);
+
+		if (fds[1].revents) {
+			int client = accept4(sock, NULL, NULL, SOCK_CLOEXEC);
+			int fd;
+
+			if (client < 0)
+				continue;
+
+			fd = ring_open_readonly(&ring);
+			if (fd >= 0) {
+				send_fd(client, fd);
+				close(fd);
+			}
+			close(client);
+		}
+	}
+
+	libinput_unref(li);
+	close(sock);
+	unlink(socket_path);
+	ring_destroy(&ring);
+
+	return 0;
+}
+
+static const char *
+event_type_name(enum libinput_event_type type)
+{
+	const char *name;
+
+	switch (type) {
+	case LIBINPUT_EVENT_KEYBOARD_KEY:
+		name = "KEYBOARD_KEY";
+		break;
+	case LIBINPUT_EVENT_POINTER_MOTION:
+		name = "POINTER_MOTION";
+		break;
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+		name = "POINTER_MOTION_ABSOLUTE";
+		break;
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+		name = "POINTER_BUTTON";
+		break;
+	case LIBINPUT_EVENT_POINTER_AXIS:
+		name = "POINTER_AXIS";
+		break;
+	case LIBINPUT_EVENT_TOUCH_DOWN:
+		name = "TOUCH_DOWN";
+		break;
+	case LIBINPUT_EVENT_TOUCH_MOTION:
+		name = "TOUCH_MOTION";
+		break;
+	case LIBINPUT_EVENT_TOUCH_UP:
+		name = "TOUCH_UP";
+		break;
+	case LIBINPUT_EVENT_TOUCH_CANCEL:
+		name = "TOUCH_CANCEL";
+		break;
+	case LIBINPUT_EVENT_TOUCH_FRAME:
+		name = "TOUCH_FRAME";
+		break;
+	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
+		name = "TABLET_TOOL_AXIS";
+		break;
+	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
+		name = "TABLET_TOOL_PROXIMITY";
+		break;
+	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
+		name = "TABLET_TOOL_TIP";
+		break;
+	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
+		name = "TABLET_TOOL_BUTTON";
+		break;
+	default:
+		name = "UNKNOWN";
+		break;
+	}
+
+	return name;
+}
+
+static int
+run_subscriber(const char *socket_path)
+{
+	struct reader reader;
+	struct ring_slot slot;
+	union libinput_event_data data;
+	enum libinput_event_type type;
+	int sock, fd;
+
+	sock = socket_open(socket_path, false);
+	if (sock < 0)
+		return 1;
+
+	fd = recv_fd(sock);
+	close(sock);
+	if (fd < 0) {
+		fprintf(stderr, "Failed to receive the ring\n");
+		return 1;
+	}
+
+	if (reader_map(&reader, fd) < 0) {
+		fprintf(stderr, "Incompatible ring\n");
+		close(fd);
+		return 1;
+	}
+	close(fd);
+
+	while (!stop && reader_next(&reader, &slot, true)) {
+		if (!libinput_event_parse(slot.data,
+					  slot.len,
+					  &type,
+					  &data,
+					  sizeof(data)))
+			continue;
+
+		printf("device %-3u %-24s latency %.3fms\n",
+		       slot.device_id,
+		       event_type_name(type),
+		       (tools_now_ns() / 1000 - slot.publish_usec)/1000.0);
+	}
+
+	printf("dropped events: %llu\n",
+	       (unsigned long long)reader.dropped);
+
+	reader_unmap(&reader);
+
+	return 0;
+}
+
+static int
+compare_double(const void *a, const void *b)
+{
+	double da = *(const double*)a,
+	       db = *(const double*)b;
+
+	return (da > db) - (da < db);
+}
+
+static void
+bench_reader(int ring_fd, int ready_fd, int result_fd, uint64_t nevents)
+{
+	struct reader reader;
+	struct ring_slot slot;
+	struct reader_result result = {0};
+	double *latencies;
+	double sum = 0;
+	uint64_t cpu_start;
+	char byte = 0;
+
+	latencies = zalloc(nevents * sizeof(*latencies));
+	if (!latencies || reader_map(&reader, ring_fd) < 0)
+		_exit(1);
+
+	cpu_start = cpu_usec();
+	if (write(ready_fd, &byte, 1) != 1)
+		_exit(1);
+
+	while (result.events + reader.dropped < nevents &&
+	       reader_next(&reader, &slot, true)) {
+		double latency = tools_now_ns() / 1000 - slot.publish_usec;
+
+		latencies[result.events++] = latency;
+		sum += latency;
+		result.latency_max = max(result.latency_max, latency);
+	}
+
+	result.cpu_usec = cpu_usec() - cpu_start;
+	result.dropped = reader.dropped;
+	if (result.events > 0) {
+		qsort(latencies, result.events, sizeof(*latencies),
+		      compare_double);
+		result.latency_mean = sum/result.events;
+		result.latency_p99 = latencies[result.events * 99/100];
+	}
+
+	if (write(result_fd, &result, sizeof(result)) != sizeof(result))
+		_exit(1);
+
+	reader_unmap(&reader);
+	free(latencies);
+	_exit(0);
+}
+
+static void
+bench_round(struct libinput *li,
+	    struct libevdev_uinput *uinput,
+	    struct ring *ring,
+	    int nreaders,
+	    uint64_t nevents)
+{
+	struct reader_result results[MAX_READERS], total = {0};
+	int ready[2], result[2];
+	int ring_fd;
+	uint64_t published = 0, cpu_start, publisher_cpu;
+	char byte;
+	int i;
+
+	ring_fd = ring_open_readonly(ring);
+	if (ring_fd < 0 ||
+	    pipe2(ready, O_CLOEXEC) < 0 ||
+	    pipe2(result, O_CLOEXEC) < 0) {
+		fprintf(stderr, "Failed to set up the readers (%s)\n",
+			strerror(errno));
+		exit(1);
+	}
+
+	for (i = 0; i < nreaders; i++) {
+		if (fork() == 0)
+			bench_reader(ring_fd, ready[1], result[1], nevents);
+	}
+	close(ring_fd);
+
+	for (i = 0; i < nreaders; i++) {
+		if (read(ready[0], &byte, 1) != 1)
+			exit(1);
+	}
+
+	cpu_start = cpu_usec();
+	while (published < nevents) {
+		for (i = 0; i < EVENTS_PER_BATCH; i++) {
+			libevdev_uinput_write_event(uinput,
+						    EV_REL, REL_X, 1);
+			libevdev_uinput_write_event(uinput,
+						    EV_SYN, SYN_REPORT, 0);
+		}
+		published += publish_events(li, ring, NULL);
+	}
+	publisher_cpu = cpu_usec() - cpu_start;
+
+	for (i = 0; i < nreaders; i++) {
+		if (read(result[0], &results[i], sizeof(results[i])) !=
+		    sizeof(results[i]))
+			exit(1);
+
+		total.events += results[i].events;
+		total.dropped += results[i].dropped;
+		total.latency_mean += results[i].latency_mean/nreaders;
+		total.latency_p99 = max(total.latency_p99,
+					results[i].latency_p99);
+		total.latency_max = max(total.latency_max,
+					results[i].latency_max);
+		total.cpu_usec += results[i].cpu_usec;
+	}
+
+	while (wait(NULL) > 0)
+		;
+
+	close(ready[0]);
+	close(ready[1]);
+	close(result[0]);
+	close(result[1]);
+
+	printf("%7d %12.1f %12.1f %12.1f %16.2f %19.2f %8llu\n",
+	       nreaders,
+	       total.latency_mean,
+	       total.latency_p99,
+	       total.latency_max,
+	       1.0 * total.cpu_usec/max(total.events, 1u),
+	       1.0 * publisher_cpu/published,
+	       (unsigned long long)total.dropped);
+}
+
+static int
+run_bench(int max_readers, uint64_t nevents, uint32_t nslots)
+{
+	struct libevdev_uinput *uinput;
+	struct libinput *li;
+	struct tools_context context;
+	struct ring ring;
+	int nreaders, rc;
+
+	uinput = tools_create_uinput_mouse("libinput fanout benchmark");
+	if (!uinput) {
+		fprintf(stderr, "Failed to create uinput device\n");
+		return 1;
+	}
+
+	rc = ring_create(&ring, nslots);
+	if (rc < 0) {
+		fprintf(stderr, "Failed to create the ring (%s)\n",
+			strerror(-rc));
+		libevdev_uinput_destroy(uinput);
+		return 1;
+	}
+
+	tools_init_context(&context);
+	context.options.backend = BACKEND_DEVICE;
+	context.options.device = libevdev_uinput_get_devnode(uinput);
+	li = tools_open_backend(&context);
+	if (!li) {
+		ring_destroy(&ring);
+		libevdev_uinput_destroy(uinput);
+		return 1;
+	}
+	publish_events(li, &ring, NULL);
+
+	printf("events per reader: %llu, ring slots: %u\n",
+	       (unsigned long long)nevents, nslots);
+	printf("readers latency-µs p99-µs       max-µs       "
+	       "reader-cpu-µs/ev publisher-cpu-µs/ev dropped\n");
+	for (nreaders = 1; nreaders <= max_readers; nreaders++)
+		bench_round(li, uinput, &ring, nreaders, nevents);
+
+	libinput_unref(li);
+	ring_destroy(&ring);
+	libevdev_uinput_destroy(uinput);
+
+	return 0;
+}
+
+static void
+usage(void)
+{
+	printf("Usage: %s [options] [--udev <seat>|--device /dev/input/event0]\n",
+	       program_invocation_short_name);
+	printf("       %s --subscribe [--socket=<path>]\n",
+	       program_invocation_short_name);
+	printf("       %s --bench[=<readers>] [--events=<n>]\n",
+	       program_invocation_short_name);
+	printf("\n"
+	       "Runs one libinput context and publishes the processed events\n"
+	       "into a ring buffer in shared memory. Subscribers connect to the\n"
+	       "socket once to receive the ring and map it read-only, after\n"
+	       "that they read events without any involvement of the publisher.\n"
+	       "\n"
+	       "Options:\n"
+	       "--udev <seat> ...... use udev device discovery (default)\n"
+	       "--device <path> .... use the given device only\n"
+	       "--socket=<path> .... the socket to hand out the ring on\n"
+	       "                     (default: $XDG_RUNTIME_DIR/libinput-fanout)\n"
+	       "--slots=<n> ........ number of events the ring holds (default: %d)\n"
+	       "--grab ............. exclusively grab all opened devices\n"
+	       "--subscribe ........ connect to the socket and print the events\n"
+	       "--bench[=<n>] ...... create a uinput mouse and measure latency and\n"
+	       "                     CPU time for 1 to n readers (default: %d)\n"
+	       "--events=<n> ....... events per benchmark round (default: 100000)\n",
+	       DEFAULT_SLOTS,
+	       MAX_READERS);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct tools_context context;
+	struct sigaction act;
+	char default_socket[PATH_MAX];
+	const char *socket_path = NULL;
+	const char *runtime_dir;
+	bool subscribe = false;
+	int bench = 0;
+	long nslots = DEFAULT_SLOTS;
+	long long nevents = 100000;
+
+	enum {
+		OPT_HELP = 1,
+		OPT_UDEV,
+		OPT_DEVICE,
+		OPT_SOCKET,
+		OPT_SLOTS,
+		OPT_GRAB,
+		OPT_SUBSCRIBE,
+		OPT_BENCH,
+		OPT_EVENTS,
+	};
+
+	tools_init_context(&context);
+
+	while (1) {
+		int c;
+		int option_index = 0;
+		static struct option long_options[] = {
+			{"help", 0, 0, OPT_HELP },
+			{"udev", 1, 0, OPT_UDEV },
+			{"device", 1, 0, OPT_DEVICE },
+			{"socket", 1, 0, OPT_SOCKET },
+			{"slots", 1, 0, OPT_SLOTS },
+			{"grab", 0, 0, OPT_GRAB },
+			{"subscribe", 0, 0, OPT_SUBSCRIBE },
+			{"bench", 2, 0, OPT_BENCH },
+			{"events", 1, 0, OPT_EVENTS },
+			{0, 0, 0, 0}
+		};
+
+		c = getopt_long(argc, argv, "",
+				long_options, &option_index);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case OPT_HELP:
+			usage();
+			exit(0);
+			break;
+		case OPT_UDEV:
+			context.options.backend = BACKEND_UDEV;
+			context.options.seat = optarg;
+			break;
+		case OPT_DEVICE:
+			context.options.backend = BACKEND_DEVICE;
+			context.options.device = optarg;
+			break;
+		case OPT_SOCKET:
+			socket_path = optarg;
+			break;
+		case OPT_SLOTS:
+			nslots = atol(optarg);
+			if (nslots <= 0 || nslots > 1 << 20) {
+				usage();
+				return 1;
+			}
+			break;
+		case OPT_GRAB:
+			context.options.grab = 1;
+			break;
+		case OPT_SUBSCRIBE:
+			subscribe = true;
+			break;
+		case OPT_BENCH:
+			bench = optarg ? atoi(optarg) : MAX_READERS;
+			if (bench <= 0 || bench > MAX_READERS) {
+				usage();
+				return 1;
+			}
+			break;
+		case OPT_EVENTS:
+			nevents = atoll(optarg);
+			if (nevents <= 0) {
+				usage();
+				return 1;
+			}
+			break;
+		default:
+			usage();
+			exit(1);
+			break;
+		}
+	}
+
+	if (bench)
+		return run_bench(bench, nevents, nslots);
+
+	if (!socket_path) {
+		runtime_dir = getenv("XDG_RUNTIME_DIR");
+		if (!runtime_dir) {
+			fprintf(stderr, "XDG_RUNTIME_DIR is not set, use --socket\n");
+			return 1;
+		}
+		snprintf(default_socket, sizeof(default_socket),
+			 "%s/libinput-fanout", runtime_dir);
+		socket_path = default_socket;
+	}
+
+	memset(&act, 0, sizeof(act));
+	act.sa_handler = sighandler;
+	if (sigaction(SIGINT, &act, NULL) == -1 ||
+	    sigaction(SIGTERM, &act, NULL) == -1) {
+		fprintf(stderr, "Failed to set up signal handling (%s)\n",
+			strerror(errno));
+		return 1;
+	}
+
+	if (subscribe)
+		return run_subscriber(socket_path);
+
+	return run_publisher(&context, socket_path, nslots);
+}
@@ -896,6 +896,7 @@ main(int argc, char *argv[])
 	gtk_main();
 
 	window_cleanup(&w);
+	libinput_log_dump_trace(li);
 	libinput_unref(li);
 	udev_unref(udev);
 
@@ -72,6 +72,18 @@ draglock_default(struct libinput_device *device)
 		return "disabled";
 }
 
+static const char *
+speculative_tap_default(struct libinput_device *device)
+{
+	if (!libinput_device_config_tap_get_finger_count(device))
+		return "n/a";
+
+	if (libinput_device_config_tap_get_default_speculative_enabled(device))
+		return "enabled";
+	else
+		return "disabled";
+}
+
 static const char*
 left_handed_default(struct libinput_device *device)
 {
@@ -226,6 +238,56 @@ dwt_default(struct libinput_device *device)
 		return "disabled";
 }
 
+static const char *
+smoothing_default(struct libinput_device *device)
+{
+	if (!libinput_device_config_smoothing_is_available(device))
+		return "n/a";
+
+	if (libinput_device_config_smoothing_get_default_enabled(device))
+		return "enabled";
+	else
+		return "disabled";
+}
+
+static char *
+prediction_default(struct libinput_device *device)
+{
+	char *str;
+	unsigned int ms;
+
+	if (!libinput_device_config_prediction_is_available(device)) {
+		xasprintf(&str, "n/a");
+		return str;
+	}
+
+	ms = libinput_device_config_prediction_get_default_time(device);
+	if (ms == 0)
+		xasprintf(&str, "disabled");
+	else
+		xasprintf(&str, "%ums", ms);
+	return str;
+}
+
+static char *
+tablet_history_default(struct libinput_device *device)
+{
+	char *str;
+	unsigned int ms;
+
+	if (!libinput_device_config_tablet_history_is_available(device)) {
+		xasprintf(&str, "n/a");
+		return str;
+	}
+
+	ms = libinput_device_config_tablet_history_get_default_window(device);
+	if (ms == 0)
+		xasprintf(&str, "disabled");
+	else
+		xasprintf(&str, "%ums", ms);
+	return str;
+}
+
 static char *
 rotation_default(struct libinput_device *device)
 {
@@ -319,6 +381,7 @@ print_device_notify(struct libinput_event *ev)
 	printf("Tap-to-click:     %s\n", tap_default(dev));
 	printf("Tap-and-drag:     %s\n",  drag_default(dev));
 	printf("Tap drag lock:    %s\n", draglock_default(dev));
+	printf("Speculative tap:  %s\n", speculative_tap_default(dev));
 	printf("Left-handed:      %s\n", left_handed_default(dev));
 	printf("Nat.scrolling:    %s\n", nat_scroll_default(dev));
 	printf("Middle emulation: %s\n", middle_emulation_default(dev));
@@ -344,6 +407,16 @@ print_device_notify(struct libinput_event *ev)
 	printf("Rotation:         %s\n", str);
 	free(str);
 
+	printf("Touch smoothing:  %s\n", smoothing_default(dev));
+
+	str = prediction_default(dev);
+	printf("Prediction:       %s\n", str);
+	free(str);
+
+	str = tablet_history_default(dev);
+	printf("Tablet history:   %s\n", str);
+	free(str);
+
 	if (libinput_device_has_capability(dev,
 					   LIBINPUT_DEVICE_CAP_TABLET_PAD))
 		print_pad_info(dev);
@@ -0,0 +1,319 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "filter.h"
+#include "libinput-util.h"
+
+#define MAX_SAMPLES 65536
+
+struct sample {
+	uint64_t time;
+	struct device_coords raw;
+	struct device_coords predicted;
+};
+
+struct error_stats {
+	int n;
+	double sum;
+	double sum_sq;
+	double max;
+};
+
+/* A synthetic trace at 125Hz: the finger draws two circles with a radius of
+ * 20mm, one per second, then rests for 0.5s. The positions are in device
+ * units at the given resolution.
+ */
+static int
+generate_trace(struct sample *samples, double resolution)
+{
+	const int nsamples = 312;
+	int i;
+
+	for (i = 0; i < nsamples; i++) {
+		double t = i * 0.008,
+		       x = 50.0,
+		       y = 50.0;
+
+		if (t < 2.0) {
+			x += 20.0 * cos(2 * M_PI * t);
+			y += 20.0 * sin(2 * M_PI * t);
+		} else {
+			x += 20.0;
+		}
+
+		samples[i].time = ms2us(8) * (i + 1);
+		samples[i].raw.x = round(x * resolution);
+		samples[i].raw.y = round(y * resolution);
+	}
+
+	return nsamples;
+}
+
+static int
+read_trace(FILE *fp, struct sample *samples)
+{
+	char line[256];
+	int nsamples = 0;
+
+	while (fgets(line, sizeof(line), fp) && nsamples < MAX_SAMPLES) {
+		unsigned long long time;
+		double x, y;
+
+		if (line[0] == '#' || line[0] == '\n')
+			continue;
+
+		if (sscanf(line, "%llu %lf %lf", &time, &x, &y) != 3) {
+			fprintf(stderr, "Invalid line: %s", line);
+			continue;
+		}
+
+		samples[nsamples].time = time;
+		samples[nsamples].raw.x = round(x);
+		samples[nsamples].raw.y = round(y);
+		nsamples++;
+	}
+
+	return nsamples;
+}
+
+/* Raw position at the given time, linearly interpolated */
+static bool
+raw_at(const struct sample *samples, int nsamples, uint64_t time,
+       struct device_float_coords *pos)
+{
+	int lo = 0, hi, i;
+	double f;
+
+	if (nsamples == 0 ||
+	    time < samples[0].time ||
+	    time > samples[nsamples - 1].time)
+		return false;
+
+	/* first sample at or after time */
+	hi = nsamples - 1;
+	while (lo < hi) {
+		int mid = (lo + hi)/2;
+
+		if (samples[mid].time < time)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	i = lo;
+
+	if (i == 0 || samples[i].time == samples[i - 1].time) {
+		pos->x = samples[i].raw.x;
+		pos->y = samples[i].raw.y;
+		return true;
+	}
+
+	f = 1.0 * (time - samples[i - 1].time)/
+		  (samples[i].time - samples[i - 1].time);
+	pos->x = samples[i - 1].raw.x + f * (samples[i].raw.x - samples[i - 1].raw.x);
+	pos->y = samples[i - 1].raw.y + f * (samples[i].raw.y - samples[i - 1].raw.y);
+
+	return true;
+}
+
+static void
+error_stats_add(struct error_stats *stats,
+		const struct device_coords *point,
+		const struct device_float_coords *actual,
+		double resolution)
+{
+	double error = hypot(point->x - actual->x,
+			     point->y - actual->y)/resolution;
+
+	stats->n++;
+	stats->sum += error;
+	stats->sum_sq += error * error;
+	stats->max = max(stats->max, error);
+}
+
+static void
+error_stats_print(const char *name, const struct error_stats *stats)
+{
+	if (stats->n == 0) {
+		printf("# %s: no samples\n", name);
+		return;
+	}
+
+	printf("# %s: mean %.3fmm rms %.3fmm max %.3fmm\n",
+	       name,
+	       stats->sum/stats->n,
+	       sqrt(stats->sum_sq/stats->n),
+	       stats->max);
+}
+
+static void
+usage(void)
+{
+	printf("Usage: %s [options] [< trace]\n", program_invocation_short_name);
+	printf("\n"
+	       "Runs a touch trace through the position predictor and prints\n"
+	       "the error between the predicted position and the position\n"
+	       "actually reached at the predicted time. For comparison, the\n"
+	       "error of the unpredicted position is printed too.\n"
+	       "\n"
+	       "Options:\n"
+	       "--resolution=<double> ... device resolution in units/mm (default: 1)\n"
+	       "--ahead=<ms> ............ prediction time in ms (default: 16)\n"
+	       "--print-trace ........... print the predicted trace\n"
+	       "\n"
+	       "If stdin is a pipe, it is read for the trace, one sample per line\n"
+	       "in the form \"<time in µs> <x> <y>\", with coordinates in device\n"
+	       "units. Otherwise a synthetic trace is used.\n"
+	       "\n"
+	       "Trace output best viewed with gnuplot. See output for gnuplot commands\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	struct prediction_filter filter;
+	struct sample *samples;
+	struct error_stats predicted_error = {0},
+			   current_error = {0};
+	double resolution = 1.0;
+	unsigned int ahead = 16;
+	bool print_trace = false;
+	int nsamples;
+	int i;
+
+	enum {
+		OPT_HELP = 1,
+		OPT_RESOLUTION,
+		OPT_AHEAD,
+		OPT_PRINT_TRACE,
+	};
+
+	while (1) {
+		int c;
+		int option_index = 0;
+		static struct option long_options[] = {
+			{"help", 0, 0, OPT_HELP },
+			{"resolution", 1, 0, OPT_RESOLUTION },
+			{"ahead", 1, 0, OPT_AHEAD },
+			{"print-trace", 0, 0, OPT_PRINT_TRACE },
+			{0, 0, 0, 0}
+		};
+
+		c = getopt_long(argc, argv, "",
+				long_options, &option_index);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case OPT_HELP:
+			usage();
+			exit(0);
+			break;
+		case OPT_RESOLUTION:
+			resolution = strtod(optarg, NULL);
+			if (resolution <= 0.0) {
+				usage();
+				return 1;
+			}
+			break;
+		case OPT_AHEAD:
+			ahead = strtoul(optarg, NULL, 10);
+			break;
+		case OPT_PRINT_TRACE:
+			print_trace = true;
+			break;
+		default:
+			usage();
+			exit(1);
+			break;
+		}
+	}
+
+	samples = zalloc(MAX_SAMPLES * sizeof(*samples));
+	if (!samples)
+		return 1;
+
+	if (!isatty(STDIN_FILENO))
+		nsamples = read_trace(stdin, samples);
+	else
+		nsamples = generate_trace(samples, resolution);
+
+	prediction_filter_reset(&filter);
+	for (i = 0; i < nsamples; i++) {
+		struct device_float_coords actual;
+
+		samples[i].predicted = prediction_filter_apply(&filter,
+							       &samples[i].raw,
+							       samples[i].time,
+							       ms2us(ahead));
+
+		if (!raw_at(samples, nsamples,
+			    samples[i].time + ms2us(ahead), &actual))
+			continue;
+
+		error_stats_add(&predicted_error,
+				&samples[i].predicted,
+				&actual,
+				resolution);
+		error_stats_add(&current_error,
+				&samples[i].raw,
+				&actual,
+				resolution);
+	}
+
+	if (print_trace) {
+		printf("# gnuplot:\n");
+		printf("# set xlabel \"time (ms)\"\n");
+		printf("# set ylabel \"position\"\n");
+		printf("# set style data lines\n");
+		printf("# plot \"gnuplot.data\" using 1:2 title \"x in\", \\\n");
+		printf("#      \"gnuplot.data\" using 1:4 title \"x predicted\"\n");
+		printf("#\n");
+		for (i = 0; i < nsamples; i++)
+			printf("%.3f\t%d\t%d\t%d\t%d\n",
+			       samples[i].time/1000.0,
+			       samples[i].raw.x,
+			       samples[i].raw.y,
+			       samples[i].predicted.x,
+			       samples[i].predicted.y);
+	}
+
+	printf("# prediction: %ums ahead\n", ahead);
+	printf("# samples: %d\n", nsamples);
+	error_stats_print("error without prediction", &current_error);
+	error_stats_print("error with prediction", &predicted_error);
+
+	free(samples);
+
+	return 0;
+}
@@ -0,0 +1,243 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libevdev/libevdev.h>
+#include <libevdev/libevdev-uinput.h>
+#include <libinput.h>
+
+#include "libinput-util.h"
+#include "shared.h"
+
+/* events written before each dispatch, small enough to fit into the
+ * kernel's evdev client buffer */
+#define EVENTS_PER_BATCH 16
+
+/* Mostly motion, with the occasional button and scroll event, roughly
+ * what a mouse in use looks like */
+static void
+write_event(struct libevdev_uinput *uinput, int n)
+{
+	switch (n % 32) {
+	case 0:
+	case 1:
+		libevdev_uinput_write_event(uinput, EV_KEY, BTN_LEFT, n % 2 == 0);
+		break;
+	case 16:
+		libevdev_uinput_write_event(uinput, EV_REL, REL_WHEEL, 1);
+		break;
+	default:
+		libevdev_uinput_write_event(uinput, EV_REL, REL_X, 1 + n % 5);
+		libevdev_uinput_write_event(uinput, EV_REL, REL_Y, -1 - n % 3);
+		break;
+	}
+	libevdev_uinput_write_event(uinput, EV_SYN, SYN_REPORT, 0);
+}
+
+static int
+collect_events(struct libinput *li,
+	       struct libevdev_uinput *uinput,
+	       struct libinput_event **events,
+	       int nevents)
+{
+	struct libinput_event *event;
+	int n = 0, written = 0;
+	int i;
+
+	while (n < nevents) {
+		for (i = 0; i < EVENTS_PER_BATCH; i++)
+			write_event(uinput, written++);
+
+		libinput_dispatch(li);
+		while ((event = libinput_get_event(li))) {
+			/* skip the device added event */
+			if (n < nevents &&
+			    libinput_event_get_type(event) !=
+			    LIBINPUT_EVENT_DEVICE_ADDED)
+				events[n++] = event;
+			else
+				libinput_event_destroy(event);
+		}
+	}
+
+	return n;
+}
+
+static void
+usage(void)
+{
+	printf("Usage: %s [--events=<n>] [--rounds=<n>]\n",
+	       program_invocation_short_name);
+	printf("\n"
+	       "Creates a uinput mouse, collects the events libinput generates\n"
+	       "for it and prints how many events per second can be serialized\n"
+	       "with libinput_event_serialize() and parsed back with\n"
+	       "libinput_event_parse(). Requires access to /dev/uinput.\n"
+	       "\n"
+	       "Options:\n"
+	       "--events=<n> .... number of events to collect (default: 10000)\n"
+	       "--rounds=<n> .... number of times to encode and decode all\n"
+	       "                  events (default: 100)\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	struct libevdev_uinput *uinput;
+	struct libinput *li;
+	struct libinput_device *device;
+	struct libinput_event **events;
+	uint8_t *buffer;
+	size_t buffer_size, used = 0;
+	uint64_t start, encode = 0, decode = 0;
+	int nevents = 10000;
+	int nrounds = 100;
+	int round, i;
+
+	enum {
+		OPT_HELP = 1,
+		OPT_EVENTS,
+		OPT_ROUNDS,
+	};
+
+	while (1) {
+		int c;
+		int option_index = 0;
+		static struct option long_options[] = {
+			{"help", 0, 0, OPT_HELP },
+			{"events", 1, 0, OPT_EVENTS },
+			{"rounds", 1, 0, OPT_ROUNDS },
+			{0, 0, 0, 0}
+		};
+
+		c = getopt_long(argc, argv, "",
+				long_options, &option_index);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case OPT_HELP:
+			usage();
+			exit(0);
+			break;
+		case OPT_EVENTS:
+			nevents = atoi(optarg);
+			if (nevents <= 0) {
+				usage();
+				return 1;
+			}
+			break;
+		case OPT_ROUNDS:
+			nrounds = atoi(optarg);
+			if (nrounds <= 0) {
+				usage();
+				return 1;
+			}
+			break;
+		default:
+			usage();
+			exit(1);
+			break;
+		}
+	}
+
+	uinput = tools_create_uinput_mouse("libinput serialize benchmark");
+	if (!uinput) {
+		fprintf(stderr, "Failed to create uinput device\n");
+		return 1;
+	}
+
+	li = libinput_path_create_context(&tools_interface, NULL);
+	device = libinput_path_add_device(li,
+					  libevdev_uinput_get_devnode(uinput));
+	if (!device) {
+		fprintf(stderr, "Failed to add the device\n");
+		libinput_unref(li);
+		libevdev_uinput_destroy(uinput);
+		return 1;
+	}
+
+	events = zalloc(nevents * sizeof(*events));
+	/* the events are written back-to-back, as they would be into a
+	 * shared memory ring */
+	buffer_size = nevents * LIBINPUT_EVENT_SERIALIZED_MAX_SIZE;
+	buffer = zalloc(buffer_size);
+	if (!events || !buffer)
+		return 1;
+
+	nevents = collect_events(li, uinput, events, nevents);
+
+	for (round = 0; round < nrounds; round++) {
+		used = 0;
+		start = tools_now_ns();
+		for (i = 0; i < nevents; i++)
+			used += libinput_event_serialize(events[i],
+							 buffer + used,
+							 buffer_size - used);
+		encode += tools_now_ns() - start;
+	}
+
+	for (round = 0; round < nrounds; round++) {
+		enum libinput_event_type type;
+		union libinput_event_data data;
+		size_t offset = 0, len;
+
+		start = tools_now_ns();
+		while ((len = libinput_event_parse(buffer + offset,
+						   used - offset,
+						   &type,
+						   &data,
+						   sizeof(data))))
+			offset += len;
+		decode += tools_now_ns() - start;
+
+		if (offset != used) {
+			fprintf(stderr, "Parse error at offset %zu\n", offset);
+			return 1;
+		}
+	}
+
+	printf("events: %d\n", nevents);
+	printf("bytes/event: %.1f\n", 1.0 * used/nevents);
+	printf("encoded events/s: %.0f\n",
+	       1e9 * nevents * nrounds/max(encode, 1u));
+	printf("decoded events/s: %.0f\n",
+	       1e9 * nevents * nrounds/max(decode, 1u));
+
+	for (i = 0; i < nevents; i++)
+		libinput_event_destroy(events[i]);
+	free(events);
+	free(buffer);
+
+	libinput_unref(li);
+	libevdev_uinput_destroy(uinput);
+
+	return 0;
+}
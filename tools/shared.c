@@ -29,9 +29,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <libudev.h>
 
 #include <libevdev/libevdev.h>
+#include <libevdev/libevdev-uinput.h>
 #include <libinput-util.h>
 
 #include "shared.h"
@@ -49,6 +51,8 @@ enum options {
 	OPT_DRAG_DISABLE,
 	OPT_DRAG_LOCK_ENABLE,
 	OPT_DRAG_LOCK_DISABLE,
+	OPT_TAP_SPECULATIVE_ENABLE,
+	OPT_TAP_SPECULATIVE_DISABLE,
 	OPT_NATURAL_SCROLL_ENABLE,
 	OPT_NATURAL_SCROLL_DISABLE,
 	OPT_LEFT_HANDED_ENABLE,
@@ -57,13 +61,22 @@ enum options {
 	OPT_MIDDLEBUTTON_DISABLE,
 	OPT_DWT_ENABLE,
 	OPT_DWT_DISABLE,
+	OPT_SMOOTHING_ENABLE,
+	OPT_SMOOTHING_DISABLE,
+	OPT_PREDICTION,
+	OPT_TABLET_HISTORY,
 	OPT_CLICK_METHOD,
 	OPT_SCROLL_METHOD,
 	OPT_SCROLL_BUTTON,
 	OPT_SPEED,
 	OPT_PROFILE,
 	OPT_SHOW_KEYCODES,
+	OPT_SHOW_LATENCY,
+	OPT_SHOW_CPU_STATS,
 	OPT_QUIET,
+	OPT_TRACE_BUFFER,
+	OPT_STATS,
+	OPT_BINARY,
 };
 
 LIBINPUT_ATTRIBUTE_PRINTF(3, 0)
@@ -109,6 +122,8 @@ tools_usage(void)
 	       "--disable-drag.... enable/disable tap-n-drag\n"
 	       "--enable-drag-lock\n"
 	       "--disable-drag-lock.... enable/disable tapping drag lock\n"
+	       "--enable-speculative-tap\n"
+	       "--disable-speculative-tap.... enable/disable click on finger up\n"
 	       "--enable-natural-scrolling\n"
 	       "--disable-natural-scrolling.... enable/disable natural scrolling\n"
 	       "--enable-left-handed\n"
@@ -117,6 +132,10 @@ tools_usage(void)
 	       "--disable-middlebutton.... enable/disable middle button emulation\n"
 	       "--enable-dwt\n"
 	       "--disable-dwt..... enable/disable disable-while-typing\n"
+	       "--enable-smoothing\n"
+	       "--disable-smoothing..... enable/disable touch smoothing\n"
+	       "--set-prediction=<ms>.... set the touch/tablet prediction time (0 disables)\n"
+	       "--set-tablet-history=<ms>.... merge tablet axis events within this window (0 disables)\n"
 	       "--set-click-method=[none|clickfinger|buttonareas] .... set the desired click method\n"
 	       "--set-scroll-method=[none|twofinger|edge|button] ... set the desired scroll method\n"
 	       "--set-scroll-button=BTN_MIDDLE ... set the button to the given button code\n"
@@ -124,6 +143,10 @@ tools_usage(void)
 	       "--set-speed=<value>.... set pointer acceleration speed (allowed range [-1, 1]) \n"
 	       "--set-tap-map=[lrm|lmr] ... set button mapping for tapping\n"
 	       "--show-keycodes.... show all key codes while typing\n"
+	       "--show-latency.... print each device's event latency histograms every second and on removal or exit\n"
+	       "--show-cpu-stats.... print the time spent processing each device's events on removal or exit\n"
+	       "--stats.......... print event rates and intervals once per second instead of the events\n"
+	       "--binary=<file>.. write the events as binary records to file instead of printing them\n"
 	       "\n"
 	       "These options apply to all applicable devices, if a feature\n"
 	       "is not explicitly specified it is left at each device's default.\n"
@@ -132,6 +155,7 @@ tools_usage(void)
 	       "--grab .......... Exclusively grab all openend devices\n"
 	       "--verbose ....... Print debugging output.\n"
 	       "--quiet ......... Only print libinput messages, useful in combination with --verbose.\n"
+	       "--trace-buffer=<n> Record the last n debug messages in memory and print them on exit.\n"
 	       "--help .......... Print this help.\n",
 		program_invocation_short_name);
 }
@@ -148,10 +172,14 @@ tools_init_context(struct tools_context *context)
 	options->tap_map = -1;
 	options->drag = -1;
 	options->drag_lock = -1;
+	options->speculative_tap = -1;
 	options->natural_scroll = -1;
 	options->left_handed = -1;
 	options->middlebutton = -1;
 	options->dwt = -1;
+	options->smoothing = -1;
+	options->prediction = -1;
+	options->tablet_history = -1;
 	options->click_method = -1;
 	options->scroll_method = -1;
 	options->scroll_button = -1;
@@ -160,6 +188,8 @@ tools_init_context(struct tools_context *context)
 	options->speed = 0.0;
 	options->profile = LIBINPUT_CONFIG_ACCEL_PROFILE_NONE;
 	options->show_keycodes = false;
+	options->show_latency = false;
+	options->show_cpu_stats = false;
 }
 
 int
@@ -177,12 +207,17 @@ tools_parse_args(int argc, char **argv, struct tools_context *context)
 			{ "help", 0, 0, OPT_HELP },
 			{ "verbose", 0, 0, OPT_VERBOSE },
 			{ "quiet", 0, 0, OPT_QUIET },
+			{ "trace-buffer", 1, 0, OPT_TRACE_BUFFER },
+			{ "stats", 0, 0, OPT_STATS },
+			{ "binary", 1, 0, OPT_BINARY },
 			{ "enable-tap", 0, 0, OPT_TAP_ENABLE },
 			{ "disable-tap", 0, 0, OPT_TAP_DISABLE },
 			{ "enable-drag", 0, 0, OPT_DRAG_ENABLE },
 			{ "disable-drag", 0, 0, OPT_DRAG_DISABLE },
 			{ "enable-drag-lock", 0, 0, OPT_DRAG_LOCK_ENABLE },
 			{ "disable-drag-lock", 0, 0, OPT_DRAG_LOCK_DISABLE },
+			{ "enable-speculative-tap", 0, 0, OPT_TAP_SPECULATIVE_ENABLE },
+			{ "disable-speculative-tap", 0, 0, OPT_TAP_SPECULATIVE_DISABLE },
 			{ "enable-natural-scrolling", 0, 0, OPT_NATURAL_SCROLL_ENABLE },
 			{ "disable-natural-scrolling", 0, 0, OPT_NATURAL_SCROLL_DISABLE },
 			{ "enable-left-handed", 0, 0, OPT_LEFT_HANDED_ENABLE },
@@ -191,6 +226,10 @@ tools_parse_args(int argc, char **argv, struct tools_context *context)
 			{ "disable-middlebutton", 0, 0, OPT_MIDDLEBUTTON_DISABLE },
 			{ "enable-dwt", 0, 0, OPT_DWT_ENABLE },
 			{ "disable-dwt", 0, 0, OPT_DWT_DISABLE },
+			{ "enable-smoothing", 0, 0, OPT_SMOOTHING_ENABLE },
+			{ "disable-smoothing", 0, 0, OPT_SMOOTHING_DISABLE },
+			{ "set-prediction", 1, 0, OPT_PREDICTION },
+			{ "set-tablet-history", 1, 0, OPT_TABLET_HISTORY },
 			{ "set-click-method", 1, 0, OPT_CLICK_METHOD },
 			{ "set-scroll-method", 1, 0, OPT_SCROLL_METHOD },
 			{ "set-scroll-button", 1, 0, OPT_SCROLL_BUTTON },
@@ -198,6 +237,8 @@ tools_parse_args(int argc, char **argv, struct tools_context *context)
 			{ "set-tap-map", 1, 0, OPT_TAP_MAP },
 			{ "set-speed", 1, 0, OPT_SPEED },
 			{ "show-keycodes", 0, 0, OPT_SHOW_KEYCODES },
+			{ "show-latency", 0, 0, OPT_SHOW_LATENCY },
+			{ "show-cpu-stats", 0, 0, OPT_SHOW_CPU_STATS },
 			{ 0, 0, 0, 0}
 		};
 
@@ -261,6 +302,12 @@ tools_parse_args(int argc, char **argv, struct tools_context *context)
 		case OPT_DRAG_LOCK_DISABLE:
 			options->drag_lock = 0;
 			break;
+		case OPT_TAP_SPECULATIVE_ENABLE:
+			options->speculative_tap = 1;
+			break;
+		case OPT_TAP_SPECULATIVE_DISABLE:
+			options->speculative_tap = 0;
+			break;
 		case OPT_NATURAL_SCROLL_ENABLE:
 			options->natural_scroll = 1;
 			break;
@@ -285,6 +332,34 @@ tools_parse_args(int argc, char **argv, struct tools_context *context)
 		case OPT_DWT_DISABLE:
 			options->dwt = LIBINPUT_CONFIG_DWT_DISABLED;
 			break;
+		case OPT_SMOOTHING_ENABLE:
+			options->smoothing = LIBINPUT_CONFIG_SMOOTHING_ENABLED;
+			break;
+		case OPT_SMOOTHING_DISABLE:
+			options->smoothing = LIBINPUT_CONFIG_SMOOTHING_DISABLED;
+			break;
+		case OPT_PREDICTION:
+			if (!optarg) {
+				tools_usage();
+				return 1;
+			}
+			options->prediction = atoi(optarg);
+			if (options->prediction < 0) {
+				tools_usage();
+				return 1;
+			}
+			break;
+		case OPT_TABLET_HISTORY:
+			if (!optarg) {
+				tools_usage();
+				return 1;
+			}
+			options->tablet_history = atoi(optarg);
+			if (options->tablet_history < 0) {
+				tools_usage();
+				return 1;
+			}
+			break;
 		case OPT_CLICK_METHOD:
 			if (!optarg) {
 				tools_usage();
@@ -365,9 +440,32 @@ tools_parse_args(int argc, char **argv, struct tools_context *context)
 		case OPT_SHOW_KEYCODES:
 			options->show_keycodes = true;
 			break;
+		case OPT_SHOW_LATENCY:
+			options->show_latency = true;
+			break;
+		case OPT_SHOW_CPU_STATS:
+			options->show_cpu_stats = true;
+			break;
 		case OPT_QUIET:
 			options->quiet = true;
 			break;
+		case OPT_TRACE_BUFFER:
+			if (!optarg) {
+				tools_usage();
+				return 1;
+			}
+			options->trace_buffer = atoi(optarg);
+			break;
+		case OPT_STATS:
+			options->stats = true;
+			break;
+		case OPT_BINARY:
+			if (!optarg) {
+				tools_usage();
+				return 1;
+			}
+			options->binary = optarg;
+			break;
 		default:
 			tools_usage();
 			return 1;
@@ -459,7 +557,7 @@ open_restricted(const char *path, int flags, void *user_data)
 	if (fd < 0)
 		fprintf(stderr, "Failed to open %s (%s)\n",
 			path, strerror(errno));
-	else if (context->options.grab &&
+	else if (context && context->options.grab &&
 		 ioctl(fd, EVIOCGRAB, (void*)1) == -1)
 		fprintf(stderr, "Grab requested, but failed for %s (%s)\n",
 			path, strerror(errno));
@@ -473,11 +571,27 @@ close_restricted(int fd, void *user_data)
 	close(fd);
 }
 
-static const struct libinput_interface interface = {
+const struct libinput_interface tools_interface = {
 	.open_restricted = open_restricted,
 	.close_restricted = close_restricted,
 };
 
+static int
+virtual_open_restricted(const char *path, int flags, void *user_data)
+{
+	return -ENODEV;
+}
+
+static void
+virtual_close_restricted(int fd, void *user_data)
+{
+}
+
+const struct libinput_interface tools_virtual_interface = {
+	.open_restricted = virtual_open_restricted,
+	.close_restricted = virtual_close_restricted,
+};
+
 struct libinput *
 tools_open_backend(struct tools_context *context)
 {
@@ -485,12 +599,16 @@ tools_open_backend(struct tools_context *context)
 	struct tools_options *options = &context->options;
 
 	if (options->backend == BACKEND_UDEV) {
-		li = open_udev(&interface, context, options->seat, options->verbose);
+		li = open_udev(&tools_interface, context, options->seat, options->verbose);
 	} else if (options->backend == BACKEND_DEVICE) {
-		li = open_device(&interface, context, options->device, options->verbose);
+		li = open_device(&tools_interface, context, options->device, options->verbose);
 	} else
 		abort();
 
+	if (li && options->trace_buffer > 0 &&
+	    libinput_log_set_trace_buffer(li, options->trace_buffer) != 0)
+		fprintf(stderr, "Failed to set up the trace buffer\n");
+
 	return li;
 }
 
@@ -509,6 +627,9 @@ tools_device_apply_config(struct libinput_device *device,
 	if (options->drag_lock != -1)
 		libinput_device_config_tap_set_drag_lock_enabled(device,
 								 options->drag_lock);
+	if (options->speculative_tap != -1)
+		libinput_device_config_tap_set_speculative_enabled(device,
+								   options->speculative_tap);
 	if (options->natural_scroll != -1)
 		libinput_device_config_scroll_set_natural_scroll_enabled(device,
 									 options->natural_scroll);
@@ -521,6 +642,18 @@ tools_device_apply_config(struct libinput_device *device,
 	if (options->dwt != -1)
 		libinput_device_config_dwt_set_enabled(device, options->dwt);
 
+	if (options->smoothing != -1)
+		libinput_device_config_smoothing_set_enabled(device,
+							     options->smoothing);
+
+	if (options->prediction != -1)
+		libinput_device_config_prediction_set_time(device,
+							   options->prediction);
+
+	if (options->tablet_history != -1)
+		libinput_device_config_tablet_history_set_window(device,
+								 options->tablet_history);
+
 	if (options->click_method != (enum libinput_config_click_method)-1)
 		libinput_device_config_click_set_method(device, options->click_method);
 
@@ -539,3 +672,37 @@ tools_device_apply_config(struct libinput_device *device,
 								 options->profile);
 	}
 }
+
+uint64_t
+tools_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+struct libevdev_uinput *
+tools_create_uinput_mouse(const char *name)
+{
+	struct libevdev *dev;
+	struct libevdev_uinput *uinput = NULL;
+
+	dev = libevdev_new();
+	libevdev_set_name(dev, name);
+	libevdev_set_id_bustype(dev, BUS_USB);
+	libevdev_enable_event_code(dev, EV_REL, REL_X, NULL);
+	libevdev_enable_event_code(dev, EV_REL, REL_Y, NULL);
+	libevdev_enable_event_code(dev, EV_REL, REL_WHEEL, NULL);
+	libevdev_enable_event_code(dev, EV_KEY, BTN_LEFT, NULL);
+	libevdev_enable_event_code(dev, EV_KEY, BTN_RIGHT, NULL);
+
+	if (libevdev_uinput_create_from_device(dev,
+					       LIBEVDEV_UINPUT_OPEN_MANAGED,
+					       &uinput) != 0)
+		uinput = NULL;
+
+	libevdev_free(dev);
+
+	return uinput;
+}
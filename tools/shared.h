@@ -25,9 +25,12 @@
 #define _SHARED_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include <libinput.h>
 
+struct libevdev_uinput;
+
 enum tools_backend {
 	BACKEND_DEVICE,
 	BACKEND_UDEV
@@ -39,12 +42,18 @@ struct tools_options {
 	const char *seat; /* if backend is BACKEND_UDEV */
 	int grab; /* EVIOCGRAB */
 	bool show_keycodes; /* show keycodes */
+	bool show_latency; /* print latency histograms */
+	bool show_cpu_stats; /* print CPU accounting stats */
+	bool stats; /* print event rates instead of events */
+	const char *binary; /* file to write binary records to */
 	bool quiet; /* only print libinput messages */
+	unsigned int trace_buffer; /* trace buffer size, 0 for none */
 
 	int verbose;
 	int tapping;
 	int drag;
 	int drag_lock;
+	int speculative_tap;
 	int natural_scroll;
 	int left_handed;
 	int middlebutton;
@@ -54,6 +63,9 @@ struct tools_options {
 	int scroll_button;
 	double speed;
 	int dwt;
+	int smoothing;
+	int prediction;
+	int tablet_history;
 	enum libinput_config_accel_profile profile;
 };
 
@@ -69,4 +81,14 @@ void tools_device_apply_config(struct libinput_device *device,
 			       struct tools_options *options);
 void tools_usage(void);
 
+/* Opens the device node, user_data is a struct tools_context or NULL */
+extern const struct libinput_interface tools_interface;
+/* Fails every open, for contexts that only have devices without a device
+ * node, see path_add_virtual_device() */
+extern const struct libinput_interface tools_virtual_interface;
+
+uint64_t tools_now_ns(void);
+/* A relative mouse with two buttons and a wheel, for the benchmarks */
+struct libevdev_uinput *tools_create_uinput_mouse(const char *name);
+
 #endif
@@ -0,0 +1,363 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "filter.h"
+#include "libinput-util.h"
+
+#define MAX_SAMPLES 65536
+#define MAX_LATENCY ms2us(100)
+#define LATENCY_STEP 250 /* µs */
+
+struct sample {
+	uint64_t time;
+	struct device_float_coords raw;
+	struct device_float_coords filtered;
+};
+
+/* A synthetic trace at 125Hz: the finger rests for 1s, moves along the x
+ * axis at 100mm/s for 1s and rests again for 1s. Every sample has up to
+ * ±0.2mm of noise added.
+ */
+static int
+generate_trace(struct sample *samples, double resolution)
+{
+	const int nsamples = 375;
+	double x = 10.0;
+	int i;
+
+	srand(0);
+
+	for (i = 0; i < nsamples; i++) {
+		double noise_x = (rand() / (double)RAND_MAX - 0.5) * 0.4,
+		       noise_y = (rand() / (double)RAND_MAX - 0.5) * 0.4;
+
+		if (i >= 125 && i < 250)
+			x += 100.0 * 0.008;
+
+		samples[i].time = ms2us(8) * (i + 1);
+		samples[i].raw.x = (x + noise_x) * resolution;
+		samples[i].raw.y = (10.0 + noise_y) * resolution;
+	}
+
+	return nsamples;
+}
+
+static int
+read_trace(FILE *fp, struct sample *samples)
+{
+	char line[256];
+	int nsamples = 0;
+
+	while (fgets(line, sizeof(line), fp) && nsamples < MAX_SAMPLES) {
+		unsigned long long time;
+		double x, y;
+
+		if (line[0] == '#' || line[0] == '\n')
+			continue;
+
+		if (sscanf(line, "%llu %lf %lf", &time, &x, &y) != 3) {
+			fprintf(stderr, "Invalid line: %s", line);
+			continue;
+		}
+
+		samples[nsamples].time = time;
+		samples[nsamples].raw.x = x;
+		samples[nsamples].raw.y = y;
+		nsamples++;
+	}
+
+	return nsamples;
+}
+
+/* Raw position at the given time, linearly interpolated */
+static bool
+raw_at(const struct sample *samples, int nsamples, uint64_t time,
+       struct device_float_coords *pos)
+{
+	int lo = 0, hi, i;
+	double f;
+
+	if (nsamples == 0 ||
+	    time < samples[0].time ||
+	    time > samples[nsamples - 1].time)
+		return false;
+
+	/* first sample at or after time */
+	hi = nsamples - 1;
+	while (lo < hi) {
+		int mid = (lo + hi)/2;
+
+		if (samples[mid].time < time)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	i = lo;
+
+	if (i == 0 || samples[i].time == samples[i - 1].time) {
+		*pos = samples[i].raw;
+		return true;
+	}
+
+	f = 1.0 * (time - samples[i - 1].time)/
+		  (samples[i].time - samples[i - 1].time);
+	pos->x = samples[i - 1].raw.x + f * (samples[i].raw.x - samples[i - 1].raw.x);
+	pos->y = samples[i - 1].raw.y + f * (samples[i].raw.y - samples[i - 1].raw.y);
+
+	return true;
+}
+
+/* The latency is the time shift that best aligns the filtered trace with
+ * the unfiltered one, i.e. filtered(t) ≈ raw(t - latency) */
+static uint64_t
+estimate_latency(const struct sample *samples, int nsamples)
+{
+	uint64_t shift, best_shift = 0;
+	double best_error = INFINITY;
+
+	for (shift = 0; shift <= MAX_LATENCY; shift += LATENCY_STEP) {
+		double error = 0.0;
+		int i, n = 0;
+
+		for (i = 0; i < nsamples; i++) {
+			struct device_float_coords pos;
+
+			if (samples[i].time < shift ||
+			    !raw_at(samples, nsamples,
+				    samples[i].time - shift, &pos))
+				continue;
+
+			error += pow(samples[i].filtered.x - pos.x, 2) +
+				 pow(samples[i].filtered.y - pos.y, 2);
+			n++;
+		}
+
+		if (n == 0)
+			break;
+
+		error /= n;
+		if (error < best_error) {
+			best_error = error;
+			best_shift = shift;
+		}
+	}
+
+	return best_shift;
+}
+
+/* RMS of the second difference. For motion at constant speed the second
+ * difference is zero, what's left is jitter. */
+static double
+jitter(const struct sample *samples, int nsamples, bool filtered,
+       double resolution)
+{
+	double sum = 0.0;
+	int i;
+
+	if (nsamples < 3)
+		return 0.0;
+
+	for (i = 1; i < nsamples - 1; i++) {
+		const struct device_float_coords *a, *b, *c;
+
+		if (filtered) {
+			a = &samples[i - 1].filtered;
+			b = &samples[i].filtered;
+			c = &samples[i + 1].filtered;
+		} else {
+			a = &samples[i - 1].raw;
+			b = &samples[i].raw;
+			c = &samples[i + 1].raw;
+		}
+
+		sum += pow(a->x - 2 * b->x + c->x, 2) +
+		       pow(a->y - 2 * b->y + c->y, 2);
+	}
+
+	return sqrt(sum/(nsamples - 2))/resolution;
+}
+
+static void
+usage(void)
+{
+	printf("Usage: %s [options] [< trace]\n", program_invocation_short_name);
+	printf("\n"
+	       "Runs a touch trace through the adaptive touch smoothing filter\n"
+	       "and prints the latency added and the jitter left by the filter.\n"
+	       "\n"
+	       "Options:\n"
+	       "--resolution=<double> ... device resolution in units/mm (default: 1)\n"
+	       "--min-cutoff=<double> ... cutoff frequency at zero speed in Hz\n"
+	       "--beta=<double> ......... cutoff increase in Hz per mm/s\n"
+	       "--dcutoff=<double> ...... cutoff frequency for the speed in Hz\n"
+	       "--print-trace ........... print the filtered trace\n"
+	       "\n"
+	       "If stdin is a pipe, it is read for the trace, one sample per line\n"
+	       "in the form \"<time in µs> <x> <y>\", with coordinates in device\n"
+	       "units. Otherwise a synthetic trace is used.\n"
+	       "\n"
+	       "Trace output best viewed with gnuplot. See output for gnuplot commands\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	struct smoothing_params params;
+	struct smoothing_filter filter;
+	struct sample *samples;
+	double resolution = 1.0;
+	double min_cutoff = -1,
+	       beta = -1,
+	       dcutoff = -1;
+	bool print_trace = false;
+	double raw_jitter, filtered_jitter;
+	int nsamples;
+	int i;
+
+	enum {
+		OPT_HELP = 1,
+		OPT_RESOLUTION,
+		OPT_MIN_CUTOFF,
+		OPT_BETA,
+		OPT_DCUTOFF,
+		OPT_PRINT_TRACE,
+	};
+
+	while (1) {
+		int c;
+		int option_index = 0;
+		static struct option long_options[] = {
+			{"help", 0, 0, OPT_HELP },
+			{"resolution", 1, 0, OPT_RESOLUTION },
+			{"min-cutoff", 1, 0, OPT_MIN_CUTOFF },
+			{"beta", 1, 0, OPT_BETA },
+			{"dcutoff", 1, 0, OPT_DCUTOFF },
+			{"print-trace", 0, 0, OPT_PRINT_TRACE },
+			{0, 0, 0, 0}
+		};
+
+		c = getopt_long(argc, argv, "",
+				long_options, &option_index);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case OPT_HELP:
+			usage();
+			exit(0);
+			break;
+		case OPT_RESOLUTION:
+			resolution = strtod(optarg, NULL);
+			if (resolution <= 0.0) {
+				usage();
+				return 1;
+			}
+			break;
+		case OPT_MIN_CUTOFF:
+			min_cutoff = strtod(optarg, NULL);
+			break;
+		case OPT_BETA:
+			beta = strtod(optarg, NULL);
+			break;
+		case OPT_DCUTOFF:
+			dcutoff = strtod(optarg, NULL);
+			break;
+		case OPT_PRINT_TRACE:
+			print_trace = true;
+			break;
+		default:
+			usage();
+			exit(1);
+			break;
+		}
+	}
+
+	samples = zalloc(MAX_SAMPLES * sizeof(*samples));
+	if (!samples)
+		return 1;
+
+	if (!isatty(STDIN_FILENO))
+		nsamples = read_trace(stdin, samples);
+	else
+		nsamples = generate_trace(samples, resolution);
+
+	smoothing_params_init(&params, resolution, resolution);
+	if (min_cutoff > 0.0)
+		params.min_cutoff = min_cutoff;
+	if (beta >= 0.0)
+		params.beta = beta;
+	if (dcutoff > 0.0)
+		params.dcutoff = dcutoff;
+
+	smoothing_filter_reset(&filter);
+	for (i = 0; i < nsamples; i++)
+		samples[i].filtered = smoothing_filter_apply(&filter,
+							     &params,
+							     &samples[i].raw,
+							     samples[i].time);
+
+	if (print_trace) {
+		printf("# gnuplot:\n");
+		printf("# set xlabel \"time (ms)\"\n");
+		printf("# set ylabel \"position\"\n");
+		printf("# set style data lines\n");
+		printf("# plot \"gnuplot.data\" using 1:2 title \"x in\", \\\n");
+		printf("#      \"gnuplot.data\" using 1:4 title \"x out\"\n");
+		printf("#\n");
+		for (i = 0; i < nsamples; i++)
+			printf("%.3f\t%.3f\t%.3f\t%.3f\t%.3f\n",
+			       samples[i].time/1000.0,
+			       samples[i].raw.x,
+			       samples[i].raw.y,
+			       samples[i].filtered.x,
+			       samples[i].filtered.y);
+	}
+
+	raw_jitter = jitter(samples, nsamples, false, resolution);
+	filtered_jitter = jitter(samples, nsamples, true, resolution);
+
+	printf("# min-cutoff %.2fHz beta %.3f dcutoff %.2fHz\n",
+	       params.min_cutoff, params.beta, params.dcutoff);
+	printf("# samples: %d\n", nsamples);
+	printf("# latency: %.2fms\n",
+	       estimate_latency(samples, nsamples)/1000.0);
+	printf("# jitter: %.3fmm in, %.3fmm out (%.0f%%)\n",
+	       raw_jitter,
+	       filtered_jitter,
+	       raw_jitter > 0.0 ? 100.0 * filtered_jitter/raw_jitter : 0.0);
+
+	free(samples);
+
+	return 0;
+}
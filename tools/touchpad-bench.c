@@ -0,0 +1,363 @@
+/*
+ * Copyright © 2017 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include <libevdev/libevdev.h>
+#include <libinput.h>
+
+#include "evdev.h"
+#include "path-seat.h"
+#include "timer.h"
+#include "shared.h"
+
+/* The benchmark links against libinput-internal.la and calls the
+ * touchpad's process function directly, there is no device node, no
+ * read() and no event queue in the measured path. */
+
+#define NFINGERS 5
+/* frames between clock moves, see main() */
+#define FRAMES_PER_BATCH 8
+#define MAX_FRAME_EVENTS (NFINGERS * 4 + 5)
+#define FRAME_INTERVAL ms2us(8)
+
+struct counter {
+	int fd;
+	uint64_t value;
+};
+
+struct frame {
+	struct input_event events[MAX_FRAME_EVENTS];
+	size_t nevents;
+};
+
+static void
+counter_open(struct counter *counter, uint64_t config)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = config;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	counter->value = 0;
+	counter->fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static inline void
+counter_start(struct counter *counter)
+{
+	if (counter->fd != -1)
+		ioctl(counter->fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+static inline void
+counter_stop(struct counter *counter)
+{
+	if (counter->fd != -1)
+		ioctl(counter->fd, PERF_EVENT_IOC_DISABLE, 0);
+}
+
+static void
+counter_close(struct counter *counter)
+{
+	if (counter->fd == -1)
+		return;
+
+	if (read(counter->fd, &counter->value, sizeof(counter->value)) !=
+	    sizeof(counter->value))
+		counter->value = 0;
+	close(counter->fd);
+}
+
+static void
+counter_print(const char *name, const struct counter *counter, int nframes)
+{
+	if (counter->fd == -1)
+		printf("%s/frame: n/a\n", name);
+	else
+		printf("%s/frame: %.1f\n", name, 1.0 * counter->value/nframes);
+}
+
+static struct evdev_device *
+add_touchpad(struct libinput *li)
+{
+	struct libinput_device *device;
+	struct libevdev *evdev;
+	struct input_absinfo abs[] = {
+		{ ABS_X, 0, 4000, 0, 0, 40 },
+		{ ABS_Y, 0, 2600, 0, 0, 40 },
+		{ ABS_MT_SLOT, 0, NFINGERS - 1, 0, 0, 0 },
+		{ ABS_MT_POSITION_X, 0, 4000, 0, 0, 40 },
+		{ ABS_MT_POSITION_Y, 0, 2600, 0, 0, 40 },
+		{ ABS_MT_TRACKING_ID, 0, 65535, 0, 0, 0 },
+	};
+	unsigned int codes[] = {
+		BTN_LEFT, BTN_TOUCH, BTN_TOOL_FINGER, BTN_TOOL_DOUBLETAP,
+		BTN_TOOL_TRIPLETAP, BTN_TOOL_QUADTAP, BTN_TOOL_QUINTTAP,
+	};
+	const char *properties[] = {
+		"ID_INPUT", "1",
+		"ID_INPUT_TOUCHPAD", "1",
+		NULL,
+	};
+	size_t i;
+
+	evdev = libevdev_new();
+	libevdev_set_name(evdev, "libinput touchpad benchmark");
+	libevdev_set_id_bustype(evdev, BUS_I2C);
+	libevdev_enable_property(evdev, INPUT_PROP_POINTER);
+	libevdev_enable_property(evdev, INPUT_PROP_BUTTONPAD);
+
+	for (i = 0; i < ARRAY_LENGTH(codes); i++)
+		libevdev_enable_event_code(evdev, EV_KEY, codes[i], NULL);
+	/* .value is the axis code, as in litest */
+	for (i = 0; i < ARRAY_LENGTH(abs); i++) {
+		struct input_absinfo a = abs[i];
+
+		a.value = 0;
+		libevdev_enable_event_code(evdev, EV_ABS, abs[i].value, &a);
+	}
+
+	/* the device owns the libevdev context */
+	device = path_add_virtual_device(li, evdev, "event0", properties, -1);
+	if (!device)
+		return NULL;
+
+	return evdev_device(device);
+}
+
+static inline void
+frame_append(struct frame *frame,
+	     uint64_t time,
+	     unsigned int type,
+	     unsigned int code,
+	     int value)
+{
+	struct input_event *ev = &frame->events[frame->nevents++];
+
+	ev->time.tv_sec = time / s2us(1);
+	ev->time.tv_usec = time % s2us(1);
+	ev->type = type;
+	ev->code = code;
+	ev->value = value;
+}
+
+static void
+build_frame(struct frame *frame, int n, uint64_t time, bool first)
+{
+	int slot;
+
+	frame->nevents = 0;
+
+	for (slot = 0; slot < NFINGERS; slot++) {
+		frame_append(frame, time, EV_ABS, ABS_MT_SLOT, slot);
+		if (first)
+			frame_append(frame, time, EV_ABS, ABS_MT_TRACKING_ID,
+				     slot);
+		frame_append(frame, time, EV_ABS, ABS_MT_POSITION_X,
+			     500 + slot * 600 + n % 400);
+		frame_append(frame, time, EV_ABS, ABS_MT_POSITION_Y,
+			     800 + n % 800);
+	}
+
+	if (first) {
+		frame_append(frame, time, EV_KEY, BTN_TOUCH, 1);
+		frame_append(frame, time, EV_KEY, BTN_TOOL_QUINTTAP, 1);
+	}
+	frame_append(frame, time, EV_ABS, ABS_X, 500 + n % 400);
+	frame_append(frame, time, EV_ABS, ABS_Y, 800 + n % 800);
+	frame_append(frame, time, EV_SYN, SYN_REPORT, 0);
+}
+
+static inline void
+process_frame(struct evdev_device *device, struct frame *frame)
+{
+	struct evdev_dispatch *dispatch = device->dispatch;
+	uint64_t time;
+	size_t i;
+
+	time = s2us(frame->events[0].time.tv_sec) +
+	       frame->events[0].time.tv_usec;
+
+	for (i = 0; i < frame->nevents; i++)
+		dispatch->interface->process(dispatch,
+					     device,
+					     &frame->events[i],
+					     time);
+}
+
+static void
+drain_events(struct libinput *li)
+{
+	struct libinput_event *event;
+
+	libinput_dispatch(li);
+	while ((event = libinput_get_event(li)))
+		libinput_event_destroy(event);
+}
+
+static void
+usage(void)
+{
+	printf("Usage: %s [--frames=<n>]\n", program_invocation_short_name);
+	printf("\n"
+	       "Creates a touchpad without a device node, feeds a %d-finger\n"
+	       "trace straight into the touchpad's event processing and prints\n"
+	       "the time and the cache misses per frame. The cache misses\n"
+	       "require access to the perf counters (see perf_event_paranoid).\n"
+	       "\n"
+	       "Options:\n"
+	       "--frames=<n> .... number of frames to replay (default: 10000)\n",
+	       NFINGERS);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct libinput_clock *clock;
+	struct libinput *li;
+	struct evdev_device *device;
+	struct counter misses, references;
+	struct frame frames[FRAMES_PER_BATCH];
+	uint64_t elapsed = 0, time;
+	int nframes = 10000;
+	int frame, i;
+
+	enum {
+		OPT_HELP = 1,
+		OPT_FRAMES,
+	};
+
+	while (1) {
+		int c;
+		int option_index = 0;
+		static struct option long_options[] = {
+			{"help", 0, 0, OPT_HELP },
+			{"frames", 1, 0, OPT_FRAMES },
+			{0, 0, 0, 0}
+		};
+
+		c = getopt_long(argc, argv, "",
+				long_options, &option_index);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case OPT_HELP:
+			usage();
+			exit(0);
+			break;
+		case OPT_FRAMES:
+			nframes = atoi(optarg);
+			if (nframes <= 0) {
+				usage();
+				return 1;
+			}
+			break;
+		default:
+			usage();
+			exit(1);
+			break;
+		}
+	}
+
+	/* The frame times are made up, the timers follow them on a
+	 * virtual clock */
+	time = tools_now_ns() / 1000;
+	clock = libinput_clock_create_virtual(time);
+	li = libinput_path_create_context(&tools_virtual_interface, NULL);
+	if (!clock || !li)
+		return 1;
+	libinput_clock_attach(clock, li);
+
+	device = add_touchpad(li);
+	if (!device || device->dispatch->dispatch_type != DISPATCH_TOUCHPAD) {
+		fprintf(stderr, "Failed to add the device as touchpad\n");
+		libinput_unref(li);
+		libinput_clock_destroy(clock);
+		return 1;
+	}
+	drain_events(li);
+
+	build_frame(&frames[0], 0, time, true);
+	process_frame(device, &frames[0]);
+	drain_events(li);
+
+	counter_open(&misses, PERF_COUNT_HW_CACHE_MISSES);
+	counter_open(&references, PERF_COUNT_HW_CACHE_REFERENCES);
+
+	for (frame = 1; frame <= nframes; frame += FRAMES_PER_BATCH) {
+		uint64_t start;
+
+		for (i = 0; i < FRAMES_PER_BATCH; i++) {
+			time += FRAME_INTERVAL;
+			build_frame(&frames[i], frame + i, time, false);
+		}
+
+		counter_start(&misses);
+		counter_start(&references);
+		start = tools_now_ns();
+
+		for (i = 0; i < FRAMES_PER_BATCH; i++)
+			process_frame(device, &frames[i]);
+
+		elapsed += tools_now_ns() - start;
+		counter_stop(&references);
+		counter_stop(&misses);
+
+		/* timers and the event queue are not part of the
+		 * measurement */
+		libinput_clock_set_time(clock, time);
+		drain_events(li);
+	}
+	nframes = frame - 1;
+
+	counter_close(&misses);
+	counter_close(&references);
+
+	printf("fingers: %d\n", NFINGERS);
+	printf("frames: %d\n", nframes);
+	printf("ns/frame: %.1f\n", 1.0 * elapsed/nframes);
+	counter_print("cache-references", &references, nframes);
+	counter_print("cache-misses", &misses, nframes);
+
+	libinput_unref(li);
+	libinput_clock_destroy(clock);
+
+	return 0;
+}